@@ -0,0 +1,748 @@
+/*
+ * AlphaAHB V5 Columnar Store
+ *
+ * Memory-mapped columnar file format for the analytics examples. A file holds
+ * a fixed number of rows split into chunks of chunk_rows rows; chunk k of
+ * every column covers the same rows, so a predicate on one column selects
+ * rows of another chunk by chunk.
+ *
+ *   offset 0    colstore_header_t          64 bytes
+ *   offset 64   colstore_column_info_t[]   32 bytes per column
+ *   directory   colstore_chunk_t[]         64 bytes per chunk, column-major
+ *   data        chunk payloads, each aligned to COLSTORE_ALIGN bytes
+ *
+ * Every chunk descriptor carries min/max (and a NaN count) so scans can skip
+ * chunks a range predicate rules out, and can evaluate chunks that lie
+ * entirely inside the range without touching the predicate column at all.
+ *
+ * Chunk encodings:
+ *
+ *   COLSTORE_PLAIN  raw little-endian values; float chunks are scanned in
+ *                   place from the mapping (zero copy)
+ *   COLSTORE_FOR    int32 frame of reference: value - chunk minimum,
+ *                   bit-packed at the minimal width
+ *   COLSTORE_DELTA  int32 delta: successive differences minus their minimum,
+ *                   bit-packed; suits sorted keys such as timestamps
+ *
+ * The writer picks the smallest encoding per chunk unless a column asks for
+ * a specific one. Files use host byte order (little-endian on every
+ * supported host) and are validated when opened.
+ *
+ * Requires _POSIX_C_SOURCE >= 200809L and -pthread.
+ */
+
+#ifndef ALPHAAHB_COLUMNAR_STORE_H
+#define ALPHAAHB_COLUMNAR_STORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "parallel-runtime.h"
+#include "statistics-engine.h"
+
+#define COLSTORE_MAGIC "AAHBCOL1"
+#define COLSTORE_VERSION 1
+#define COLSTORE_ALIGN 64
+#define COLSTORE_NAME_LEN 24
+
+// Default rows per chunk: 256 KB of floats, L2-resident while scanned
+#define COLSTORE_CHUNK_ROWS 65536
+
+// Largest chunk whose plain payload (the biggest encoding) fits the 32-bit
+// colstore_chunk_t.bytes field
+#define COLSTORE_MAX_CHUNK_ROWS (UINT32_MAX / sizeof(uint32_t))
+
+// Column types
+#define COLSTORE_F32 0
+#define COLSTORE_I32 1
+
+// Chunk encodings
+#define COLSTORE_PLAIN 0
+#define COLSTORE_FOR 1
+#define COLSTORE_DELTA 2
+#define COLSTORE_AUTO 255
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t num_columns;
+    uint64_t rows;
+    uint32_t chunk_rows;
+    uint32_t num_chunks;        // Per column
+    uint64_t directory_offset;
+    uint64_t file_size;
+    uint8_t reserved[16];
+} colstore_header_t;
+
+typedef struct {
+    char name[COLSTORE_NAME_LEN];
+    uint32_t type;
+    uint32_t reserved;
+} colstore_column_info_t;
+
+typedef struct {
+    uint64_t offset;            // Payload offset from the start of the file
+    uint32_t bytes;             // Payload size
+    uint32_t count;             // Rows in this chunk
+    uint8_t encoding;
+    uint8_t bit_width;          // Packed width for FOR/DELTA
+    uint16_t reserved;
+    uint32_t nan_count;
+    int64_t reference;          // FOR: chunk minimum; DELTA: first value
+    int64_t delta_min;          // DELTA: minimum successive difference
+    double min;                 // NaN-free minimum (+inf if none)
+    double max;                 // NaN-free maximum (-inf if none)
+    uint8_t pad[8];
+} colstore_chunk_t;
+
+// Writer input: one source array per column, read with a row stride so a
+// row-major records x features matrix can be written without transposing
+typedef struct {
+    const char *name;
+    uint32_t type;              // COLSTORE_F32 or COLSTORE_I32
+    uint32_t encoding;          // COLSTORE_AUTO picks the smallest per chunk
+    const void *data;
+    size_t stride;              // Elements between consecutive rows (0 = 1)
+} colstore_column_t;
+
+// Open, mapped file
+typedef struct {
+    int fd;
+    const uint8_t *map;
+    size_t map_size;
+    const colstore_header_t *header;
+    const colstore_column_info_t *columns;
+    const colstore_chunk_t *chunks;
+} colstore_t;
+
+// Range predicate lo <= column <= hi (column < 0 disables filtering)
+typedef struct {
+    int column;
+    double lo;
+    double hi;
+} colstore_filter_t;
+
+typedef struct {
+    size_t chunks_total;
+    size_t chunks_skipped;      // Ruled out by chunk min/max
+    size_t chunks_full;         // Entirely inside the range, predicate not read
+    size_t chunks_partial;      // Predicate evaluated row by row
+    size_t chunks_zero_copy;    // Values read in place from the mapping
+    uint64_t rows_selected;
+} colstore_scan_info_t;
+
+static inline size_t colstore_align(size_t offset) {
+    return (offset + COLSTORE_ALIGN - 1) & ~(size_t)(COLSTORE_ALIGN - 1);
+}
+
+// Bit packing
+// ===========
+
+// Packed payload size: one spare word lets the unpacker always read a pair
+static inline size_t colstore_packed_words(size_t count, uint32_t width) {
+    return (count * width + 63) / 64 + 1;
+}
+
+static inline void colstore_pack(const uint32_t *values, size_t count, uint32_t width,
+                                 uint64_t *words) {
+    memset(words, 0, colstore_packed_words(count, width) * sizeof(uint64_t));
+    for (size_t i = 0; i < count; i++) {
+        size_t bit = i * width;
+        size_t word = bit >> 6;
+        uint32_t shift = bit & 63;
+        words[word] |= (uint64_t)values[i] << shift;
+        if (shift + width > 64) {
+            words[word + 1] |= (uint64_t)values[i] >> (64 - shift);
+        }
+    }
+}
+
+// Branch-free unpack; the double shift avoids an undefined shift by 64
+static inline void colstore_unpack(const uint64_t *words, size_t count, uint32_t width,
+                                   uint32_t *out) {
+    uint64_t mask = ((uint64_t)1 << width) - 1;
+
+    if (width == 0) {
+        memset(out, 0, count * sizeof(uint32_t));
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        size_t bit = i * width;
+        size_t word = bit >> 6;
+        uint32_t shift = bit & 63;
+        uint64_t v = (words[word] >> shift) | ((words[word + 1] << 1) << (63 - shift));
+        out[i] = (uint32_t)(v & mask);
+    }
+}
+
+static inline uint32_t colstore_bit_width(uint64_t range) {
+    uint32_t width = 0;
+    while (width < 64 && (range >> width) != 0) {
+        width++;
+    }
+    return width;
+}
+
+// Writer
+// ======
+
+// Element i of a gathered chunk; memcpy keeps the type punning well defined
+static inline double colstore_value(uint32_t type, const uint32_t *values, size_t i) {
+    float f;
+    if (type == COLSTORE_I32) {
+        return (double)(int32_t)values[i];
+    }
+    memcpy(&f, &values[i], sizeof(f));
+    return (double)f;
+}
+
+// Chunk statistics over gathered values
+static inline void colstore_chunk_stats(uint32_t type, const uint32_t *values, size_t count,
+                                        colstore_chunk_t *desc) {
+    desc->min = INFINITY;
+    desc->max = -INFINITY;
+    desc->nan_count = 0;
+    for (size_t i = 0; i < count; i++) {
+        double v = colstore_value(type, values, i);
+        if (v != v) {
+            desc->nan_count++;
+            continue;
+        }
+        desc->min = v < desc->min ? v : desc->min;
+        desc->max = v > desc->max ? v : desc->max;
+    }
+}
+
+// Encode one chunk. Returns the payload (values itself for PLAIN, else
+// words) and its size in bytes via *bytes.
+static inline const void *colstore_encode_chunk(uint32_t type, uint32_t requested,
+                                                const uint32_t *values, size_t count,
+                                                uint32_t *deltas, uint64_t *words,
+                                                colstore_chunk_t *desc, size_t *bytes) {
+    const int32_t *ints = (const int32_t *)values;  // Signed view, may alias
+    size_t plain_bytes = count * sizeof(uint32_t);
+    size_t for_bytes = SIZE_MAX, delta_bytes = SIZE_MAX;
+    uint32_t for_width = 0, delta_width = 0;
+    int64_t delta_min = 0;
+
+    desc->encoding = COLSTORE_PLAIN;
+    desc->bit_width = 32;
+    desc->reference = 0;
+    desc->delta_min = 0;
+    *bytes = plain_bytes;
+
+    if (type != COLSTORE_I32 || count == 0 || requested == COLSTORE_PLAIN) {
+        return values;
+    }
+
+    for_width = colstore_bit_width((uint64_t)((int64_t)desc->max - (int64_t)desc->min));
+    if (for_width <= 32) {
+        for_bytes = colstore_packed_words(count, for_width) * sizeof(uint64_t);
+    }
+    if (count > 1) {
+        int64_t delta_max = INT64_MIN;
+        delta_min = INT64_MAX;
+        for (size_t i = 1; i < count; i++) {
+            int64_t d = (int64_t)ints[i] - ints[i - 1];
+            delta_min = d < delta_min ? d : delta_min;
+            delta_max = d > delta_max ? d : delta_max;
+        }
+        delta_width = colstore_bit_width((uint64_t)(delta_max - delta_min));
+        if (delta_width <= 32) {
+            delta_bytes = colstore_packed_words(count - 1, delta_width) * sizeof(uint64_t);
+        }
+    }
+
+    if (requested == COLSTORE_DELTA && delta_bytes != SIZE_MAX) {
+        for_bytes = SIZE_MAX;
+    } else if (requested == COLSTORE_FOR && for_bytes != SIZE_MAX) {
+        delta_bytes = SIZE_MAX;
+    }
+
+    if (delta_bytes < for_bytes && delta_bytes < plain_bytes) {
+        for (size_t i = 1; i < count; i++) {
+            deltas[i - 1] = (uint32_t)((int64_t)ints[i] - ints[i - 1] - delta_min);
+        }
+        colstore_pack(deltas, count - 1, delta_width, words);
+        desc->encoding = COLSTORE_DELTA;
+        desc->bit_width = (uint8_t)delta_width;
+        desc->reference = ints[0];
+        desc->delta_min = delta_min;
+        *bytes = delta_bytes;
+        return words;
+    }
+    if (for_bytes < plain_bytes) {
+        for (size_t i = 0; i < count; i++) {
+            deltas[i] = (uint32_t)((int64_t)ints[i] - (int64_t)desc->min);
+        }
+        colstore_pack(deltas, count, for_width, words);
+        desc->encoding = COLSTORE_FOR;
+        desc->bit_width = (uint8_t)for_width;
+        desc->reference = (int64_t)desc->min;
+        *bytes = for_bytes;
+        return words;
+    }
+    return values;
+}
+
+static inline int colstore_write_padding(FILE *f, size_t offset) {
+    static const uint8_t zeros[COLSTORE_ALIGN];
+    size_t pad = colstore_align(offset) - offset;
+    return fwrite(zeros, 1, pad, f) == pad ? 0 : -1;
+}
+
+// Write rows x num_columns values to path (chunk_rows 0 selects the default,
+// at most COLSTORE_MAX_CHUNK_ROWS).
+// Returns 0 on success, -1 on failure.
+static inline int colstore_write(const char *path, const colstore_column_t *columns,
+                                 size_t num_columns, size_t rows, size_t chunk_rows) {
+    colstore_header_t header;
+    colstore_column_info_t *infos;
+    colstore_chunk_t *chunks;
+    uint32_t *values, *deltas;
+    uint64_t *words;
+    size_t num_chunks, offset;
+    int failed = 0;
+    FILE *f;
+
+    if (chunk_rows == 0) {
+        chunk_rows = COLSTORE_CHUNK_ROWS;
+    }
+    if (chunk_rows > COLSTORE_MAX_CHUNK_ROWS || num_columns > UINT32_MAX) {
+        return -1;
+    }
+    num_chunks = (rows + chunk_rows - 1) / chunk_rows;
+    if (num_chunks > UINT32_MAX) {
+        return -1;
+    }
+
+    f = fopen(path, "wb");
+    if (!f) {
+        return -1;
+    }
+    infos = calloc(num_columns ? num_columns : 1, sizeof(*infos));
+    chunks = calloc(num_columns * num_chunks + 1, sizeof(*chunks));
+    values = malloc(chunk_rows * sizeof(uint32_t));
+    deltas = malloc(chunk_rows * sizeof(uint32_t));
+    words = malloc(colstore_packed_words(chunk_rows, 32) * sizeof(uint64_t));
+    if (!infos || !chunks || !values || !deltas || !words) {
+        failed = 1;
+        goto done;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, COLSTORE_MAGIC, sizeof(header.magic));
+    header.version = COLSTORE_VERSION;
+    header.num_columns = (uint32_t)num_columns;
+    header.rows = rows;
+    header.chunk_rows = (uint32_t)chunk_rows;
+    header.num_chunks = (uint32_t)num_chunks;
+    header.directory_offset = colstore_align(sizeof(header) + num_columns * sizeof(*infos));
+
+    for (size_t c = 0; c < num_columns; c++) {
+        strncpy(infos[c].name, columns[c].name, COLSTORE_NAME_LEN - 1);
+        infos[c].type = columns[c].type;
+    }
+
+    // Payloads first; header and directory are written once offsets are known
+    offset = colstore_align(header.directory_offset +
+                            num_columns * num_chunks * sizeof(colstore_chunk_t));
+    failed = fseek(f, (long)offset, SEEK_SET) != 0;
+
+    for (size_t c = 0; c < num_columns && !failed; c++) {
+        size_t stride = columns[c].stride ? columns[c].stride : 1;
+        const uint8_t *src = (const uint8_t *)columns[c].data;
+
+        for (size_t k = 0; k < num_chunks && !failed; k++) {
+            colstore_chunk_t *desc = &chunks[c * num_chunks + k];
+            size_t first = k * chunk_rows;
+            size_t count = rows - first < chunk_rows ? rows - first : chunk_rows;
+            const void *payload;
+            size_t bytes;
+
+            // Both column types are 32 bits wide; gather by bit pattern
+            for (size_t i = 0; i < count; i++) {
+                memcpy(&values[i], src + (first + i) * stride * sizeof(uint32_t),
+                       sizeof(uint32_t));
+            }
+            colstore_chunk_stats(columns[c].type, values, count, desc);
+            payload = colstore_encode_chunk(columns[c].type, columns[c].encoding, values,
+                                            count, deltas, words, desc, &bytes);
+            desc->offset = offset;
+            desc->bytes = (uint32_t)bytes;
+            desc->count = (uint32_t)count;
+
+            failed = fwrite(payload, 1, bytes, f) != bytes ||
+                     colstore_write_padding(f, offset + bytes) != 0;
+            offset = colstore_align(offset + bytes);
+        }
+    }
+
+    header.file_size = offset;
+    if (!failed) {
+        failed = fseek(f, 0, SEEK_SET) != 0 ||
+                 fwrite(&header, sizeof(header), 1, f) != 1 ||
+                 (num_columns && fwrite(infos, sizeof(*infos), num_columns, f) != num_columns) ||
+                 colstore_write_padding(f, sizeof(header) + num_columns * sizeof(*infos)) != 0 ||
+                 (num_chunks && num_columns &&
+                  fwrite(chunks, sizeof(*chunks), num_columns * num_chunks, f) !=
+                      num_columns * num_chunks);
+    }
+
+done:
+    failed |= fclose(f) != 0;
+    free(infos);
+    free(chunks);
+    free(values);
+    free(deltas);
+    free(words);
+    if (failed) {
+        remove(path);
+    }
+    return failed ? -1 : 0;
+}
+
+// Reader
+// ======
+
+static inline void colstore_close(colstore_t *cs) {
+    if (cs->map) {
+        munmap((void *)cs->map, cs->map_size);
+    }
+    if (cs->fd >= 0) {
+        close(cs->fd);
+    }
+    cs->map = NULL;
+    cs->fd = -1;
+}
+
+// Bounds-check every directory entry against the mapping
+static inline int colstore_validate(const colstore_t *cs) {
+    const colstore_header_t *h = cs->header;
+    size_t num_chunks = h->num_chunks;
+    size_t directory_end;
+
+    if (memcmp(h->magic, COLSTORE_MAGIC, sizeof(h->magic)) != 0 ||
+        h->version != COLSTORE_VERSION || h->file_size != cs->map_size ||
+        h->chunk_rows == 0 || h->directory_offset % COLSTORE_ALIGN != 0 ||
+        num_chunks != (h->rows + h->chunk_rows - 1) / h->chunk_rows) {
+        return -1;
+    }
+    if (sizeof(*h) + (uint64_t)h->num_columns * sizeof(colstore_column_info_t) >
+            h->directory_offset ||
+        (uint64_t)h->num_columns * num_chunks > cs->map_size / sizeof(colstore_chunk_t)) {
+        return -1;
+    }
+    directory_end = h->directory_offset +
+                    (uint64_t)h->num_columns * num_chunks * sizeof(colstore_chunk_t);
+    if (directory_end > cs->map_size || directory_end < h->directory_offset) {
+        return -1;
+    }
+
+    for (size_t c = 0; c < h->num_columns; c++) {
+        if (cs->columns[c].type != COLSTORE_F32 && cs->columns[c].type != COLSTORE_I32) {
+            return -1;
+        }
+        for (size_t k = 0; k < num_chunks; k++) {
+            const colstore_chunk_t *ch = &cs->chunks[c * num_chunks + k];
+            uint64_t expect_rows = k + 1 < num_chunks ? h->chunk_rows
+                                                      : h->rows - k * (uint64_t)h->chunk_rows;
+            size_t need;
+
+            if (ch->count != expect_rows || ch->offset % COLSTORE_ALIGN != 0 ||
+                ch->offset < directory_end || ch->offset > cs->map_size ||
+                ch->bytes > cs->map_size - ch->offset) {
+                return -1;
+            }
+            switch (ch->encoding) {
+                case COLSTORE_PLAIN:
+                    need = (size_t)ch->count * sizeof(uint32_t);
+                    break;
+                case COLSTORE_FOR:
+                    need = colstore_packed_words(ch->count, ch->bit_width) * sizeof(uint64_t);
+                    break;
+                case COLSTORE_DELTA:
+                    need = colstore_packed_words(ch->count ? ch->count - 1 : 0, ch->bit_width) *
+                           sizeof(uint64_t);
+                    break;
+                default:
+                    return -1;
+            }
+            if (ch->bytes < need || ch->bit_width > 32 ||
+                (ch->encoding != COLSTORE_PLAIN && cs->columns[c].type != COLSTORE_I32)) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+// Map a file read-only. Returns 0 on success, -1 on failure.
+static inline int colstore_open(colstore_t *cs, const char *path) {
+    struct stat st;
+    void *map;
+
+    memset(cs, 0, sizeof(*cs));
+    cs->fd = open(path, O_RDONLY);
+    if (cs->fd < 0) {
+        return -1;
+    }
+    if (fstat(cs->fd, &st) != 0 || (size_t)st.st_size < sizeof(colstore_header_t)) {
+        colstore_close(cs);
+        return -1;
+    }
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, cs->fd, 0);
+    if (map == MAP_FAILED) {
+        colstore_close(cs);
+        return -1;
+    }
+    posix_madvise(map, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+
+    cs->map = (const uint8_t *)map;
+    cs->map_size = (size_t)st.st_size;
+    cs->header = (const colstore_header_t *)cs->map;
+    cs->columns = (const colstore_column_info_t *)(cs->map + sizeof(colstore_header_t));
+    cs->chunks = (const colstore_chunk_t *)(cs->map + cs->header->directory_offset);
+
+    if (colstore_validate(cs) != 0) {
+        colstore_close(cs);
+        return -1;
+    }
+    return 0;
+}
+
+// Column index by name, or -1
+static inline int colstore_find_column(const colstore_t *cs, const char *name) {
+    for (uint32_t c = 0; c < cs->header->num_columns; c++) {
+        if (strncmp(cs->columns[c].name, name, COLSTORE_NAME_LEN) == 0) {
+            return (int)c;
+        }
+    }
+    return -1;
+}
+
+static inline const colstore_chunk_t *colstore_chunk(const colstore_t *cs, size_t column,
+                                                     size_t chunk) {
+    return &cs->chunks[column * cs->header->num_chunks + chunk];
+}
+
+// Decode an int32 chunk into out (count entries)
+static inline void colstore_decode_i32(const colstore_t *cs, const colstore_chunk_t *ch,
+                                       int32_t *out) {
+    const void *payload = cs->map + ch->offset;
+    uint32_t *raw = (uint32_t *)out;
+
+    switch (ch->encoding) {
+        case COLSTORE_PLAIN:
+            memcpy(out, payload, (size_t)ch->count * sizeof(int32_t));
+            break;
+        case COLSTORE_FOR:
+            colstore_unpack((const uint64_t *)payload, ch->count, ch->bit_width, raw);
+            for (size_t i = 0; i < ch->count; i++) {
+                out[i] = (int32_t)(ch->reference + raw[i]);
+            }
+            break;
+        case COLSTORE_DELTA:
+            if (ch->count == 0) {
+                break;
+            }
+            colstore_unpack((const uint64_t *)payload, ch->count - 1, ch->bit_width, raw + 1);
+            out[0] = (int32_t)ch->reference;
+            for (size_t i = 1; i < ch->count; i++) {
+                out[i] = (int32_t)(out[i - 1] + ch->delta_min + raw[i]);
+            }
+            break;
+    }
+}
+
+// Chunk values as floats: plain float chunks are returned in place (zero
+// copy); int32 chunks are decoded into ints and widened into scratch.
+static inline const float *colstore_read_f32(const colstore_t *cs, size_t column, size_t chunk,
+                                             int32_t *ints, float *scratch) {
+    const colstore_chunk_t *ch = colstore_chunk(cs, column, chunk);
+
+    if (cs->columns[column].type == COLSTORE_F32) {
+        return (const float *)(cs->map + ch->offset);
+    }
+    colstore_decode_i32(cs, ch, ints);
+    for (size_t i = 0; i < ch->count; i++) {
+        scratch[i] = (float)ints[i];
+    }
+    return scratch;
+}
+
+// Filtered scans
+// ==============
+
+#define COLSTORE_CHUNK_SKIPPED 0
+#define COLSTORE_CHUNK_FULL 1
+#define COLSTORE_CHUNK_PARTIAL 2
+
+typedef struct {
+    int32_t *ints;
+    float *values;
+    float *selected;
+} colstore_scratch_t;
+
+typedef struct {
+    const colstore_t *cs;
+    size_t column;
+    const colstore_filter_t *filter;
+    stats_moments_t *partials;  // One per chunk
+    uint8_t *state;             // COLSTORE_CHUNK_* per chunk
+    colstore_scratch_t scratch[PARALLEL_MAX_THREADS];
+} colstore_scan_ctx_t;
+
+static inline int colstore_classify(const colstore_chunk_t *ch, const colstore_filter_t *filter) {
+    if (ch->max < filter->lo || ch->min > filter->hi) {
+        return COLSTORE_CHUNK_SKIPPED;
+    }
+    if (ch->min >= filter->lo && ch->max <= filter->hi && ch->nan_count == 0) {
+        return COLSTORE_CHUNK_FULL;
+    }
+    return COLSTORE_CHUNK_PARTIAL;
+}
+
+static inline void colstore_scan_chunks(size_t begin, size_t end, int tid, void *arg) {
+    colstore_scan_ctx_t *ctx = (colstore_scan_ctx_t *)arg;
+    colstore_scratch_t *s = &ctx->scratch[tid];
+    const colstore_t *cs = ctx->cs;
+    const colstore_filter_t *filter = ctx->filter;
+
+    for (size_t k = begin; k < end; k++) {
+        const colstore_chunk_t *ch = colstore_chunk(cs, ctx->column, k);
+        int state = filter ? colstore_classify(colstore_chunk(cs, filter->column, k), filter)
+                           : COLSTORE_CHUNK_FULL;
+        const float *values;
+
+        ctx->state[k] = (uint8_t)state;
+        stats_moments_init(&ctx->partials[k]);
+        if (state == COLSTORE_CHUNK_SKIPPED) {
+            continue;
+        }
+
+        values = colstore_read_f32(cs, ctx->column, k, s->ints, s->values);
+        if (state == COLSTORE_CHUNK_FULL) {
+            stats_moments_f32(values, ch->count, &ctx->partials[k]);
+            continue;
+        }
+
+        // Partial chunk: evaluate the predicate and compact without branches.
+        // Keys decode into whichever buffer the values left free; the kept
+        // values are compacted into the other one (in place if decoded).
+        const float *keys = colstore_read_f32(cs, (size_t)filter->column, k, s->ints,
+                                              values == s->values ? s->selected : s->values);
+        float *kept_values = keys == s->selected ? s->values : s->selected;
+        size_t kept = 0;
+
+        for (size_t i = 0; i < ch->count; i++) {
+            double key = (double)keys[i];
+            kept_values[kept] = values[i];
+            kept += key >= filter->lo && key <= filter->hi;
+        }
+        stats_moments_f32(kept_values, kept, &ctx->partials[k]);
+    }
+}
+
+static inline void colstore_free_scratch(colstore_scan_ctx_t *ctx, int threads) {
+    for (int t = 0; t < threads; t++) {
+        free(ctx->scratch[t].ints);
+        free(ctx->scratch[t].values);
+        free(ctx->scratch[t].selected);
+    }
+}
+
+// Moments of one column over the rows passing filter (NULL scans all rows).
+// Chunk partials are merged in chunk order, so the result is identical for
+// any thread count. Returns 0 on success, -1 on bad arguments or allocation
+// failure.
+static inline int colstore_moments(const colstore_t *cs, size_t column,
+                                   const colstore_filter_t *filter, int num_threads,
+                                   stats_moments_t *out, colstore_scan_info_t *info) {
+    size_t num_chunks = cs->header->num_chunks;
+    size_t chunk_rows = cs->header->chunk_rows;
+    colstore_scan_ctx_t *ctx;
+    int threads;
+    int failed = 0;
+
+    stats_moments_init(out);
+    if (info) {
+        memset(info, 0, sizeof(*info));
+        info->chunks_total = num_chunks;
+    }
+    if (column >= cs->header->num_columns ||
+        (filter && filter->column >= (int)cs->header->num_columns)) {
+        return -1;
+    }
+    if (filter && filter->column < 0) {
+        filter = NULL;
+    }
+    if (num_chunks == 0) {
+        return 0;
+    }
+
+    threads = num_threads > 0 ? num_threads : parallel_default_threads();
+    if (threads > PARALLEL_MAX_THREADS) {
+        threads = PARALLEL_MAX_THREADS;
+    }
+    if ((size_t)threads > num_chunks) {
+        threads = (int)num_chunks;
+    }
+
+    ctx = calloc(1, sizeof(*ctx));
+    if (!ctx) {
+        return -1;
+    }
+    ctx->cs = cs;
+    ctx->column = column;
+    ctx->filter = filter;
+    ctx->partials = malloc(num_chunks * sizeof(stats_moments_t));
+    ctx->state = malloc(num_chunks);
+    failed = !ctx->partials || !ctx->state;
+
+    for (int t = 0; t < threads && !failed; t++) {
+        colstore_scratch_t *s = &ctx->scratch[t];
+        void *ints = NULL, *values = NULL, *selected = NULL;
+
+        failed = posix_memalign(&ints, COLSTORE_ALIGN, chunk_rows * sizeof(int32_t)) != 0 ||
+                 posix_memalign(&values, COLSTORE_ALIGN, chunk_rows * sizeof(float)) != 0 ||
+                 posix_memalign(&selected, COLSTORE_ALIGN, chunk_rows * sizeof(float)) != 0;
+        s->ints = ints;
+        s->values = values;
+        s->selected = selected;
+    }
+
+    if (!failed) {
+        parallel_for(0, num_chunks, 1, threads, colstore_scan_chunks, ctx);
+
+        for (size_t k = 0; k < num_chunks; k++) {
+            stats_moments_merge(out, &ctx->partials[k]);
+            if (!info) {
+                continue;
+            }
+            info->chunks_skipped += ctx->state[k] == COLSTORE_CHUNK_SKIPPED;
+            info->chunks_full += ctx->state[k] == COLSTORE_CHUNK_FULL;
+            info->chunks_partial += ctx->state[k] == COLSTORE_CHUNK_PARTIAL;
+            info->chunks_zero_copy += ctx->state[k] != COLSTORE_CHUNK_SKIPPED &&
+                                      cs->columns[column].type == COLSTORE_F32;
+        }
+        if (info) {
+            info->rows_selected = out->count;
+        }
+    }
+
+    colstore_free_scratch(ctx, threads);
+    free(ctx->partials);
+    free(ctx->state);
+    free(ctx);
+    return failed ? -1 : 0;
+}
+
+#endif // ALPHAAHB_COLUMNAR_STORE_H
@@ -0,0 +1,377 @@
+/*
+ * AlphaAHB V5 Static Throughput Analyzer
+ *
+ * Estimates how fast a region of guest code (typically a loop body) runs
+ * in steady state, in the manner of llvm-mca, from the latency and
+ * throughput of every instruction in the ISA description (cpu-isa.h,
+ * instruction-timing.md sections 2, 3, 6.1 and 7) and the 12-stage pipeline
+ * of section 1. The region is taken to repeat back to back, and the cycles
+ * per iteration are the largest of three bounds:
+ *
+ * - dispatch: CPU_MCA_DISPATCH_WIDTH instructions per cycle, plus the
+ *   target fetch cycle of every unconditional jump (section 4.2);
+ *   conditional branches are assumed predicted
+ * - ports: each execution unit has as many ports as its fastest
+ *   instruction's throughput (4 ALU, 2 memory, 4 vector, ...); an
+ *   instruction with throughput t issues to the first t ports of its unit,
+ *   and the busiest port after the optimal balance bounds the loop
+ * - recurrence: the longest dependency chain carried from one iteration to
+ *   the next through registers (GPRs, FP and vector registers, LR and the
+ *   flags), weighted by producer latency
+ *
+ * Memory is assumed not to alias, like llvm-mca's default. Unspecified
+ * latencies and throughputs count as one cycle and one per cycle. The
+ * analysis is closed form (no cycle-by-cycle simulation) and allocation
+ * free, so a compiler tuning loop can afford thousands of calls a second.
+ *
+ * Functions that can fail return 0 on success and -1 on error.
+ */
+
+#ifndef ALPHAAHB_CPU_ANALYZER_H
+#define ALPHAAHB_CPU_ANALYZER_H
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "cpu-simulator.h"
+
+#define CPU_MCA_MAX 1024              // Instructions per analyzed region
+#define CPU_MCA_DISPATCH_WIDTH 4
+#define CPU_MCA_PIPELINE_DEPTH 12
+#define CPU_MCA_JUMP_PENALTY 1        // Target fetch of an unconditional jump
+
+// Execution units and their ports
+typedef enum {
+    CPU_MCA_ALU,
+    CPU_MCA_MEM,
+    CPU_MCA_BRANCH,
+    CPU_MCA_FPU,
+    CPU_MCA_VEC,
+    CPU_MCA_AI,
+    CPU_MCA_SYNC,
+    CPU_MCA_UNITS
+} cpu_mca_unit_t;
+
+static const char *const cpu_mca_unit_names[CPU_MCA_UNITS] = {
+    "ALU", "MEM", "BR", "FPU", "VEC", "AI", "SYNC"
+};
+static const uint8_t cpu_mca_unit_ports[CPU_MCA_UNITS] = { 4, 2, 1, 1, 4, 8, 1 };
+static const uint8_t cpu_mca_unit_first[CPU_MCA_UNITS] = { 0, 4, 6, 7, 8, 12, 20 };
+#define CPU_MCA_PORTS 21
+
+// Unit of every instruction type, from its handler
+#define CPU_MCA_UNIT_arithmetic CPU_MCA_ALU
+#define CPU_MCA_UNIT_memory CPU_MCA_MEM
+#define CPU_MCA_UNIT_branch CPU_MCA_BRANCH
+#define CPU_MCA_UNIT_upper CPU_MCA_ALU
+#define CPU_MCA_UNIT_floating_point CPU_MCA_FPU
+#define CPU_MCA_UNIT_vector CPU_MCA_VEC
+#define CPU_MCA_UNIT_ai_ml CPU_MCA_AI
+#define CPU_MCA_UNIT_mimd CPU_MCA_SYNC
+#define CPU_MCA_UNIT_control CPU_MCA_ALU
+#define CPU_MCA_UNIT_invalid CPU_MCA_SYNC
+#define CPU_MCA_UNIT_OF(name, handler) CPU_MCA_UNIT_##handler,
+static const uint8_t cpu_mca_units[INST_COUNT] = { CPU_INSTRUCTIONS(CPU_MCA_UNIT_OF) };
+#undef CPU_MCA_UNIT_OF
+
+// Dependency-tracked registers: GPRs, FP and vector registers, special
+// registers (CPU_SR_*)
+#define CPU_MCA_REG_FPR 64
+#define CPU_MCA_REG_VR 128
+#define CPU_MCA_REG_SR 192
+#define CPU_MCA_REGS 200
+#define CPU_MCA_NO_REG 0xFFFF
+
+typedef struct {
+    uint8_t type;            // instruction_type_t
+    uint8_t unit;            // cpu_mca_unit_t
+    uint8_t ports;           // Issues to the unit's first `ports` ports
+    uint8_t latency;
+    uint8_t critical;        // On the loop-carried critical chain
+    uint8_t sources;
+    uint16_t src[4];         // Registers read (CPU_MCA_REG_* numbering)
+    uint16_t dst[2];         // Registers written, CPU_MCA_NO_REG if none
+    int16_t producer[4];     // Instruction that wrote src[k] last, -1 if none
+    uint8_t carried[4];      // ... in the previous iteration
+} cpu_mca_inst_t;
+
+typedef struct {
+    size_t count;
+    double cycles_per_iteration;  // Steady state: the largest bound
+    double dispatch_bound;
+    double port_bound;
+    double recurrence_bound;
+    const char *bottleneck;       // "dispatch", "ports" or "recurrence"
+    unsigned critical_path;       // Longest dependency chain within one iteration
+    unsigned latency;             // One iteration through the pipeline, from fetch
+    double port_pressure[CPU_MCA_PORTS];  // Cycles per iteration on each port
+    size_t chain[CPU_MCA_MAX + 1];        // Loop-carried critical chain, first to
+    size_t chain_length;                  // last; repeats the first next iteration
+    cpu_mca_inst_t inst[CPU_MCA_MAX];
+} cpu_mca_t;
+
+static inline void cpu_mca_port_name(unsigned port, char *buf, size_t size) {
+    unsigned unit = CPU_MCA_UNITS - 1;
+    while (cpu_mca_unit_first[unit] > port) unit--;
+    snprintf(buf, size, "%s%u", cpu_mca_unit_names[unit], port - cpu_mca_unit_first[unit]);
+}
+
+static inline unsigned cpu_mca_register(char file, unsigned index) {
+    switch (file) {
+        case 'f': return CPU_MCA_REG_FPR + index;
+        case 'v': return CPU_MCA_REG_VR + index;
+        default:
+            // R0 reads as zero, and writes to it are discarded
+            return index == 0 || index == CPU_DISCARD_REG ? CPU_MCA_NO_REG : index;
+    }
+}
+
+// Registers an instruction reads and writes, from its operand syntax
+static inline void cpu_mca_operands(const cpu_op_t *op, cpu_mca_inst_t *in) {
+    const char *s = cpu_isa[op->type].syntax;
+    unsigned position = 0;
+
+    in->sources = 0;
+    in->dst[0] = in->dst[1] = CPU_MCA_NO_REG;
+    while (*s) {
+        const char *t = s;
+        size_t n = 0;
+        unsigned reg = CPU_MCA_NO_REG;
+        int dest = 0;
+
+        if (*t == '[') t++;  // [rs1 + imm]: the base register
+        while (t[n] && t[n] != ',' && t[n] != ' ' && t[n] != ']') n++;
+        if (n == 2 && t[0] == 's' && t[1] == 'r') {
+            reg = CPU_MCA_REG_SR + ((unsigned)op->imm & 7);
+            dest = position == 0;
+        } else if (n >= 2 && (t[0] == 'r' || t[0] == 'f' || t[0] == 'v') &&
+                   (t[1] == 'd' || t[1] == 's')) {
+            char file = t[0];
+            // FCVT with IMM 1 converts FP to integer: the files swap
+            if (op->type == INST_FCVT && op->imm) file = file == 'f' ? 'r' : 'f';
+            dest = t[1] == 'd';
+            reg = cpu_mca_register(file, dest ? op->rd : t[2] == '1' ? op->rs1 : op->rs2);
+        }
+        if (reg != CPU_MCA_NO_REG) {
+            if (dest) {
+                in->dst[0] = (uint16_t)reg;
+            } else if (in->sources < 3) {
+                in->src[in->sources++] = (uint16_t)reg;
+            }
+        }
+        while (*s && *s != ',') s++;
+        while (*s == ',' || *s == ' ') s++;
+        position++;
+    }
+    // Accumulating and merging instructions (FMA, VFMA, LUI) read rd too
+    if ((cpu_isa[op->type].properties & CPU_ISA_READS_RD) && in->dst[0] != CPU_MCA_NO_REG) {
+        in->src[in->sources++] = in->dst[0];
+    }
+    // Implicit operands: the link register and the flags
+    if (op->type == INST_JAL || op->type == INST_JALR) {
+        in->dst[1] = CPU_MCA_REG_SR + CPU_SR_LR;
+    } else if (op->type == INST_RET) {
+        in->src[in->sources++] = CPU_MCA_REG_SR + CPU_SR_LR;
+    } else if (cpu_isa[op->type].properties & CPU_ISA_SETS_FLAGS) {
+        in->dst[1] = CPU_MCA_REG_SR + CPU_SR_FLAGS;
+    }
+}
+
+// Adds amount to the least loaded of the first n ports, levelling them. The
+// ports are kept in non-increasing load order, which adding classes in
+// increasing n preserves, and the result is the optimal balance.
+static inline void cpu_mca_fill(double *load, unsigned n, double amount) {
+    while (amount > 0) {
+        unsigned j = n - 1;
+        while (j > 0 && load[j - 1] == load[n - 1]) j--;
+        unsigned width = n - j;
+        if (j == 0 || (load[j - 1] - load[n - 1]) * width >= amount) {
+            for (unsigned i = j; i < n; i++) load[i] += amount / width;
+            return;
+        }
+        amount -= (load[j - 1] - load[n - 1]) * width;
+        for (unsigned i = j; i < n; i++) load[i] = load[j - 1];
+    }
+}
+
+static inline void cpu_mca_reverse(size_t *a, size_t begin, size_t end) {
+    while (begin + 1 < end) {
+        size_t t = a[begin];
+        a[begin++] = a[--end];
+        a[end] = t;
+    }
+}
+
+// Longest chain from instruction start in one iteration to the same
+// instruction in the next; dist covers 2 * count entries, from covers the
+// predecessor of each
+static inline int cpu_mca_carried(const cpu_mca_t *m, size_t start, int *dist, int *from) {
+    size_t n = m->count;
+
+    for (size_t k = 0; k < 2 * n; k++) dist[k] = -1;
+    dist[start] = 0;
+    for (size_t k = start + 1; k <= start + n; k++) {
+        const cpu_mca_inst_t *in = &m->inst[k % n];
+        for (unsigned s = 0; s < in->sources; s++) {
+            if (in->producer[s] < 0) continue;
+            // Producer in this copy, or in the previous one when carried
+            size_t p = (size_t)in->producer[s] + (k >= n ? n : 0) -
+                       (in->carried[s] ? n : 0);
+            if (p < start || p >= k || dist[p] < 0) continue;
+            int d = dist[p] + m->inst[p % n].latency;
+            if (d > dist[k]) {
+                dist[k] = d;
+                from[k] = (int)p;
+            }
+        }
+    }
+    return dist[start + n];
+}
+
+// Analyzes count instruction words repeated back to back
+static inline int cpu_mca_analyze(const uint64_t *words, size_t count, cpu_mca_t *m) {
+    int16_t writer[CPU_MCA_REGS];
+    double amount[CPU_MCA_UNITS][9];
+    int dist[2 * CPU_MCA_MAX], from[2 * CPU_MCA_MAX], ready[CPU_MCA_MAX];
+    size_t jumps = 0;
+
+    if (count == 0 || count > CPU_MCA_MAX) {
+        return -1;
+    }
+    m->count = count;
+    memset(amount, 0, sizeof(amount));
+    for (size_t i = 0; i < count; i++) {
+        cpu_mca_inst_t *in = &m->inst[i];
+        cpu_op_t op;
+
+        cpu_predecode(words[i], &op);
+        if (op.type == INST_INVALID) {
+            return -1;
+        }
+        in->type = op.type;
+        in->unit = cpu_mca_units[op.type];
+        in->ports = cpu_isa[op.type].throughput ? cpu_isa[op.type].throughput : 1;
+        if (in->ports > cpu_mca_unit_ports[in->unit]) in->ports = cpu_mca_unit_ports[in->unit];
+        in->latency = cpu_isa[op.type].latency ? cpu_isa[op.type].latency : 1;
+        in->critical = 0;
+        cpu_mca_operands(&op, in);
+        amount[in->unit][in->ports] += 1.0;
+        if (op.type == INST_J || op.type == INST_JAL || op.type == INST_JR ||
+            op.type == INST_JALR || op.type == INST_RET) {
+            jumps++;
+        }
+    }
+
+    // Producers: the last writer before the reader, else the region's last
+    // writer, one iteration back
+    for (size_t r = 0; r < CPU_MCA_REGS; r++) writer[r] = -1;
+    for (size_t i = 0; i < count; i++) {
+        cpu_mca_inst_t *in = &m->inst[i];
+        for (unsigned s = 0; s < in->sources; s++) {
+            in->producer[s] = writer[in->src[s]];
+            in->carried[s] = 0;
+        }
+        for (int d = 0; d < 2; d++) {
+            if (in->dst[d] != CPU_MCA_NO_REG) writer[in->dst[d]] = (int16_t)i;
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        cpu_mca_inst_t *in = &m->inst[i];
+        for (unsigned s = 0; s < in->sources; s++) {
+            if (in->producer[s] < 0 && writer[in->src[s]] >= 0) {
+                in->producer[s] = writer[in->src[s]];
+                in->carried[s] = 1;
+            }
+        }
+    }
+
+    // Dispatch and port bounds
+    m->dispatch_bound = (double)count / CPU_MCA_DISPATCH_WIDTH + (double)jumps * CPU_MCA_JUMP_PENALTY;
+    memset(m->port_pressure, 0, sizeof(m->port_pressure));
+    m->port_bound = 0;
+    for (unsigned u = 0; u < CPU_MCA_UNITS; u++) {
+        double *load = &m->port_pressure[cpu_mca_unit_first[u]];
+        for (unsigned t = 1; t <= cpu_mca_unit_ports[u]; t++) {
+            if (amount[u][t] > 0) cpu_mca_fill(load, t, amount[u][t]);
+        }
+        if (load[0] > m->port_bound) m->port_bound = load[0];
+    }
+
+    // Critical path within an iteration, then the loop-carried recurrence
+    m->critical_path = 0;
+    for (size_t i = 0; i < count; i++) {
+        const cpu_mca_inst_t *in = &m->inst[i];
+        ready[i] = 0;
+        for (unsigned s = 0; s < in->sources; s++) {
+            if (in->producer[s] >= 0 && !in->carried[s]) {
+                int p = in->producer[s];
+                if (ready[p] + m->inst[p].latency > ready[i]) ready[i] = ready[p] + m->inst[p].latency;
+            }
+        }
+        if ((unsigned)(ready[i] + in->latency) > m->critical_path) {
+            m->critical_path = (unsigned)(ready[i] + in->latency);
+        }
+    }
+    // Every carried chain crosses the iteration boundary once, leaving from
+    // the last writer of some register, so only those need to start one
+    int best = 0;
+    size_t best_start = 0;
+    for (size_t i = 0; i < count; i++) {
+        const cpu_mca_inst_t *in = &m->inst[i];
+        if (!((in->dst[0] != CPU_MCA_NO_REG && writer[in->dst[0]] == (int16_t)i) ||
+              (in->dst[1] != CPU_MCA_NO_REG && writer[in->dst[1]] == (int16_t)i))) {
+            continue;
+        }
+        int d = cpu_mca_carried(m, i, dist, from);
+        if (d > best) {
+            best = d;
+            best_start = i;
+        }
+    }
+    m->recurrence_bound = best;
+    m->chain_length = 0;
+    if (best > 0) {
+        size_t k = best_start + count;
+        cpu_mca_carried(m, best_start, dist, from);
+        while (k != best_start) {
+            k = (size_t)from[k];
+            m->chain[m->chain_length++] = k % count;
+        }
+        // Collected last to first; report it from its earliest instruction
+        size_t first = 0;
+        cpu_mca_reverse(m->chain, 0, m->chain_length);
+        for (size_t c = 1; c < m->chain_length; c++) {
+            if (m->chain[c] < m->chain[first]) first = c;
+        }
+        cpu_mca_reverse(m->chain, 0, first);
+        cpu_mca_reverse(m->chain, first, m->chain_length);
+        cpu_mca_reverse(m->chain, 0, m->chain_length);
+        for (size_t c = 0; c < m->chain_length; c++) m->inst[m->chain[c]].critical = 1;
+    }
+
+    m->cycles_per_iteration = m->dispatch_bound;
+    m->bottleneck = "dispatch";
+    if (m->port_bound > m->cycles_per_iteration) {
+        m->cycles_per_iteration = m->port_bound;
+        m->bottleneck = "ports";
+    }
+    if (m->recurrence_bound > m->cycles_per_iteration) {
+        m->cycles_per_iteration = m->recurrence_bound;
+        m->bottleneck = "recurrence";
+    }
+    // Fetch to writeback: the chain's execution plus one cycle per other stage
+    m->latency = CPU_MCA_PIPELINE_DEPTH - 1 + m->critical_path;
+    return 0;
+}
+
+// Cycles for iterations back-to-back iterations: the first one's latency,
+// then one steady-state iteration each
+static inline double cpu_mca_cycles(const cpu_mca_t *m, uint64_t iterations) {
+    if (iterations == 0) {
+        return 0.0;
+    }
+    return m->latency + (double)(iterations - 1) * m->cycles_per_iteration;
+}
+
+#endif // ALPHAAHB_CPU_ANALYZER_H
@@ -0,0 +1,821 @@
+/*
+ * AlphaAHB V5 In-Process Assembler
+ *
+ * Builds guest programs in memory, fast enough to generate the
+ * multi-million-instruction programs the simulator benchmarks and stress
+ * tests run. Two front ends share one encoder, both driven by the
+ * generated ISA tables (cpu-isa.h):
+ *
+ * - emitters: cpu_emit_<mnemonic>(a, operands...) for every instruction,
+ *   operands in assembler syntax order (cpu_emit_add(a, rd, rs1, rs2),
+ *   cpu_emit_store(a, rs2, rs1, imm), cpu_emit_bnz(a, rs1, label))
+ * - text: cpu_asm_source() assembles source in the syntax of
+ *   assembly-language.md (see below)
+ *
+ * Branch and jump targets are labels, bound before or after use; every use
+ * records a relocation that cpu_asm_finish() resolves. Named labels become
+ * symbols of the ELF image. The finished program goes straight into a
+ * cpu_system_t (cpu_asm_load) or an ELF executable (cpu_asm_write_elf).
+ *
+ * Text syntax, one statement per line, case-insensitive mnemonics:
+ *
+ *   [label:] [MNEMONIC operand, ...] [; comment]
+ *
+ * - registers R0-R15, F0-F15, V0-V15 (the field holds only the number)
+ * - immediates #imm or imm: decimal, 0x hex, 0b binary, 0o octal, signed
+ * - memory operands [Rn], [Rn + #imm], [Rn - #imm]
+ * - branch targets: a label, or an absolute address (as disassemblers
+ *   print them)
+ * - special registers of MFSR/MTSR by number or name (PC, SP, FP, LR,
+ *   FLAGS, CORE_ID, THREAD_ID)
+ * - LI takes a label (its absolute address) or any 64-bit value, expanding
+ *   to LI + LUI when the value does not sign-extend from 32 bits
+ * - comments start with ';', "//", or a '#' that does not begin an
+ *   immediate
+ * - directives: .dword v, ... (64-bit data words), .align n (pad with NOP
+ *   to 2^n bytes), .text/.global/.local/.weak (accepted; every named label
+ *   is a symbol)
+ *
+ * Errors are sticky: the first one is kept in cpu_asm_t.error (with the
+ * source line for text) and every later call fails, so generators can
+ * emit freely and check once at cpu_asm_finish().
+ *
+ * Functions that can fail return 0 on success and -1 on error.
+ */
+
+#ifndef ALPHAAHB_CPU_ASSEMBLER_H
+#define ALPHAAHB_CPU_ASSEMBLER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
+
+#include "cpu-simulator.h"
+#include "cpu-elf.h"
+
+#define CPU_ASM_UNBOUND UINT64_MAX
+#define CPU_ASM_NO_NAME UINT32_MAX
+#define CPU_ASM_LINE_MAX 256
+
+typedef uint32_t cpu_label_t;
+
+typedef struct {
+    uint64_t index;          // Word index, CPU_ASM_UNBOUND until bound
+    uint32_t name;           // Offset in cpu_asm_t.names, CPU_ASM_NO_NAME if anonymous
+} cpu_asm_label_t;
+
+// Relocation kinds: where the target goes in the instruction word
+enum {
+    CPU_ASM_FIX_IMM,         // Byte offset in IMM (B-type)
+    CPU_ASM_FIX_EXTENDED,    // Byte offset in EXTENDED (J-type)
+    CPU_ASM_FIX_ABSOLUTE     // Address in EXTENDED (U-type LI)
+};
+
+typedef struct {
+    uint64_t at;             // Word index of the instruction
+    cpu_label_t label;
+    uint32_t line;           // Source line, 0 for emitters
+    uint32_t kind;           // CPU_ASM_FIX_*
+} cpu_asm_fixup_t;
+
+typedef struct {
+    uint64_t base;           // Guest address of words[0]
+    uint64_t *words;
+    size_t count, capacity;
+
+    cpu_asm_label_t *labels;
+    size_t label_count, label_capacity;
+    cpu_asm_fixup_t *fixups;
+    size_t fixup_count, fixup_capacity;
+    char *names;             // Label names, NUL-separated
+    size_t names_size, names_capacity;
+    uint32_t *symbols;       // Open-addressed name -> label + 1, 0 empty
+    size_t symbol_slots;     // Power of two
+    size_t named;
+
+    uint16_t mnemonics[512]; // Open-addressed mnemonic -> opcode/funct byte + 1
+
+    uint32_t line;           // Current source line, 0 outside cpu_asm_source
+    int failed;
+    char error[160];
+} cpu_asm_t;
+
+static inline int cpu_asm_fail(cpu_asm_t *a, const char *format, ...) {
+    va_list args;
+    size_t n = 0;
+
+    if (a->failed) {
+        return -1;
+    }
+    a->failed = 1;
+    if (a->line) {
+        n = (size_t)snprintf(a->error, sizeof(a->error), "line %u: ", (unsigned)a->line);
+    }
+    va_start(args, format);
+    vsnprintf(a->error + n, sizeof(a->error) - n, format, args);
+    va_end(args);
+    return -1;
+}
+
+// Grows *p to hold need elements of size elem, doubling
+static inline int cpu_asm_reserve(void **p, size_t *capacity, size_t need, size_t elem) {
+    size_t n = *capacity ? *capacity : 64;
+    void *q;
+
+    if (need <= *capacity) {
+        return 0;
+    }
+    while (n < need) {
+        n *= 2;
+    }
+    q = realloc(*p, n * elem);
+    if (!q) {
+        return -1;
+    }
+    *p = q;
+    *capacity = n;
+    return 0;
+}
+
+// FNV-1a of an upper-cased (mnemonics) or exact (labels) name
+static inline uint32_t cpu_asm_hash(const char *s, size_t len, int fold) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)s[i];
+        if (fold && c >= 'a' && c <= 'z') c = (unsigned char)(c - 'a' + 'A');
+        h = (h ^ c) * 16777619u;
+    }
+    return h;
+}
+
+static inline int cpu_asm_same(const char *name, const char *s, size_t len, int fold) {
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)s[i];
+        if (fold && c >= 'a' && c <= 'z') c = (unsigned char)(c - 'a' + 'A');
+        if ((unsigned char)name[i] != c) return 0;
+    }
+    return name[len] == '\0';
+}
+
+static inline int cpu_asm_init(cpu_asm_t *a, uint64_t base) {
+    memset(a, 0, sizeof(*a));
+    a->base = base;
+    if (base & (CPU_INST_BYTES - 1)) {
+        return cpu_asm_fail(a, "base 0x%llx is not instruction aligned", (unsigned long long)base);
+    }
+    for (int code = 0; code < 256; code++) {
+        const char *m = cpu_isa_mnemonics[code];
+        if (!m) continue;
+        uint32_t h = cpu_asm_hash(m, strlen(m), 1) & 511;
+        while (a->mnemonics[h]) h = (h + 1) & 511;
+        a->mnemonics[h] = (uint16_t)(code + 1);
+    }
+    return 0;
+}
+
+static inline void cpu_asm_free(cpu_asm_t *a) {
+    free(a->words);
+    free(a->labels);
+    free(a->fixups);
+    free(a->names);
+    free(a->symbols);
+    memset(a, 0, sizeof(*a));
+}
+
+// Opcode/funct byte of a mnemonic, -1 if unknown
+static inline int cpu_asm_mnemonic(const cpu_asm_t *a, const char *s, size_t len) {
+    uint32_t h = cpu_asm_hash(s, len, 1) & 511;
+    while (a->mnemonics[h]) {
+        int code = a->mnemonics[h] - 1;
+        if (cpu_asm_same(cpu_isa_mnemonics[code], s, len, 1)) return code;
+        h = (h + 1) & 511;
+    }
+    return -1;
+}
+
+// Labels
+// ======
+
+// New anonymous label, bound later with cpu_asm_bind
+static inline cpu_label_t cpu_asm_label(cpu_asm_t *a) {
+    if (cpu_asm_reserve((void **)&a->labels, &a->label_capacity, a->label_count + 1,
+                        sizeof(cpu_asm_label_t)) != 0) {
+        cpu_asm_fail(a, "out of memory");
+        return 0;
+    }
+    a->labels[a->label_count].index = CPU_ASM_UNBOUND;
+    a->labels[a->label_count].name = CPU_ASM_NO_NAME;
+    return (cpu_label_t)a->label_count++;
+}
+
+static inline int cpu_asm_rehash(cpu_asm_t *a, size_t slots) {
+    uint32_t *symbols = calloc(slots, sizeof(uint32_t));
+    if (!symbols) {
+        return -1;
+    }
+    for (size_t l = 0; l < a->label_count; l++) {
+        uint32_t name = a->labels[l].name;
+        if (name == CPU_ASM_NO_NAME) continue;
+        const char *s = a->names + name;
+        size_t h = cpu_asm_hash(s, strlen(s), 0) & (slots - 1);
+        while (symbols[h]) h = (h + 1) & (slots - 1);
+        symbols[h] = (uint32_t)l + 1;
+    }
+    free(a->symbols);
+    a->symbols = symbols;
+    a->symbol_slots = slots;
+    return 0;
+}
+
+// The label called name, created unbound on first use
+static inline cpu_label_t cpu_asm_named(cpu_asm_t *a, const char *name, size_t len) {
+    size_t h;
+    cpu_label_t l;
+
+    if (a->symbol_slots) {
+        h = cpu_asm_hash(name, len, 0) & (a->symbol_slots - 1);
+        while (a->symbols[h]) {
+            l = a->symbols[h] - 1;
+            if (cpu_asm_same(a->names + a->labels[l].name, name, len, 0)) return l;
+            h = (h + 1) & (a->symbol_slots - 1);
+        }
+    }
+    if (a->failed) {
+        return 0;
+    }
+    if ((a->named + 1) * 2 > a->symbol_slots &&
+        cpu_asm_rehash(a, a->symbol_slots ? a->symbol_slots * 2 : 256) != 0) {
+        cpu_asm_fail(a, "out of memory");
+        return 0;
+    }
+    if (cpu_asm_reserve((void **)&a->names, &a->names_capacity, a->names_size + len + 1, 1) != 0) {
+        cpu_asm_fail(a, "out of memory");
+        return 0;
+    }
+    l = cpu_asm_label(a);
+    if (a->failed) {
+        return 0;
+    }
+    memcpy(a->names + a->names_size, name, len);
+    a->names[a->names_size + len] = '\0';
+    a->labels[l].name = (uint32_t)a->names_size;
+    a->names_size += len + 1;
+    h = cpu_asm_hash(name, len, 0) & (a->symbol_slots - 1);
+    while (a->symbols[h]) h = (h + 1) & (a->symbol_slots - 1);
+    a->symbols[h] = l + 1;
+    a->named++;
+    return l;
+}
+
+// Binds label to the next instruction
+static inline int cpu_asm_bind(cpu_asm_t *a, cpu_label_t label) {
+    if (a->failed) {
+        return -1;
+    }
+    if (label >= a->label_count) {
+        return cpu_asm_fail(a, "unknown label %u", (unsigned)label);
+    }
+    if (a->labels[label].index != CPU_ASM_UNBOUND) {
+        return a->labels[label].name == CPU_ASM_NO_NAME
+                   ? cpu_asm_fail(a, "label %u bound twice", (unsigned)label)
+                   : cpu_asm_fail(a, "label '%s' defined twice", a->names + a->labels[label].name);
+    }
+    a->labels[label].index = a->count;
+    return 0;
+}
+
+// Guest address of a bound label, CPU_ASM_UNBOUND otherwise
+static inline uint64_t cpu_asm_address(const cpu_asm_t *a, cpu_label_t label) {
+    if (label >= a->label_count || a->labels[label].index == CPU_ASM_UNBOUND) {
+        return CPU_ASM_UNBOUND;
+    }
+    return a->base + a->labels[label].index * CPU_INST_BYTES;
+}
+
+// Encoding
+// ========
+
+// Appends a raw 64-bit word
+static inline int cpu_asm_word(cpu_asm_t *a, uint64_t word) {
+    if (a->failed) {
+        return -1;
+    }
+    if (a->count == a->capacity &&
+        cpu_asm_reserve((void **)&a->words, &a->capacity, a->count + 1, sizeof(uint64_t)) != 0) {
+        return cpu_asm_fail(a, "out of memory");
+    }
+    a->words[a->count++] = word;
+    return 0;
+}
+
+// Encodes the instruction with opcode/funct byte code. Immediates must fit
+// their field: 16 bits signed, or EXTENDED for J-type (signed) and U-type
+// (signed for LI, unsigned for LUI).
+static inline int cpu_asm_encode(cpu_asm_t *a, unsigned code, unsigned rd, unsigned rs1,
+                                 unsigned rs2, int64_t imm) {
+    instruction_type_t type = (instruction_type_t)cpu_decode_table[code & 0xFF];
+    const cpu_isa_t *isa = &cpu_isa[type];
+
+    if (a->failed) {
+        return -1;
+    }
+    if (type == INST_INVALID) {
+        return cpu_asm_fail(a, "invalid opcode/funct 0x%02x", code);
+    }
+    if ((rd | rs1 | rs2) > 15) {
+        return cpu_asm_fail(a, "%s: register out of range", cpu_isa_mnemonics[code]);
+    }
+    if (isa->format == 'U' || isa->format == 'J') {
+        int64_t min = INT32_MIN, max = type == INST_LUI ? (int64_t)UINT32_MAX : INT32_MAX;
+        if (imm < min || imm > max) {
+            return cpu_asm_fail(a, "%s: immediate %lld out of range", cpu_isa_mnemonics[code],
+                                (long long)imm);
+        }
+        // U-type names its destination in RS1, J-type its source
+        return cpu_asm_word(a, cpu_encode_long(code >> 4, code & 0xF, isa->format == 'U' ? rd : rs1,
+                                               (int32_t)(uint32_t)imm));
+    }
+    if (imm < INT16_MIN || imm > INT16_MAX) {
+        return cpu_asm_fail(a, "%s: immediate %lld out of range", cpu_isa_mnemonics[code],
+                            (long long)imm);
+    }
+    return cpu_asm_word(a, cpu_encode_op(code >> 4, code & 0xF, rd, rs1, rs2, (int32_t)imm));
+}
+
+static inline int cpu_asm_emit(cpu_asm_t *a, instruction_type_t type, unsigned rd, unsigned rs1,
+                               unsigned rs2, int64_t imm) {
+    return cpu_asm_encode(a, (unsigned)cpu_isa[type].opcode << 4 | cpu_isa[type].funct, rd, rs1,
+                          rs2, imm);
+}
+
+// Emits an instruction whose target (B/J-type) or value (U-type) is label
+static inline int cpu_asm_emit_label(cpu_asm_t *a, unsigned code, unsigned rd, unsigned rs1,
+                                     unsigned rs2, cpu_label_t label) {
+    char format = cpu_isa[cpu_decode_table[code & 0xFF]].format;
+    cpu_asm_fixup_t *fix;
+
+    if (a->failed) {
+        return -1;
+    }
+    if (format != 'B' && format != 'J' && format != 'U') {
+        return cpu_asm_fail(a, "%s takes no label", cpu_isa_mnemonics[code & 0xFF]);
+    }
+    if (label >= a->label_count) {
+        return cpu_asm_fail(a, "unknown label %u", (unsigned)label);
+    }
+    if (cpu_asm_reserve((void **)&a->fixups, &a->fixup_capacity, a->fixup_count + 1,
+                        sizeof(cpu_asm_fixup_t)) != 0) {
+        return cpu_asm_fail(a, "out of memory");
+    }
+    fix = &a->fixups[a->fixup_count++];
+    fix->at = a->count;
+    fix->label = label;
+    fix->line = a->line;
+    fix->kind = format == 'B' ? CPU_ASM_FIX_IMM
+              : format == 'J' ? CPU_ASM_FIX_EXTENDED : CPU_ASM_FIX_ABSOLUTE;
+    return cpu_asm_encode(a, code, rd, rs1, rs2, 0);
+}
+
+// 64-bit constant: LI of the low half, LUI of the high half when needed
+static inline int cpu_asm_li(cpu_asm_t *a, unsigned rd, uint64_t value) {
+    if (cpu_asm_emit(a, INST_LI, rd, 0, 0, (int32_t)(uint32_t)value) != 0) {
+        return -1;
+    }
+    if ((uint64_t)(int64_t)(int32_t)(uint32_t)value != value) {
+        return cpu_asm_emit(a, INST_LUI, rd, 0, 0, (int64_t)(value >> 32));
+    }
+    return 0;
+}
+
+// Emitters: cpu_emit_<mnemonic>, operands in syntax order (cpu-isa.h)
+#define CPU_EMIT_NONE(NAME, name) \
+    static inline int cpu_emit_##name(cpu_asm_t *a) { \
+        return cpu_asm_emit(a, INST_##NAME, 0, 0, 0, 0); \
+    }
+#define CPU_EMIT_D_S1_S2(NAME, name) \
+    static inline int cpu_emit_##name(cpu_asm_t *a, unsigned rd, unsigned rs1, unsigned rs2) { \
+        return cpu_asm_emit(a, INST_##NAME, rd, rs1, rs2, 0); \
+    }
+#define CPU_EMIT_S1_S2(NAME, name) \
+    static inline int cpu_emit_##name(cpu_asm_t *a, unsigned rs1, unsigned rs2) { \
+        return cpu_asm_emit(a, INST_##NAME, 0, rs1, rs2, 0); \
+    }
+#define CPU_EMIT_D_S1(NAME, name) \
+    static inline int cpu_emit_##name(cpu_asm_t *a, unsigned rd, unsigned rs1) { \
+        return cpu_asm_emit(a, INST_##NAME, rd, rs1, 0, 0); \
+    }
+#define CPU_EMIT_S1(NAME, name) \
+    static inline int cpu_emit_##name(cpu_asm_t *a, unsigned rs1) { \
+        return cpu_asm_emit(a, INST_##NAME, 0, rs1, 0, 0); \
+    }
+#define CPU_EMIT_D_S1_IMM(NAME, name) \
+    static inline int cpu_emit_##name(cpu_asm_t *a, unsigned rd, unsigned rs1, int64_t imm) { \
+        return cpu_asm_emit(a, INST_##NAME, rd, rs1, 0, imm); \
+    }
+#define CPU_EMIT_S1_IMM(NAME, name) \
+    static inline int cpu_emit_##name(cpu_asm_t *a, unsigned rs1, int64_t imm) { \
+        return cpu_asm_emit(a, INST_##NAME, 0, rs1, 0, imm); \
+    }
+#define CPU_EMIT_S2_S1_IMM(NAME, name) \
+    static inline int cpu_emit_##name(cpu_asm_t *a, unsigned rs2, unsigned rs1, int64_t imm) { \
+        return cpu_asm_emit(a, INST_##NAME, 0, rs1, rs2, imm); \
+    }
+#define CPU_EMIT_D_S2_S1_IMM(NAME, name) \
+    static inline int cpu_emit_##name(cpu_asm_t *a, unsigned rd, unsigned rs2, unsigned rs1, \
+                                      int64_t imm) { \
+        return cpu_asm_emit(a, INST_##NAME, rd, rs1, rs2, imm); \
+    }
+#define CPU_EMIT_D_IMM(NAME, name) \
+    static inline int cpu_emit_##name(cpu_asm_t *a, unsigned rd, int64_t imm) { \
+        return cpu_asm_emit(a, INST_##NAME, rd, 0, 0, imm); \
+    }
+#define CPU_EMIT_IMM_S1(NAME, name) \
+    static inline int cpu_emit_##name(cpu_asm_t *a, int64_t imm, unsigned rs1) { \
+        return cpu_asm_emit(a, INST_##NAME, 0, rs1, 0, imm); \
+    }
+#define CPU_EMIT_TARGET(NAME, name) \
+    static inline int cpu_emit_##name(cpu_asm_t *a, cpu_label_t target) { \
+        return cpu_asm_emit_label(a, (unsigned)cpu_isa[INST_##NAME].opcode << 4 | \
+                                     cpu_isa[INST_##NAME].funct, 0, 0, 0, target); \
+    }
+#define CPU_EMIT_S1_TARGET(NAME, name) \
+    static inline int cpu_emit_##name(cpu_asm_t *a, unsigned rs1, cpu_label_t target) { \
+        return cpu_asm_emit_label(a, (unsigned)cpu_isa[INST_##NAME].opcode << 4 | \
+                                     cpu_isa[INST_##NAME].funct, 0, rs1, 0, target); \
+    }
+#define CPU_EMIT_S1_S2_TARGET(NAME, name) \
+    static inline int cpu_emit_##name(cpu_asm_t *a, unsigned rs1, unsigned rs2, \
+                                      cpu_label_t target) { \
+        return cpu_asm_emit_label(a, (unsigned)cpu_isa[INST_##NAME].opcode << 4 | \
+                                     cpu_isa[INST_##NAME].funct, 0, rs1, rs2, target); \
+    }
+#define CPU_EMITTER(NAME, name, signature) CPU_EMIT_##signature(NAME, name)
+CPU_ISA_OPERANDS(CPU_EMITTER)
+#undef CPU_EMITTER
+
+// Text Front End
+// ==============
+
+static inline const char *cpu_asm_skip(const char *s) {
+    while (*s == ' ' || *s == '\t') s++;
+    return s;
+}
+
+static inline int cpu_asm_ident_start(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == '.';
+}
+
+static inline int cpu_asm_ident_char(char c) {
+    return cpu_asm_ident_start(c) || (c >= '0' && c <= '9');
+}
+
+// Parses [#][-]digits with an optional 0x/0b/0o prefix
+static inline int cpu_asm_number(const char **sp, int64_t *value) {
+    const char *s = cpu_asm_skip(*sp);
+    unsigned base = 10;
+    uint64_t v = 0;
+    int negative = 0, digits = 0;
+
+    if (*s == '#') s++;
+    if (*s == '-' || *s == '+') negative = *s++ == '-';
+    if (s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) base = 16, s += 2;
+    else if (s[0] == '0' && (s[1] == 'b' || s[1] == 'B')) base = 2, s += 2;
+    else if (s[0] == '0' && (s[1] == 'o' || s[1] == 'O')) base = 8, s += 2;
+    for (;; s++, digits++) {
+        unsigned d;
+        if (*s >= '0' && *s <= '9') d = (unsigned)(*s - '0');
+        else if (*s >= 'a' && *s <= 'f') d = (unsigned)(*s - 'a' + 10);
+        else if (*s >= 'A' && *s <= 'F') d = (unsigned)(*s - 'A' + 10);
+        else break;
+        if (d >= base || v > (UINT64_MAX - d) / base) return -1;
+        v = v * base + d;
+    }
+    if (digits == 0) {
+        return -1;
+    }
+    *value = negative ? (int64_t)(0 - v) : (int64_t)v;
+    *sp = s;
+    return 0;
+}
+
+static inline int cpu_asm_register(const char **sp, unsigned *reg) {
+    const char *s = cpu_asm_skip(*sp);
+    int64_t n;
+
+    if (*s != 'R' && *s != 'r' && *s != 'F' && *s != 'f' && *s != 'V' && *s != 'v') {
+        return -1;
+    }
+    s++;
+    if (*s < '0' || *s > '9' || cpu_asm_number(&s, &n) != 0 || n > 15 || cpu_asm_ident_char(*s)) {
+        return -1;
+    }
+    *reg = (unsigned)n;
+    *sp = s;
+    return 0;
+}
+
+static inline int cpu_asm_special(const char **sp, int64_t *value) {
+    static const char *const names[] = { "PC", "SP", "FP", "LR", "FLAGS", "CORE_ID", "THREAD_ID" };
+    const char *s = cpu_asm_skip(*sp), *end = s;
+
+    while (cpu_asm_ident_char(*end)) end++;
+    for (int i = 0; i < (int)(sizeof(names) / sizeof(names[0])); i++) {
+        if (cpu_asm_same(names[i], s, (size_t)(end - s), 1)) {
+            *value = i;
+            *sp = end;
+            return 0;
+        }
+    }
+    return cpu_asm_number(sp, value);
+}
+
+// Label reference: an identifier that is not a number
+static inline int cpu_asm_symbol(cpu_asm_t *a, const char **sp, cpu_label_t *label) {
+    const char *s = cpu_asm_skip(*sp), *end = s;
+
+    if (!cpu_asm_ident_start(*s)) {
+        return -1;
+    }
+    while (cpu_asm_ident_char(*end)) end++;
+    *label = cpu_asm_named(a, s, (size_t)(end - s));
+    *sp = end;
+    return a->failed ? -1 : 0;
+}
+
+// [Rn], [Rn + imm], [Rn - imm]
+static inline int cpu_asm_memory(const char **sp, unsigned *rs1, int64_t *imm) {
+    const char *s = cpu_asm_skip(*sp);
+
+    if (*s++ != '[' || cpu_asm_register(&s, rs1) != 0) {
+        return -1;
+    }
+    *imm = 0;
+    s = cpu_asm_skip(s);
+    if (*s == '+' || *s == '-') {
+        int negative = *s++ == '-';
+        if (cpu_asm_number(&s, imm) != 0) return -1;
+        if (negative) *imm = -*imm;
+        s = cpu_asm_skip(s);
+    }
+    if (*s++ != ']') {
+        return -1;
+    }
+    *sp = s;
+    return 0;
+}
+
+// Assembles one statement (label definitions and comment already removed)
+static inline int cpu_asm_statement(cpu_asm_t *a, const char *s) {
+    const char *name = s, *syntax;
+    unsigned reg[3] = { 0, 0, 0 };   // rd, rs1, rs2
+    int64_t imm = 0;
+    int code, has_label = 0;
+    cpu_label_t label = 0;
+
+    while (cpu_asm_ident_char(*s)) s++;
+    if (*name == '.') {
+        size_t len = (size_t)(s - name);
+        if (cpu_asm_same(".DWORD", name, len, 1)) {
+            for (;;) {
+                if (cpu_asm_number(&s, &imm) != 0) return cpu_asm_fail(a, "bad .dword value");
+                cpu_asm_word(a, (uint64_t)imm);
+                s = cpu_asm_skip(s);
+                if (*s != ',') break;
+                s++;
+            }
+            return *s ? cpu_asm_fail(a, ".dword: unexpected '%s'", s) : (a->failed ? -1 : 0);
+        }
+        if (cpu_asm_same(".ALIGN", name, len, 1) || cpu_asm_same(".P2ALIGN", name, len, 1)) {
+            if (cpu_asm_number(&s, &imm) != 0 || imm < 0 || imm > 20) {
+                return cpu_asm_fail(a, "bad alignment");
+            }
+            while (((a->base + a->count * CPU_INST_BYTES) & (((uint64_t)1 << imm) - 1)) &&
+                   cpu_emit_nop(a) == 0) {
+            }
+            return a->failed ? -1 : 0;
+        }
+        if (cpu_asm_same(".TEXT", name, len, 1) || cpu_asm_same(".GLOBAL", name, len, 1) ||
+            cpu_asm_same(".LOCAL", name, len, 1) || cpu_asm_same(".WEAK", name, len, 1)) {
+            return 0;
+        }
+        return cpu_asm_fail(a, "unsupported directive %.*s", (int)len, name);
+    }
+
+    code = cpu_asm_mnemonic(a, name, (size_t)(s - name));
+    if (code < 0) {
+        return cpu_asm_fail(a, "unknown instruction '%.*s'", (int)(s - name), name);
+    }
+    syntax = cpu_isa[cpu_decode_table[code]].syntax;
+
+    // Walk the operands of the syntax string: "rd, [rs1 + imm]", ...
+    while (*syntax) {
+        const char *op = syntax;
+        int ok;
+
+        while (*syntax && *syntax != ',') syntax++;
+        size_t len = (size_t)(syntax - op);
+        if (*syntax) syntax += 2;                  // ", "
+        if (op != cpu_isa[cpu_decode_table[code]].syntax) {
+            s = cpu_asm_skip(s);
+            if (*s++ != ',') return cpu_asm_fail(a, "%s: expected ','", cpu_isa_mnemonics[code]);
+        }
+        if (op[0] == '[') {
+            ok = cpu_asm_memory(&s, &reg[1], &imm) == 0;
+        } else if (op[1] == 'd') {
+            ok = cpu_asm_register(&s, &reg[0]) == 0;
+        } else if (len == 3 && op[2] == '1') {
+            ok = cpu_asm_register(&s, &reg[1]) == 0;
+        } else if (len == 3 && op[2] == '2') {
+            ok = cpu_asm_register(&s, &reg[2]) == 0;
+        } else if (op[0] == 's') {                 // sr
+            ok = cpu_asm_special(&s, &imm) == 0;
+        } else if (op[0] == 't' || (op[0] == 'i' && cpu_isa[cpu_decode_table[code]].format == 'U')) {
+            // target, or the U-type value: a number or a label
+            const char *t = cpu_asm_skip(s);
+            if (*t == '#' || *t == '-' || *t == '+' || (*t >= '0' && *t <= '9')) {
+                ok = cpu_asm_number(&s, &imm) == 0;
+                if (op[0] == 't') {
+                    imm -= (int64_t)(a->base + a->count * CPU_INST_BYTES);
+                }
+            } else {
+                ok = cpu_asm_symbol(a, &s, &label) == 0;
+                has_label = 1;
+            }
+        } else {                                   // imm
+            ok = cpu_asm_number(&s, &imm) == 0;
+        }
+        if (!ok) {
+            return cpu_asm_fail(a, "%s: bad operand '%.*s'", cpu_isa_mnemonics[code], (int)len, op);
+        }
+    }
+    s = cpu_asm_skip(s);
+    if (*s) {
+        return cpu_asm_fail(a, "%s: unexpected '%s'", cpu_isa_mnemonics[code], s);
+    }
+    if (has_label) {
+        return cpu_asm_emit_label(a, (unsigned)code, reg[0], reg[1], reg[2], label);
+    }
+    if (code == (CPU_OPC_U << 4 | cpu_isa[INST_LI].funct)) {
+        return cpu_asm_li(a, reg[0], (uint64_t)imm);
+    }
+    return cpu_asm_encode(a, (unsigned)code, reg[0], reg[1], reg[2], imm);
+}
+
+// Assembles len bytes of source text, appending to the program
+static inline int cpu_asm_source(cpu_asm_t *a, const char *text, size_t len) {
+    const char *end = text + len;
+    char line[CPU_ASM_LINE_MAX];
+
+    a->line = 0;
+    while (text < end && !a->failed) {
+        const char *eol = memchr(text, '\n', (size_t)(end - text));
+        size_t n = (size_t)((eol ? eol : end) - text);
+        char *s;
+
+        a->line++;
+        if (n >= sizeof(line)) {
+            cpu_asm_fail(a, "line too long");
+            break;
+        }
+        memcpy(line, text, n);
+        line[n] = '\0';
+        text += n + 1;
+
+        // Comments: ';', "//", or '#' not followed by an immediate
+        for (s = line; *s; s++) {
+            if (*s == ';' || (s[0] == '/' && s[1] == '/') ||
+                (*s == '#' && !(s[1] == '-' || s[1] == '+' || (s[1] >= '0' && s[1] <= '9')))) {
+                *s = '\0';
+                break;
+            }
+        }
+        for (s = line + n; s > line && (s[-1] == ' ' || s[-1] == '\t' || s[-1] == '\r'); s--) {
+            s[-1] = '\0';
+        }
+
+        // Label definitions
+        s = (char *)cpu_asm_skip(line);
+        for (;;) {
+            char *t = s;
+            while (cpu_asm_ident_char(*t)) t++;
+            if (t == s || *t != ':' || !cpu_asm_ident_start(*s)) break;
+            cpu_asm_bind(a, cpu_asm_named(a, s, (size_t)(t - s)));
+            s = (char *)cpu_asm_skip(t + 1);
+        }
+        if (*s) {
+            cpu_asm_statement(a, s);
+        }
+    }
+    a->line = 0;
+    return a->failed ? -1 : 0;
+}
+
+// Output
+// ======
+
+// Resolves every relocation; fails on unbound labels and out-of-range
+// offsets. The program can be extended and finished again.
+static inline int cpu_asm_finish(cpu_asm_t *a) {
+    for (size_t i = 0; i < a->fixup_count && !a->failed; i++) {
+        const cpu_asm_fixup_t *fix = &a->fixups[i];
+        const cpu_asm_label_t *label = &a->labels[fix->label];
+        uint64_t *word = &a->words[fix->at];
+        int64_t offset = ((int64_t)label->index - (int64_t)fix->at) * CPU_INST_BYTES;
+        uint64_t address = a->base + label->index * CPU_INST_BYTES;
+
+        a->line = fix->line;
+        if (label->index == CPU_ASM_UNBOUND) {
+            if (label->name == CPU_ASM_NO_NAME) {
+                cpu_asm_fail(a, "label %u never bound", (unsigned)fix->label);
+            } else {
+                cpu_asm_fail(a, "undefined label '%s'", a->names + label->name);
+            }
+        } else if (fix->kind == CPU_ASM_FIX_IMM) {
+            if (offset < INT16_MIN || offset > INT16_MAX) {
+                cpu_asm_fail(a, "branch target out of range");
+            }
+            *word = (*word & ~(0xFFFFULL << 32)) | ((uint64_t)(uint16_t)offset << 32);
+        } else if (fix->kind == CPU_ASM_FIX_EXTENDED) {
+            if (offset < INT32_MIN || offset > INT32_MAX) {
+                cpu_asm_fail(a, "jump target out of range");
+            }
+            *word = (*word & ~0xFFFFFFFFULL) | (uint32_t)offset;
+        } else {
+            if (address > INT32_MAX) {
+                cpu_asm_fail(a, "label address does not fit LI");
+            }
+            *word = (*word & ~0xFFFFFFFFULL) | (uint32_t)address;
+        }
+    }
+    a->line = 0;
+    if (a->failed) {
+        return -1;
+    }
+    a->fixup_count = 0;
+    return 0;
+}
+
+// Finishes the program and loads it into cpu at its base
+static inline int cpu_asm_load(cpu_asm_t *a, cpu_system_t *cpu) {
+    if (cpu_asm_finish(a) != 0) {
+        return -1;
+    }
+    if (cpu_load_program(cpu, a->base, a->words, a->count) != 0) {
+        return cpu_asm_fail(a, "program does not fit guest memory");
+    }
+    return 0;
+}
+
+// Named labels of a finished program as symbols sorted by address, each
+// sized up to the next higher address (labels sharing one get the same
+// size) or the end of the text. Names point into names, a->names or a copy
+// of it; symbols has room for a->named entries. Returns the count
+static inline size_t cpu_asm_symbols(const cpu_asm_t *a, const char *names,
+                                     cpu_elf_symbol_t *symbols) {
+    size_t n = 0;
+
+    for (size_t l = 0; l < a->label_count; l++) {
+        if (a->labels[l].name == CPU_ASM_NO_NAME || a->labels[l].index == CPU_ASM_UNBOUND) {
+            continue;
+        }
+        symbols[n].name = names + a->labels[l].name;
+        symbols[n].address = cpu_asm_address(a, (cpu_label_t)l);
+        n++;
+    }
+    qsort(symbols, n, sizeof(cpu_elf_symbol_t), cpu_elf_symbol_compare);
+    for (size_t i = 0; i < n; i++) {
+        uint64_t end = a->base + a->count * CPU_INST_BYTES;
+        for (size_t j = i + 1; j < n; j++) {
+            if (symbols[j].address > symbols[i].address) {
+                end = symbols[j].address;
+                break;
+            }
+        }
+        symbols[i].size = end - symbols[i].address;
+    }
+    return n;
+}
+
+// Finishes the program and writes it as an ELF executable entered at its
+// base, named labels as symbols (cpu_asm_symbols)
+static inline int cpu_asm_write_elf(cpu_asm_t *a, const char *path) {
+    cpu_elf_symbol_t *symbols;
+    size_t n;
+    int rc;
+
+    if (cpu_asm_finish(a) != 0) {
+        return -1;
+    }
+    symbols = malloc((a->named + 1) * sizeof(cpu_elf_symbol_t));
+    if (!symbols) {
+        return cpu_asm_fail(a, "out of memory");
+    }
+    n = cpu_asm_symbols(a, a->names, symbols);
+    rc = cpu_elf_write(path, a->words, a->count, a->base, a->base, symbols, n);
+    free(symbols);
+    return rc == 0 ? 0 : cpu_asm_fail(a, "cannot write %s", path);
+}
+
+#endif // ALPHAAHB_CPU_ASSEMBLER_H
@@ -0,0 +1,331 @@
+/*
+ * AlphaAHB V5 Disassembler
+ *
+ * Formats instruction words as assembler text using the generated ISA
+ * tables (cpu-isa.h), for listings and for post-processing instruction
+ * traces:
+ *
+ * - cpu_disasm: one instruction into a caller buffer, in the operand syntax
+ *   of the ISA description (so listings read like cpu-assembler.h input);
+ *   branch and jump targets as absolute addresses, symbolized when an ELF
+ *   image is given. No allocation, no stdio.
+ * - cpu_disasm_line: an objdump-style line "addr <sym+off>: word  text"
+ * - cpu_disasm_trace / cpu_disasm_trace_file: trace records (PC and word)
+ *   formatted in parallel chunks (parallel-runtime.h) and written in order
+ *
+ * Formatting functions return the length of the full text, like snprintf:
+ * the output is truncated (and still NUL-terminated) when it does not fit.
+ *
+ * Functions that can fail return 0 on success and -1 on error.
+ */
+
+#ifndef ALPHAAHB_CPU_DISASSEMBLER_H
+#define ALPHAAHB_CPU_DISASSEMBLER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "cpu-simulator.h"
+#include "cpu-elf.h"
+#include "parallel-runtime.h"
+
+#define CPU_DISASM_MAX 160        // Buffer for any instruction text
+#define CPU_DISASM_LINE_MAX 256   // Buffer for any listing or trace line
+#define CPU_DISASM_SYMBOL_MAX 64  // Longer symbol names are cut
+#define CPU_DISASM_CHUNK 8192     // Trace records per parallel chunk
+
+// One executed instruction of a trace file
+typedef struct {
+    uint64_t pc;
+    uint64_t word;
+} cpu_trace_entry_t;
+
+// Bounded writer: counts everything, stores what fits before the NUL
+typedef struct {
+    char *p;
+    char *end;               // Last byte, reserved for the NUL
+    size_t length;
+} cpu_disasm_out_t;
+
+static inline void cpu_disasm_char(cpu_disasm_out_t *o, char c) {
+    if (o->p < o->end) *o->p++ = c;
+    o->length++;
+}
+
+static inline void cpu_disasm_str(cpu_disasm_out_t *o, const char *s, size_t max) {
+    for (size_t i = 0; s[i] && i < max; i++) cpu_disasm_char(o, s[i]);
+}
+
+// Hex without leading zeros, or zero-padded to width digits
+static inline void cpu_disasm_hex(cpu_disasm_out_t *o, uint64_t v, int width) {
+    static const char digits[] = "0123456789abcdef";
+    int n = 1;
+    while (n < 16 && (v >> (4 * n))) n++;
+    if (n < width) n = width;
+    while (n-- > 0) cpu_disasm_char(o, digits[(v >> (4 * n)) & 0xF]);
+}
+
+static inline void cpu_disasm_dec(cpu_disasm_out_t *o, int64_t v) {
+    char digits[20];
+    uint64_t u = v < 0 ? 0 - (uint64_t)v : (uint64_t)v;
+    int n = 0;
+    if (v < 0) cpu_disasm_char(o, '-');
+    do {
+        digits[n++] = (char)('0' + u % 10);
+        u /= 10;
+    } while (u);
+    while (n-- > 0) cpu_disasm_char(o, digits[n]);
+}
+
+static inline void cpu_disasm_reg(cpu_disasm_out_t *o, char kind, unsigned reg) {
+    cpu_disasm_char(o, kind == 'f' ? 'F' : kind == 'v' ? 'V' : 'R');
+    cpu_disasm_dec(o, reg);
+}
+
+// " <sym>" or " <sym+0x10>" when image has a symbol covering address
+static inline void cpu_disasm_symbol(cpu_disasm_out_t *o, const cpu_elf_image_t *image,
+                                     uint64_t address) {
+    const cpu_elf_symbol_t *sym = image ? cpu_elf_symbolize(image, address) : NULL;
+    if (!sym) {
+        return;
+    }
+    cpu_disasm_str(o, " <", 2);
+    cpu_disasm_str(o, sym->name, CPU_DISASM_SYMBOL_MAX);
+    if (address != sym->address) {
+        cpu_disasm_str(o, "+0x", 3);
+        cpu_disasm_hex(o, address - sym->address, 0);
+    }
+    cpu_disasm_char(o, '>');
+}
+
+static inline void cpu_disasm_body(cpu_disasm_out_t *o, uint64_t word, uint64_t address,
+                                   const cpu_elf_image_t *image) {
+    static const char *const special[] = { "PC", "SP", "FP", "LR", "FLAGS", "CORE_ID",
+                                           "THREAD_ID" };
+    unsigned code = (unsigned)(word >> 56);
+    instruction_type_t type = (instruction_type_t)cpu_decode_table[code];
+    const cpu_isa_t *isa = &cpu_isa[type];
+    instruction_t inst;
+    const char *syntax;
+
+    if (type == INST_INVALID) {
+        cpu_disasm_str(o, ".dword 0x", 9);
+        cpu_disasm_hex(o, word, 16);
+        return;
+    }
+    cpu_unpack(word, &inst);
+    cpu_disasm_str(o, cpu_isa_mnemonics[code], 16);
+
+    // Operands in the order of the syntax string: "rd, [rs1 + imm]", ...
+    for (syntax = isa->syntax; *syntax;) {
+        const char *op = syntax;
+        while (*syntax && *syntax != ',') syntax++;
+        size_t len = (size_t)(syntax - op);
+        if (*syntax) syntax += 2;
+        cpu_disasm_str(o, op == isa->syntax ? " " : ", ", 2);
+
+        if (op[0] == '[') {
+            int64_t imm = (int16_t)inst.imm;
+            cpu_disasm_char(o, '[');
+            cpu_disasm_reg(o, 'r', inst.rs1);
+            if (imm) {
+                cpu_disasm_str(o, imm < 0 ? " - #" : " + #", 4);
+                cpu_disasm_dec(o, imm < 0 ? -imm : imm);
+            }
+            cpu_disasm_char(o, ']');
+        } else if (op[1] == 'd') {
+            cpu_disasm_reg(o, op[0], isa->format == 'U' ? inst.rs1 : inst.extended & 0xF);
+        } else if (len == 3 && op[2] == '1') {
+            cpu_disasm_reg(o, op[0], inst.rs1);
+        } else if (len == 3 && op[2] == '2') {
+            cpu_disasm_reg(o, op[0], inst.rs2);
+        } else if (op[0] == 's') {                 // sr
+            if ((uint16_t)inst.imm < sizeof(special) / sizeof(special[0])) {
+                cpu_disasm_str(o, special[inst.imm], 16);
+            } else {
+                cpu_disasm_char(o, '#');
+                cpu_disasm_dec(o, (int16_t)inst.imm);
+            }
+        } else if (op[0] == 't') {                 // target
+            int64_t offset = isa->format == 'J' ? (int64_t)(int32_t)inst.extended
+                                                : (int64_t)(int16_t)inst.imm;
+            uint64_t target = address + (uint64_t)offset;
+            cpu_disasm_str(o, "0x", 2);
+            cpu_disasm_hex(o, target, 0);
+            cpu_disasm_symbol(o, image, target);
+        } else if (type == INST_LUI) {
+            cpu_disasm_str(o, "#0x", 3);
+            cpu_disasm_hex(o, inst.extended, 0);
+        } else {                                   // imm
+            cpu_disasm_char(o, '#');
+            cpu_disasm_dec(o, isa->format == 'U' ? (int64_t)(int32_t)inst.extended
+                                                 : (int64_t)(int16_t)inst.imm);
+        }
+    }
+}
+
+// The instruction word at address as assembler text. image (may be NULL)
+// symbolizes branch and jump targets.
+static inline size_t cpu_disasm(uint64_t word, uint64_t address, const cpu_elf_image_t *image,
+                                char *buf, size_t size) {
+    cpu_disasm_out_t o = { buf, buf + (size ? size - 1 : 0), 0 };
+    cpu_disasm_body(&o, word, address, image);
+    if (size) *o.p = '\0';
+    return o.length;
+}
+
+// "    1010 <loop+0x8>:\t3b10000000080000\tBNZ R1, 0x1008 <loop>\n"
+static inline size_t cpu_disasm_line(uint64_t word, uint64_t address,
+                                     const cpu_elf_image_t *image, char *buf, size_t size) {
+    cpu_disasm_out_t o = { buf, buf + (size ? size - 1 : 0), 0 };
+    int width = 1;
+
+    while (width < 8 && (address >> (4 * width))) width++;
+    for (int pad = width; pad < 8; pad++) cpu_disasm_char(&o, ' ');
+    cpu_disasm_hex(&o, address, 0);
+    cpu_disasm_symbol(&o, image, address);
+    cpu_disasm_str(&o, ":\t", 2);
+    cpu_disasm_hex(&o, word, 16);
+    cpu_disasm_char(&o, '\t');
+    cpu_disasm_body(&o, word, address, image);
+    cpu_disasm_char(&o, '\n');
+    if (size) *o.p = '\0';
+    return o.length;
+}
+
+// Traces
+// ======
+
+typedef struct {
+    const cpu_trace_entry_t *entries;
+    size_t count;
+    const cpu_elf_image_t *image;
+    int threads;
+    size_t batch;            // Chunks formatted per round, 2 per thread
+    char *text;              // CPU_DISASM_CHUNK lines per chunk
+    size_t *length;          // Bytes of text per chunk
+} cpu_disasm_trace_ctx_t;
+
+static inline void cpu_disasm_trace_chunks(size_t begin, size_t end, int tid, void *arg) {
+    cpu_disasm_trace_ctx_t *ctx = (cpu_disasm_trace_ctx_t *)arg;
+    (void)tid;
+    for (size_t c = begin; c < end; c++) {
+        size_t first = c * CPU_DISASM_CHUNK;
+        size_t last = first + CPU_DISASM_CHUNK < ctx->count ? first + CPU_DISASM_CHUNK : ctx->count;
+        char *p = ctx->text + c * CPU_DISASM_CHUNK * CPU_DISASM_LINE_MAX;
+        char *start = p;
+
+        for (size_t i = first; i < last; i++) {
+            size_t n = cpu_disasm_line(ctx->entries[i].word, ctx->entries[i].pc, ctx->image, p,
+                                       CPU_DISASM_LINE_MAX);
+            if (n >= CPU_DISASM_LINE_MAX) {
+                n = CPU_DISASM_LINE_MAX - 1;       // Cut line: keep its newline
+                p[n - 1] = '\n';
+            }
+            p += n;
+        }
+        ctx->length[c] = (size_t)(p - start);
+    }
+}
+
+// Text buffers for `threads` workers (threads <= 0: parallel_default_threads(),
+// at most PARALLEL_MAX_THREADS), reused by every cpu_disasm_trace_write
+static inline int cpu_disasm_trace_init(cpu_disasm_trace_ctx_t *ctx, const cpu_elf_image_t *image,
+                                        int threads) {
+    if (threads <= 0) {
+        threads = parallel_default_threads();
+    }
+    if (threads > PARALLEL_MAX_THREADS) {
+        threads = PARALLEL_MAX_THREADS;
+    }
+    ctx->image = image;
+    ctx->threads = threads;
+    ctx->batch = (size_t)threads * 2;
+    ctx->text = malloc(ctx->batch * CPU_DISASM_CHUNK * CPU_DISASM_LINE_MAX);
+    ctx->length = malloc(ctx->batch * sizeof(size_t));
+    if (!ctx->text || !ctx->length) {
+        free(ctx->text);
+        free(ctx->length);
+        return -1;
+    }
+    return 0;
+}
+
+static inline void cpu_disasm_trace_free(cpu_disasm_trace_ctx_t *ctx) {
+    free(ctx->text);
+    free(ctx->length);
+    ctx->text = NULL;
+    ctx->length = NULL;
+}
+
+// Writes count trace records to out, one line each in trace order
+static inline int cpu_disasm_trace_write(cpu_disasm_trace_ctx_t *ctx,
+                                         const cpu_trace_entry_t *entries, size_t count,
+                                         FILE *out) {
+    int rc = 0;
+
+    for (size_t done = 0; done < count && rc == 0;) {
+        size_t n = count - done;
+        if (n > ctx->batch * CPU_DISASM_CHUNK) n = ctx->batch * CPU_DISASM_CHUNK;
+        size_t chunks = (n + CPU_DISASM_CHUNK - 1) / CPU_DISASM_CHUNK;
+
+        ctx->entries = entries + done;
+        ctx->count = n;
+        parallel_for(0, chunks, 1, ctx->threads, cpu_disasm_trace_chunks, ctx);
+        for (size_t c = 0; c < chunks && rc == 0; c++) {
+            const char *text = ctx->text + c * CPU_DISASM_CHUNK * CPU_DISASM_LINE_MAX;
+            if (fwrite(text, 1, ctx->length[c], out) != ctx->length[c]) rc = -1;
+        }
+        done += n;
+    }
+    return rc;
+}
+
+// Writes count trace records to out, one line each in trace order,
+// formatting up to `threads` chunks at a time in parallel (threads <= 0:
+// parallel_default_threads())
+static inline int cpu_disasm_trace(const cpu_trace_entry_t *entries, size_t count,
+                                   const cpu_elf_image_t *image, int threads, FILE *out) {
+    cpu_disasm_trace_ctx_t ctx;
+    int rc;
+
+    if (cpu_disasm_trace_init(&ctx, image, threads) != 0) {
+        return -1;
+    }
+    rc = cpu_disasm_trace_write(&ctx, entries, count, out);
+    cpu_disasm_trace_free(&ctx);
+    return rc;
+}
+
+// Streams a trace file of cpu_trace_entry_t records through
+// cpu_disasm_trace_write, one round of chunks per read
+static inline int cpu_disasm_trace_file(FILE *in, const cpu_elf_image_t *image, int threads,
+                                        FILE *out) {
+    cpu_disasm_trace_ctx_t ctx;
+    cpu_trace_entry_t *entries;
+    size_t n;
+    int rc = 0;
+
+    if (cpu_disasm_trace_init(&ctx, image, threads) != 0) {
+        return -1;
+    }
+    entries = malloc(ctx.batch * CPU_DISASM_CHUNK * sizeof(cpu_trace_entry_t));
+    if (!entries) {
+        cpu_disasm_trace_free(&ctx);
+        return -1;
+    }
+    while (rc == 0 &&
+           (n = fread(entries, sizeof(cpu_trace_entry_t), ctx.batch * CPU_DISASM_CHUNK, in)) > 0) {
+        rc = cpu_disasm_trace_write(&ctx, entries, n, out);
+    }
+    if (ferror(in)) {
+        rc = -1;
+    }
+    free(entries);
+    cpu_disasm_trace_free(&ctx);
+    return rc;
+}
+
+#endif // ALPHAAHB_CPU_DISASSEMBLER_H
@@ -0,0 +1,351 @@
+/*
+ * AlphaAHB V5 ELF Images
+ *
+ * Guest programs as ELF64 executables: one loadable text segment at the
+ * program's base address, and a symbol table with the program's named
+ * labels (address and size), so tools can load, disassemble and symbolize
+ * the same file. Instruction words are stored in host byte order like
+ * cpu_system_t memory, and EI_DATA records which order that is; reading a
+ * file written on a host of the other order fails.
+ *
+ * AlphaAHB has no assigned e_machine value; images carry CPU_ELF_MACHINE.
+ *
+ * Functions that can fail return 0 on success and -1 on error.
+ */
+
+#ifndef ALPHAAHB_CPU_ELF_H
+#define ALPHAAHB_CPU_ELF_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "cpu-simulator.h"
+
+#define CPU_ELF_MACHINE 0x4148  // "AH", unassigned
+
+// ELF64 structures (System V gABI), only the fields used here
+typedef struct {
+    uint8_t ident[16];
+    uint16_t type, machine;
+    uint32_t version;
+    uint64_t entry, phoff, shoff;
+    uint32_t flags;
+    uint16_t ehsize, phentsize, phnum, shentsize, shnum, shstrndx;
+} cpu_elf_header_t;
+
+typedef struct {
+    uint32_t type, flags;
+    uint64_t offset, vaddr, paddr, filesz, memsz, align;
+} cpu_elf_segment_t;
+
+typedef struct {
+    uint32_t name, type;
+    uint64_t flags, addr, offset, size;
+    uint32_t link, info;
+    uint64_t addralign, entsize;
+} cpu_elf_section_t;
+
+typedef struct {
+    uint32_t name;
+    uint8_t info, other;
+    uint16_t shndx;
+    uint64_t value, size;
+} cpu_elf_sym_t;
+
+enum {
+    CPU_ELF_EXEC = 2,                                  // e_type ET_EXEC
+    CPU_ELF_PT_LOAD = 1,
+    CPU_ELF_PF_X = 1, CPU_ELF_PF_R = 4,
+    CPU_ELF_SHT_PROGBITS = 1, CPU_ELF_SHT_SYMTAB = 2, CPU_ELF_SHT_STRTAB = 3,
+    CPU_ELF_SHF_ALLOC = 2, CPU_ELF_SHF_EXECINSTR = 4,
+    CPU_ELF_STT_FUNC = 2, CPU_ELF_STB_GLOBAL = 1
+};
+
+// A named address range in the text
+typedef struct {
+    const char *name;
+    uint64_t address;
+    uint64_t size;
+} cpu_elf_symbol_t;
+
+// A program read back from a file; symbols sorted by address
+typedef struct {
+    uint64_t *words;
+    size_t count;
+    uint64_t base;
+    uint64_t entry;
+    cpu_elf_symbol_t *symbols;
+    size_t symbol_count;
+    char *strings;           // Backs the symbol names
+} cpu_elf_image_t;
+
+static inline uint8_t cpu_elf_byte_order(void) {
+    const uint16_t probe = 1;
+    return *(const uint8_t *)&probe ? 1 : 2;           // ELFDATA2LSB : ELFDATA2MSB
+}
+
+// Writes count words loaded at base, starting at entry, with symbols
+static inline int cpu_elf_write(const char *path, const uint64_t *words, size_t count,
+                                uint64_t base, uint64_t entry,
+                                const cpu_elf_symbol_t *symbols, size_t symbol_count) {
+    static const char shstrtab[] = "\0.text\0.symtab\0.strtab\0.shstrtab";
+    cpu_elf_header_t eh;
+    cpu_elf_segment_t ph;
+    cpu_elf_section_t sh[5];
+    size_t strtab_size = 1;
+    uint64_t text_off = sizeof(eh) + sizeof(ph);
+    uint64_t text_size = (uint64_t)count * sizeof(uint64_t);
+    uint64_t sym_off = text_off + text_size;
+    uint64_t sym_size = (uint64_t)(symbol_count + 1) * sizeof(cpu_elf_sym_t);
+    uint64_t str_off = sym_off + sym_size;
+    uint64_t shstr_off, sh_off;
+    FILE *f;
+    int ok;
+
+    for (size_t i = 0; i < symbol_count; i++) {
+        strtab_size += strlen(symbols[i].name) + 1;
+    }
+    shstr_off = str_off + strtab_size;
+    sh_off = (shstr_off + sizeof(shstrtab) + 7) & ~(uint64_t)7;
+
+    memset(&eh, 0, sizeof(eh));
+    memcpy(eh.ident, "\177ELF", 4);
+    eh.ident[4] = 2;                                   // ELFCLASS64
+    eh.ident[5] = cpu_elf_byte_order();
+    eh.ident[6] = 1;                                   // EV_CURRENT
+    eh.type = CPU_ELF_EXEC;
+    eh.machine = CPU_ELF_MACHINE;
+    eh.version = 1;
+    eh.entry = entry;
+    eh.phoff = sizeof(eh);
+    eh.shoff = sh_off;
+    eh.ehsize = sizeof(eh);
+    eh.phentsize = sizeof(ph);
+    eh.phnum = 1;
+    eh.shentsize = sizeof(cpu_elf_section_t);
+    eh.shnum = 5;
+    eh.shstrndx = 4;
+
+    memset(&ph, 0, sizeof(ph));
+    ph.type = CPU_ELF_PT_LOAD;
+    ph.flags = CPU_ELF_PF_R | CPU_ELF_PF_X;
+    ph.offset = text_off;
+    ph.vaddr = ph.paddr = base;
+    ph.filesz = ph.memsz = text_size;
+    ph.align = CPU_INST_BYTES;
+
+    memset(sh, 0, sizeof(sh));
+    sh[1].name = 1;                                    // .text
+    sh[1].type = CPU_ELF_SHT_PROGBITS;
+    sh[1].flags = CPU_ELF_SHF_ALLOC | CPU_ELF_SHF_EXECINSTR;
+    sh[1].addr = base;
+    sh[1].offset = text_off;
+    sh[1].size = text_size;
+    sh[1].addralign = CPU_INST_BYTES;
+    sh[2].name = 7;                                    // .symtab
+    sh[2].type = CPU_ELF_SHT_SYMTAB;
+    sh[2].offset = sym_off;
+    sh[2].size = sym_size;
+    sh[2].link = 3;
+    sh[2].info = 1;                                    // First global symbol
+    sh[2].addralign = 8;
+    sh[2].entsize = sizeof(cpu_elf_sym_t);
+    sh[3].name = 15;                                   // .strtab
+    sh[3].type = CPU_ELF_SHT_STRTAB;
+    sh[3].offset = str_off;
+    sh[3].size = strtab_size;
+    sh[3].addralign = 1;
+    sh[4].name = 23;                                   // .shstrtab
+    sh[4].type = CPU_ELF_SHT_STRTAB;
+    sh[4].offset = shstr_off;
+    sh[4].size = sizeof(shstrtab);
+    sh[4].addralign = 1;
+
+    f = fopen(path, "wb");
+    if (!f) {
+        return -1;
+    }
+    ok = fwrite(&eh, sizeof(eh), 1, f) == 1 && fwrite(&ph, sizeof(ph), 1, f) == 1 &&
+         fwrite(words, sizeof(uint64_t), count, f) == count;
+
+    cpu_elf_sym_t sym;
+    uint32_t name = 1;
+    memset(&sym, 0, sizeof(sym));
+    ok = ok && fwrite(&sym, sizeof(sym), 1, f) == 1;
+    for (size_t i = 0; ok && i < symbol_count; i++) {
+        sym.name = name;
+        sym.info = (uint8_t)(CPU_ELF_STB_GLOBAL << 4 | CPU_ELF_STT_FUNC);
+        sym.shndx = 1;
+        sym.value = symbols[i].address;
+        sym.size = symbols[i].size;
+        name += (uint32_t)strlen(symbols[i].name) + 1;
+        ok = fwrite(&sym, sizeof(sym), 1, f) == 1;
+    }
+    ok = ok && fputc('\0', f) != EOF;
+    for (size_t i = 0; ok && i < symbol_count; i++) {
+        ok = fwrite(symbols[i].name, strlen(symbols[i].name) + 1, 1, f) == 1;
+    }
+    ok = ok && fwrite(shstrtab, sizeof(shstrtab), 1, f) == 1;
+    for (uint64_t pad = shstr_off + sizeof(shstrtab); ok && pad < sh_off; pad++) {
+        ok = fputc('\0', f) != EOF;
+    }
+    ok = ok && fwrite(sh, sizeof(sh), 1, f) == 1;
+    return (fclose(f) == 0 && ok) ? 0 : -1;
+}
+
+static inline void cpu_elf_free(cpu_elf_image_t *image) {
+    free(image->words);
+    free(image->symbols);
+    free(image->strings);
+    memset(image, 0, sizeof(*image));
+}
+
+static inline int cpu_elf_symbol_compare(const void *a, const void *b) {
+    uint64_t x = ((const cpu_elf_symbol_t *)a)->address;
+    uint64_t y = ((const cpu_elf_symbol_t *)b)->address;
+    return (x > y) - (x < y);
+}
+
+// Parses the text segment and function symbols of an AlphaAHB executable
+// held in memory; the image copies what it keeps
+static inline int cpu_elf_parse(const unsigned char *file, size_t size, cpu_elf_image_t *image) {
+    cpu_elf_header_t eh;
+    cpu_elf_segment_t ph;
+    cpu_elf_section_t sh, strsh;
+
+    memset(image, 0, sizeof(*image));
+    if (size < sizeof(eh)) {
+        return -1;
+    }
+
+#define CPU_ELF_FITS(off, len) ((off) <= (uint64_t)size && (len) <= (uint64_t)size - (off))
+    memcpy(&eh, file, sizeof(eh));
+    if (memcmp(eh.ident, "\177ELF", 4) != 0 || eh.ident[4] != 2 ||
+        eh.ident[5] != cpu_elf_byte_order() || eh.machine != CPU_ELF_MACHINE ||
+        eh.phentsize != sizeof(ph) || eh.shentsize != sizeof(sh) ||
+        !CPU_ELF_FITS(eh.phoff, (uint64_t)eh.phnum * sizeof(ph)) ||
+        !CPU_ELF_FITS(eh.shoff, (uint64_t)eh.shnum * sizeof(sh))) {
+        return -1;
+    }
+    image->entry = eh.entry;
+
+    // Text: the executable loadable segment
+    for (int i = 0; i < eh.phnum && !image->words; i++) {
+        memcpy(&ph, file + eh.phoff + (uint64_t)i * sizeof(ph), sizeof(ph));
+        if (ph.type != CPU_ELF_PT_LOAD || !(ph.flags & CPU_ELF_PF_X)) {
+            continue;
+        }
+        if (!CPU_ELF_FITS(ph.offset, ph.filesz) || ph.filesz == 0 ||
+            ph.filesz % CPU_INST_BYTES != 0 || !(image->words = malloc(ph.filesz))) {
+            break;
+        }
+        memcpy(image->words, file + ph.offset, ph.filesz);
+        image->count = ph.filesz / CPU_INST_BYTES;
+        image->base = ph.vaddr;
+    }
+    if (!image->words) {
+        return -1;
+    }
+
+    // Symbols: function symbols of the first symbol table
+    for (int i = 0; i < eh.shnum; i++) {
+        memcpy(&sh, file + eh.shoff + (uint64_t)i * sizeof(sh), sizeof(sh));
+        if (sh.type != CPU_ELF_SHT_SYMTAB) {
+            continue;
+        }
+        if (sh.link >= eh.shnum || !CPU_ELF_FITS(sh.offset, sh.size)) {
+            break;
+        }
+        memcpy(&strsh, file + eh.shoff + (uint64_t)sh.link * sizeof(sh), sizeof(strsh));
+        size_t n = sh.size / sizeof(cpu_elf_sym_t);
+        if (!CPU_ELF_FITS(strsh.offset, strsh.size) || strsh.size == 0 ||
+            !(image->strings = malloc(strsh.size)) ||
+            !(image->symbols = malloc((n + 1) * sizeof(cpu_elf_symbol_t)))) {
+            break;
+        }
+        memcpy(image->strings, file + strsh.offset, strsh.size);
+        image->strings[strsh.size - 1] = '\0';
+        for (size_t s = 0; s < n; s++) {
+            cpu_elf_sym_t sym;
+            memcpy(&sym, file + sh.offset + s * sizeof(sym), sizeof(sym));
+            if ((sym.info & 0xF) != CPU_ELF_STT_FUNC || sym.shndx == 0 ||
+                sym.name >= strsh.size) {
+                continue;
+            }
+            image->symbols[image->symbol_count].name = image->strings + sym.name;
+            image->symbols[image->symbol_count].address = sym.value;
+            image->symbols[image->symbol_count].size = sym.size;
+            image->symbol_count++;
+        }
+        qsort(image->symbols, image->symbol_count, sizeof(cpu_elf_symbol_t),
+              cpu_elf_symbol_compare);
+        break;
+    }
+#undef CPU_ELF_FITS
+    return 0;
+}
+
+// Reads the text segment and function symbols of an AlphaAHB executable
+static inline int cpu_elf_read(const char *path, cpu_elf_image_t *image) {
+    unsigned char *file = NULL;
+    long size;
+    int rc;
+    FILE *f;
+
+    memset(image, 0, sizeof(*image));
+    f = fopen(path, "rb");
+    if (!f) {
+        return -1;
+    }
+    if (fseek(f, 0, SEEK_END) != 0 || (size = ftell(f)) <= 0 || fseek(f, 0, SEEK_SET) != 0 ||
+        !(file = malloc((size_t)size)) || fread(file, 1, (size_t)size, f) != (size_t)size) {
+        fclose(f);
+        free(file);
+        return -1;
+    }
+    fclose(f);
+    rc = cpu_elf_parse(file, (size_t)size, image);
+    free(file);
+    return rc;
+}
+
+// The symbol whose range holds address, or NULL
+static inline const cpu_elf_symbol_t *cpu_elf_symbolize(const cpu_elf_image_t *image,
+                                                        uint64_t address) {
+    size_t lo = 0, hi = image->symbol_count;
+
+    // Last symbol starting at or below address
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (image->symbols[mid].address <= address) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == 0) {
+        return NULL;
+    }
+    const cpu_elf_symbol_t *sym = &image->symbols[lo - 1];
+    return address - sym->address < sym->size ? sym : NULL;
+}
+
+// Loads an executable's text into cpu and starts every core at its entry
+static inline int cpu_elf_load(cpu_system_t *cpu, const char *path) {
+    cpu_elf_image_t image;
+    int rc;
+
+    if (cpu_elf_read(path, &image) != 0) {
+        return -1;
+    }
+    rc = cpu_load_program(cpu, image.base, image.words, image.count);
+    if (rc == 0) {
+        cpu_reset(cpu, image.entry);
+    }
+    cpu_elf_free(&image);
+    return rc;
+}
+
+#endif // ALPHAAHB_CPU_ELF_H
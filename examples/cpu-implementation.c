@@ -5,537 +5,44 @@
  * specification, including instruction decoding, execution, and pipeline management.
  */
 
+#define _DEFAULT_SOURCE
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
 #include <math.h>
 
+#include "cpu-simulator.h"
+
 // AlphaAHB V5 CPU Implementation
 // =============================
+// Core types, decoder and execution engines live in cpu-simulator.h
 
-// CPU Configuration
-#define MAX_CORES 16
-#define MAX_THREADS_PER_CORE 4
-#define INSTRUCTION_CACHE_SIZE 256 * 1024  // 256KB
-#define DATA_CACHE_SIZE 256 * 1024         // 256KB
-#define L2_CACHE_SIZE 16 * 1024 * 1024     // 16MB
-#define L3_CACHE_SIZE 512 * 1024 * 1024    // 512MB
-
-// Instruction Format (64-bit)
-typedef struct {
-    uint8_t opcode : 4;      // Bits 63-60
-    uint8_t funct : 4;       // Bits 59-56
-    uint8_t rs2 : 4;         // Bits 55-52
-    uint8_t rs1 : 4;         // Bits 51-48
-    uint16_t imm : 16;       // Bits 47-32
-    uint32_t extended : 32;  // Bits 31-0
-} instruction_t;
-
-// Register File
-typedef struct {
-    uint64_t gpr[64];        // General Purpose Registers
-    float fpr[64];           // Floating-Point Registers
-    uint8_t vector[32][64];  // Vector Registers (512-bit each)
-    uint64_t pc;             // Program Counter
-    uint64_t sp;             // Stack Pointer
-    uint64_t fp;             // Frame Pointer
-    uint64_t lr;             // Link Register
-    uint64_t flags;          // Status Flags
-} register_file_t;
-
-// Cache Line
-typedef struct {
-    uint64_t tag;
-    uint8_t data[64];        // 64-byte cache line
-    uint8_t valid;
-    uint8_t dirty;
-    uint8_t lru;
-} cache_line_t;
-
-// Cache
-typedef struct {
-    cache_line_t *lines;
-    int size;
-    int associativity;
-    int line_size;
-    int sets;
-} cache_t;
-
-// CPU Core
-typedef struct {
-    int core_id;
-    int thread_id;
-    register_file_t regs;
-    cache_t l1i;             // L1 Instruction Cache
-    cache_t l1d;             // L1 Data Cache
-    cache_t l2;              // L2 Cache
-    cache_t l3;              // L3 Cache
-    uint8_t pipeline[12];    // 12-stage pipeline
-    int pipeline_stage;
-    int branch_predictor[1024];
-    int performance_counters[8];
-} cpu_core_t;
-
-// CPU System
-typedef struct {
-    cpu_core_t cores[MAX_CORES];
-    int num_cores;
-    uint8_t *memory;
-    uint64_t memory_size;
-    int clock_frequency;     // MHz
-    int power_consumption;   // Watts
-} cpu_system_t;
-
-// Instruction Decoder
-typedef enum {
-    INST_ADD, INST_SUB, INST_MUL, INST_DIV, INST_MOD,
-    INST_AND, INST_OR, INST_XOR, INST_NOT,
-    INST_SHL, INST_SHR, INST_ROT,
-    INST_CMP, INST_TEST,
-    INST_CLZ, INST_CTZ, INST_POPCNT,
-    INST_LOAD, INST_STORE,
-    INST_BEQ, INST_BNE, INST_BLT, INST_BLE, INST_BGT, INST_BGE,
-    INST_FADD, INST_FSUB, INST_FMUL, INST_FDIV, INST_FSQRT,
-    INST_VADD, INST_VSUB, INST_VMUL, INST_VDIV,
-    INST_CONV, INST_RELU, INST_SOFTMAX,
-    INST_BARRIER, INST_LOCK, INST_UNLOCK, INST_ATOMIC,
-    INST_SYSCALL, INST_RET, INST_NOP
-} instruction_type_t;
-
-// Function prototypes
-cpu_system_t* cpu_init(int num_cores, uint64_t memory_size);
-void cpu_destroy(cpu_system_t *cpu);
-int cpu_execute_instruction(cpu_core_t *core, instruction_t *inst);
-int cpu_fetch_instruction(cpu_core_t *core, uint64_t address, instruction_t *inst);
-int cpu_decode_instruction(instruction_t *inst, instruction_type_t *type);
-int cpu_execute_arithmetic(cpu_core_t *core, instruction_t *inst);
-int cpu_execute_memory(cpu_core_t *core, instruction_t *inst);
-int cpu_execute_branch(cpu_core_t *core, instruction_t *inst);
-int cpu_execute_floating_point(cpu_core_t *core, instruction_t *inst);
-int cpu_execute_vector(cpu_core_t *core, instruction_t *inst);
-int cpu_execute_ai_ml(cpu_core_t *core, instruction_t *inst);
-int cpu_execute_mimd(cpu_core_t *core, instruction_t *inst);
 void cpu_show_status(cpu_system_t *cpu);
 
-// CPU Initialization
-cpu_system_t* cpu_init(int num_cores, uint64_t memory_size) {
-    cpu_system_t *cpu = malloc(sizeof(cpu_system_t));
-    if (!cpu) return NULL;
-    
-    cpu->num_cores = num_cores;
-    cpu->memory_size = memory_size;
-    cpu->memory = malloc(memory_size);
-    cpu->clock_frequency = 5000;  // 5 GHz
-    cpu->power_consumption = 0;
-    
-    if (!cpu->memory) {
-        free(cpu);
-        return NULL;
-    }
-    
-    // Initialize cores
-    for (int i = 0; i < num_cores; i++) {
-        cpu_core_t *core = &cpu->cores[i];
-        core->core_id = i;
-        core->thread_id = 0;
-        
-        // Initialize register file
-        memset(&core->regs, 0, sizeof(register_file_t));
-        core->regs.pc = 0x1000;  // Start address
-        core->regs.sp = 0x8000;  // Stack pointer
-        core->regs.fp = 0x8000;  // Frame pointer
-        
-        // Initialize caches
-        core->l1i.size = INSTRUCTION_CACHE_SIZE;
-        core->l1d.size = DATA_CACHE_SIZE;
-        core->l2.size = L2_CACHE_SIZE;
-        core->l3.size = L3_CACHE_SIZE;
-        
-        // Initialize pipeline
-        memset(core->pipeline, 0, sizeof(core->pipeline));
-        core->pipeline_stage = 0;
-        
-        // Initialize branch predictor
-        memset(core->branch_predictor, 0, sizeof(core->branch_predictor));
-        
-        // Initialize performance counters
-        memset(core->performance_counters, 0, sizeof(core->performance_counters));
-        
-        cpu->power_consumption += 25;  // 25W per core
-    }
-    
-    printf("AlphaAHB V5 CPU initialized with %d cores, %lu MB memory\n", 
-           num_cores, memory_size / (1024 * 1024));
-    
-    return cpu;
-}
-
-// CPU Cleanup
-void cpu_destroy(cpu_system_t *cpu) {
-    if (cpu) {
-        free(cpu->memory);
-        free(cpu);
-    }
-}
-
-// Instruction Fetch
-int cpu_fetch_instruction(cpu_core_t *core, uint64_t address, instruction_t *inst) {
-    // Simulate instruction fetch from memory
-    // In a real implementation, this would access the instruction cache
-    
-    // For demonstration, we'll create a simple ADD instruction
-    inst->opcode = 0x0;  // R-Type
-    inst->funct = 0x0;   // ADD
-    inst->rs2 = 0x2;     // R2
-    inst->rs1 = 0x1;     // R1
-    inst->imm = 0x0;     // No immediate
-    inst->extended = 0x0; // No extended data
-    
-    core->regs.pc += 8;  // 64-bit instructions
-    return 0;
-}
-
-// Instruction Decode
-int cpu_decode_instruction(instruction_t *inst, instruction_type_t *type) {
-    switch (inst->opcode) {
-        case 0x0:  // R-Type
-            switch (inst->funct) {
-                case 0x0: *type = INST_ADD; break;
-                case 0x1: *type = INST_SUB; break;
-                case 0x2: *type = INST_MUL; break;
-                case 0x3: *type = INST_DIV; break;
-                case 0x4: *type = INST_MOD; break;
-                case 0x5: *type = INST_AND; break;
-                case 0x6: *type = INST_OR; break;
-                case 0x7: *type = INST_XOR; break;
-                case 0x8: *type = INST_SHL; break;
-                case 0x9: *type = INST_SHR; break;
-                case 0xA: *type = INST_ROT; break;
-                case 0xB: *type = INST_CMP; break;
-                case 0xC: *type = INST_CLZ; break;
-                case 0xD: *type = INST_CTZ; break;
-                case 0xE: *type = INST_POPCNT; break;
-                default: return -1;
-            }
-            break;
-        case 0x1:  // I-Type
-            switch (inst->funct) {
-                case 0x9: *type = INST_LOAD; break;
-                default: return -1;
-            }
-            break;
-        case 0x2:  // S-Type
-            switch (inst->funct) {
-                case 0x0: *type = INST_STORE; break;
-                default: return -1;
-            }
-            break;
-        case 0x3:  // B-Type
-            switch (inst->funct) {
-                case 0x0: *type = INST_BEQ; break;
-                case 0x1: *type = INST_BNE; break;
-                case 0x2: *type = INST_BLT; break;
-                case 0x3: *type = INST_BLE; break;
-                case 0x4: *type = INST_BGT; break;
-                case 0x5: *type = INST_BGE; break;
-                default: return -1;
-            }
-            break;
-        case 0x8:  // F-Type
-            switch (inst->funct) {
-                case 0x0: *type = INST_FADD; break;
-                case 0x1: *type = INST_FSUB; break;
-                case 0x2: *type = INST_FMUL; break;
-                case 0x3: *type = INST_FDIV; break;
-                case 0x4: *type = INST_FSQRT; break;
-                default: return -1;
-            }
-            break;
-        case 0x6:  // V-Type
-            switch (inst->funct) {
-                case 0x0: *type = INST_VADD; break;
-                case 0x1: *type = INST_VSUB; break;
-                case 0x2: *type = INST_VMUL; break;
-                case 0x3: *type = INST_VDIV; break;
-                default: return -1;
-            }
-            break;
-        case 0x9:  // A-Type
-            switch (inst->funct) {
-                case 0x0: *type = INST_CONV; break;
-                case 0x2: *type = INST_RELU; break;
-                case 0x5: *type = INST_SOFTMAX; break;
-                default: return -1;
-            }
-            break;
-        case 0x7:  // M-Type
-            switch (inst->funct) {
-                case 0x0: *type = INST_BARRIER; break;
-                case 0x1: *type = INST_LOCK; break;
-                case 0x2: *type = INST_UNLOCK; break;
-                case 0x3: *type = INST_ATOMIC; break;
-                default: return -1;
-            }
-            break;
-        default:
-            return -1;
-    }
-    return 0;
-}
-
-// Arithmetic Instruction Execution
-int cpu_execute_arithmetic(cpu_core_t *core, instruction_t *inst) {
-    uint64_t rs1_val = core->regs.gpr[inst->rs1];
-    uint64_t rs2_val = core->regs.gpr[inst->rs2];
-    uint64_t result = 0;
-    
-    switch (inst->funct) {
-        case 0x0:  // ADD
-            result = rs1_val + rs2_val;
-            break;
-        case 0x1:  // SUB
-            result = rs1_val - rs2_val;
-            break;
-        case 0x2:  // MUL
-            result = rs1_val * rs2_val;
-            break;
-        case 0x3:  // DIV
-            if (rs2_val != 0) {
-                result = rs1_val / rs2_val;
-            } else {
-                return -1;  // Division by zero
-            }
-            break;
-        case 0x4:  // MOD
-            if (rs2_val != 0) {
-                result = rs1_val % rs2_val;
-            } else {
-                return -1;  // Division by zero
-            }
-            break;
-        case 0x5:  // AND
-            result = rs1_val & rs2_val;
-            break;
-        case 0x6:  // OR
-            result = rs1_val | rs2_val;
-            break;
-        case 0x7:  // XOR
-            result = rs1_val ^ rs2_val;
-            break;
-        case 0x8:  // SHL
-            result = rs1_val << (rs2_val & 0x3F);
-            break;
-        case 0x9:  // SHR
-            result = rs1_val >> (rs2_val & 0x3F);
-            break;
-        case 0xA:  // ROT
-            result = (rs1_val << (rs2_val & 0x3F)) | (rs1_val >> (64 - (rs2_val & 0x3F)));
-            break;
-        default:
-            return -1;
-    }
-    
-    // Store result in destination register (rs1 for this example)
-    core->regs.gpr[inst->rs1] = result;
-    
-    // Update flags
-    if (result == 0) {
-        core->regs.flags |= 0x01;  // Zero flag
-    } else {
-        core->regs.flags &= ~0x01;
-    }
-    
-    if (result & 0x8000000000000000ULL) {
-        core->regs.flags |= 0x02;  // Sign flag
-    } else {
-        core->regs.flags &= ~0x02;
-    }
-    
-    return 0;
-}
-
-// Floating-Point Instruction Execution
-int cpu_execute_floating_point(cpu_core_t *core, instruction_t *inst) {
-    float rs1_val = core->regs.fpr[inst->rs1];
-    float rs2_val = core->regs.fpr[inst->rs2];
-    float result = 0.0f;
-    
-    switch (inst->funct) {
-        case 0x0:  // FADD
-            result = rs1_val + rs2_val;
-            break;
-        case 0x1:  // FSUB
-            result = rs1_val - rs2_val;
-            break;
-        case 0x2:  // FMUL
-            result = rs1_val * rs2_val;
-            break;
-        case 0x3:  // FDIV
-            if (rs2_val != 0.0f) {
-                result = rs1_val / rs2_val;
-            } else {
-                return -1;  // Division by zero
-            }
-            break;
-        case 0x4:  // FSQRT
-            if (rs1_val >= 0.0f) {
-                result = sqrtf(rs1_val);
-            } else {
-                return -1;  // Invalid operation
-            }
-            break;
-        default:
-            return -1;
-    }
-    
-    // Store result in destination register
-    core->regs.fpr[inst->rs1] = result;
-    
-    return 0;
-}
-
-// Vector Instruction Execution
-int cpu_execute_vector(cpu_core_t *core, instruction_t *inst) {
-    // Simulate 512-bit vector operations
-    uint8_t *v1 = core->regs.vector[inst->rs1];
-    uint8_t *v2 = core->regs.vector[inst->rs2];
-    uint8_t *vd = core->regs.vector[inst->rs1];  // Destination
-    
-    switch (inst->funct) {
-        case 0x0:  // VADD
-            for (int i = 0; i < 64; i++) {
-                vd[i] = v1[i] + v2[i];
-            }
-            break;
-        case 0x1:  // VSUB
-            for (int i = 0; i < 64; i++) {
-                vd[i] = v1[i] - v2[i];
-            }
-            break;
-        case 0x2:  // VMUL
-            for (int i = 0; i < 64; i++) {
-                vd[i] = v1[i] * v2[i];
-            }
-            break;
-        case 0x3:  // VDIV
-            for (int i = 0; i < 64; i++) {
-                if (v2[i] != 0) {
-                    vd[i] = v1[i] / v2[i];
-                } else {
-                    vd[i] = 0;
-                }
-            }
-            break;
-        default:
-            return -1;
-    }
-    
-    return 0;
-}
-
-// AI/ML Instruction Execution
-int cpu_execute_ai_ml(cpu_core_t *core, instruction_t *inst) {
-    // Simulate AI/ML operations
-    switch (inst->funct) {
-        case 0x0:  // CONV
-            // Simulate convolution operation
-            printf("Executing convolution operation\n");
-            break;
-        case 0x2:  // RELU
-            // Simulate ReLU activation
-            printf("Executing ReLU activation\n");
-            break;
-        case 0x5:  // SOFTMAX
-            // Simulate softmax activation
-            printf("Executing softmax activation\n");
-            break;
-        default:
-            return -1;
-    }
-    
-    return 0;
-}
-
-// MIMD Instruction Execution
-int cpu_execute_mimd(cpu_core_t *core, instruction_t *inst) {
-    // Simulate MIMD operations
-    switch (inst->funct) {
-        case 0x0:  // BARRIER
-            printf("Core %d: Barrier synchronization\n", core->core_id);
-            break;
-        case 0x1:  // LOCK
-            printf("Core %d: Acquiring lock\n", core->core_id);
-            break;
-        case 0x2:  // UNLOCK
-            printf("Core %d: Releasing lock\n", core->core_id);
-            break;
-        case 0x3:  // ATOMIC
-            printf("Core %d: Atomic operation\n", core->core_id);
-            break;
-        default:
-            return -1;
-    }
-    
-    return 0;
-}
-
-// Main Instruction Execution
-int cpu_execute_instruction(cpu_core_t *core, instruction_t *inst) {
-    instruction_type_t type;
-    
-    if (cpu_decode_instruction(inst, &type) != 0) {
-        return -1;
-    }
-    
-    switch (type) {
-        case INST_ADD:
-        case INST_SUB:
-        case INST_MUL:
-        case INST_DIV:
-        case INST_MOD:
-        case INST_AND:
-        case INST_OR:
-        case INST_XOR:
-        case INST_SHL:
-        case INST_SHR:
-        case INST_ROT:
-            return cpu_execute_arithmetic(core, inst);
-            
-        case INST_FADD:
-        case INST_FSUB:
-        case INST_FMUL:
-        case INST_FDIV:
-        case INST_FSQRT:
-            return cpu_execute_floating_point(core, inst);
-            
-        case INST_VADD:
-        case INST_VSUB:
-        case INST_VMUL:
-        case INST_VDIV:
-            return cpu_execute_vector(core, inst);
-            
-        case INST_CONV:
-        case INST_RELU:
-        case INST_SOFTMAX:
-            return cpu_execute_ai_ml(core, inst);
-            
-        case INST_BARRIER:
-        case INST_LOCK:
-        case INST_UNLOCK:
-        case INST_ATOMIC:
-            return cpu_execute_mimd(core, inst);
-            
-        default:
-            return -1;
-    }
+// Demo program: every core adds core_id + 1 to R2 five times, converts the
+// sum to floating point, then all cores meet at a barrier and halt
+static size_t demo_assemble(uint64_t *words) {
+    size_t n = 0;
+    words[n++] = cpu_encode_op(CPU_OPC_C, 0x2, 1, 0, 0, CPU_SR_CORE_ID);  // MFSR R1, CORE_ID
+    words[n++] = cpu_encode_op(CPU_OPC_I, 0x0, 1, 1, 0, 1);               // ADDI R1, R1, #1
+    words[n++] = cpu_encode_long(CPU_OPC_U, 0x0, 3, 5);                    // LI R3, #5
+    words[n++] = cpu_encode_op(CPU_OPC_R, 0x0, 2, 2, 1, 0);               // loop: ADD R2, R2, R1
+    words[n++] = cpu_encode_op(CPU_OPC_I, 0x1, 3, 3, 0, 1);               // SUBI R3, R3, #1
+    words[n++] = cpu_encode_op(CPU_OPC_B, 0xB, 0, 3, 0, -16);             // BNZ R3, loop
+    words[n++] = cpu_encode_op(CPU_OPC_F, 0x7, 1, 2, 0, 0);               // FCVT F1, R2
+    words[n++] = cpu_encode_op(CPU_OPC_F, 0x0, 2, 1, 1, 0);               // FADD F2, F1, F1
+    words[n++] = cpu_encode_op(CPU_OPC_M, 0x0, 0, 0, 0, 0);               // BARRIER
+    words[n++] = cpu_encode_op(CPU_OPC_C, 0x1, 0, 0, 0, 0);               // HALT
+    return n;
 }
 
 // CPU Status Display
 void cpu_show_status(cpu_system_t *cpu) {
     printf("\n=== AlphaAHB V5 CPU Status ===\n");
     printf("Cores: %d\n", cpu->num_cores);
-    printf("Memory: %lu MB\n", cpu->memory_size / (1024 * 1024));
+    printf("Memory: %lu MB\n", (unsigned long)(cpu->memory_size / (1024 * 1024)));
     printf("Clock: %d MHz\n", cpu->clock_frequency);
     printf("Power: %d W\n", cpu->power_consumption);
     
@@ -545,7 +52,7 @@ void cpu_show_status(cpu_system_t *cpu) {
         printf("  PC: 0x%016lX\n", core->regs.pc);
         printf("  SP: 0x%016lX\n", core->regs.sp);
         printf("  FP: 0x%016lX\n", core->regs.fp);
-        printf("  Flags: 0x%016lX\n", core->regs.flags);
+        printf("  Flags: 0x%016lX\n", cpu_flags(core));
         printf("  R1: 0x%016lX\n", core->regs.gpr[1]);
         printf("  R2: 0x%016lX\n", core->regs.gpr[2]);
         printf("  F1: %f\n", core->regs.fpr[1]);
@@ -565,6 +72,14 @@ int main() {
         return 1;
     }
     
+    // Load the demo program at the reset PC
+    uint64_t program[16];
+    if (cpu_load_program(cpu, CPU_RESET_PC, program, demo_assemble(program)) != 0) {
+        printf("Failed to load program\n");
+        cpu_destroy(cpu);
+        return 1;
+    }
+    
     // Show initial status
     cpu_show_status(cpu);
     
@@ -584,6 +99,7 @@ int main() {
                        i, inst.opcode, inst.funct, inst.rs1, inst.rs2);
                 
                 if (cpu_execute_instruction(core, &inst) == 0) {
+                    core->retired++;
                     printf("    Execution successful\n");
                 } else {
                     printf("    Execution failed\n");
@@ -592,6 +108,12 @@ int main() {
         }
     }
     
+    // Run the rest on the predecoded block engine
+    if (cpu_run(cpu, CPU_MODE_BLOCK, 1000000) != 0 || !cpu_halted(cpu)) {
+        printf("\nSimulation stopped abnormally\n");
+    }
+    printf("\nRetired %lu instructions\n", (unsigned long)cpu_retired(cpu));
+    
     // Show final status
     cpu_show_status(cpu);
     
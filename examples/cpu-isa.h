@@ -0,0 +1,483 @@
+/*
+ * AlphaAHB V5 Instruction Set Tables
+ *
+ * Generated by tooling/isa/alphaahb_isa.py from specs/instruction-set.json.
+ * Do not edit: change the description and run `make isa`.
+ *
+ * - CPU_INSTRUCTIONS(X): X(name, handler) for every instruction, in
+ *   instruction_type_t order; cpu_execute_<handler> runs it
+ * - cpu_isa: encoding, operand syntax, timing and properties per type
+ * - cpu_decode_table: type of every opcode/funct byte (instruction bits
+ *   63-56), INST_INVALID for unassigned encodings
+ * - cpu_isa_mnemonics: mnemonic of every opcode/funct byte (aliases
+ *   included), NULL for unassigned encodings
+ * - CPU_ISA_OPERANDS(X): X(NAME, name, SIGNATURE) for every instruction,
+ *   SIGNATURE naming its operands in syntax order (D destination, S1/S2
+ *   sources, IMM immediate or special register, TARGET branch target)
+ *
+ * Included by cpu-simulator.h.
+ */
+
+#ifndef ALPHAAHB_CPU_ISA_H
+#define ALPHAAHB_CPU_ISA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CPU_INSTRUCTIONS(X) \
+    X(INVALID, invalid) \
+    X(ADD, arithmetic) \
+    X(SUB, arithmetic) \
+    X(MUL, arithmetic) \
+    X(DIV, arithmetic) \
+    X(MOD, arithmetic) \
+    X(AND, arithmetic) \
+    X(OR, arithmetic) \
+    X(XOR, arithmetic) \
+    X(SHL, arithmetic) \
+    X(SHR, arithmetic) \
+    X(ROT, arithmetic) \
+    X(CMP, arithmetic) \
+    X(CLZ, arithmetic) \
+    X(CTZ, arithmetic) \
+    X(POPCNT, arithmetic) \
+    X(ADDI, arithmetic) \
+    X(SUBI, arithmetic) \
+    X(MULI, arithmetic) \
+    X(DIVI, arithmetic) \
+    X(ANDI, arithmetic) \
+    X(ORI, arithmetic) \
+    X(XORI, arithmetic) \
+    X(SHLI, arithmetic) \
+    X(SHRI, arithmetic) \
+    X(LOAD, memory) \
+    X(LOADU, memory) \
+    X(LOADL, memory) \
+    X(CMPI, arithmetic) \
+    X(TESTI, arithmetic) \
+    X(STORE, memory) \
+    X(STOREU, memory) \
+    X(PREFETCH, memory) \
+    X(FENCE, memory) \
+    X(FENCEI, memory) \
+    X(BEQ, branch) \
+    X(BNE, branch) \
+    X(BLT, branch) \
+    X(BLE, branch) \
+    X(BGT, branch) \
+    X(BGE, branch) \
+    X(BLTU, branch) \
+    X(BLEU, branch) \
+    X(BGTU, branch) \
+    X(BGEU, branch) \
+    X(BZ, branch) \
+    X(BNZ, branch) \
+    X(BLTZ, branch) \
+    X(BLEZ, branch) \
+    X(BGTZ, branch) \
+    X(BGEZ, branch) \
+    X(J, branch) \
+    X(JAL, branch) \
+    X(JR, branch) \
+    X(JALR, branch) \
+    X(RET, branch) \
+    X(LI, upper) \
+    X(LUI, upper) \
+    X(FADD, floating_point) \
+    X(FSUB, floating_point) \
+    X(FMUL, floating_point) \
+    X(FDIV, floating_point) \
+    X(FSQRT, floating_point) \
+    X(FMA, floating_point) \
+    X(FCMP, floating_point) \
+    X(FCVT, floating_point) \
+    X(VADD, vector) \
+    X(VSUB, vector) \
+    X(VMUL, vector) \
+    X(VDIV, vector) \
+    X(VFMA, vector) \
+    X(VAND, vector) \
+    X(VOR, vector) \
+    X(VXOR, vector) \
+    X(VSHL, vector) \
+    X(VSHR, vector) \
+    X(VREDUCE, vector) \
+    X(CONV, ai_ml) \
+    X(RELU, ai_ml) \
+    X(SOFTMAX, ai_ml) \
+    X(BARRIER, mimd) \
+    X(LOCK, mimd) \
+    X(UNLOCK, mimd) \
+    X(ATOMIC, mimd) \
+    X(YIELD, mimd) \
+    X(NOP, control) \
+    X(HALT, control) \
+    X(MFSR, control) \
+    X(MTSR, control)
+
+#define CPU_ENUM(name, handler) INST_##name,
+typedef enum {
+    CPU_INSTRUCTIONS(CPU_ENUM)
+    INST_COUNT
+} instruction_type_t;
+#undef CPU_ENUM
+
+// cpu_isa_t.properties
+#define CPU_ISA_WRITES_GPR 0x01  // writes its destination to a GPR (R0 writes are discarded)
+#define CPU_ISA_SETS_FLAGS 0x02  // updates Z/S/C/V
+#define CPU_ISA_ENDS_BLOCK 0x04  // control transfer, synchronization or halt: ends a basic block
+#define CPU_ISA_READS_RD 0x08  // also reads its destination (accumulates into or merges with it)
+
+typedef struct {
+    const char *name;
+    uint8_t opcode;          // Primary opcode (bits 63-60)
+    uint8_t funct;           // Function code (bits 59-56)
+    char format;             // 'R', 'I', 'S', ...; 0 for INVALID
+    uint8_t properties;      // CPU_ISA_*
+    uint8_t latency;         // Cycles (instruction-timing.md), 0 = unspecified
+    uint8_t throughput;      // Per cycle, 0 = unspecified
+    const char *syntax;      // Assembler operands, e.g. "rd, rs1, imm"
+} cpu_isa_t;
+
+static const cpu_isa_t cpu_isa[INST_COUNT] = {
+    { "INVALID", 0x0, 0x0, 0, CPU_ISA_ENDS_BLOCK, 0, 0, "" },
+    { "ADD", 0x0, 0x0, 'R', CPU_ISA_WRITES_GPR | CPU_ISA_SETS_FLAGS, 1, 4, "rd, rs1, rs2" },
+    { "SUB", 0x0, 0x1, 'R', CPU_ISA_WRITES_GPR | CPU_ISA_SETS_FLAGS, 1, 4, "rd, rs1, rs2" },
+    { "MUL", 0x0, 0x2, 'R', CPU_ISA_WRITES_GPR | CPU_ISA_SETS_FLAGS, 3, 2, "rd, rs1, rs2" },
+    { "DIV", 0x0, 0x3, 'R', CPU_ISA_WRITES_GPR | CPU_ISA_SETS_FLAGS, 8, 1, "rd, rs1, rs2" },
+    { "MOD", 0x0, 0x4, 'R', CPU_ISA_WRITES_GPR | CPU_ISA_SETS_FLAGS, 8, 1, "rd, rs1, rs2" },
+    { "AND", 0x0, 0x5, 'R', CPU_ISA_WRITES_GPR | CPU_ISA_SETS_FLAGS, 1, 4, "rd, rs1, rs2" },
+    { "OR", 0x0, 0x6, 'R', CPU_ISA_WRITES_GPR | CPU_ISA_SETS_FLAGS, 1, 4, "rd, rs1, rs2" },
+    { "XOR", 0x0, 0x7, 'R', CPU_ISA_WRITES_GPR | CPU_ISA_SETS_FLAGS, 1, 4, "rd, rs1, rs2" },
+    { "SHL", 0x0, 0x8, 'R', CPU_ISA_WRITES_GPR | CPU_ISA_SETS_FLAGS, 1, 4, "rd, rs1, rs2" },
+    { "SHR", 0x0, 0x9, 'R', CPU_ISA_WRITES_GPR | CPU_ISA_SETS_FLAGS, 1, 4, "rd, rs1, rs2" },
+    { "ROT", 0x0, 0xA, 'R', CPU_ISA_WRITES_GPR | CPU_ISA_SETS_FLAGS, 1, 4, "rd, rs1, rs2" },
+    { "CMP", 0x0, 0xB, 'R', CPU_ISA_SETS_FLAGS, 1, 0, "rs1, rs2" },
+    { "CLZ", 0x0, 0xC, 'R', CPU_ISA_WRITES_GPR | CPU_ISA_SETS_FLAGS, 2, 0, "rd, rs1" },
+    { "CTZ", 0x0, 0xD, 'R', CPU_ISA_WRITES_GPR | CPU_ISA_SETS_FLAGS, 2, 0, "rd, rs1" },
+    { "POPCNT", 0x0, 0xE, 'R', CPU_ISA_WRITES_GPR | CPU_ISA_SETS_FLAGS, 2, 0, "rd, rs1" },
+    { "ADDI", 0x1, 0x0, 'I', CPU_ISA_WRITES_GPR | CPU_ISA_SETS_FLAGS, 1, 4, "rd, rs1, imm" },
+    { "SUBI", 0x1, 0x1, 'I', CPU_ISA_WRITES_GPR | CPU_ISA_SETS_FLAGS, 1, 4, "rd, rs1, imm" },
+    { "MULI", 0x1, 0x2, 'I', CPU_ISA_WRITES_GPR | CPU_ISA_SETS_FLAGS, 3, 2, "rd, rs1, imm" },
+    { "DIVI", 0x1, 0x3, 'I', CPU_ISA_WRITES_GPR | CPU_ISA_SETS_FLAGS, 8, 1, "rd, rs1, imm" },
+    { "ANDI", 0x1, 0x4, 'I', CPU_ISA_WRITES_GPR | CPU_ISA_SETS_FLAGS, 1, 4, "rd, rs1, imm" },
+    { "ORI", 0x1, 0x5, 'I', CPU_ISA_WRITES_GPR | CPU_ISA_SETS_FLAGS, 1, 4, "rd, rs1, imm" },
+    { "XORI", 0x1, 0x6, 'I', CPU_ISA_WRITES_GPR | CPU_ISA_SETS_FLAGS, 1, 4, "rd, rs1, imm" },
+    { "SHLI", 0x1, 0x7, 'I', CPU_ISA_WRITES_GPR | CPU_ISA_SETS_FLAGS, 1, 4, "rd, rs1, imm" },
+    { "SHRI", 0x1, 0x8, 'I', CPU_ISA_WRITES_GPR | CPU_ISA_SETS_FLAGS, 1, 4, "rd, rs1, imm" },
+    { "LOAD", 0x1, 0x9, 'I', CPU_ISA_WRITES_GPR, 3, 2, "rd, [rs1 + imm]" },
+    { "LOADU", 0x1, 0xA, 'I', CPU_ISA_WRITES_GPR, 4, 1, "rd, [rs1 + imm]" },
+    { "LOADL", 0x1, 0xB, 'I', CPU_ISA_WRITES_GPR, 3, 1, "rd, [rs1 + imm]" },
+    { "CMPI", 0x1, 0xC, 'I', CPU_ISA_SETS_FLAGS, 1, 0, "rs1, imm" },
+    { "TESTI", 0x1, 0xD, 'I', CPU_ISA_SETS_FLAGS, 1, 0, "rs1, imm" },
+    { "STORE", 0x2, 0x0, 'S', 0, 1, 2, "rs2, [rs1 + imm]" },
+    { "STOREU", 0x2, 0x1, 'S', 0, 2, 1, "rs2, [rs1 + imm]" },
+    { "PREFETCH", 0x2, 0x4, 'S', 0, 0, 0, "[rs1 + imm]" },
+    { "FENCE", 0x2, 0x8, 'S', 0, 0, 0, "" },
+    { "FENCEI", 0x2, 0x9, 'S', CPU_ISA_ENDS_BLOCK, 0, 0, "" },
+    { "BEQ", 0x3, 0x0, 'B', CPU_ISA_ENDS_BLOCK, 1, 0, "rs1, rs2, target" },
+    { "BNE", 0x3, 0x1, 'B', CPU_ISA_ENDS_BLOCK, 1, 0, "rs1, rs2, target" },
+    { "BLT", 0x3, 0x2, 'B', CPU_ISA_ENDS_BLOCK, 1, 0, "rs1, rs2, target" },
+    { "BLE", 0x3, 0x3, 'B', CPU_ISA_ENDS_BLOCK, 1, 0, "rs1, rs2, target" },
+    { "BGT", 0x3, 0x4, 'B', CPU_ISA_ENDS_BLOCK, 1, 0, "rs1, rs2, target" },
+    { "BGE", 0x3, 0x5, 'B', CPU_ISA_ENDS_BLOCK, 1, 0, "rs1, rs2, target" },
+    { "BLTU", 0x3, 0x6, 'B', CPU_ISA_ENDS_BLOCK, 0, 0, "rs1, rs2, target" },
+    { "BLEU", 0x3, 0x7, 'B', CPU_ISA_ENDS_BLOCK, 0, 0, "rs1, rs2, target" },
+    { "BGTU", 0x3, 0x8, 'B', CPU_ISA_ENDS_BLOCK, 0, 0, "rs1, rs2, target" },
+    { "BGEU", 0x3, 0x9, 'B', CPU_ISA_ENDS_BLOCK, 0, 0, "rs1, rs2, target" },
+    { "BZ", 0x3, 0xA, 'B', CPU_ISA_ENDS_BLOCK, 0, 0, "rs1, target" },
+    { "BNZ", 0x3, 0xB, 'B', CPU_ISA_ENDS_BLOCK, 0, 0, "rs1, target" },
+    { "BLTZ", 0x3, 0xC, 'B', CPU_ISA_ENDS_BLOCK, 0, 0, "rs1, target" },
+    { "BLEZ", 0x3, 0xD, 'B', CPU_ISA_ENDS_BLOCK, 0, 0, "rs1, target" },
+    { "BGTZ", 0x3, 0xE, 'B', CPU_ISA_ENDS_BLOCK, 0, 0, "rs1, target" },
+    { "BGEZ", 0x3, 0xF, 'B', CPU_ISA_ENDS_BLOCK, 0, 0, "rs1, target" },
+    { "J", 0x5, 0x0, 'J', CPU_ISA_ENDS_BLOCK, 0, 0, "target" },
+    { "JAL", 0x5, 0x1, 'J', CPU_ISA_ENDS_BLOCK, 0, 0, "target" },
+    { "JR", 0x5, 0x2, 'J', CPU_ISA_ENDS_BLOCK, 0, 0, "rs1" },
+    { "JALR", 0x5, 0x3, 'J', CPU_ISA_ENDS_BLOCK, 0, 0, "rs1" },
+    { "RET", 0x5, 0x4, 'J', CPU_ISA_ENDS_BLOCK, 0, 0, "" },
+    { "LI", 0x4, 0x0, 'U', CPU_ISA_WRITES_GPR, 0, 0, "rd, imm" },
+    { "LUI", 0x4, 0x1, 'U', CPU_ISA_WRITES_GPR | CPU_ISA_READS_RD, 0, 0, "rd, imm" },
+    { "FADD", 0x8, 0x0, 'F', 0, 2, 0, "fd, fs1, fs2" },
+    { "FSUB", 0x8, 0x1, 'F', 0, 2, 0, "fd, fs1, fs2" },
+    { "FMUL", 0x8, 0x2, 'F', 0, 4, 0, "fd, fs1, fs2" },
+    { "FDIV", 0x8, 0x3, 'F', 0, 8, 0, "fd, fs1, fs2" },
+    { "FSQRT", 0x8, 0x4, 'F', 0, 12, 0, "fd, fs1" },
+    { "FMA", 0x8, 0x5, 'F', CPU_ISA_READS_RD, 4, 0, "fd, fs1, fs2" },
+    { "FCMP", 0x8, 0x6, 'F', 0, 0, 0, "fs1, fs2" },
+    { "FCVT", 0x8, 0x7, 'F', 0, 0, 0, "fd, rs1, imm" },
+    { "VADD", 0x6, 0x0, 'V', 0, 2, 2, "vd, vs1, vs2" },
+    { "VSUB", 0x6, 0x1, 'V', 0, 2, 2, "vd, vs1, vs2" },
+    { "VMUL", 0x6, 0x2, 'V', 0, 4, 1, "vd, vs1, vs2" },
+    { "VDIV", 0x6, 0x3, 'V', 0, 8, 1, "vd, vs1, vs2" },
+    { "VFMA", 0x6, 0x4, 'V', CPU_ISA_READS_RD, 4, 1, "vd, vs1, vs2" },
+    { "VAND", 0x6, 0x5, 'V', 0, 1, 4, "vd, vs1, vs2" },
+    { "VOR", 0x6, 0x6, 'V', 0, 1, 4, "vd, vs1, vs2" },
+    { "VXOR", 0x6, 0x7, 'V', 0, 1, 4, "vd, vs1, vs2" },
+    { "VSHL", 0x6, 0x8, 'V', 0, 0, 0, "vd, vs1, imm" },
+    { "VSHR", 0x6, 0x9, 'V', 0, 0, 0, "vd, vs1, imm" },
+    { "VREDUCE", 0x6, 0xB, 'V', CPU_ISA_WRITES_GPR, 4, 0, "rd, vs1" },
+    { "CONV", 0x9, 0x0, 'A', 0, 16, 1, "" },
+    { "RELU", 0x9, 0x2, 'A', 0, 1, 8, "" },
+    { "SOFTMAX", 0x9, 0x5, 'A', 0, 8, 1, "" },
+    { "BARRIER", 0x7, 0x0, 'M', CPU_ISA_ENDS_BLOCK, 10, 0, "" },
+    { "LOCK", 0x7, 0x1, 'M', CPU_ISA_ENDS_BLOCK, 5, 0, "[rs1 + imm]" },
+    { "UNLOCK", 0x7, 0x2, 'M', CPU_ISA_ENDS_BLOCK, 1, 0, "[rs1 + imm]" },
+    { "ATOMIC", 0x7, 0x3, 'M', CPU_ISA_WRITES_GPR | CPU_ISA_ENDS_BLOCK, 3, 0, "rd, rs2, [rs1 + imm]" },
+    { "YIELD", 0x7, 0xA, 'M', CPU_ISA_ENDS_BLOCK, 1, 0, "" },
+    { "NOP", 0xB, 0x0, 'C', 0, 0, 0, "" },
+    { "HALT", 0xB, 0x1, 'C', CPU_ISA_ENDS_BLOCK, 0, 0, "" },
+    { "MFSR", 0xB, 0x2, 'C', CPU_ISA_WRITES_GPR, 0, 0, "rd, sr" },
+    { "MTSR", 0xB, 0x3, 'C', CPU_ISA_ENDS_BLOCK, 0, 0, "sr, rs1" },
+};
+
+// Instruction type by opcode << 4 | funct: cpu_decode_table[word >> 56]
+static const uint8_t cpu_decode_table[256] = {
+    /* 0x0_ */
+    INST_ADD, INST_SUB, INST_MUL, INST_DIV,
+    INST_MOD, INST_AND, INST_OR, INST_XOR,
+    INST_SHL, INST_SHR, INST_ROT, INST_CMP,
+    INST_CLZ, INST_CTZ, INST_POPCNT, INST_INVALID,
+    /* 0x1_ */
+    INST_ADDI, INST_SUBI, INST_MULI, INST_DIVI,
+    INST_ANDI, INST_ORI, INST_XORI, INST_SHLI,
+    INST_SHRI, INST_LOAD, INST_LOADU, INST_LOADL,
+    INST_CMPI, INST_TESTI, INST_INVALID, INST_INVALID,
+    /* 0x2_ */
+    INST_STORE, INST_STOREU, INST_INVALID, INST_INVALID,
+    INST_PREFETCH, INST_FENCE, INST_FENCE, INST_FENCE,
+    INST_FENCE, INST_FENCEI, INST_INVALID, INST_INVALID,
+    INST_INVALID, INST_INVALID, INST_INVALID, INST_INVALID,
+    /* 0x3_ */
+    INST_BEQ, INST_BNE, INST_BLT, INST_BLE,
+    INST_BGT, INST_BGE, INST_BLTU, INST_BLEU,
+    INST_BGTU, INST_BGEU, INST_BZ, INST_BNZ,
+    INST_BLTZ, INST_BLEZ, INST_BGTZ, INST_BGEZ,
+    /* 0x4_ */
+    INST_LI, INST_LUI, INST_INVALID, INST_INVALID,
+    INST_INVALID, INST_INVALID, INST_INVALID, INST_INVALID,
+    INST_INVALID, INST_INVALID, INST_INVALID, INST_INVALID,
+    INST_INVALID, INST_INVALID, INST_INVALID, INST_INVALID,
+    /* 0x5_ */
+    INST_J, INST_JAL, INST_JR, INST_JALR,
+    INST_RET, INST_INVALID, INST_INVALID, INST_INVALID,
+    INST_INVALID, INST_INVALID, INST_INVALID, INST_INVALID,
+    INST_INVALID, INST_INVALID, INST_INVALID, INST_INVALID,
+    /* 0x6_ */
+    INST_VADD, INST_VSUB, INST_VMUL, INST_VDIV,
+    INST_VFMA, INST_VAND, INST_VOR, INST_VXOR,
+    INST_VSHL, INST_VSHR, INST_INVALID, INST_VREDUCE,
+    INST_INVALID, INST_INVALID, INST_INVALID, INST_INVALID,
+    /* 0x7_ */
+    INST_BARRIER, INST_LOCK, INST_UNLOCK, INST_ATOMIC,
+    INST_INVALID, INST_INVALID, INST_INVALID, INST_INVALID,
+    INST_INVALID, INST_INVALID, INST_YIELD, INST_INVALID,
+    INST_INVALID, INST_INVALID, INST_INVALID, INST_INVALID,
+    /* 0x8_ */
+    INST_FADD, INST_FSUB, INST_FMUL, INST_FDIV,
+    INST_FSQRT, INST_FMA, INST_FCMP, INST_FCVT,
+    INST_INVALID, INST_INVALID, INST_INVALID, INST_INVALID,
+    INST_INVALID, INST_INVALID, INST_INVALID, INST_INVALID,
+    /* 0x9_ */
+    INST_CONV, INST_INVALID, INST_RELU, INST_INVALID,
+    INST_INVALID, INST_SOFTMAX, INST_INVALID, INST_INVALID,
+    INST_INVALID, INST_INVALID, INST_INVALID, INST_INVALID,
+    INST_INVALID, INST_INVALID, INST_INVALID, INST_INVALID,
+    /* 0xA_ */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /* 0xB_ */
+    INST_NOP, INST_HALT, INST_MFSR, INST_MTSR,
+    INST_INVALID, INST_INVALID, INST_INVALID, INST_INVALID,
+    INST_INVALID, INST_INVALID, INST_INVALID, INST_INVALID,
+    INST_INVALID, INST_INVALID, INST_INVALID, INST_INVALID,
+    /* 0xC_ */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /* 0xD_ */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /* 0xE_ */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /* 0xF_ */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+// Mnemonic by opcode << 4 | funct
+static const char *const cpu_isa_mnemonics[256] = {
+    [0x00] = "ADD",
+    [0x01] = "SUB",
+    [0x02] = "MUL",
+    [0x03] = "DIV",
+    [0x04] = "MOD",
+    [0x05] = "AND",
+    [0x06] = "OR",
+    [0x07] = "XOR",
+    [0x08] = "SHL",
+    [0x09] = "SHR",
+    [0x0A] = "ROT",
+    [0x0B] = "CMP",
+    [0x0C] = "CLZ",
+    [0x0D] = "CTZ",
+    [0x0E] = "POPCNT",
+    [0x10] = "ADDI",
+    [0x11] = "SUBI",
+    [0x12] = "MULI",
+    [0x13] = "DIVI",
+    [0x14] = "ANDI",
+    [0x15] = "ORI",
+    [0x16] = "XORI",
+    [0x17] = "SHLI",
+    [0x18] = "SHRI",
+    [0x19] = "LOAD",
+    [0x1A] = "LOADU",
+    [0x1B] = "LOADL",
+    [0x1C] = "CMPI",
+    [0x1D] = "TESTI",
+    [0x20] = "STORE",
+    [0x21] = "STOREU",
+    [0x24] = "PREFETCH",
+    [0x25] = "FLUSH",
+    [0x26] = "INVALIDATE",
+    [0x27] = "SYNC",
+    [0x28] = "FENCE",
+    [0x29] = "FENCEI",
+    [0x30] = "BEQ",
+    [0x31] = "BNE",
+    [0x32] = "BLT",
+    [0x33] = "BLE",
+    [0x34] = "BGT",
+    [0x35] = "BGE",
+    [0x36] = "BLTU",
+    [0x37] = "BLEU",
+    [0x38] = "BGTU",
+    [0x39] = "BGEU",
+    [0x3A] = "BZ",
+    [0x3B] = "BNZ",
+    [0x3C] = "BLTZ",
+    [0x3D] = "BLEZ",
+    [0x3E] = "BGTZ",
+    [0x3F] = "BGEZ",
+    [0x40] = "LI",
+    [0x41] = "LUI",
+    [0x50] = "J",
+    [0x51] = "JAL",
+    [0x52] = "JR",
+    [0x53] = "JALR",
+    [0x54] = "RET",
+    [0x60] = "VADD",
+    [0x61] = "VSUB",
+    [0x62] = "VMUL",
+    [0x63] = "VDIV",
+    [0x64] = "VFMA",
+    [0x65] = "VAND",
+    [0x66] = "VOR",
+    [0x67] = "VXOR",
+    [0x68] = "VSHL",
+    [0x69] = "VSHR",
+    [0x6B] = "VREDUCE",
+    [0x70] = "BARRIER",
+    [0x71] = "LOCK",
+    [0x72] = "UNLOCK",
+    [0x73] = "ATOMIC",
+    [0x7A] = "YIELD",
+    [0x80] = "FADD",
+    [0x81] = "FSUB",
+    [0x82] = "FMUL",
+    [0x83] = "FDIV",
+    [0x84] = "FSQRT",
+    [0x85] = "FMA",
+    [0x86] = "FCMP",
+    [0x87] = "FCVT",
+    [0x90] = "CONV",
+    [0x92] = "RELU",
+    [0x95] = "SOFTMAX",
+    [0xB0] = "NOP",
+    [0xB1] = "HALT",
+    [0xB2] = "MFSR",
+    [0xB3] = "MTSR",
+};
+
+#define CPU_ISA_OPERANDS(X) \
+    X(ADD, add, D_S1_S2) \
+    X(SUB, sub, D_S1_S2) \
+    X(MUL, mul, D_S1_S2) \
+    X(DIV, div, D_S1_S2) \
+    X(MOD, mod, D_S1_S2) \
+    X(AND, and, D_S1_S2) \
+    X(OR, or, D_S1_S2) \
+    X(XOR, xor, D_S1_S2) \
+    X(SHL, shl, D_S1_S2) \
+    X(SHR, shr, D_S1_S2) \
+    X(ROT, rot, D_S1_S2) \
+    X(CMP, cmp, S1_S2) \
+    X(CLZ, clz, D_S1) \
+    X(CTZ, ctz, D_S1) \
+    X(POPCNT, popcnt, D_S1) \
+    X(ADDI, addi, D_S1_IMM) \
+    X(SUBI, subi, D_S1_IMM) \
+    X(MULI, muli, D_S1_IMM) \
+    X(DIVI, divi, D_S1_IMM) \
+    X(ANDI, andi, D_S1_IMM) \
+    X(ORI, ori, D_S1_IMM) \
+    X(XORI, xori, D_S1_IMM) \
+    X(SHLI, shli, D_S1_IMM) \
+    X(SHRI, shri, D_S1_IMM) \
+    X(LOAD, load, D_S1_IMM) \
+    X(LOADU, loadu, D_S1_IMM) \
+    X(LOADL, loadl, D_S1_IMM) \
+    X(CMPI, cmpi, S1_IMM) \
+    X(TESTI, testi, S1_IMM) \
+    X(STORE, store, S2_S1_IMM) \
+    X(STOREU, storeu, S2_S1_IMM) \
+    X(PREFETCH, prefetch, S1_IMM) \
+    X(FENCE, fence, NONE) \
+    X(FENCEI, fencei, NONE) \
+    X(BEQ, beq, S1_S2_TARGET) \
+    X(BNE, bne, S1_S2_TARGET) \
+    X(BLT, blt, S1_S2_TARGET) \
+    X(BLE, ble, S1_S2_TARGET) \
+    X(BGT, bgt, S1_S2_TARGET) \
+    X(BGE, bge, S1_S2_TARGET) \
+    X(BLTU, bltu, S1_S2_TARGET) \
+    X(BLEU, bleu, S1_S2_TARGET) \
+    X(BGTU, bgtu, S1_S2_TARGET) \
+    X(BGEU, bgeu, S1_S2_TARGET) \
+    X(BZ, bz, S1_TARGET) \
+    X(BNZ, bnz, S1_TARGET) \
+    X(BLTZ, bltz, S1_TARGET) \
+    X(BLEZ, blez, S1_TARGET) \
+    X(BGTZ, bgtz, S1_TARGET) \
+    X(BGEZ, bgez, S1_TARGET) \
+    X(J, j, TARGET) \
+    X(JAL, jal, TARGET) \
+    X(JR, jr, S1) \
+    X(JALR, jalr, S1) \
+    X(RET, ret, NONE) \
+    X(LI, li, D_IMM) \
+    X(LUI, lui, D_IMM) \
+    X(FADD, fadd, D_S1_S2) \
+    X(FSUB, fsub, D_S1_S2) \
+    X(FMUL, fmul, D_S1_S2) \
+    X(FDIV, fdiv, D_S1_S2) \
+    X(FSQRT, fsqrt, D_S1) \
+    X(FMA, fma, D_S1_S2) \
+    X(FCMP, fcmp, S1_S2) \
+    X(FCVT, fcvt, D_S1_IMM) \
+    X(VADD, vadd, D_S1_S2) \
+    X(VSUB, vsub, D_S1_S2) \
+    X(VMUL, vmul, D_S1_S2) \
+    X(VDIV, vdiv, D_S1_S2) \
+    X(VFMA, vfma, D_S1_S2) \
+    X(VAND, vand, D_S1_S2) \
+    X(VOR, vor, D_S1_S2) \
+    X(VXOR, vxor, D_S1_S2) \
+    X(VSHL, vshl, D_S1_IMM) \
+    X(VSHR, vshr, D_S1_IMM) \
+    X(VREDUCE, vreduce, D_S1) \
+    X(CONV, conv, NONE) \
+    X(RELU, relu, NONE) \
+    X(SOFTMAX, softmax, NONE) \
+    X(BARRIER, barrier, NONE) \
+    X(LOCK, lock, S1_IMM) \
+    X(UNLOCK, unlock, S1_IMM) \
+    X(ATOMIC, atomic, D_S2_S1_IMM) \
+    X(YIELD, yield, NONE) \
+    X(NOP, nop, NONE) \
+    X(HALT, halt, NONE) \
+    X(MFSR, mfsr, D_IMM) \
+    X(MTSR, mtsr, IMM_S1)
+
+#endif // ALPHAAHB_CPU_ISA_H
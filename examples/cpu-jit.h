@@ -0,0 +1,1048 @@
+/*
+ * AlphaAHB V5 Simulator JIT
+ *
+ * Dynamic binary translation of hot guest basic blocks to x86-64 machine
+ * code, the tier above the block interpreter in CPU_MODE_JIT. A block is
+ * interpreted until it has been entered CPU_JIT_THRESHOLD times, then
+ * cpu_jit_translate emits host code for it:
+ *
+ * - integer ALU and immediate operations, loads and stores, LI/LUI,
+ *   branches and jumps, FADD/FSUB/FMUL/FCVT and the byte-lane
+ *   VADD/VSUB/VAND/VOR/VXOR run inline; every other instruction calls
+ *   cpu_execute_op, so the interpreter stays the reference for semantics
+ * - guest GPRs are cached in six host registers inside a block: loaded on
+ *   first use, written back before helper calls and at every exit
+ * - flags are lazy like in the interpreter: an ALU instruction stores its
+ *   result, operands and cpu_flags_kind, and only when something after it
+ *   can observe them (a helper, a side exit or the end of the block)
+ * - blocks chain: an exit loads its successor's translation from
+ *   cpu_block_t.code and jumps straight to it, for static and computed
+ *   targets alike; each block checks the instruction budget on entry
+ *
+ * Nothing is patched after emission, so invalidation is just clearing
+ * cpu_block_t.code. A store into the text (cpu_text_written) or a full
+ * code buffer clears them all and the buffer is reused from the start at
+ * the next block boundary.
+ *
+ * Generated code keeps the core in RBX, guest memory in RBP, the budget
+ * left in R12, the instructions retired in R13 and the last valid 8-byte
+ * address in R14. It needs x86-64, GCC or clang and an anonymous RWX
+ * mapping (_DEFAULT_SOURCE for MAP_ANONYMOUS); elsewhere translation fails
+ * and CPU_MODE_JIT runs entirely in the block interpreter.
+ *
+ * Included by cpu-simulator.h.
+ */
+
+#ifndef ALPHAAHB_CPU_JIT_H
+#define ALPHAAHB_CPU_JIT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <sys/mman.h>
+#endif
+
+#if defined(__x86_64__) && defined(__GNUC__) && defined(MAP_ANONYMOUS)
+#define CPU_HAVE_JIT 1
+#else
+#define CPU_HAVE_JIT 0
+#endif
+
+// In/out state of one trip through translated code
+typedef struct {
+    uint64_t budget;         // Instructions the core may still run
+    uint64_t executed;       // Instructions retired by translated code
+} cpu_jit_frame_t;
+
+// Runs translated code from code until an exit; returns CPU_EXEC_FAULT
+// with regs.pc at the faulting instruction, otherwise 0
+typedef int (*cpu_jit_entry_t)(cpu_core_t *core, void *code, cpu_jit_frame_t *frame);
+
+// Drops every translation; blocks are rebuilt (and re-heated) on demand
+static inline void cpu_jit_flush(cpu_system_t *cpu) {
+    if (cpu->blocks) {
+        memset(cpu->blocks, 0, cpu->text_count * sizeof(cpu_block_t));
+    }
+    cpu->jit.used = cpu->jit.prologue;
+    cpu->jit.flush = 0;
+    cpu->jit.flushes++;
+}
+
+static inline int cpu_jit_enter(cpu_core_t *core, void *code, cpu_jit_frame_t *frame) {
+    cpu_jit_entry_t entry = (cpu_jit_entry_t)(uintptr_t)core->system->jit.code;
+    return entry(core, code, frame);
+}
+
+#if CPU_HAVE_JIT
+
+// x86-64 encoder
+// ==============
+
+enum {
+    X64_RAX, X64_RCX, X64_RDX, X64_RBX, X64_RSP, X64_RBP, X64_RSI, X64_RDI,
+    X64_R8, X64_R9, X64_R10, X64_R11, X64_R12, X64_R13, X64_R14, X64_R15
+};
+
+// Condition codes (low nibble of Jcc/SETcc)
+enum {
+    X64_B = 0x2, X64_AE = 0x3, X64_E = 0x4, X64_NE = 0x5, X64_BE = 0x6, X64_A = 0x7,
+    X64_L = 0xC, X64_GE = 0xD, X64_LE = 0xE, X64_G = 0xF
+};
+
+// Group-1 ALU extensions (0x81 /ext) and their register forms
+enum { X64_ADD = 0, X64_OR = 1, X64_AND = 4, X64_SUB = 5, X64_XOR = 6, X64_CMP = 7 };
+static const uint8_t x64_alu_rr[8] = { 0x01, 0x09, 0, 0, 0x21, 0x29, 0x31, 0x39 };
+
+// Shift extensions (0xC1/0xD3 /ext)
+enum { X64_ROL = 0, X64_SHL = 4, X64_SHR = 5 };
+
+typedef struct {
+    uint8_t *p;
+    uint8_t *end;
+    int overflow;
+} x64_buf_t;
+
+static inline void x64_byte(x64_buf_t *b, unsigned v) {
+    if (b->p < b->end) {
+        *b->p++ = (uint8_t)v;
+    } else {
+        b->overflow = 1;
+    }
+}
+
+static inline void x64_u32(x64_buf_t *b, uint32_t v) {
+    for (int i = 0; i < 4; i++) x64_byte(b, (v >> (8 * i)) & 0xFF);
+}
+
+static inline void x64_u64(x64_buf_t *b, uint64_t v) {
+    for (int i = 0; i < 8; i++) x64_byte(b, (unsigned)(v >> (8 * i)) & 0xFF);
+}
+
+static inline void x64_rex(x64_buf_t *b, int w, int reg, int index, int base) {
+    unsigned rex = 0x40 | (w ? 8 : 0) | ((reg & 8) >> 1) | ((index & 8) >> 2) | ((base & 8) >> 3);
+    if (rex != 0x40) x64_byte(b, rex);
+}
+
+static inline void x64_modrm_reg(x64_buf_t *b, int reg, int rm) {
+    x64_byte(b, 0xC0 | ((reg & 7) << 3) | (rm & 7));
+}
+
+// [base + disp32]
+static inline void x64_modrm_mem(x64_buf_t *b, int reg, int base, int32_t disp) {
+    x64_byte(b, 0x80 | ((reg & 7) << 3) | (base & 7));
+    if ((base & 7) == X64_RSP) x64_byte(b, 0x24);
+    x64_u32(b, (uint32_t)disp);
+}
+
+// [base + index]
+static inline void x64_modrm_sib(x64_buf_t *b, int reg, int base, int index) {
+    x64_byte(b, 0x44 | ((reg & 7) << 3));
+    x64_byte(b, ((index & 7) << 3) | (base & 7));
+    x64_byte(b, 0);
+}
+
+// op dst, src for the 0x01-style "r/m64, r64" opcodes (and 0x89 mov, 0x85 test)
+static inline void x64_rr(x64_buf_t *b, unsigned opcode, int dst, int src) {
+    x64_rex(b, 1, src, 0, dst);
+    x64_byte(b, opcode);
+    x64_modrm_reg(b, src, dst);
+}
+
+static inline void x64_mov_rr(x64_buf_t *b, int dst, int src) {
+    if (dst != src) x64_rr(b, 0x89, dst, src);
+}
+
+static inline void x64_load(x64_buf_t *b, int dst, int base, int32_t disp) {
+    x64_rex(b, 1, dst, 0, base);
+    x64_byte(b, 0x8B);
+    x64_modrm_mem(b, dst, base, disp);
+}
+
+static inline void x64_store(x64_buf_t *b, int base, int32_t disp, int src) {
+    x64_rex(b, 1, src, 0, base);
+    x64_byte(b, 0x89);
+    x64_modrm_mem(b, src, base, disp);
+}
+
+// mov qword [base + disp], sign-extended imm32
+static inline void x64_store_imm(x64_buf_t *b, int base, int32_t disp, int32_t imm) {
+    x64_rex(b, 1, 0, 0, base);
+    x64_byte(b, 0xC7);
+    x64_modrm_mem(b, 0, base, disp);
+    x64_u32(b, (uint32_t)imm);
+}
+
+static inline int x64_fits32(int64_t v) {
+    return v == (int64_t)(int32_t)v;
+}
+
+static inline void x64_mov_ri(x64_buf_t *b, int dst, uint64_t imm) {
+    if (x64_fits32((int64_t)imm)) {
+        x64_rex(b, 1, 0, 0, dst);
+        x64_byte(b, 0xC7);
+        x64_modrm_reg(b, 0, dst);
+        x64_u32(b, (uint32_t)imm);
+    } else if (imm <= 0xFFFFFFFFULL) {
+        x64_rex(b, 0, 0, 0, dst);  // mov r32, imm32 zero-extends
+        x64_byte(b, 0xB8 + (dst & 7));
+        x64_u32(b, (uint32_t)imm);
+    } else {
+        x64_rex(b, 1, 0, 0, dst);
+        x64_byte(b, 0xB8 + (dst & 7));
+        x64_u64(b, imm);
+    }
+}
+
+// op dst, imm; immediates beyond 32 bits go through RCX
+static inline void x64_alu_ri(x64_buf_t *b, int ext, int dst, int64_t imm) {
+    if (!x64_fits32(imm)) {
+        x64_mov_ri(b, X64_RCX, (uint64_t)imm);
+        x64_rr(b, x64_alu_rr[ext], dst, X64_RCX);
+        return;
+    }
+    x64_rex(b, 1, 0, 0, dst);
+    if (imm >= -128 && imm <= 127) {
+        x64_byte(b, 0x83);
+        x64_modrm_reg(b, ext, dst);
+        x64_byte(b, (uint8_t)imm);
+    } else {
+        x64_byte(b, 0x81);
+        x64_modrm_reg(b, ext, dst);
+        x64_u32(b, (uint32_t)imm);
+    }
+}
+
+static inline void x64_shift_ri(x64_buf_t *b, int ext, int dst, unsigned count) {
+    x64_rex(b, 1, 0, 0, dst);
+    x64_byte(b, 0xC1);
+    x64_modrm_reg(b, ext, dst);
+    x64_byte(b, count & 0x3F);
+}
+
+// Shift by CL (the hardware masks the count to 6 bits, like the model)
+static inline void x64_shift_cl(x64_buf_t *b, int ext, int dst) {
+    x64_rex(b, 1, 0, 0, dst);
+    x64_byte(b, 0xD3);
+    x64_modrm_reg(b, ext, dst);
+}
+
+static inline void x64_imul_rr(x64_buf_t *b, int dst, int src) {
+    x64_rex(b, 1, dst, 0, src);
+    x64_byte(b, 0x0F);
+    x64_byte(b, 0xAF);
+    x64_modrm_reg(b, dst, src);
+}
+
+static inline void x64_imul_rri(x64_buf_t *b, int dst, int src, int32_t imm) {
+    x64_rex(b, 1, dst, 0, src);
+    x64_byte(b, 0x69);
+    x64_modrm_reg(b, dst, src);
+    x64_u32(b, (uint32_t)imm);
+}
+
+// Jumps return the rel32 field for x64_bind
+static inline uint8_t *x64_jcc(x64_buf_t *b, int cc) {
+    x64_byte(b, 0x0F);
+    x64_byte(b, 0x80 | cc);
+    x64_u32(b, 0);
+    return b->overflow ? NULL : b->p - 4;
+}
+
+static inline uint8_t *x64_jmp(x64_buf_t *b) {
+    x64_byte(b, 0xE9);
+    x64_u32(b, 0);
+    return b->overflow ? NULL : b->p - 4;
+}
+
+static inline void x64_bind_to(uint8_t *rel, const uint8_t *target) {
+    if (rel) {
+        int32_t disp = (int32_t)(target - (rel + 4));
+        memcpy(rel, &disp, sizeof(disp));
+    }
+}
+
+static inline void x64_bind(x64_buf_t *b, uint8_t *rel) {
+    if (!b->overflow) x64_bind_to(rel, b->p);
+}
+
+static inline void x64_jcc_to(x64_buf_t *b, int cc, const uint8_t *target) {
+    x64_bind_to(x64_jcc(b, cc), target);
+}
+
+static inline void x64_jmp_to(x64_buf_t *b, const uint8_t *target) {
+    x64_bind_to(x64_jmp(b), target);
+}
+
+// call/jmp through a register
+static inline void x64_indirect(x64_buf_t *b, int ext, int reg) {
+    x64_rex(b, 0, 0, 0, reg);
+    x64_byte(b, 0xFF);
+    x64_modrm_reg(b, ext, reg);
+}
+
+static inline void x64_push(x64_buf_t *b, int reg) {
+    x64_rex(b, 0, 0, 0, reg);
+    x64_byte(b, 0x50 + (reg & 7));
+}
+
+static inline void x64_pop(x64_buf_t *b, int reg) {
+    x64_rex(b, 0, 0, 0, reg);
+    x64_byte(b, 0x58 + (reg & 7));
+}
+
+// SSE op xmm, [base + disp32]: prefix 0F opcode
+static inline void x64_sse_mem(x64_buf_t *b, unsigned prefix, unsigned opcode, int xmm, int base,
+                               int32_t disp) {
+    x64_byte(b, prefix);
+    x64_rex(b, 0, xmm, 0, base);
+    x64_byte(b, 0x0F);
+    x64_byte(b, opcode);
+    x64_modrm_mem(b, xmm, base, disp);
+}
+
+static inline void x64_sse_rr(x64_buf_t *b, unsigned prefix, unsigned opcode, int dst, int src) {
+    x64_byte(b, prefix);
+    x64_rex(b, 0, dst, 0, src);
+    x64_byte(b, 0x0F);
+    x64_byte(b, opcode);
+    x64_modrm_reg(b, dst, src);
+}
+
+// Translator
+// ==========
+
+// Instruction the translation hands to the interpreter
+static int cpu_jit_helper(cpu_core_t *core, const cpu_op_t *op, uint64_t pc) {
+    return cpu_execute_op(core, (instruction_type_t)op->type, op, pc);
+}
+
+#define CPU_JIT_CACHED 6
+#define CPU_JIT_MAX_STUBS (2 * CPU_MAX_BLOCK)
+
+// Host registers that cache guest GPRs (caller-saved: spilled around helpers)
+static const uint8_t cpu_jit_cache_regs[CPU_JIT_CACHED] = {
+    X64_RSI, X64_RDI, X64_R8, X64_R9, X64_R10, X64_R11
+};
+
+typedef struct {
+    int8_t guest[CPU_JIT_CACHED];    // Cached guest GPR, -1 when free
+    uint8_t dirty[CPU_JIT_CACHED];
+    uint32_t used[CPU_JIT_CACHED];   // For LRU eviction
+    uint32_t clock;
+} cpu_jit_cache_t;
+
+// Out-of-line paths, emitted after the block body
+typedef enum {
+    CPU_JIT_STUB_FAULT,      // Memory check failed: write back, report op i
+    CPU_JIT_STUB_HELPER,     // Helper returned non-zero in EAX
+    CPU_JIT_STUB_STORE       // Store overlaps the text: let the helper do it
+} cpu_jit_stub_kind_t;
+
+typedef struct {
+    uint8_t *rel;
+    cpu_jit_stub_kind_t kind;
+    uint32_t index;
+    cpu_jit_cache_t cache;   // Register state at the branch
+} cpu_jit_stub_t;
+
+typedef struct {
+    x64_buf_t b;
+    cpu_system_t *cpu;
+    const cpu_block_t *block;
+    const cpu_op_t *ops;
+    cpu_jit_cache_t cache;
+    cpu_jit_stub_t stubs[CPU_JIT_MAX_STUBS];
+    int nstubs;
+    uint8_t *exit;           // Return to the dispatcher, status in EAX
+    uint8_t *exit_continue;  // Same with status 0
+} cpu_jit_ctx_t;
+
+#define CPU_JIT_GPR(r) ((int32_t)(offsetof(cpu_core_t, regs.gpr) + 8 * (r)))
+#define CPU_JIT_FPR(r) ((int32_t)(offsetof(cpu_core_t, regs.fpr) + 4 * (r)))
+#define CPU_JIT_VR(r) ((int32_t)(offsetof(cpu_core_t, regs.vector) + 64 * (r)))
+#define CPU_JIT_REG(field) ((int32_t)offsetof(cpu_core_t, regs.field))
+#define CPU_JIT_CORE(field) ((int32_t)offsetof(cpu_core_t, field))
+
+// cpu_jit_chain_dynamic turns a text offset into a blocks[] offset with one
+// multiply by sizeof(cpu_block_t) / CPU_INST_BYTES
+typedef char cpu_jit_block_layout_check[sizeof(cpu_block_t) % CPU_INST_BYTES == 0 ? 1 : -1];
+
+static inline uint64_t cpu_jit_pc(const cpu_jit_ctx_t *t, uint32_t i) {
+    return t->block->pc + (uint64_t)i * CPU_INST_BYTES;
+}
+
+static inline void cpu_jit_writeback(x64_buf_t *b, cpu_jit_cache_t *c) {
+    for (int s = 0; s < CPU_JIT_CACHED; s++) {
+        if (c->guest[s] >= 0 && c->dirty[s]) {
+            x64_store(b, X64_RBX, CPU_JIT_GPR(c->guest[s]), cpu_jit_cache_regs[s]);
+            c->dirty[s] = 0;
+        }
+    }
+}
+
+static inline void cpu_jit_forget(cpu_jit_cache_t *c) {
+    for (int s = 0; s < CPU_JIT_CACHED; s++) {
+        c->guest[s] = -1;
+        c->dirty[s] = 0;
+    }
+}
+
+// Host register holding guest GPR g, loaded from the register file unless
+// the caller is about to overwrite it
+static inline int cpu_jit_reg(cpu_jit_ctx_t *t, unsigned g, int load) {
+    cpu_jit_cache_t *c = &t->cache;
+    int slot = -1;
+
+    for (int s = 0; s < CPU_JIT_CACHED; s++) {
+        if (c->guest[s] == (int8_t)g) {
+            c->used[s] = ++c->clock;
+            return cpu_jit_cache_regs[s];
+        }
+    }
+    for (int s = 0; s < CPU_JIT_CACHED; s++) {
+        if (c->guest[s] < 0) {
+            slot = s;
+            break;
+        }
+        if (slot < 0 || c->used[s] < c->used[slot]) {
+            slot = s;
+        }
+    }
+    if (c->guest[slot] >= 0 && c->dirty[slot]) {
+        x64_store(&t->b, X64_RBX, CPU_JIT_GPR(c->guest[slot]), cpu_jit_cache_regs[slot]);
+    }
+    c->guest[slot] = (int8_t)g;
+    c->dirty[slot] = 0;
+    c->used[slot] = ++c->clock;
+    if (load) {
+        x64_load(&t->b, cpu_jit_cache_regs[slot], X64_RBX, CPU_JIT_GPR(g));
+    }
+    return cpu_jit_cache_regs[slot];
+}
+
+// Guest GPR g := RAX
+static inline void cpu_jit_def(cpu_jit_ctx_t *t, unsigned g) {
+    int host = cpu_jit_reg(t, g, 0);
+
+    x64_mov_rr(&t->b, host, X64_RAX);
+    for (int s = 0; s < CPU_JIT_CACHED; s++) {
+        if (cpu_jit_cache_regs[s] == host) t->cache.dirty[s] = 1;
+    }
+}
+
+static inline void cpu_jit_stub(cpu_jit_ctx_t *t, uint8_t *rel, cpu_jit_stub_kind_t kind,
+                                uint32_t index) {
+    cpu_jit_stub_t *s;
+
+    if (t->nstubs == CPU_JIT_MAX_STUBS) {
+        t->b.overflow = 1;
+        return;
+    }
+    s = &t->stubs[t->nstubs++];
+    s->rel = rel;
+    s->kind = kind;
+    s->index = index;
+    s->cache = t->cache;
+}
+
+// Pending flag update of an ALU op with its result in RAX, like
+// cpu_defer_flags: operand a in host register a, b in host register c or
+// the immediate when c < 0. Logic kinds only need the result.
+static inline void cpu_jit_flags(x64_buf_t *b, const cpu_op_t *op, int a, int c) {
+    uint64_t kind = cpu_flags_kind((instruction_type_t)op->type);
+
+    x64_store_imm(b, X64_RBX, CPU_JIT_CORE(flags_op), (int32_t)kind);
+    x64_store(b, X64_RBX, CPU_JIT_CORE(flags_result), X64_RAX);
+    if (kind == CPU_FLAGS_LOGIC) {
+        return;
+    }
+    x64_store(b, X64_RBX, CPU_JIT_CORE(flags_a), a);
+    if (c >= 0) {
+        x64_store(b, X64_RBX, CPU_JIT_CORE(flags_b), c);
+    } else {
+        x64_store_imm(b, X64_RBX, CPU_JIT_CORE(flags_b), op->imm);
+    }
+}
+
+// Budget and retired count when leaving after op i: the block entry charged
+// the whole block, give back what did not run
+static inline void cpu_jit_refund(x64_buf_t *b, uint32_t count, uint32_t index, int retired) {
+    uint32_t unretired = count - index - (retired ? 1 : 0);
+    uint32_t unrun = count - index - 1;
+
+    if (unretired) x64_alu_ri(b, X64_SUB, X64_R13, unretired);
+    if (unrun) x64_alu_ri(b, X64_ADD, X64_R12, unrun);
+}
+
+static inline void cpu_jit_set_pc(x64_buf_t *b, uint64_t pc) {
+    x64_mov_ri(b, X64_RAX, pc);
+    x64_store(b, X64_RBX, CPU_JIT_REG(pc), X64_RAX);
+}
+
+// Leave for a known PC: jump into its translation if there is one
+static inline void cpu_jit_chain(cpu_jit_ctx_t *t, uint64_t target) {
+    x64_buf_t *b = &t->b;
+    cpu_system_t *cpu = t->cpu;
+
+    cpu_jit_set_pc(b, target);
+    if (!cpu_in_text(cpu, target)) {
+        x64_jmp_to(b, t->exit_continue);
+        return;
+    }
+    x64_mov_ri(b, X64_RAX,
+               (uint64_t)(uintptr_t)&cpu->blocks[(target - cpu->text_base) / CPU_INST_BYTES].code);
+    x64_load(b, X64_RAX, X64_RAX, 0);
+    x64_rr(b, 0x85, X64_RAX, X64_RAX);
+    x64_jcc_to(b, X64_E, t->exit_continue);
+    x64_indirect(b, 4, X64_RAX);
+}
+
+// Leave for the PC in RAX
+static inline void cpu_jit_chain_dynamic(cpu_jit_ctx_t *t) {
+    x64_buf_t *b = &t->b;
+    cpu_system_t *cpu = t->cpu;
+
+    x64_store(b, X64_RBX, CPU_JIT_REG(pc), X64_RAX);
+    x64_mov_ri(b, X64_RDX, cpu->text_base);
+    x64_rr(b, 0x29, X64_RAX, X64_RDX);
+    x64_mov_ri(b, X64_RDX, cpu->text_count * CPU_INST_BYTES);
+    x64_rr(b, 0x39, X64_RAX, X64_RDX);
+    x64_jcc_to(b, X64_AE, t->exit_continue);
+    x64_byte(b, 0xA8);                               // test al, 7
+    x64_byte(b, CPU_INST_BYTES - 1);
+    x64_jcc_to(b, X64_NE, t->exit_continue);
+    x64_imul_rri(b, X64_RAX, X64_RAX, (int32_t)(sizeof(cpu_block_t) / CPU_INST_BYTES));
+    x64_mov_ri(b, X64_RDX, (uint64_t)(uintptr_t)&cpu->blocks[0].code);
+    x64_rex(b, 1, X64_RAX, X64_RAX, X64_RDX);        // mov rax, [rdx + rax]
+    x64_byte(b, 0x8B);
+    x64_modrm_sib(b, X64_RAX, X64_RDX, X64_RAX);
+    x64_rr(b, 0x85, X64_RAX, X64_RAX);
+    x64_jcc_to(b, X64_E, t->exit_continue);
+    x64_indirect(b, 4, X64_RAX);
+}
+
+// Helper call for op i; registers must be written back
+static inline void cpu_jit_call(cpu_jit_ctx_t *t, uint32_t i) {
+    x64_buf_t *b = &t->b;
+
+    x64_mov_rr(b, X64_RDI, X64_RBX);
+    x64_mov_ri(b, X64_RSI, (uint64_t)(uintptr_t)&t->ops[i]);
+    x64_mov_ri(b, X64_RDX, cpu_jit_pc(t, i));
+    x64_mov_ri(b, X64_RAX, (uint64_t)(uintptr_t)&cpu_jit_helper);
+    x64_indirect(b, 2, X64_RAX);
+}
+
+// Dispatcher exit for helper status EAX != 0 at op i
+static inline void cpu_jit_helper_exit(cpu_jit_ctx_t *t, uint32_t i) {
+    x64_buf_t *b = &t->b;
+    uint32_t count = t->block->count;
+    uint8_t *not_fault, *retired;
+
+    x64_byte(b, 0x83);                               // cmp eax, FAULT
+    x64_modrm_reg(b, X64_CMP, X64_RAX);
+    x64_byte(b, (uint8_t)CPU_EXEC_FAULT);
+    not_fault = x64_jcc(b, X64_NE);
+    cpu_jit_refund(b, count, i, 0);
+    cpu_jit_set_pc(b, cpu_jit_pc(t, i));
+    x64_mov_ri(b, X64_RAX, (uint64_t)(int64_t)CPU_EXEC_FAULT);
+    x64_jmp_to(b, t->exit);
+
+    x64_bind(b, not_fault);
+    x64_byte(b, 0x83);                               // cmp eax, RETRY
+    x64_modrm_reg(b, X64_CMP, X64_RAX);
+    x64_byte(b, CPU_EXEC_RETRY);
+    retired = x64_jcc(b, X64_NE);
+    cpu_jit_refund(b, count, i, 0);
+    x64_jmp_to(b, t->exit_continue);
+
+    // JUMP or STOP: retired, the helper set regs.pc
+    x64_bind(b, retired);
+    cpu_jit_refund(b, count, i, 1);
+    x64_jmp_to(b, t->exit_continue);
+}
+
+static inline void cpu_jit_emit_stubs(cpu_jit_ctx_t *t) {
+    x64_buf_t *b = &t->b;
+
+    for (int k = 0; k < t->nstubs; k++) {
+        cpu_jit_stub_t *s = &t->stubs[k];
+        uint8_t *jumped;
+
+        x64_bind(b, s->rel);
+        switch (s->kind) {
+            case CPU_JIT_STUB_FAULT:
+                cpu_jit_writeback(b, &s->cache);
+                cpu_jit_refund(b, t->block->count, s->index, 0);
+                cpu_jit_set_pc(b, cpu_jit_pc(t, s->index));
+                x64_mov_ri(b, X64_RAX, (uint64_t)(int64_t)CPU_EXEC_FAULT);
+                x64_jmp_to(b, t->exit);
+                break;
+            case CPU_JIT_STUB_STORE:
+                cpu_jit_writeback(b, &s->cache);
+                cpu_jit_call(t, s->index);
+                x64_rr(b, 0x85, X64_RAX, X64_RAX);
+                jumped = x64_jcc(b, X64_NE);
+                // Completed without a transfer: resume after it
+                cpu_jit_set_pc(b, cpu_jit_pc(t, s->index) + CPU_INST_BYTES);
+                cpu_jit_refund(b, t->block->count, s->index, 1);
+                x64_jmp_to(b, t->exit_continue);
+                x64_bind(b, jumped);
+                cpu_jit_helper_exit(t, s->index);
+                break;
+            case CPU_JIT_STUB_HELPER:
+                cpu_jit_helper_exit(t, s->index);
+                break;
+        }
+    }
+}
+
+// Instructions with an inline translation
+static inline int cpu_jit_native(instruction_type_t type) {
+    switch (type) {
+        case INST_ADD: case INST_SUB: case INST_MUL: case INST_AND: case INST_OR:
+        case INST_XOR: case INST_SHL: case INST_SHR: case INST_ROT: case INST_CMP:
+        case INST_ADDI: case INST_SUBI: case INST_MULI: case INST_ANDI: case INST_ORI:
+        case INST_XORI: case INST_SHLI: case INST_SHRI: case INST_CMPI: case INST_TESTI:
+        case INST_LOAD: case INST_LOADU: case INST_LOADL:
+        case INST_STORE: case INST_STOREU: case INST_PREFETCH: case INST_FENCE:
+        case INST_BEQ: case INST_BNE: case INST_BLT: case INST_BLE: case INST_BGT:
+        case INST_BGE: case INST_BLTU: case INST_BLEU: case INST_BGTU: case INST_BGEU:
+        case INST_BZ: case INST_BNZ: case INST_BLTZ: case INST_BLEZ: case INST_BGTZ:
+        case INST_BGEZ:
+        case INST_J: case INST_JAL: case INST_JR: case INST_JALR: case INST_RET:
+        case INST_LI: case INST_LUI:
+        case INST_FADD: case INST_FSUB: case INST_FMUL: case INST_FCVT:
+        case INST_VADD: case INST_VSUB: case INST_VAND: case INST_VOR: case INST_VXOR:
+        case INST_NOP:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// Translator of every instruction type, from its handler, so the dispatch
+// does not depend on the order of the ISA description
+enum {
+    CPU_JIT_ALU, CPU_JIT_MEMORY, CPU_JIT_BRANCH, CPU_JIT_UPPER, CPU_JIT_FLOAT, CPU_JIT_VECTOR,
+    CPU_JIT_OTHER
+};
+#define CPU_JIT_CLASS_arithmetic CPU_JIT_ALU
+#define CPU_JIT_CLASS_memory CPU_JIT_MEMORY
+#define CPU_JIT_CLASS_branch CPU_JIT_BRANCH
+#define CPU_JIT_CLASS_upper CPU_JIT_UPPER
+#define CPU_JIT_CLASS_floating_point CPU_JIT_FLOAT
+#define CPU_JIT_CLASS_vector CPU_JIT_VECTOR
+#define CPU_JIT_CLASS_ai_ml CPU_JIT_OTHER
+#define CPU_JIT_CLASS_mimd CPU_JIT_OTHER
+#define CPU_JIT_CLASS_control CPU_JIT_OTHER
+#define CPU_JIT_CLASS_invalid CPU_JIT_OTHER
+#define CPU_JIT_CLASS_OF(name, handler) CPU_JIT_CLASS_##handler,
+static const uint8_t cpu_jit_classes[INST_COUNT] = { CPU_INSTRUCTIONS(CPU_JIT_CLASS_OF) };
+#undef CPU_JIT_CLASS_OF
+
+static inline int cpu_jit_sets_flags(instruction_type_t type) {
+    return (cpu_isa[type].properties & CPU_ISA_SETS_FLAGS) != 0;
+}
+
+// Loads and stores leave the block on a bad address, branches always
+static inline int cpu_jit_may_exit(instruction_type_t type) {
+    return cpu_jit_classes[type] == CPU_JIT_MEMORY || cpu_jit_classes[type] == CPU_JIT_BRANCH;
+}
+
+// Does the instruction read RS2 (register-register ALU ops and compares)?
+static inline int cpu_jit_reads_rs2(instruction_type_t type) {
+    return strstr(cpu_isa[type].syntax, "rs2") != NULL;
+}
+
+// Integer ALU: result in RAX, then flags, then the destination
+static inline void cpu_jit_alu(cpu_jit_ctx_t *t, const cpu_op_t *op, int flags) {
+    x64_buf_t *b = &t->b;
+    instruction_type_t type = (instruction_type_t)op->type;
+    int a, c = -1;
+
+    if (!flags && (type == INST_CMP || type == INST_CMPI || type == INST_TESTI)) {
+        return;  // Only flags, and nobody reads them
+    }
+    if (cpu_jit_reads_rs2(type)) {
+        c = cpu_jit_reg(t, op->rs2, 1);
+    }
+    a = cpu_jit_reg(t, op->rs1, 1);
+    switch (type) {
+        case INST_SHL: case INST_SHR: case INST_ROT:
+            x64_mov_rr(b, X64_RCX, c);
+            x64_mov_rr(b, X64_RAX, a);
+            x64_shift_cl(b, type == INST_SHL ? X64_SHL : type == INST_SHR ? X64_SHR : X64_ROL,
+                         X64_RAX);
+            break;
+        case INST_MUL:
+            x64_mov_rr(b, X64_RAX, a);
+            x64_imul_rr(b, X64_RAX, c);
+            break;
+        case INST_MULI:
+            x64_imul_rri(b, X64_RAX, a, op->imm);
+            break;
+        case INST_SHLI: case INST_SHRI:
+            x64_mov_rr(b, X64_RAX, a);
+            x64_shift_ri(b, type == INST_SHLI ? X64_SHL : X64_SHR, X64_RAX, (unsigned)op->imm);
+            break;
+        default: {
+            int ext;
+            switch (type) {
+                case INST_ADD: case INST_ADDI: ext = X64_ADD; break;
+                case INST_AND: case INST_ANDI: case INST_TESTI: ext = X64_AND; break;
+                case INST_OR: case INST_ORI: ext = X64_OR; break;
+                case INST_XOR: case INST_XORI: ext = X64_XOR; break;
+                default: ext = X64_SUB; break;  // SUB, SUBI, CMP, CMPI
+            }
+            x64_mov_rr(b, X64_RAX, a);
+            if (c >= 0) {
+                x64_rr(b, x64_alu_rr[ext], X64_RAX, c);
+            } else {
+                x64_alu_ri(b, ext, X64_RAX, op->imm);
+            }
+            break;
+        }
+    }
+    if (flags) {
+        cpu_jit_flags(b, op, a, c);
+    }
+    if (type != INST_CMP && type != INST_CMPI && type != INST_TESTI) {
+        cpu_jit_def(t, op->rd);
+    }
+}
+
+// Effective address [rs1 + imm] into RAX, bounds (and alignment) checked
+static inline void cpu_jit_address(cpu_jit_ctx_t *t, const cpu_op_t *op, uint32_t i,
+                                   int aligned) {
+    x64_buf_t *b = &t->b;
+
+    x64_mov_rr(b, X64_RAX, cpu_jit_reg(t, op->rs1, 1));
+    if (op->imm) x64_alu_ri(b, X64_ADD, X64_RAX, op->imm);
+    x64_rr(b, 0x39, X64_RAX, X64_R14);
+    cpu_jit_stub(t, x64_jcc(b, X64_A), CPU_JIT_STUB_FAULT, i);
+    if (aligned) {
+        x64_byte(b, 0xA8);                           // test al, 7
+        x64_byte(b, 7);
+        cpu_jit_stub(t, x64_jcc(b, X64_NE), CPU_JIT_STUB_FAULT, i);
+    }
+}
+
+static inline void cpu_jit_memory(cpu_jit_ctx_t *t, const cpu_op_t *op, uint32_t i) {
+    x64_buf_t *b = &t->b;
+    cpu_system_t *cpu = t->cpu;
+    instruction_type_t type = (instruction_type_t)op->type;
+
+    if (type == INST_LOAD || type == INST_LOADU || type == INST_LOADL) {
+        cpu_jit_address(t, op, i, type != INST_LOADU);
+        x64_rex(b, 1, X64_RAX, X64_RAX, X64_RBP);    // mov rax, [rbp + rax]
+        x64_byte(b, 0x8B);
+        x64_modrm_sib(b, X64_RAX, X64_RBP, X64_RAX);
+        cpu_jit_def(t, op->rd);
+    } else if (type == INST_STORE || type == INST_STOREU) {
+        uint64_t text_end = cpu->text_base + cpu->text_count * CPU_INST_BYTES;
+        uint64_t low = cpu->text_base >= 7 ? cpu->text_base - 7 : 0;
+        int value = cpu_jit_reg(t, op->rs2, 1);
+
+        cpu_jit_address(t, op, i, type == INST_STORE);
+        // Does [addr, addr + 8) overlap the text?
+        x64_mov_rr(b, X64_RDX, X64_RAX);
+        x64_alu_ri(b, X64_SUB, X64_RDX, (int64_t)low);
+        x64_alu_ri(b, X64_CMP, X64_RDX, (int64_t)(text_end - low));
+        cpu_jit_stub(t, x64_jcc(b, X64_B), CPU_JIT_STUB_STORE, i);
+        x64_rex(b, 1, value, X64_RAX, X64_RBP);      // mov [rbp + rax], value
+        x64_byte(b, 0x89);
+        x64_modrm_sib(b, value, X64_RBP, X64_RAX);
+    }
+    // PREFETCH and FENCE: nothing to do
+}
+
+static inline void cpu_jit_branch(cpu_jit_ctx_t *t, const cpu_op_t *op, uint32_t i) {
+    x64_buf_t *b = &t->b;
+    instruction_type_t type = (instruction_type_t)op->type;
+    uint64_t pc = cpu_jit_pc(t, i);
+    uint64_t target = pc + (uint64_t)(int64_t)op->imm;
+    uint8_t *taken;
+    int cc, a, c = -1;
+
+    switch (type) {
+        case INST_J:
+            cpu_jit_writeback(b, &t->cache);
+            cpu_jit_chain(t, target);
+            return;
+        case INST_JAL:
+            cpu_jit_writeback(b, &t->cache);
+            x64_mov_ri(b, X64_RAX, pc + CPU_INST_BYTES);
+            x64_store(b, X64_RBX, CPU_JIT_REG(lr), X64_RAX);
+            cpu_jit_chain(t, target);
+            return;
+        case INST_JR:
+        case INST_JALR:
+            a = cpu_jit_reg(t, op->rs1, 1);
+            cpu_jit_writeback(b, &t->cache);
+            if (type == INST_JALR) {
+                x64_mov_ri(b, X64_RDX, pc + CPU_INST_BYTES);
+                x64_store(b, X64_RBX, CPU_JIT_REG(lr), X64_RDX);
+            }
+            x64_mov_rr(b, X64_RAX, a);
+            cpu_jit_chain_dynamic(t);
+            return;
+        case INST_RET:
+            cpu_jit_writeback(b, &t->cache);
+            x64_load(b, X64_RAX, X64_RBX, CPU_JIT_REG(lr));
+            cpu_jit_chain_dynamic(t);
+            return;
+        default:
+            break;
+    }
+
+    a = cpu_jit_reg(t, op->rs1, 1);
+    if (cpu_jit_reads_rs2(type)) {
+        c = cpu_jit_reg(t, op->rs2, 1);
+    }
+    cpu_jit_writeback(b, &t->cache);
+    if (c >= 0) {
+        x64_rr(b, 0x39, a, c);
+    } else {
+        x64_rr(b, 0x85, a, a);
+    }
+    switch (type) {
+        case INST_BEQ: case INST_BZ: cc = X64_E; break;
+        case INST_BNE: case INST_BNZ: cc = X64_NE; break;
+        case INST_BLT: case INST_BLTZ: cc = X64_L; break;
+        case INST_BLE: case INST_BLEZ: cc = X64_LE; break;
+        case INST_BGT: case INST_BGTZ: cc = X64_G; break;
+        case INST_BGE: case INST_BGEZ: cc = X64_GE; break;
+        case INST_BLTU: cc = X64_B; break;
+        case INST_BLEU: cc = X64_BE; break;
+        case INST_BGTU: cc = X64_A; break;
+        default: cc = X64_AE; break;  // BGEU
+    }
+    taken = x64_jcc(b, cc);
+    cpu_jit_chain(t, pc + CPU_INST_BYTES);
+    x64_bind(b, taken);
+    cpu_jit_chain(t, target);
+}
+
+static inline void cpu_jit_float(cpu_jit_ctx_t *t, const cpu_op_t *op) {
+    x64_buf_t *b = &t->b;
+    int a;
+
+    switch ((instruction_type_t)op->type) {
+        case INST_FCVT:
+            if (op->imm) {                           // cvttss2si rax, Fs1
+                x64_byte(b, 0xF3);
+                x64_rex(b, 1, X64_RAX, 0, X64_RBX);
+                x64_byte(b, 0x0F);
+                x64_byte(b, 0x2C);
+                x64_modrm_mem(b, X64_RAX, X64_RBX, CPU_JIT_FPR(op->rs1));
+                cpu_jit_def(t, op->rd);
+                return;
+            }
+            a = cpu_jit_reg(t, op->rs1, 1);
+            x64_byte(b, 0xF3);                       // cvtsi2ss xmm0, Rs1
+            x64_rex(b, 1, 0, 0, a);
+            x64_byte(b, 0x0F);
+            x64_byte(b, 0x2A);
+            x64_modrm_reg(b, 0, a);
+            break;
+        default: {
+            unsigned opcode = op->type == INST_FADD ? 0x58 : op->type == INST_FSUB ? 0x5C : 0x59;
+            x64_sse_mem(b, 0xF3, 0x10, 0, X64_RBX, CPU_JIT_FPR(op->rs1));    // movss
+            x64_sse_mem(b, 0xF3, 0x10, 1, X64_RBX, CPU_JIT_FPR(op->rs2));
+            x64_sse_rr(b, 0xF3, opcode, 0, 1);
+            break;
+        }
+    }
+    x64_sse_mem(b, 0xF3, 0x11, 0, X64_RBX, CPU_JIT_FPR(op->rd));
+}
+
+// Byte lanes 16 at a time; each chunk is read before it is written, so Vd
+// may alias a source
+static inline void cpu_jit_vector(cpu_jit_ctx_t *t, const cpu_op_t *op) {
+    x64_buf_t *b = &t->b;
+    unsigned opcode;
+
+    switch ((instruction_type_t)op->type) {
+        case INST_VADD: opcode = 0xFC; break;        // paddb
+        case INST_VSUB: opcode = 0xF8; break;        // psubb
+        case INST_VAND: opcode = 0xDB; break;        // pand
+        case INST_VOR:  opcode = 0xEB; break;        // por
+        default:        opcode = 0xEF; break;        // pxor
+    }
+    for (int k = 0; k < 4; k++) {
+        x64_sse_mem(b, 0xF3, 0x6F, 0, X64_RBX, CPU_JIT_VR(op->rs1) + 16 * k);  // movdqu
+        x64_sse_mem(b, 0xF3, 0x6F, 1, X64_RBX, CPU_JIT_VR(op->rs2) + 16 * k);
+        x64_sse_rr(b, 0x66, opcode, 0, 1);
+        x64_sse_mem(b, 0xF3, 0x7F, 0, X64_RBX, CPU_JIT_VR(op->rd) + 16 * k);
+    }
+}
+
+// Shared entry and exit at the start of the code buffer:
+//   int enter(cpu_core_t *core, void *code, cpu_jit_frame_t *frame)
+static inline size_t cpu_jit_emit_prologue(cpu_jit_t *jit) {
+    x64_buf_t b = { jit->code, jit->code + jit->size, 0 };
+    static const uint8_t saved[6] = { X64_RBX, X64_RBP, X64_R12, X64_R13, X64_R14, X64_R15 };
+
+    for (int i = 0; i < 6; i++) x64_push(&b, saved[i]);
+    x64_push(&b, X64_RDX);                           // Frame; keeps RSP 16-byte aligned
+    x64_mov_rr(&b, X64_RBX, X64_RDI);
+    x64_load(&b, X64_RBP, X64_RBX, (int32_t)offsetof(cpu_core_t, memory));
+    x64_load(&b, X64_R14, X64_RBX, (int32_t)offsetof(cpu_core_t, memory_size));
+    x64_alu_ri(&b, X64_SUB, X64_R14, sizeof(uint64_t));
+    x64_load(&b, X64_R12, X64_RDX, (int32_t)offsetof(cpu_jit_frame_t, budget));
+    x64_rr(&b, 0x31, X64_R13, X64_R13);
+    x64_indirect(&b, 4, X64_RSI);
+
+    jit->exit_continue = b.p;
+    x64_rr(&b, 0x31, X64_RAX, X64_RAX);
+    jit->exit = b.p;
+    x64_pop(&b, X64_RCX);
+    x64_store(&b, X64_RCX, (int32_t)offsetof(cpu_jit_frame_t, budget), X64_R12);
+    x64_store(&b, X64_RCX, (int32_t)offsetof(cpu_jit_frame_t, executed), X64_R13);
+    for (int i = 5; i >= 0; i--) x64_pop(&b, saved[i]);
+    x64_byte(&b, 0xC3);                              // ret
+    return (size_t)(b.p - jit->code);
+}
+
+// Translates block into the code buffer and publishes it in block->code.
+// Returns -1 when the host has no JIT or the buffer is full (a flush is
+// then pending).
+static inline int cpu_jit_translate(cpu_system_t *cpu, cpu_block_t *block) {
+    cpu_jit_t *jit = &cpu->jit;
+    cpu_jit_ctx_t *t;
+    uint8_t flags_live[CPU_MAX_BLOCK];
+    uint8_t *entry;
+    int live = 1;
+
+    if (jit->disabled) {
+        return -1;
+    }
+    if (!jit->code) {
+        void *code = mmap(NULL, CPU_JIT_CODE_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (code == MAP_FAILED) {
+            jit->disabled = 1;
+            return -1;
+        }
+        jit->code = code;
+        jit->size = CPU_JIT_CODE_SIZE;
+        jit->prologue = cpu_jit_emit_prologue(jit);
+        jit->used = jit->prologue;
+    }
+    t = malloc(sizeof(*t));
+    if (!t) {
+        return -1;
+    }
+
+    // Backwards: does anything observe the flags op i writes?
+    for (uint32_t i = block->count; i-- > 0;) {
+        const cpu_op_t *op = &cpu->decoded[block->index + i];
+        instruction_type_t type = (instruction_type_t)op->type;
+
+        flags_live[i] = 0;
+        if (!cpu_jit_native(type)) {
+            live = 1;
+        } else if (cpu_jit_sets_flags(type)) {
+            flags_live[i] = (uint8_t)live;
+            live = 0;
+        } else if (cpu_jit_may_exit(type)) {
+            live = 1;
+        }
+    }
+
+    t->b.p = jit->code + jit->used;
+    t->b.end = jit->code + jit->size;
+    t->b.overflow = 0;
+    t->cpu = cpu;
+    t->block = block;
+    t->ops = cpu->decoded + block->index;
+    t->nstubs = 0;
+    t->exit = jit->exit;
+    t->exit_continue = jit->exit_continue;
+    memset(&t->cache, 0, sizeof(t->cache));
+    cpu_jit_forget(&t->cache);
+
+    // Entry: charge the whole block against the budget
+    entry = t->b.p;
+    x64_alu_ri(&t->b, X64_CMP, X64_R12, block->count);
+    x64_jcc_to(&t->b, X64_B, t->exit_continue);
+    x64_alu_ri(&t->b, X64_SUB, X64_R12, block->count);
+    x64_alu_ri(&t->b, X64_ADD, X64_R13, block->count);
+
+    for (uint32_t i = 0; i < block->count && !t->b.overflow; i++) {
+        const cpu_op_t *op = &t->ops[i];
+        instruction_type_t type = (instruction_type_t)op->type;
+
+        if (!cpu_jit_native(type)) {
+            cpu_jit_writeback(&t->b, &t->cache);
+            cpu_jit_call(t, i);
+            cpu_jit_forget(&t->cache);
+            x64_rr(&t->b, 0x85, X64_RAX, X64_RAX);
+            cpu_jit_stub(t, x64_jcc(&t->b, X64_NE), CPU_JIT_STUB_HELPER, i);
+        } else if (cpu_jit_classes[type] == CPU_JIT_ALU) {
+            cpu_jit_alu(t, op, flags_live[i]);
+        } else if (cpu_jit_classes[type] == CPU_JIT_MEMORY) {
+            cpu_jit_memory(t, op, i);
+        } else if (cpu_jit_classes[type] == CPU_JIT_BRANCH) {
+            cpu_jit_branch(t, op, i);
+        } else if (type == INST_LI) {
+            x64_mov_ri(&t->b, X64_RAX, (uint64_t)(int64_t)op->imm);
+            cpu_jit_def(t, op->rd);
+        } else if (type == INST_LUI) {
+            int d = cpu_jit_reg(t, op->rd, 1);
+            x64_rex(&t->b, 0, d, 0, X64_RAX);        // mov eax, d32
+            x64_byte(&t->b, 0x89);
+            x64_modrm_reg(&t->b, d, X64_RAX);
+            x64_mov_ri(&t->b, X64_RCX, (uint64_t)(uint32_t)op->imm << 32);
+            x64_rr(&t->b, 0x09, X64_RAX, X64_RCX);
+            cpu_jit_def(t, op->rd);
+        } else if (cpu_jit_classes[type] == CPU_JIT_FLOAT) {
+            cpu_jit_float(t, op);
+        } else if (cpu_jit_classes[type] == CPU_JIT_VECTOR) {
+            cpu_jit_vector(t, op);
+        }
+    }
+    // Anything but a branch at the end falls through to the next block
+    if (cpu_jit_classes[t->ops[block->count - 1].type] != CPU_JIT_BRANCH) {
+        cpu_jit_writeback(&t->b, &t->cache);
+        cpu_jit_chain(t, block->pc + (uint64_t)block->count * CPU_INST_BYTES);
+    }
+    cpu_jit_emit_stubs(t);
+
+    if (t->b.overflow) {
+        free(t);
+        jit->flush = 1;
+        return -1;
+    }
+    jit->used = (size_t)(t->b.p - jit->code);
+    jit->used = (jit->used + 15) & ~(size_t)15;
+    jit->translations++;
+    block->code = entry;
+    free(t);
+    return 0;
+}
+
+static inline void cpu_jit_release(cpu_system_t *cpu) {
+    if (cpu->jit.code) {
+        munmap(cpu->jit.code, cpu->jit.size);
+        cpu->jit.code = NULL;
+    }
+}
+
+#else
+
+static inline int cpu_jit_translate(cpu_system_t *cpu, cpu_block_t *block) {
+    (void)block;
+    cpu->jit.disabled = 1;
+    return -1;
+}
+
+static inline void cpu_jit_release(cpu_system_t *cpu) {
+    (void)cpu;
+}
+
+#endif // CPU_HAVE_JIT
+
+#endif // ALPHAAHB_CPU_JIT_H
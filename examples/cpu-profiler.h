@@ -0,0 +1,333 @@
+/*
+ * AlphaAHB V5 Guest Sampling Profiler
+ *
+ * Statistical profile of where guest programs spend their time. Every
+ * `period` instructions a core retires (one cycle each in this functional
+ * model), cpu_run stops that core at a quantum boundary and the profiler
+ * records its call stack, weighted by the instructions since its previous
+ * sample. The engines are not instrumented: without a profiler attached
+ * cpu_run costs one pointer test per quantum and nothing per instruction.
+ *
+ * Stacks are unwound through frame records, AArch64 style: a function that
+ * calls others stores { caller's FP, LR } at the new frame and points FP at
+ * it, so [FP] links to the caller's record and [FP + 8] returns into the
+ * caller. The unwinder starts at the PC, takes LR as the caller of a leaf
+ * (LR outside the PC's function and not the current record's return
+ * address), then walks the records while they move up the stack. A
+ * recursive leaf loses one frame, as with any frame pointer unwinder.
+ *
+ * Reports are symbolized against an ELF image (cpu-elf.h), by function:
+ *
+ * - cpu_prof_write_folded: "main;f;g 1234" lines, root first, for
+ *   flamegraph.pl and compatible viewers
+ * - cpu_prof_write_table: self and total instructions per function,
+ *   hottest first
+ *
+ * Addresses outside every symbol are reported as hex.
+ *
+ * Functions that can fail return 0 on success and -1 on error.
+ */
+
+#ifndef ALPHAAHB_CPU_PROFILER_H
+#define ALPHAAHB_CPU_PROFILER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "cpu-simulator.h"
+#include "cpu-elf.h"
+
+#define CPU_PROF_MAX_DEPTH 64
+
+typedef struct {
+    uint64_t weight;         // Instructions the core retired since its last sample
+    size_t first;            // Frames in cpu_prof_t.frames, leaf first
+    uint32_t depth;
+    uint32_t core;
+} cpu_prof_sample_t;
+
+typedef struct {
+    cpu_sampler_t sampler;   // First, so cpu_run's callback finds the profiler
+    const cpu_elf_image_t *image;  // Symbols, or NULL
+    uint64_t last[MAX_CORES];
+    uint64_t *frames;        // Sampled PCs and call sites
+    size_t frame_count, frame_capacity;
+    cpu_prof_sample_t *samples;
+    size_t count, capacity;
+    uint64_t total;          // Sum of the sample weights
+    int failed;              // Out of memory: later samples were dropped
+} cpu_prof_t;
+
+static inline int cpu_prof_load(const cpu_core_t *core, uint64_t addr, uint64_t *value) {
+    if (addr & 7 || addr > core->memory_size - sizeof(uint64_t)) {
+        return -1;
+    }
+    memcpy(value, core->memory + addr, sizeof(uint64_t));
+    return 0;
+}
+
+static inline int cpu_prof_same_function(const cpu_elf_image_t *image, uint64_t a, uint64_t b) {
+    const cpu_elf_symbol_t *s = image ? cpu_elf_symbolize(image, a) : NULL;
+    return s && s == cpu_elf_symbolize(image, b);
+}
+
+// Call stack of core, leaf first: the PC, then call sites (return address
+// minus one instruction). Returns the depth.
+static inline uint32_t cpu_prof_unwind(const cpu_core_t *core, const cpu_elf_image_t *image,
+                                       uint64_t *frames) {
+    uint64_t pc = core->regs.pc, lr = core->regs.lr, fp = core->regs.fp;
+    uint64_t link = 0, next;
+    uint32_t depth = 0;
+
+    frames[depth++] = pc;
+    cpu_prof_load(core, fp + 8, &link);
+    if (lr >= CPU_INST_BYTES && lr != link && !cpu_prof_same_function(image, lr, pc)) {
+        frames[depth++] = lr - CPU_INST_BYTES;
+    }
+    // Records sit at increasing addresses towards the root
+    while (depth < CPU_PROF_MAX_DEPTH && cpu_prof_load(core, fp + 8, &link) == 0 &&
+           link >= CPU_INST_BYTES && cpu_prof_load(core, fp, &next) == 0) {
+        frames[depth++] = link - CPU_INST_BYTES;
+        if (next <= fp) {
+            break;
+        }
+        fp = next;
+    }
+    return depth;
+}
+
+static inline void cpu_prof_sample(cpu_sampler_t *sampler, cpu_core_t *core) {
+    cpu_prof_t *p = (cpu_prof_t *)sampler;
+    uint64_t weight = core->retired - p->last[core->core_id];
+
+    p->last[core->core_id] = core->retired;
+    if (p->failed || weight == 0) {
+        return;
+    }
+    if (p->frame_count + CPU_PROF_MAX_DEPTH > p->frame_capacity) {
+        size_t capacity = p->frame_capacity ? 2 * p->frame_capacity : 4096;
+        uint64_t *frames = realloc(p->frames, capacity * sizeof(uint64_t));
+        if (!frames) {
+            p->failed = 1;
+            return;
+        }
+        p->frames = frames;
+        p->frame_capacity = capacity;
+    }
+    if (p->count == p->capacity) {
+        size_t capacity = p->capacity ? 2 * p->capacity : 1024;
+        cpu_prof_sample_t *samples = realloc(p->samples, capacity * sizeof(cpu_prof_sample_t));
+        if (!samples) {
+            p->failed = 1;
+            return;
+        }
+        p->samples = samples;
+        p->capacity = capacity;
+    }
+    cpu_prof_sample_t *s = &p->samples[p->count++];
+    s->weight = weight;
+    s->first = p->frame_count;
+    s->core = (uint32_t)core->core_id;
+    s->depth = cpu_prof_unwind(core, p->image, p->frames + p->frame_count);
+    p->frame_count += s->depth;
+    p->total += weight;
+}
+
+// Empty profile sampling every period instructions per core; image may be
+// NULL
+static inline int cpu_prof_init(cpu_prof_t *p, uint64_t period, const cpu_elf_image_t *image) {
+    memset(p, 0, sizeof(*p));
+    if (period == 0) {
+        return -1;
+    }
+    p->sampler.period = period;
+    p->sampler.sample = cpu_prof_sample;
+    p->image = image;
+    return 0;
+}
+
+static inline void cpu_prof_free(cpu_prof_t *p) {
+    free(p->frames);
+    free(p->samples);
+    memset(p, 0, sizeof(*p));
+}
+
+// Runs like cpu_run with p sampling (accumulating across calls)
+static inline int cpu_prof_run(cpu_system_t *cpu, cpu_mode_t mode, uint64_t max_instructions,
+                               cpu_prof_t *p) {
+    int r;
+
+    for (int i = 0; i < cpu->num_cores; i++) {
+        p->last[i] = cpu->cores[i].retired;
+        p->sampler.next[i] = cpu->cores[i].retired + p->sampler.period;
+    }
+    cpu->sampler = &p->sampler;
+    r = cpu_run(cpu, mode, max_instructions);
+    cpu->sampler = NULL;
+    return r;
+}
+
+// Function key of an address: symbol index with the top bit set, else the
+// address itself
+static inline uint64_t cpu_prof_key(const cpu_prof_t *p, uint64_t address) {
+    const cpu_elf_symbol_t *s = p->image ? cpu_elf_symbolize(p->image, address) : NULL;
+    return s ? (UINT64_C(1) << 63) | (uint64_t)(s - p->image->symbols) : address;
+}
+
+static inline void cpu_prof_print_key(const cpu_prof_t *p, uint64_t key, FILE *out) {
+    if (key >> 63) {
+        fputs(p->image->symbols[key & ~(UINT64_C(1) << 63)].name, out);
+    } else {
+        fprintf(out, "0x%llx", (unsigned long long)key);
+    }
+}
+
+// Folded stacks: samples are keyed by function, root first, then sorted so
+// equal stacks are adjacent
+typedef struct {
+    const uint64_t *keys;
+    uint32_t depth;
+    uint64_t weight;
+} cpu_prof_stack_t;
+
+static inline int cpu_prof_stack_compare(const void *a, const void *b) {
+    const cpu_prof_stack_t *x = (const cpu_prof_stack_t *)a;
+    const cpu_prof_stack_t *y = (const cpu_prof_stack_t *)b;
+
+    for (uint32_t i = 0; i < x->depth && i < y->depth; i++) {
+        if (x->keys[i] != y->keys[i]) {
+            return x->keys[i] < y->keys[i] ? -1 : 1;
+        }
+    }
+    return (x->depth > y->depth) - (x->depth < y->depth);
+}
+
+static inline int cpu_prof_write_folded(const cpu_prof_t *p, FILE *out) {
+    uint64_t *keys = malloc((p->frame_count + 1) * sizeof(uint64_t));
+    cpu_prof_stack_t *stacks = malloc((p->count + 1) * sizeof(cpu_prof_stack_t));
+
+    if (!keys || !stacks) {
+        free(keys);
+        free(stacks);
+        return -1;
+    }
+    for (size_t i = 0; i < p->count; i++) {
+        const cpu_prof_sample_t *s = &p->samples[i];
+        for (uint32_t d = 0; d < s->depth; d++) {
+            keys[s->first + d] = cpu_prof_key(p, p->frames[s->first + s->depth - 1 - d]);
+        }
+        stacks[i].keys = keys + s->first;
+        stacks[i].depth = s->depth;
+        stacks[i].weight = s->weight;
+    }
+    qsort(stacks, p->count, sizeof(cpu_prof_stack_t), cpu_prof_stack_compare);
+    for (size_t i = 0; i < p->count;) {
+        uint64_t weight = 0;
+        size_t j = i;
+        while (j < p->count && cpu_prof_stack_compare(&stacks[i], &stacks[j]) == 0) {
+            weight += stacks[j++].weight;
+        }
+        for (uint32_t d = 0; d < stacks[i].depth; d++) {
+            if (d) fputc(';', out);
+            cpu_prof_print_key(p, stacks[i].keys[d], out);
+        }
+        fprintf(out, " %llu\n", (unsigned long long)weight);
+        i = j;
+    }
+    free(keys);
+    free(stacks);
+    return ferror(out) ? -1 : 0;
+}
+
+// Self and total weight of one function
+typedef struct {
+    uint64_t key;
+    uint64_t self;
+    uint64_t total;
+} cpu_prof_function_t;
+
+static inline int cpu_prof_key_compare(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static inline int cpu_prof_function_compare(const void *a, const void *b) {
+    const cpu_prof_function_t *x = (const cpu_prof_function_t *)a;
+    const cpu_prof_function_t *y = (const cpu_prof_function_t *)b;
+    if (x->self != y->self) {
+        return x->self < y->self ? 1 : -1;
+    }
+    return x->total < y->total ? 1 : x->total > y->total ? -1 : 0;
+}
+
+// Per-function weights, hottest first; *count receives how many. NULL on
+// allocation failure.
+static inline cpu_prof_function_t *cpu_prof_functions(const cpu_prof_t *p, size_t *count) {
+    uint64_t *keys = malloc((p->frame_count + 1) * sizeof(uint64_t));
+    cpu_prof_function_t *f = NULL;
+    size_t n = 0;
+
+    if (!keys) {
+        return NULL;
+    }
+    for (size_t i = 0; i < p->frame_count; i++) {
+        keys[i] = cpu_prof_key(p, p->frames[i]);
+    }
+    qsort(keys, p->frame_count, sizeof(uint64_t), cpu_prof_key_compare);
+    for (size_t i = 0; i < p->frame_count; i++) {
+        if (n == 0 || keys[i] != keys[n - 1]) keys[n++] = keys[i];
+    }
+    f = calloc(n + 1, sizeof(cpu_prof_function_t));
+    if (!f) {
+        free(keys);
+        return NULL;
+    }
+    for (size_t i = 0; i < n; i++) {
+        f[i].key = keys[i];
+    }
+    for (size_t i = 0; i < p->count; i++) {
+        const cpu_prof_sample_t *s = &p->samples[i];
+        for (uint32_t d = 0; d < s->depth; d++) {
+            uint64_t key = cpu_prof_key(p, p->frames[s->first + d]);
+            const uint64_t *k = bsearch(&key, keys, n, sizeof(uint64_t), cpu_prof_key_compare);
+            cpu_prof_function_t *fn = &f[k - keys];
+            int seen = 0;
+            // Recursion counts once towards the total
+            for (uint32_t e = 0; e < d && !seen; e++) {
+                seen = cpu_prof_key(p, p->frames[s->first + e]) == key;
+            }
+            if (d == 0) fn->self += s->weight;
+            if (!seen) fn->total += s->weight;
+        }
+    }
+    free(keys);
+    qsort(f, n, sizeof(cpu_prof_function_t), cpu_prof_function_compare);
+    *count = n;
+    return f;
+}
+
+static inline int cpu_prof_write_table(const cpu_prof_t *p, FILE *out) {
+    size_t n;
+    cpu_prof_function_t *f = cpu_prof_functions(p, &n);
+    double total = p->total ? (double)p->total : 1.0;
+
+    if (!f) {
+        return -1;
+    }
+    fprintf(out, "%14s %7s %14s %7s  %s\n", "Self", "Self%", "Total", "Total%", "Function");
+    for (size_t i = 0; i < n; i++) {
+        fprintf(out, "%14llu %6.2f%% %14llu %6.2f%%  ", (unsigned long long)f[i].self,
+                100.0 * f[i].self / total, (unsigned long long)f[i].total,
+                100.0 * f[i].total / total);
+        cpu_prof_print_key(p, f[i].key, out);
+        fputc('\n', out);
+    }
+    fprintf(out, "%llu instructions in %zu samples%s\n", (unsigned long long)p->total, p->count,
+            p->failed ? " (out of memory, later samples dropped)" : "");
+    free(f);
+    return ferror(out) ? -1 : 0;
+}
+
+#endif // ALPHAAHB_CPU_PROFILER_H
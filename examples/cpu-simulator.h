@@ -0,0 +1,1798 @@
+/*
+ * AlphaAHB V5 CPU Simulator Core
+ *
+ * Functional model of AlphaAHB V5 cores running guest code from a flat
+ * memory image, shared by the cpu-implementation example, the simulator
+ * benchmarks and the tests. Instructions are fetched as 64-bit words from
+ * cpu_system_t.memory in the layout of instruction-encodings.md section 1.3:
+ *
+ *   63-60 OPCODE | 59-56 FUNCT | 55-52 RS2 | 51-48 RS1 | 47-32 IMM | 31-0 EXTENDED
+ *
+ * The spec leaves a few operand placements open; this model uses:
+ *
+ * - destination register in EXTENDED[3:0] (R/I/F/V/M/C-type); U-type
+ *   instructions have no sources and name their destination in RS1
+ * - IMM sign-extended: ALU immediates, load/store/atomic offsets, and
+ *   branch offsets in bytes relative to the branch
+ * - J-type: J 0x0, JAL 0x1, JR 0x2, JALR 0x3, RET 0x4 with the offset in
+ *   EXTENDED; JAL/JALR link through the LR special register, RET jumps to it
+ * - U-type: LI 0x0 (sign-extended EXTENDED), LUI 0x1 (EXTENDED into the
+ *   upper 32 bits)
+ * - C-type: NOP 0x0, HALT 0x1, MFSR 0x2 and MTSR 0x3 with the special
+ *   register number (section 3.4) in IMM
+ * - stores write RS2 to [RS1 + IMM]; memory is accessed in host byte order
+ * - R0 reads as zero: writes to it land in the unaddressable
+ *   gpr[CPU_DISCARD_REG]
+ * - integer ALU instructions set Z, S, C (carry out, or borrow for
+ *   SUB/CMP) and V (signed overflow); logic, shift, divide and bit-count
+ *   results clear C and V. Flags are evaluated lazily (cpu_flags) and are
+ *   current in regs.flags whenever no engine is running.
+ *
+ * Opcodes, function codes, handlers and per-instruction properties come
+ * from the machine-readable ISA description (specs/instruction-set.json)
+ * through the generated cpu-isa.h: decoding is one table lookup, and each
+ * instruction type dispatches straight to cpu_execute_<handler>.
+ *
+ * Cores share memory and are interleaved round-robin on the calling thread
+ * (CPU_QUANTUM instructions at a time), so BARRIER, LOCK and ATOMIC have
+ * exact, deterministic semantics. Three execution engines run the same
+ * instruction semantics (cpu_execute_op):
+ *
+ * - switch: fetch, unpack and decode every instruction, then dispatch on
+ *   the type; the reference the others are checked against
+ * - threaded: instructions predecoded once at load, dispatched with one
+ *   computed goto per handler (GCC/clang; a switch loop elsewhere)
+ * - block: predecoded basic blocks cached by PC and chained to their
+ *   successors, so budget checks and PC updates happen once per block
+ * - jit: the block engine, with blocks entered CPU_JIT_THRESHOLD times
+ *   translated to host machine code (cpu-jit.h, x86-64 only; other hosts
+ *   stay in the block interpreter)
+ *
+ * The predecoded engines hand anything unusual (code outside the loaded
+ * text, invalid encodings, faults) to the reference interpreter. Stores into
+ * the text re-predecode the touched instructions and drop the block cache
+ * and every translation.
+ *
+ * Functions that can fail return 0 on success and -1 on error.
+ */
+
+#ifndef ALPHAAHB_CPU_SIMULATOR_H
+#define ALPHAAHB_CPU_SIMULATOR_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+// CPU Configuration
+#define MAX_CORES 16
+#define MAX_THREADS_PER_CORE 4
+#define INSTRUCTION_CACHE_SIZE 256 * 1024  // 256KB
+#define DATA_CACHE_SIZE 256 * 1024         // 256KB
+#define L2_CACHE_SIZE 16 * 1024 * 1024     // 16MB
+#define L3_CACHE_SIZE 512 * 1024 * 1024    // 512MB
+
+#define CPU_INST_BYTES 8
+#define CPU_RESET_PC 0x1000
+#define CPU_RESET_SP 0x8000
+
+// Target of GPR writes to R0; no 4-bit register field can name it
+#define CPU_DISCARD_REG 63
+
+// Instructions a core runs before the scheduler moves to the next one
+#define CPU_QUANTUM 4096
+
+// Longest predecoded basic block
+#define CPU_MAX_BLOCK 64
+
+// Block entries before CPU_MODE_JIT translates a block, and the size of the
+// translated code buffer
+#define CPU_JIT_THRESHOLD 16
+#define CPU_JIT_CODE_SIZE (4 << 20)
+
+// Status flags
+#define CPU_FLAG_Z 0x01
+#define CPU_FLAG_S 0x02
+#define CPU_FLAG_C 0x04      // Unsigned carry out (borrow for SUB/CMP)
+#define CPU_FLAG_V 0x08      // Signed overflow
+#define CPU_FLAGS_ALU (CPU_FLAG_Z | CPU_FLAG_S | CPU_FLAG_C | CPU_FLAG_V)
+
+// Kinds of pending ALU flag updates (cpu_core_t.flags_op)
+enum {
+    CPU_FLAGS_NONE,          // regs.flags is current
+    CPU_FLAGS_LOGIC,         // Z/S of the result, C and V clear
+    CPU_FLAGS_ADD,
+    CPU_FLAGS_SUB,
+    CPU_FLAGS_MUL
+};
+
+#if defined(__GNUC__)
+#define CPU_INLINE static inline __attribute__((always_inline))
+#define CPU_HAVE_COMPUTED_GOTO 1
+#else
+#define CPU_INLINE static inline
+#define CPU_HAVE_COMPUTED_GOTO 0
+#endif
+
+// Every core starts on its own cache line when the system can be allocated
+// aligned (posix_memalign: _POSIX_C_SOURCE or _DEFAULT_SOURCE)
+#define CPU_CACHE_LINE 64
+#if defined(__GNUC__) && defined(_POSIX_C_SOURCE) && _POSIX_C_SOURCE >= 200112L
+#define CPU_ALIGNED __attribute__((aligned(CPU_CACHE_LINE)))
+#define CPU_HAVE_ALIGNED_ALLOC 1
+#else
+#define CPU_ALIGNED
+#define CPU_HAVE_ALIGNED_ALLOC 0
+#endif
+
+// Primary opcodes (instruction-encodings.md section 2.1)
+enum {
+    CPU_OPC_R = 0x0, CPU_OPC_I = 0x1, CPU_OPC_S = 0x2, CPU_OPC_B = 0x3,
+    CPU_OPC_U = 0x4, CPU_OPC_J = 0x5, CPU_OPC_V = 0x6, CPU_OPC_M = 0x7,
+    CPU_OPC_F = 0x8, CPU_OPC_A = 0x9, CPU_OPC_P = 0xA, CPU_OPC_C = 0xB
+};
+
+// Special purpose registers (section 3.4)
+enum {
+    CPU_SR_PC, CPU_SR_SP, CPU_SR_FP, CPU_SR_LR, CPU_SR_FLAGS,
+    CPU_SR_CORE_ID, CPU_SR_THREAD_ID
+};
+
+// Instruction Format (64-bit)
+typedef struct {
+    uint8_t opcode : 4;      // Bits 63-60
+    uint8_t funct : 4;       // Bits 59-56
+    uint8_t rs2 : 4;         // Bits 55-52
+    uint8_t rs1 : 4;         // Bits 51-48
+    uint16_t imm : 16;       // Bits 47-32
+    uint32_t extended : 32;  // Bits 31-0
+} instruction_t;
+
+// Instruction Decoder: CPU_INSTRUCTIONS, instruction_type_t and the decode
+// tables are generated from specs/instruction-set.json
+#include "cpu-isa.h"
+
+#define CPU_NAME(name, handler) #name,
+static const char *const cpu_instruction_names[INST_COUNT] = {
+    CPU_INSTRUCTIONS(CPU_NAME)
+};
+#undef CPU_NAME
+
+// Superinstructions of the block engine: adjacent instructions run by one
+// handler with no dispatch in between. Picked from cpu_profile_sequences
+// over the guest kernels (loop counters closing with a branch, address
+// arithmetic feeding loads, loads feeding adds). Triples are tried before
+// pairs; only the last instruction may end a block.
+#define CPU_FUSED_TRIPLES(X) \
+    X(ADDI, SUBI, BNZ) \
+    X(ADD, SUBI, BNZ) \
+    X(SHRI, ANDI, BZ) \
+    X(LOAD, LOAD, ADD) \
+    X(LOAD, ADDI, STORE)
+#define CPU_FUSED_PAIRS(X) \
+    X(SUBI, BNZ) \
+    X(ANDI, BZ) \
+    X(ANDI, BNZ) \
+    X(ADDI, LOAD) \
+    X(LOAD, ADD) \
+    X(LOAD, ADDI) \
+    X(ADD, ADD) \
+    X(ADD, STORE) \
+    X(ADDI, STORE) \
+    X(ADDI, ADDI) \
+    X(MUL, ADD) \
+    X(MUL, ADDI) \
+    X(XOR, SHLI) \
+    X(OR, ADDI) \
+    X(FMUL, FADD) \
+    X(ADD, RET)
+
+// Fused types follow the decoded ones in cpu_op_t.type
+#define CPU_FUSED3_ENUM(a, b, c) INST_##a##_##b##_##c,
+#define CPU_FUSED2_ENUM(a, b) INST_##a##_##b,
+typedef enum {
+    INST_FUSED_BASE = INST_COUNT - 1,
+    CPU_FUSED_TRIPLES(CPU_FUSED3_ENUM)
+    CPU_FUSED_PAIRS(CPU_FUSED2_ENUM)
+    INST_FUSED_END
+} cpu_fused_type_t;
+#undef CPU_FUSED3_ENUM
+#undef CPU_FUSED2_ENUM
+
+#define CPU_FUSED_COUNT (INST_FUSED_END - INST_COUNT)
+
+#define CPU_FUSED3_NAME(a, b, c) #a "+" #b "+" #c,
+#define CPU_FUSED2_NAME(a, b) #a "+" #b,
+static const char *const cpu_fused_names[CPU_FUSED_COUNT] = {
+    CPU_FUSED_TRIPLES(CPU_FUSED3_NAME)
+    CPU_FUSED_PAIRS(CPU_FUSED2_NAME)
+};
+#undef CPU_FUSED3_NAME
+#undef CPU_FUSED2_NAME
+
+// Instructions a fused type stands for (1 for decoded types)
+static inline int cpu_fused_length(unsigned type) {
+#define CPU_FUSED3_LEN(a, b, c) + 1
+    enum { triples = 0 CPU_FUSED_TRIPLES(CPU_FUSED3_LEN) };
+#undef CPU_FUSED3_LEN
+    if (type < INST_COUNT) return 1;
+    return type - INST_COUNT < (unsigned)triples ? 3 : 2;
+}
+
+// Predecoded instruction: operands extracted and placed per the format
+typedef struct {
+    uint8_t type;            // instruction_type_t
+    uint8_t rd;
+    uint8_t rs1;
+    uint8_t rs2;
+    int32_t imm;             // Sign-extended IMM, or EXTENDED for J/U-type
+} cpu_op_t;
+
+// Register File: GPRs and the control registers every instruction touches
+// first and contiguous, the FP and vector files after them
+typedef struct {
+    uint64_t gpr[64];        // General Purpose Registers
+    uint64_t pc;             // Program Counter
+    uint64_t sp;             // Stack Pointer
+    uint64_t fp;             // Frame Pointer
+    uint64_t lr;             // Link Register
+    uint64_t flags;          // Status Flags
+    float fpr[64];           // Floating-Point Registers
+    uint8_t vector[32][64];  // Vector Registers (512-bit each)
+} register_file_t;
+
+// Cache Line
+typedef struct {
+    uint64_t tag;
+    uint8_t data[64];        // 64-byte cache line
+    uint8_t valid;
+    uint8_t dirty;
+    uint8_t lru;
+} cache_line_t;
+
+// Cache
+typedef struct {
+    cache_line_t *lines;
+    int size;
+    int associativity;
+    int line_size;
+    int sets;
+} cache_t;
+
+typedef enum {
+    CPU_RUNNING,
+    CPU_WAITING,             // Yielded or spinning on a LOCK; runs next round
+    CPU_BARRIER,             // Parked until the barrier generation changes
+    CPU_HALTED,
+    CPU_FAULTED
+} cpu_state_t;
+
+typedef enum {
+    CPU_MODE_SWITCH,
+    CPU_MODE_THREADED,
+    CPU_MODE_BLOCK,
+    CPU_MODE_JIT,
+    CPU_MODES
+} cpu_mode_t;
+
+static const char *const cpu_mode_names[CPU_MODES] = { "switch", "threaded", "block", "jit" };
+
+struct cpu_system;
+
+// Microarchitectural model of a core (caches, pipeline, predictor). The
+// execution engines never touch it, so it lives apart from the hot state
+// in cpu_system_t.models.
+typedef struct {
+    cache_t l1i;             // L1 Instruction Cache
+    cache_t l1d;             // L1 Data Cache
+    cache_t l2;              // L2 Cache
+    cache_t l3;              // L3 Cache
+    uint8_t pipeline[12];    // 12-stage pipeline
+    int pipeline_stage;
+    int branch_predictor[1024];
+    int performance_counters[8];
+} CPU_ALIGNED cpu_core_model_t;
+
+// CPU Core: the state the engines use on every instruction or block, then
+// the registers, so that and the GPRs, PC and flags share the first ten
+// cache lines; what only setup and the slow paths read comes last
+typedef struct {
+    uint8_t *memory;         // Copies of the system's, for the load/store path
+    uint64_t memory_size;
+    struct cpu_system *system;
+    struct cpu_block *next_block;  // Block engine: chained block at regs.pc, or NULL
+    uint64_t retired;        // Instructions completed
+    cpu_state_t state;
+    unsigned barrier_generation;
+    // Lazy flags: the last flag-setting ALU operation, folded into the
+    // Z/S/C/V bits of regs.flags by cpu_flags when something reads them
+    uint64_t flags_op;       // CPU_FLAGS_*
+    uint64_t flags_result;
+    uint64_t flags_a;
+    uint64_t flags_b;
+    register_file_t regs;
+    int core_id;
+    int thread_id;
+    cpu_core_model_t *model;
+} CPU_ALIGNED cpu_core_t;
+
+// Predecoded basic block; blocks[i] starts at text_base + 8 * i
+typedef struct cpu_block {
+    uint32_t count;          // Instructions including the terminator, 0 = unbuilt
+    uint32_t index;          // First op in cpu_system_t.decoded
+    uint64_t pc;
+    struct cpu_block *next[2];  // Chained successors: fall-through, taken
+    void *code;              // Host translation (CPU_MODE_JIT), NULL if none
+    uint32_t heat;           // Interpreted entries, up to CPU_JIT_THRESHOLD
+} cpu_block_t;
+
+// Translated code buffer: shared entry/exit code, then blocks back to back
+typedef struct {
+    uint8_t *code;           // Executable mapping, allocated on first use
+    size_t size;
+    size_t used;
+    size_t prologue;         // Bytes of entry/exit code at the start
+    uint8_t *exit;           // Exit to the dispatcher, status in EAX
+    uint8_t *exit_continue;  // Exit with status 0
+    int flush;               // Drop every translation at the next block boundary
+    int disabled;            // No executable memory on this host
+    uint64_t translations;
+    uint64_t flushes;
+} cpu_jit_t;
+
+// Dynamic counts of adjacent instruction sequences: pairs and triples that
+// ran back to back at consecutive addresses, with every instruction but the
+// last falling through (cpu_profile_sequences)
+#define CPU_PROFILE_TRIPLES 4096
+typedef struct {
+    uint64_t pc[2];          // Last two retired instructions, newest first
+    uint8_t type[2];
+    int n;
+} cpu_profile_history_t;
+
+typedef struct {
+    uint64_t instructions;
+    uint64_t pairs[INST_COUNT][INST_COUNT];
+    struct {
+        uint32_t key;        // 0 = empty, else 1 << 24 | a << 16 | b << 8 | c
+        uint64_t count;
+    } triples[CPU_PROFILE_TRIPLES];
+    cpu_profile_history_t history[MAX_CORES];
+} cpu_profile_t;
+
+// Sampling of each core every `period` retired instructions (cpu-profiler.h).
+// cpu_run shortens quanta to end on the sample points and calls sample
+// there, so the engines themselves never see it.
+typedef struct cpu_sampler {
+    uint64_t period;
+    uint64_t next[MAX_CORES];  // Core's retired count at its next sample
+    void (*sample)(struct cpu_sampler *sampler, cpu_core_t *core);
+} cpu_sampler_t;
+
+// CPU System
+typedef struct cpu_system {
+    cpu_core_t cores[MAX_CORES];
+    cpu_core_model_t *models;  // One per core, cpu_core_t.model
+    int num_cores;
+    uint8_t *memory;
+    uint64_t memory_size;
+    int clock_frequency;     // MHz
+    int power_consumption;   // Watts
+    // Text loaded by cpu_load_program, predecoded for the threaded and block
+    // engines (one extra INVALID op past the end stops fall-through)
+    uint64_t text_base;
+    uint64_t text_count;
+    cpu_op_t *decoded;
+    cpu_op_t *fused;         // decoded with superinstructions, for the block engine
+    cpu_block_t *blocks;
+    cpu_jit_t jit;
+    // BARRIER rendezvous of all cores
+    int barrier_arrived;
+    unsigned barrier_generation;
+    // Superinstructions the block engine ran since the last reset
+    uint64_t fused_hits[CPU_FUSED_COUNT];
+    // Sequence profile fed by the switch engine, NULL when not profiling
+    cpu_profile_t *profile;
+    // Periodic sampler called by cpu_run between quanta, NULL when not sampling
+    struct cpu_sampler *sampler;
+} cpu_system_t;
+
+// Outcome of executing one instruction
+#define CPU_EXEC_NEXT 0      // Continue at pc + 8
+#define CPU_EXEC_JUMP 1      // Continue at regs.pc
+#define CPU_EXEC_STOP 2      // Retired; core left CPU_RUNNING or yields, resume at regs.pc
+#define CPU_EXEC_RETRY 3     // Not retired (lock busy); retry at regs.pc later
+#define CPU_EXEC_FAULT (-1)
+
+// Encoders for building guest programs
+
+static inline uint64_t cpu_encode(unsigned opcode, unsigned funct, unsigned rs2, unsigned rs1,
+                                  uint16_t imm, uint32_t extended) {
+    return ((uint64_t)(opcode & 0xF) << 60) | ((uint64_t)(funct & 0xF) << 56) |
+           ((uint64_t)(rs2 & 0xF) << 52) | ((uint64_t)(rs1 & 0xF) << 48) |
+           ((uint64_t)imm << 32) | extended;
+}
+
+// Register/immediate forms: destination in EXTENDED[3:0]
+static inline uint64_t cpu_encode_op(unsigned opcode, unsigned funct, unsigned rd, unsigned rs1,
+                                     unsigned rs2, int32_t imm) {
+    return cpu_encode(opcode, funct, rs2, rs1, (uint16_t)imm, rd & 0xF);
+}
+
+// J/U-type: 32-bit offset or value in EXTENDED
+static inline uint64_t cpu_encode_long(unsigned opcode, unsigned funct, unsigned rs1,
+                                       int32_t value) {
+    return cpu_encode(opcode, funct, 0, rs1, 0, (uint32_t)value);
+}
+
+static inline void cpu_unpack(uint64_t word, instruction_t *inst) {
+    inst->opcode = (uint8_t)(word >> 60);
+    inst->funct = (uint8_t)(word >> 56) & 0xF;
+    inst->rs2 = (uint8_t)(word >> 52) & 0xF;
+    inst->rs1 = (uint8_t)(word >> 48) & 0xF;
+    inst->imm = (uint16_t)(word >> 32);
+    inst->extended = (uint32_t)word;
+}
+
+// CPU Initialization
+
+static inline void cpu_reset_core(cpu_core_t *core, uint64_t entry) {
+    memset(&core->regs, 0, sizeof(register_file_t));
+    core->regs.pc = entry;
+    core->regs.sp = CPU_RESET_SP;
+    core->regs.fp = CPU_RESET_SP;
+    core->flags_op = CPU_FLAGS_NONE;
+    core->next_block = NULL;
+    core->state = CPU_RUNNING;
+    core->barrier_generation = 0;
+    core->retired = 0;
+}
+
+// Resets every core to start at entry
+static inline void cpu_reset(cpu_system_t *cpu, uint64_t entry) {
+    for (int i = 0; i < cpu->num_cores; i++) {
+        cpu_reset_core(&cpu->cores[i], entry);
+    }
+    cpu->barrier_arrived = 0;
+    cpu->barrier_generation = 0;
+    memset(cpu->fused_hits, 0, sizeof(cpu->fused_hits));
+}
+
+// Zeroed, cache-line aligned where the host allows it; NULL on failure
+static inline void *cpu_alloc(size_t size) {
+    void *p = NULL;
+#if CPU_HAVE_ALIGNED_ALLOC
+    if (posix_memalign(&p, CPU_CACHE_LINE, size) != 0) {
+        return NULL;
+    }
+#else
+    p = malloc(size);
+    if (!p) {
+        return NULL;
+    }
+#endif
+    memset(p, 0, size);
+    return p;
+}
+
+// Allocates a system with zeroed memory; cpu_init is the same plus a banner
+static inline cpu_system_t *cpu_create(int num_cores, uint64_t memory_size) {
+    if (num_cores < 1 || num_cores > MAX_CORES || memory_size < CPU_RESET_SP) {
+        return NULL;
+    }
+    cpu_system_t *cpu = cpu_alloc(sizeof(cpu_system_t));
+    if (!cpu) return NULL;
+
+    cpu->num_cores = num_cores;
+    cpu->memory_size = memory_size;
+    cpu->memory = calloc(1, memory_size);
+    cpu->models = cpu_alloc(num_cores * sizeof(cpu_core_model_t));
+    cpu->clock_frequency = 5000;  // 5 GHz
+    cpu->power_consumption = 0;
+
+    if (!cpu->memory || !cpu->models) {
+        free(cpu->memory);
+        free(cpu->models);
+        free(cpu);
+        return NULL;
+    }
+
+    for (int i = 0; i < num_cores; i++) {
+        cpu_core_t *core = &cpu->cores[i];
+        core->core_id = i;
+        core->thread_id = 0;
+        core->system = cpu;
+        core->memory = cpu->memory;
+        core->memory_size = memory_size;
+        core->model = &cpu->models[i];
+        cpu_reset_core(core, CPU_RESET_PC);
+
+        core->model->l1i.size = INSTRUCTION_CACHE_SIZE;
+        core->model->l1d.size = DATA_CACHE_SIZE;
+        core->model->l2.size = L2_CACHE_SIZE;
+        core->model->l3.size = L3_CACHE_SIZE;
+
+        cpu->power_consumption += 25;  // 25W per core
+    }
+    return cpu;
+}
+
+static inline cpu_system_t *cpu_init(int num_cores, uint64_t memory_size) {
+    cpu_system_t *cpu = cpu_create(num_cores, memory_size);
+    if (cpu) {
+        printf("AlphaAHB V5 CPU initialized with %d cores, %lu MB memory\n",
+               num_cores, (unsigned long)(memory_size / (1024 * 1024)));
+    }
+    return cpu;
+}
+
+static inline void cpu_jit_release(cpu_system_t *cpu);
+
+// CPU Cleanup
+static inline void cpu_destroy(cpu_system_t *cpu) {
+    if (cpu) {
+        cpu_jit_release(cpu);
+        free(cpu->decoded);
+        free(cpu->fused);
+        free(cpu->blocks);
+        free(cpu->memory);
+        free(cpu->models);
+        free(cpu);
+    }
+}
+
+// Instruction Fetch: reads the word at address and advances the PC past it
+static inline int cpu_fetch_instruction(cpu_core_t *core, uint64_t address, instruction_t *inst) {
+    uint64_t word;
+
+    if ((address & (CPU_INST_BYTES - 1)) || address > core->memory_size - CPU_INST_BYTES) {
+        return -1;
+    }
+    memcpy(&word, core->memory + address, sizeof(word));
+    cpu_unpack(word, inst);
+    core->regs.pc = address + CPU_INST_BYTES;
+    return 0;
+}
+
+// Instruction Decode: opcode and funct index the generated decode table
+static inline int cpu_decode_instruction(const instruction_t *inst, instruction_type_t *type) {
+    *type = (instruction_type_t)cpu_decode_table[inst->opcode << 4 | inst->funct];
+    return *type == INST_INVALID ? -1 : 0;
+}
+
+// Does the instruction write its destination to a GPR?
+static inline int cpu_writes_gpr(instruction_type_t type) {
+    return (cpu_isa[type].properties & CPU_ISA_WRITES_GPR) != 0;
+}
+
+// Operand extraction for a decoded instruction
+static inline void cpu_operands(const instruction_t *inst, instruction_type_t type, cpu_op_t *op) {
+    op->type = (uint8_t)type;
+    op->rs1 = inst->rs1;
+    op->rs2 = inst->rs2;
+    op->rd = inst->extended & 0xF;
+    op->imm = (int16_t)inst->imm;
+    if (inst->opcode == CPU_OPC_J || inst->opcode == CPU_OPC_U) {
+        op->imm = (int32_t)inst->extended;
+    }
+    if (inst->opcode == CPU_OPC_U) {
+        op->rd = inst->rs1;
+    }
+    if (op->rd == 0 && (cpu_writes_gpr(type) || (type == INST_FCVT && op->imm != 0))) {
+        op->rd = CPU_DISCARD_REG;
+    }
+}
+
+static inline void cpu_predecode(uint64_t word, cpu_op_t *op) {
+    instruction_t inst;
+    instruction_type_t type;
+
+    cpu_unpack(word, &inst);
+    if (cpu_decode_instruction(&inst, &type) != 0) {
+        memset(op, 0, sizeof(*op));
+        op->type = INST_INVALID;
+        return;
+    }
+    cpu_operands(&inst, type, op);
+}
+
+// Control transfers, synchronization and halts end a basic block
+static inline int cpu_ends_block(instruction_type_t type) {
+    return (cpu_isa[type].properties & CPU_ISA_ENDS_BLOCK) != 0;
+}
+
+// Superinstruction starting at index i of the text, or its decoded type
+static inline unsigned cpu_fuse_at(const cpu_system_t *cpu, uint64_t i) {
+    const cpu_op_t *ops = cpu->decoded;
+    unsigned a = ops[i].type;
+    unsigned b = i + 1 < cpu->text_count ? ops[i + 1].type : INST_INVALID;
+    unsigned c = i + 2 < cpu->text_count ? ops[i + 2].type : INST_INVALID;
+
+    if (cpu_ends_block((instruction_type_t)a)) {
+        return a;
+    }
+#define CPU_MATCH3(x, y, z) \
+    if (a == INST_##x && b == INST_##y && c == INST_##z) return INST_##x##_##y##_##z;
+#define CPU_MATCH2(x, y) \
+    if (a == INST_##x && b == INST_##y) return INST_##x##_##y;
+    if (!cpu_ends_block((instruction_type_t)b)) {
+        CPU_FUSED_TRIPLES(CPU_MATCH3)
+    }
+    CPU_FUSED_PAIRS(CPU_MATCH2)
+#undef CPU_MATCH3
+#undef CPU_MATCH2
+    return a;
+}
+
+// Refreshes the fused copy of text indices [first, end)
+static inline void cpu_fuse(cpu_system_t *cpu, uint64_t first, uint64_t end) {
+    for (uint64_t i = first; i < end && i < cpu->text_count; i++) {
+        cpu->fused[i] = cpu->decoded[i];
+        cpu->fused[i].type = (uint8_t)cpu_fuse_at(cpu, i);
+    }
+}
+
+// Copies count words to address and makes them the predecoded text. Every
+// core restarts at address.
+static inline int cpu_load_program(cpu_system_t *cpu, uint64_t address, const uint64_t *words,
+                                   size_t count) {
+    if ((address & (CPU_INST_BYTES - 1)) || count == 0 ||
+        count > (cpu->memory_size - address) / CPU_INST_BYTES || address >= cpu->memory_size) {
+        return -1;
+    }
+    cpu_op_t *decoded = malloc((count + 1) * sizeof(cpu_op_t));
+    cpu_op_t *fused = malloc((count + 1) * sizeof(cpu_op_t));
+    cpu_block_t *blocks = calloc(count, sizeof(cpu_block_t));
+    if (!decoded || !fused || !blocks) {
+        free(decoded);
+        free(fused);
+        free(blocks);
+        return -1;
+    }
+    memcpy(cpu->memory + address, words, count * sizeof(uint64_t));
+    for (size_t i = 0; i < count; i++) {
+        cpu_predecode(words[i], &decoded[i]);
+    }
+    memset(&decoded[count], 0, sizeof(cpu_op_t));
+    decoded[count].type = INST_INVALID;
+
+    free(cpu->decoded);
+    free(cpu->fused);
+    free(cpu->blocks);
+    cpu->decoded = decoded;
+    cpu->fused = fused;
+    cpu->blocks = blocks;
+    cpu->text_base = address;
+    cpu->text_count = count;
+    cpu_fuse(cpu, 0, count);
+    cpu->fused[count] = decoded[count];
+    cpu->jit.flush = 1;
+    cpu_reset(cpu, address);
+    return 0;
+}
+
+static inline int cpu_in_text(const cpu_system_t *cpu, uint64_t pc) {
+    return pc - cpu->text_base < cpu->text_count * CPU_INST_BYTES && !(pc & (CPU_INST_BYTES - 1));
+}
+
+// A store overlapped the text: predecode the words again, drop all blocks
+// and translations
+static inline void cpu_text_written(cpu_system_t *cpu, uint64_t addr, uint64_t bytes) {
+    uint64_t end = cpu->text_base + cpu->text_count * CPU_INST_BYTES;
+    uint64_t first = addr < cpu->text_base ? cpu->text_base : addr & ~(uint64_t)7;
+    uint64_t index = (first - cpu->text_base) / CPU_INST_BYTES;
+    uint64_t a;
+
+    for (a = first; a < addr + bytes && a < end; a += CPU_INST_BYTES) {
+        uint64_t word;
+        memcpy(&word, cpu->memory + a, sizeof(word));
+        cpu_predecode(word, &cpu->decoded[(a - cpu->text_base) / CPU_INST_BYTES]);
+    }
+    // Superinstructions covering the rewritten words start up to two before
+    cpu_fuse(cpu, index >= 2 ? index - 2 : 0, (a - cpu->text_base) / CPU_INST_BYTES);
+    memset(cpu->blocks, 0, cpu->text_count * sizeof(cpu_block_t));
+    cpu->jit.flush = 1;
+}
+
+// Memory access
+
+CPU_INLINE int cpu_load64(const cpu_core_t *core, uint64_t addr, uint64_t *value) {
+    if (addr > core->memory_size - sizeof(uint64_t)) {
+        return -1;
+    }
+    memcpy(value, core->memory + addr, sizeof(uint64_t));
+    return 0;
+}
+
+CPU_INLINE int cpu_store64(cpu_core_t *core, uint64_t addr, uint64_t value) {
+    if (addr > core->memory_size - sizeof(uint64_t)) {
+        return -1;
+    }
+    memcpy(core->memory + addr, &value, sizeof(uint64_t));
+    return 0;
+}
+
+// Guest store of an instruction: CPU_EXEC_JUMP to the next instruction when
+// it rewrote the text, whose predecoded and translated copies are then stale
+CPU_INLINE int cpu_execute_store(cpu_core_t *core, uint64_t addr, uint64_t value, uint64_t pc) {
+    cpu_system_t *cpu = core->system;
+
+    if (cpu_store64(core, addr, value) != 0) {
+        return CPU_EXEC_FAULT;
+    }
+    if (addr + sizeof(uint64_t) > cpu->text_base &&
+        addr < cpu->text_base + cpu->text_count * CPU_INST_BYTES) {
+        cpu_text_written(cpu, addr, sizeof(uint64_t));
+        core->regs.pc = pc + CPU_INST_BYTES;
+        return CPU_EXEC_JUMP;
+    }
+    return CPU_EXEC_NEXT;
+}
+
+// Flag update kind of an ALU instruction
+CPU_INLINE uint64_t cpu_flags_kind(instruction_type_t type) {
+    switch (type) {
+        case INST_ADD: case INST_ADDI:
+            return CPU_FLAGS_ADD;
+        case INST_SUB: case INST_SUBI: case INST_CMP: case INST_CMPI:
+            return CPU_FLAGS_SUB;
+        case INST_MUL: case INST_MULI:
+            return CPU_FLAGS_MUL;
+        default:
+            return CPU_FLAGS_LOGIC;
+    }
+}
+
+// Records an ALU operation's flag update without computing it
+CPU_INLINE void cpu_defer_flags(cpu_core_t *core, uint64_t kind, uint64_t result, uint64_t a,
+                                uint64_t b) {
+    core->flags_op = kind;
+    core->flags_result = result;
+    core->flags_a = a;
+    core->flags_b = b;
+}
+
+// C and V of a 64-bit multiply: the unsigned and signed products overflow
+static inline uint64_t cpu_mul_flags(uint64_t a, uint64_t b) {
+    uint64_t flags = 0;
+#if defined(__GNUC__)
+    uint64_t u;
+    int64_t v;
+    if (__builtin_mul_overflow(a, b, &u)) flags |= CPU_FLAG_C;
+    if (__builtin_mul_overflow((int64_t)a, (int64_t)b, &v)) flags |= CPU_FLAG_V;
+#else
+    int64_t x = (int64_t)a, y = (int64_t)b;
+    if (a && a * b / a != b) flags |= CPU_FLAG_C;
+    if (x && y && ((x == -1 && y == INT64_MIN) || (y == -1 && x == INT64_MIN) ||
+                   (int64_t)(a * b) / y != x)) {
+        flags |= CPU_FLAG_V;
+    }
+#endif
+    return flags;
+}
+
+// Status flags with any pending ALU update folded in
+static inline uint64_t cpu_flags(cpu_core_t *core) {
+    uint64_t r = core->flags_result, a = core->flags_a, b = core->flags_b;
+    uint64_t flags;
+
+    if (core->flags_op == CPU_FLAGS_NONE) {
+        return core->regs.flags;
+    }
+    flags = core->regs.flags & ~(uint64_t)CPU_FLAGS_ALU;
+    if (r == 0) flags |= CPU_FLAG_Z;
+    if (r >> 63) flags |= CPU_FLAG_S;
+    switch (core->flags_op) {
+        case CPU_FLAGS_ADD:
+            if (r < a) flags |= CPU_FLAG_C;
+            if (((a ^ r) & (b ^ r)) >> 63) flags |= CPU_FLAG_V;
+            break;
+        case CPU_FLAGS_SUB:
+            if (a < b) flags |= CPU_FLAG_C;
+            if (((a ^ b) & (a ^ r)) >> 63) flags |= CPU_FLAG_V;
+            break;
+        case CPU_FLAGS_MUL:
+            flags |= cpu_mul_flags(a, b);
+            break;
+        default:
+            break;
+    }
+    core->regs.flags = flags;
+    core->flags_op = CPU_FLAGS_NONE;
+    return flags;
+}
+
+static inline uint64_t cpu_clz(uint64_t x) {
+#if defined(__GNUC__)
+    return x ? (uint64_t)__builtin_clzll(x) : 64;
+#else
+    uint64_t n = 0;
+    for (uint64_t bit = 1ULL << 63; bit && !(x & bit); bit >>= 1) n++;
+    return n;
+#endif
+}
+
+static inline uint64_t cpu_ctz(uint64_t x) {
+#if defined(__GNUC__)
+    return x ? (uint64_t)__builtin_ctzll(x) : 64;
+#else
+    uint64_t n = 0;
+    for (uint64_t bit = 1; bit && !(x & bit); bit <<= 1) n++;
+    return n;
+#endif
+}
+
+static inline uint64_t cpu_popcount(uint64_t x) {
+#if defined(__GNUC__)
+    return (uint64_t)__builtin_popcountll(x);
+#else
+    uint64_t n = 0;
+    for (; x; x &= x - 1) n++;
+    return n;
+#endif
+}
+
+// Arithmetic Instruction Execution (R-type, I-type immediates and compares)
+CPU_INLINE int cpu_execute_arithmetic(cpu_core_t *core, instruction_type_t type,
+                                      const cpu_op_t *op, uint64_t pc) {
+    (void)pc;
+    uint64_t rs1_val = core->regs.gpr[op->rs1];
+    uint64_t rs2_val = cpu_isa[type].format == 'I' ? (uint64_t)(int64_t)op->imm
+                                                   : core->regs.gpr[op->rs2];
+    uint64_t result = 0;
+
+    switch (type) {
+        case INST_ADD: case INST_ADDI:
+            result = rs1_val + rs2_val;
+            break;
+        case INST_SUB: case INST_SUBI: case INST_CMP: case INST_CMPI:
+            result = rs1_val - rs2_val;
+            break;
+        case INST_MUL: case INST_MULI:
+            result = rs1_val * rs2_val;
+            break;
+        case INST_DIV: case INST_DIVI:
+            if (rs2_val == 0) return CPU_EXEC_FAULT;  // Division by zero
+            result = rs1_val / rs2_val;
+            break;
+        case INST_MOD:
+            if (rs2_val == 0) return CPU_EXEC_FAULT;
+            result = rs1_val % rs2_val;
+            break;
+        case INST_AND: case INST_ANDI: case INST_TESTI:
+            result = rs1_val & rs2_val;
+            break;
+        case INST_OR: case INST_ORI:
+            result = rs1_val | rs2_val;
+            break;
+        case INST_XOR: case INST_XORI:
+            result = rs1_val ^ rs2_val;
+            break;
+        case INST_SHL: case INST_SHLI:
+            result = rs1_val << (rs2_val & 0x3F);
+            break;
+        case INST_SHR: case INST_SHRI:
+            result = rs1_val >> (rs2_val & 0x3F);
+            break;
+        case INST_ROT: {
+            unsigned n = rs2_val & 0x3F;
+            result = n ? (rs1_val << n) | (rs1_val >> (64 - n)) : rs1_val;
+            break;
+        }
+        case INST_CLZ:
+            result = cpu_clz(rs1_val);
+            break;
+        case INST_CTZ:
+            result = cpu_ctz(rs1_val);
+            break;
+        case INST_POPCNT:
+            result = cpu_popcount(rs1_val);
+            break;
+        default:
+            return CPU_EXEC_FAULT;
+    }
+
+    // Compares only set flags
+    if (type != INST_CMP && type != INST_CMPI && type != INST_TESTI) {
+        core->regs.gpr[op->rd] = result;
+    }
+    cpu_defer_flags(core, cpu_flags_kind(type), result, rs1_val, rs2_val);
+    return CPU_EXEC_NEXT;
+}
+
+// Load/Store Instruction Execution
+CPU_INLINE int cpu_execute_memory(cpu_core_t *core, instruction_type_t type, const cpu_op_t *op,
+                                  uint64_t pc) {
+    uint64_t addr = core->regs.gpr[op->rs1] + (uint64_t)(int64_t)op->imm;
+
+    switch (type) {
+        case INST_LOAD:
+        case INST_LOADL:  // No reservation to track with interleaved cores
+            if (addr & 7) return CPU_EXEC_FAULT;
+            /* fall through */
+        case INST_LOADU:
+            return cpu_load64(core, addr, &core->regs.gpr[op->rd]) ? CPU_EXEC_FAULT
+                                                                   : CPU_EXEC_NEXT;
+        case INST_STORE:
+            if (addr & 7) return CPU_EXEC_FAULT;
+            /* fall through */
+        case INST_STOREU:
+            return cpu_execute_store(core, addr, core->regs.gpr[op->rs2], pc);
+        case INST_PREFETCH:
+        case INST_FENCE:
+            return CPU_EXEC_NEXT;
+        case INST_FENCEI:
+            core->regs.pc = pc + CPU_INST_BYTES;
+            return CPU_EXEC_JUMP;
+        default:
+            return CPU_EXEC_FAULT;
+    }
+}
+
+// Branch and Jump Execution
+CPU_INLINE int cpu_execute_branch(cpu_core_t *core, instruction_type_t type, const cpu_op_t *op,
+                                  uint64_t pc) {
+    uint64_t a = core->regs.gpr[op->rs1];
+    uint64_t b = core->regs.gpr[op->rs2];
+    uint64_t target = pc + (uint64_t)(int64_t)op->imm;
+    int taken;
+
+    switch (type) {
+        case INST_BEQ:  taken = a == b; break;
+        case INST_BNE:  taken = a != b; break;
+        case INST_BLT:  taken = (int64_t)a < (int64_t)b; break;
+        case INST_BLE:  taken = (int64_t)a <= (int64_t)b; break;
+        case INST_BGT:  taken = (int64_t)a > (int64_t)b; break;
+        case INST_BGE:  taken = (int64_t)a >= (int64_t)b; break;
+        case INST_BLTU: taken = a < b; break;
+        case INST_BLEU: taken = a <= b; break;
+        case INST_BGTU: taken = a > b; break;
+        case INST_BGEU: taken = a >= b; break;
+        case INST_BZ:   taken = a == 0; break;
+        case INST_BNZ:  taken = a != 0; break;
+        case INST_BLTZ: taken = (int64_t)a < 0; break;
+        case INST_BLEZ: taken = (int64_t)a <= 0; break;
+        case INST_BGTZ: taken = (int64_t)a > 0; break;
+        case INST_BGEZ: taken = (int64_t)a >= 0; break;
+        case INST_J:
+            taken = 1;
+            break;
+        case INST_JAL:
+            core->regs.lr = pc + CPU_INST_BYTES;
+            taken = 1;
+            break;
+        case INST_JR:
+            target = a;
+            taken = 1;
+            break;
+        case INST_JALR:
+            core->regs.lr = pc + CPU_INST_BYTES;
+            target = a;
+            taken = 1;
+            break;
+        case INST_RET:
+            target = core->regs.lr;
+            taken = 1;
+            break;
+        default:
+            return CPU_EXEC_FAULT;
+    }
+    if (!taken) {
+        return CPU_EXEC_NEXT;
+    }
+    core->regs.pc = target;
+    return CPU_EXEC_JUMP;
+}
+
+// Floating-Point Instruction Execution
+CPU_INLINE int cpu_execute_floating_point(cpu_core_t *core, instruction_type_t type,
+                                          const cpu_op_t *op, uint64_t pc) {
+    (void)pc;
+    float rs1_val = core->regs.fpr[op->rs1];
+    float rs2_val = core->regs.fpr[op->rs2];
+    float result = 0.0f;
+
+    switch (type) {
+        case INST_FADD:
+            result = rs1_val + rs2_val;
+            break;
+        case INST_FSUB:
+            result = rs1_val - rs2_val;
+            break;
+        case INST_FMUL:
+            result = rs1_val * rs2_val;
+            break;
+        case INST_FDIV:
+            if (rs2_val == 0.0f) return CPU_EXEC_FAULT;  // Division by zero
+            result = rs1_val / rs2_val;
+            break;
+        case INST_FSQRT:
+            if (rs1_val < 0.0f) return CPU_EXEC_FAULT;  // Invalid operation
+            result = sqrtf(rs1_val);
+            break;
+        case INST_FMA:
+            result = fmaf(rs1_val, rs2_val, core->regs.fpr[op->rd]);
+            break;
+        case INST_FCMP: {
+            // Replaces any pending ALU update; C and V clear
+            uint64_t flags = core->regs.flags & ~(uint64_t)CPU_FLAGS_ALU;
+            if (rs1_val == rs2_val) flags |= CPU_FLAG_Z;
+            if (rs1_val < rs2_val) flags |= CPU_FLAG_S;
+            core->regs.flags = flags;
+            core->flags_op = CPU_FLAGS_NONE;
+            return CPU_EXEC_NEXT;
+        }
+        case INST_FCVT:
+            // IMM 0: Fd = (float)Rs1, IMM 1: Rd = (int64)Fs1 truncated. NaN
+            // and out-of-range values give INT64_MIN, as cvttss2si does in
+            // the JIT; the C conversion would be undefined for them.
+            if (op->imm) {
+                int64_t value = INT64_MIN;
+                if (rs1_val >= -9223372036854775808.0f && rs1_val < 9223372036854775808.0f) {
+                    value = (int64_t)rs1_val;
+                }
+                core->regs.gpr[op->rd] = (uint64_t)value;
+                return CPU_EXEC_NEXT;
+            }
+            result = (float)(int64_t)core->regs.gpr[op->rs1];
+            break;
+        default:
+            return CPU_EXEC_FAULT;
+    }
+
+    // Store result in destination register
+    core->regs.fpr[op->rd] = result;
+    return CPU_EXEC_NEXT;
+}
+
+// Vector Instruction Execution (512-bit registers as 64 byte lanes). Lanes
+// are computed into a local copy, so Vd may alias a source and the loops
+// still vectorize.
+CPU_INLINE int cpu_execute_vector(cpu_core_t *core, instruction_type_t type, const cpu_op_t *op,
+                                  uint64_t pc) {
+    (void)pc;
+    uint8_t v1[64], v2[64], vd[64];
+    unsigned shift = (unsigned)op->imm & 7;
+    uint64_t sum = 0;
+
+    memcpy(v1, core->regs.vector[op->rs1], sizeof(v1));
+    memcpy(v2, core->regs.vector[op->rs2], sizeof(v2));
+    switch (type) {
+        case INST_VADD:
+            for (int i = 0; i < 64; i++) vd[i] = (uint8_t)(v1[i] + v2[i]);
+            break;
+        case INST_VSUB:
+            for (int i = 0; i < 64; i++) vd[i] = (uint8_t)(v1[i] - v2[i]);
+            break;
+        case INST_VMUL:
+            for (int i = 0; i < 64; i++) vd[i] = (uint8_t)(v1[i] * v2[i]);
+            break;
+        case INST_VDIV:
+            for (int i = 0; i < 64; i++) vd[i] = v2[i] ? (uint8_t)(v1[i] / v2[i]) : 0;
+            break;
+        case INST_VFMA:
+            memcpy(vd, core->regs.vector[op->rd], sizeof(vd));
+            for (int i = 0; i < 64; i++) vd[i] = (uint8_t)(vd[i] + v1[i] * v2[i]);
+            break;
+        case INST_VAND:
+            for (int i = 0; i < 64; i++) vd[i] = v1[i] & v2[i];
+            break;
+        case INST_VOR:
+            for (int i = 0; i < 64; i++) vd[i] = v1[i] | v2[i];
+            break;
+        case INST_VXOR:
+            for (int i = 0; i < 64; i++) vd[i] = v1[i] ^ v2[i];
+            break;
+        case INST_VSHL:
+            for (int i = 0; i < 64; i++) vd[i] = (uint8_t)(v1[i] << shift);
+            break;
+        case INST_VSHR:
+            for (int i = 0; i < 64; i++) vd[i] = (uint8_t)(v1[i] >> shift);
+            break;
+        case INST_VREDUCE:
+            for (int i = 0; i < 64; i++) sum += v1[i];
+            core->regs.gpr[op->rd] = sum;
+            return CPU_EXEC_NEXT;
+        default:
+            return CPU_EXEC_FAULT;
+    }
+    memcpy(core->regs.vector[op->rd], vd, sizeof(vd));
+    return CPU_EXEC_NEXT;
+}
+
+// AI/ML Instruction Execution
+static inline int cpu_execute_ai_ml(cpu_core_t *core, instruction_type_t type, const cpu_op_t *op,
+                                    uint64_t pc) {
+    (void)core; (void)op; (void)pc;
+    // Simulate AI/ML operations
+    switch (type) {
+        case INST_CONV:
+            printf("Executing convolution operation\n");
+            break;
+        case INST_RELU:
+            printf("Executing ReLU activation\n");
+            break;
+        case INST_SOFTMAX:
+            printf("Executing softmax activation\n");
+            break;
+        default:
+            return CPU_EXEC_FAULT;
+    }
+    return CPU_EXEC_NEXT;
+}
+
+// MIMD Instruction Execution: all cores of the system take part in a
+// BARRIER; LOCK spins (yielding the core) on the word at [Rs1 + IMM], which
+// holds 0 when free and the owner's core id + 1 when taken; ATOMIC adds Rs2
+// to [Rs1 + IMM] and returns the old value in Rd.
+static inline int cpu_execute_mimd(cpu_core_t *core, instruction_type_t type, const cpu_op_t *op,
+                                   uint64_t pc) {
+    cpu_system_t *cpu = core->system;
+    uint64_t addr = core->regs.gpr[op->rs1] + (uint64_t)(int64_t)op->imm;
+    uint64_t value;
+
+    switch (type) {
+        case INST_BARRIER:
+            core->regs.pc = pc + CPU_INST_BYTES;
+            if (++cpu->barrier_arrived == cpu->num_cores) {
+                cpu->barrier_arrived = 0;
+                cpu->barrier_generation++;
+                return CPU_EXEC_NEXT;
+            }
+            core->barrier_generation = cpu->barrier_generation;
+            core->state = CPU_BARRIER;
+            return CPU_EXEC_STOP;
+        case INST_LOCK:
+            if (cpu_load64(core, addr, &value) != 0) return CPU_EXEC_FAULT;
+            if (value != 0) {
+                core->regs.pc = pc;
+                core->state = CPU_WAITING;
+                return CPU_EXEC_RETRY;
+            }
+            return cpu_execute_store(core, addr, (uint64_t)core->core_id + 1, pc);
+        case INST_UNLOCK:
+            return cpu_execute_store(core, addr, 0, pc);
+        case INST_ATOMIC: {
+            if (cpu_load64(core, addr, &value) != 0) return CPU_EXEC_FAULT;
+            uint64_t sum = value + core->regs.gpr[op->rs2];
+            core->regs.gpr[op->rd] = value;
+            return cpu_execute_store(core, addr, sum, pc);
+        }
+        case INST_YIELD:
+            core->regs.pc = pc + CPU_INST_BYTES;
+            core->state = CPU_WAITING;
+            return CPU_EXEC_STOP;
+        default:
+            return CPU_EXEC_FAULT;
+    }
+}
+
+// Control Instruction Execution
+CPU_INLINE int cpu_execute_control(cpu_core_t *core, instruction_type_t type, const cpu_op_t *op,
+                                   uint64_t pc) {
+    uint64_t value = core->regs.gpr[op->rs1];
+
+    switch (type) {
+        case INST_NOP:
+            return CPU_EXEC_NEXT;
+        case INST_HALT:
+            core->regs.pc = pc + CPU_INST_BYTES;
+            core->state = CPU_HALTED;
+            return CPU_EXEC_STOP;
+        case INST_MFSR:
+            switch (op->imm) {
+                case CPU_SR_PC: value = pc; break;
+                case CPU_SR_SP: value = core->regs.sp; break;
+                case CPU_SR_FP: value = core->regs.fp; break;
+                case CPU_SR_LR: value = core->regs.lr; break;
+                case CPU_SR_FLAGS: value = cpu_flags(core); break;
+                case CPU_SR_CORE_ID: value = (uint64_t)core->core_id; break;
+                case CPU_SR_THREAD_ID: value = (uint64_t)core->thread_id; break;
+                default: return CPU_EXEC_FAULT;
+            }
+            core->regs.gpr[op->rd] = value;
+            return CPU_EXEC_NEXT;
+        case INST_MTSR:
+            switch (op->imm) {
+                case CPU_SR_PC:
+                    core->regs.pc = value;
+                    return CPU_EXEC_JUMP;
+                case CPU_SR_SP: core->regs.sp = value; break;
+                case CPU_SR_FP: core->regs.fp = value; break;
+                case CPU_SR_LR: core->regs.lr = value; break;
+                case CPU_SR_FLAGS:
+                    core->regs.flags = value;
+                    core->flags_op = CPU_FLAGS_NONE;
+                    break;
+                default: return CPU_EXEC_FAULT;  // Read-only or reserved
+            }
+            return CPU_EXEC_NEXT;
+        default:
+            return CPU_EXEC_FAULT;
+    }
+}
+
+// Upper Immediate Instruction Execution
+CPU_INLINE int cpu_execute_upper(cpu_core_t *core, instruction_type_t type, const cpu_op_t *op,
+                                 uint64_t pc) {
+    (void)pc;
+    if (type == INST_LUI) {
+        core->regs.gpr[op->rd] = ((uint64_t)(uint32_t)op->imm << 32) |
+                                 (core->regs.gpr[op->rd] & 0xFFFFFFFFULL);
+    } else {
+        core->regs.gpr[op->rd] = (uint64_t)(int64_t)op->imm;
+    }
+    return CPU_EXEC_NEXT;
+}
+
+// Undecodable encodings fault
+static inline int cpu_execute_invalid(cpu_core_t *core, instruction_type_t type,
+                                      const cpu_op_t *op, uint64_t pc) {
+    (void)core; (void)type; (void)op; (void)pc;
+    return CPU_EXEC_FAULT;
+}
+
+// Executes one predecoded instruction located at pc. One jump table over
+// all types, each case calling its handler from the ISA description with a
+// constant type; in the threaded handlers only that case remains.
+CPU_INLINE int cpu_execute_op(cpu_core_t *core, instruction_type_t type, const cpu_op_t *op,
+                              uint64_t pc) {
+    switch (type) {
+#define CPU_CASE(name, handler) \
+        case INST_##name: \
+            return cpu_execute_##handler(core, INST_##name, op, pc);
+        CPU_INSTRUCTIONS(CPU_CASE)
+#undef CPU_CASE
+        default:
+            return CPU_EXEC_FAULT;
+    }
+}
+
+// Main Instruction Execution: inst was fetched from regs.pc - 8
+static inline int cpu_execute_instruction(cpu_core_t *core, instruction_t *inst) {
+    instruction_type_t type;
+    cpu_op_t op;
+
+    if (cpu_decode_instruction(inst, &type) != 0) {
+        return -1;
+    }
+    cpu_operands(inst, type, &op);
+    return cpu_execute_op(core, type, &op, core->regs.pc - CPU_INST_BYTES) < 0 ? -1 : 0;
+}
+
+static inline void cpu_fault(cpu_core_t *core, uint64_t pc) {
+    core->regs.pc = pc;
+    core->state = CPU_FAULTED;
+}
+
+// Reference interpreter: one instruction through fetch, decode and execute
+static inline int cpu_step(cpu_core_t *core) {
+    uint64_t pc = core->regs.pc;
+    instruction_t inst;
+    instruction_type_t type;
+    cpu_op_t op;
+    int r;
+
+    if (cpu_fetch_instruction(core, pc, &inst) != 0 ||
+        cpu_decode_instruction(&inst, &type) != 0) {
+        cpu_fault(core, pc);
+        return -1;
+    }
+    cpu_operands(&inst, type, &op);
+    r = cpu_execute_op(core, type, &op, pc);
+    if (r == CPU_EXEC_FAULT) {
+        cpu_fault(core, pc);
+        return -1;
+    }
+    if (r != CPU_EXEC_RETRY) {
+        core->retired++;
+    }
+    return 0;
+}
+
+#include "cpu-jit.h"
+
+// Counts the sequences the instruction retired at pc (of the given type)
+// ends
+static inline void cpu_profile_record(cpu_profile_t *p, int core_id, uint64_t pc,
+                                      unsigned type) {
+    cpu_profile_history_t *h = &p->history[core_id];
+
+    p->instructions++;
+    if (h->n >= 1 && h->pc[0] + CPU_INST_BYTES == pc &&
+        !cpu_ends_block((instruction_type_t)h->type[0])) {
+        p->pairs[h->type[0]][type]++;
+        if (h->n >= 2 && h->pc[1] + CPU_INST_BYTES == h->pc[0] &&
+            !cpu_ends_block((instruction_type_t)h->type[1])) {
+            uint32_t key = 1u << 24 | (uint32_t)h->type[1] << 16 | (uint32_t)h->type[0] << 8 | type;
+            uint32_t slot = (key * 2654435761u) % CPU_PROFILE_TRIPLES;
+            for (int probe = 0; probe < CPU_PROFILE_TRIPLES; probe++) {
+                if (p->triples[slot].key == key || p->triples[slot].key == 0) {
+                    p->triples[slot].key = key;
+                    p->triples[slot].count++;
+                    break;
+                }
+                slot = (slot + 1) % CPU_PROFILE_TRIPLES;
+            }
+        }
+    }
+    h->pc[1] = h->pc[0];
+    h->type[1] = h->type[0];
+    h->pc[0] = pc;
+    h->type[0] = (uint8_t)type;
+    if (h->n < 2) h->n++;
+}
+
+static inline int cpu_run_switch(cpu_core_t *core, uint64_t budget) {
+    cpu_profile_t *profile = core->system->profile;
+
+    while (budget-- > 0 && core->state == CPU_RUNNING) {
+        uint64_t pc = core->regs.pc;
+        uint64_t retired = core->retired;
+        uint64_t word = 0;
+
+        if (profile) {
+            cpu_load64(core, pc, &word);
+        }
+        if (cpu_step(core) != 0) {
+            return -1;
+        }
+        if (profile && core->retired != retired) {
+            cpu_op_t op;
+            cpu_predecode(word, &op);
+            cpu_profile_record(profile, core->core_id, pc, op.type);
+        }
+    }
+    return 0;
+}
+
+// Predecoded ops with one dispatch per instruction. Outside the text and on
+// faults the reference interpreter takes over for the instruction.
+static inline int cpu_run_threaded(cpu_core_t *core, uint64_t budget) {
+    cpu_system_t *cpu = core->system;
+    const cpu_op_t *ops = cpu->decoded;
+    const uint64_t base = cpu->text_base;
+    const cpu_op_t *op;
+    uint64_t executed = 0;
+    int r = CPU_EXEC_NEXT;
+
+    for (;;) {
+        uint64_t pc = core->regs.pc;
+
+        if (budget == 0 || core->state != CPU_RUNNING) {
+            break;
+        }
+        if (!cpu_in_text(cpu, pc)) {
+            budget--;
+            if (cpu_step(core) != 0) {
+                core->retired += executed;
+                return -1;
+            }
+            continue;
+        }
+        op = ops + (pc - base) / CPU_INST_BYTES;
+
+#if CPU_HAVE_COMPUTED_GOTO
+#define CPU_LABEL(name, handler) &&cpu_op_##name,
+        static const void *const handlers[INST_COUNT] = { CPU_INSTRUCTIONS(CPU_LABEL) };
+#undef CPU_LABEL
+#define CPU_DISPATCH() \
+        do { \
+            if (budget == 0) goto out; \
+            budget--; \
+            goto *handlers[op->type]; \
+        } while (0)
+#define CPU_HANDLER(name, handler) \
+    cpu_op_##name: \
+        r = cpu_execute_op(core, INST_##name, op, base + (uint64_t)(op - ops) * CPU_INST_BYTES); \
+        if (r == CPU_EXEC_NEXT) { \
+            executed++; \
+            op++; \
+            CPU_DISPATCH(); \
+        } \
+        goto transfer;
+
+        CPU_DISPATCH();
+        CPU_INSTRUCTIONS(CPU_HANDLER)
+#undef CPU_HANDLER
+#undef CPU_DISPATCH
+#else
+        for (;;) {
+            if (budget == 0) goto out;
+            budget--;
+            r = cpu_execute_op(core, (instruction_type_t)op->type, op,
+                               base + (uint64_t)(op - ops) * CPU_INST_BYTES);
+            if (r != CPU_EXEC_NEXT) goto transfer;
+            executed++;
+            op++;
+        }
+#endif
+    out:
+        core->regs.pc = base + (uint64_t)(op - ops) * CPU_INST_BYTES;
+        break;
+    transfer:
+        if (r == CPU_EXEC_JUMP || r == CPU_EXEC_STOP) {
+            executed++;
+        } else if (r == CPU_EXEC_FAULT) {
+            // Let the reference report it (also covers the end-of-text sentinel)
+            core->regs.pc = base + (uint64_t)(op - ops) * CPU_INST_BYTES;
+            if (cpu_step(core) != 0) {
+                core->retired += executed;
+                return -1;
+            }
+        }
+    }
+    core->retired += executed;
+    return 0;
+}
+
+// Block for pc, predecoding it on first use
+static inline cpu_block_t *cpu_block_lookup(cpu_system_t *cpu, uint64_t pc) {
+    uint64_t index = (pc - cpu->text_base) / CPU_INST_BYTES;
+    cpu_block_t *block = &cpu->blocks[index];
+
+    if (block->count == 0) {
+        uint32_t n = 0;
+        while (index + n < cpu->text_count && n < CPU_MAX_BLOCK) {
+            if (cpu_ends_block((instruction_type_t)cpu->decoded[index + n++].type)) {
+                break;
+            }
+        }
+        // Cut before a superinstruction the length limit would split
+        for (uint32_t i = n > 2 ? n - 2 : 0; i < n; i++) {
+            if (i > 0 && i + cpu_fused_length(cpu->fused[index + i].type) > n) {
+                n = i;
+                break;
+            }
+        }
+        block->count = n;
+        block->index = (uint32_t)index;
+        block->pc = pc;
+        block->next[0] = block->next[1] = NULL;
+        block->code = NULL;
+        block->heat = 0;
+    }
+    return block;
+}
+
+// Predecoded basic blocks, chained: the budget is checked and the PC
+// written once per block, and superinstructions (CPU_FUSED_PAIRS/TRIPLES)
+// run adjacent instructions without dispatching in between. With jit set,
+// blocks that get hot are translated and run as host code from then on.
+static inline int cpu_run_block(cpu_core_t *core, uint64_t budget, int jit) {
+    cpu_system_t *cpu = core->system;
+    cpu_block_t *block = NULL;
+    const cpu_op_t *ops, *op, *last;
+    uint64_t executed = 0;
+    uint64_t block_pc;
+    int taken = 0;
+    int r = CPU_EXEC_NEXT;
+
+#if CPU_HAVE_COMPUTED_GOTO
+    const cpu_op_t *text = cpu->fused;
+#define CPU_LABEL(name, handler) &&cpu_block_##name,
+#define CPU_LABEL3(a, b, c) &&cpu_block_##a##_##b##_##c,
+#define CPU_LABEL2(a, b) &&cpu_block_##a##_##b,
+    static const void *const handlers[INST_FUSED_END] = {
+        CPU_INSTRUCTIONS(CPU_LABEL)
+        CPU_FUSED_TRIPLES(CPU_LABEL3)
+        CPU_FUSED_PAIRS(CPU_LABEL2)
+    };
+#undef CPU_LABEL
+#undef CPU_LABEL3
+#undef CPU_LABEL2
+#else
+    const cpu_op_t *text = cpu->decoded;
+#endif
+
+    while (budget > 0 && core->state == CPU_RUNNING) {
+        uint64_t pc = core->regs.pc;
+        cpu_block_t *next;
+
+        if (jit && cpu->jit.flush) {
+            cpu_jit_flush(cpu);
+            block = NULL;
+        }
+
+        if (!cpu_in_text(cpu, pc)) {
+            budget--;
+            block = NULL;
+            if (cpu_step(core) != 0) {
+                core->retired += executed;
+                return -1;
+            }
+            continue;
+        }
+        next = block ? block->next[taken] : core->next_block;
+        if (!next || next->pc != pc || next->count == 0) {
+            next = cpu_block_lookup(cpu, pc);
+            if (block) {
+                block->next[taken] = next;
+            }
+        }
+        block = next;
+        if (block->count > budget) {
+            // Finish the budget one instruction at a time
+            budget--;
+            block = NULL;
+            if (cpu_step(core) != 0) {
+                core->retired += executed;
+                return -1;
+            }
+            continue;
+        }
+
+        if (jit) {
+            if (!block->code && block->heat < CPU_JIT_THRESHOLD &&
+                ++block->heat == CPU_JIT_THRESHOLD) {
+                cpu_jit_translate(cpu, block);
+            }
+            if (block->code) {
+                cpu_jit_frame_t frame = { budget, 0 };
+
+                r = cpu_jit_enter(core, block->code, &frame);
+                executed += frame.executed;
+                budget = frame.budget;
+                block = NULL;
+                if (r == CPU_EXEC_FAULT && cpu_step(core) != 0) {
+                    core->retired += executed;
+                    return -1;
+                }
+                continue;
+            }
+        }
+
+        ops = text + block->index;
+        last = ops + block->count - 1;
+        op = ops;
+        block_pc = block->pc;
+
+#if CPU_HAVE_COMPUTED_GOTO
+#define CPU_EXECUTE(name) \
+        r = cpu_execute_op(core, INST_##name, op, \
+                           block_pc + (uint64_t)(op - ops) * CPU_INST_BYTES); \
+        if (r != CPU_EXEC_NEXT) goto exit;
+#define CPU_NEXT() \
+        if (op == last) goto done; \
+        op++; \
+        goto *handlers[op->type];
+#define CPU_HANDLER(name, handler) \
+    cpu_block_##name: \
+        CPU_EXECUTE(name) \
+        CPU_NEXT()
+#define CPU_HANDLER3(a, b, c) \
+    cpu_block_##a##_##b##_##c: \
+        cpu->fused_hits[INST_##a##_##b##_##c - INST_COUNT]++; \
+        CPU_EXECUTE(a) \
+        op++; \
+        CPU_EXECUTE(b) \
+        op++; \
+        CPU_EXECUTE(c) \
+        CPU_NEXT()
+#define CPU_HANDLER2(a, b) \
+    cpu_block_##a##_##b: \
+        cpu->fused_hits[INST_##a##_##b - INST_COUNT]++; \
+        CPU_EXECUTE(a) \
+        op++; \
+        CPU_EXECUTE(b) \
+        CPU_NEXT()
+
+        goto *handlers[op->type];
+        CPU_INSTRUCTIONS(CPU_HANDLER)
+        CPU_FUSED_TRIPLES(CPU_HANDLER3)
+        CPU_FUSED_PAIRS(CPU_HANDLER2)
+#undef CPU_HANDLER
+#undef CPU_HANDLER3
+#undef CPU_HANDLER2
+#undef CPU_NEXT
+#undef CPU_EXECUTE
+#else
+        for (;;) {
+            r = cpu_execute_op(core, (instruction_type_t)op->type, op,
+                               block_pc + (uint64_t)(op - ops) * CPU_INST_BYTES);
+            if (r != CPU_EXEC_NEXT) goto exit;
+            if (op == last) goto done;
+            op++;
+        }
+#endif
+    done:
+        // Ran off the end: fall through to the next block
+        executed += block->count;
+        budget -= block->count;
+        core->regs.pc = block_pc + (uint64_t)block->count * CPU_INST_BYTES;
+        taken = 0;
+        continue;
+    exit:
+        executed += (uint64_t)(op - ops);
+        budget -= (uint64_t)(op - ops) + 1;
+        taken = 1;
+        if (r == CPU_EXEC_FAULT) {
+            core->regs.pc = block_pc + (uint64_t)(op - ops) * CPU_INST_BYTES;
+            block = NULL;
+            if (cpu_step(core) != 0) {
+                core->retired += executed;
+                return -1;
+            }
+            continue;
+        }
+        if (r != CPU_EXEC_RETRY) {
+            executed++;
+        }
+        if (r != CPU_EXEC_JUMP) {
+            block = NULL;
+        }
+    }
+    // The next quantum resumes the chain where this one stopped
+    core->next_block = block ? block->next[taken] : NULL;
+    core->retired += executed;
+    return 0;
+}
+
+static inline int cpu_run_core(cpu_core_t *core, cpu_mode_t mode, uint64_t budget) {
+    int r;
+
+    switch (mode) {
+        case CPU_MODE_THREADED:
+            r = cpu_run_threaded(core, budget);
+            break;
+        case CPU_MODE_BLOCK:
+            r = cpu_run_block(core, budget, 0);
+            break;
+        case CPU_MODE_JIT:
+            r = cpu_run_block(core, budget, 1);
+            break;
+        default:
+            r = cpu_run_switch(core, budget);
+            break;
+    }
+    // regs.flags is architectural again between quanta
+    cpu_flags(core);
+    return r;
+}
+
+// Runs all cores round-robin until every core halts or max_instructions have
+// retired in total, stopping at the sample points of an attached sampler.
+// Returns -1 when a core faults or the cores deadlock.
+static inline int cpu_run(cpu_system_t *cpu, cpu_mode_t mode, uint64_t max_instructions) {
+    uint64_t retired = 0;
+
+    while (retired < max_instructions) {
+        int active = 0;
+        uint64_t progress = 0;
+
+        for (int i = 0; i < cpu->num_cores; i++) {
+            cpu_core_t *core = &cpu->cores[i];
+            if (core->state == CPU_BARRIER &&
+                core->barrier_generation != cpu->barrier_generation) {
+                core->state = CPU_RUNNING;
+            } else if (core->state == CPU_WAITING) {
+                core->state = CPU_RUNNING;
+            }
+            if (core->state == CPU_RUNNING || core->state == CPU_BARRIER) {
+                active++;
+            }
+        }
+        if (active == 0) {
+            return 0;
+        }
+        for (int i = 0; i < cpu->num_cores && retired + progress < max_instructions; i++) {
+            cpu_core_t *core = &cpu->cores[i];
+            uint64_t before = core->retired;
+            uint64_t quantum = max_instructions - retired - progress;
+
+            if (core->state != CPU_RUNNING) {
+                continue;
+            }
+            if (active > 1 && quantum > CPU_QUANTUM) {
+                quantum = CPU_QUANTUM;
+            }
+            if (cpu->sampler && quantum > cpu->sampler->next[i] - core->retired) {
+                quantum = cpu->sampler->next[i] - core->retired;
+            }
+            if (cpu_run_core(core, mode, quantum) != 0) {
+                return -1;
+            }
+            if (cpu->sampler && core->retired >= cpu->sampler->next[i]) {
+                cpu->sampler->sample(cpu->sampler, core);
+                cpu->sampler->next[i] = core->retired + cpu->sampler->period;
+            }
+            progress += core->retired - before;
+        }
+        if (progress == 0) {
+            return -1;  // Everyone parked on a barrier or lock nobody releases
+        }
+        retired += progress;
+    }
+    return 0;
+}
+
+static inline int cpu_halted(const cpu_system_t *cpu) {
+    for (int i = 0; i < cpu->num_cores; i++) {
+        if (cpu->cores[i].state != CPU_HALTED) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static inline uint64_t cpu_retired(const cpu_system_t *cpu) {
+    uint64_t total = 0;
+    for (int i = 0; i < cpu->num_cores; i++) {
+        total += cpu->cores[i].retired;
+    }
+    return total;
+}
+
+// Sequence profiling
+// ==================
+
+// One profiled sequence: 2 or 3 instruction types
+typedef struct {
+    uint8_t type[3];
+    int length;
+    uint64_t count;
+} cpu_sequence_t;
+
+// Runs the system in the switch engine like cpu_run, counting the adjacent
+// pairs and triples it retires into profile (accumulating across calls)
+static inline int cpu_profile_sequences(cpu_system_t *cpu, uint64_t max_instructions,
+                                        cpu_profile_t *profile) {
+    int r;
+
+    for (int i = 0; i < MAX_CORES; i++) {
+        profile->history[i].n = 0;
+    }
+    cpu->profile = profile;
+    r = cpu_run(cpu, CPU_MODE_SWITCH, max_instructions);
+    cpu->profile = NULL;
+    return r;
+}
+
+static inline int cpu_sequence_compare(const void *a, const void *b) {
+    uint64_t x = ((const cpu_sequence_t *)a)->count;
+    uint64_t y = ((const cpu_sequence_t *)b)->count;
+    return x < y ? 1 : x > y ? -1 : 0;
+}
+
+// The max most frequent sequences of the given length (2 or 3), most
+// frequent first. Returns how many were stored.
+static inline size_t cpu_profile_top(const cpu_profile_t *profile, int length,
+                                     cpu_sequence_t *out, size_t max) {
+    size_t n = 0;
+    cpu_sequence_t *all;
+    size_t capacity = length == 2 ? (size_t)INST_COUNT * INST_COUNT : CPU_PROFILE_TRIPLES;
+
+    all = malloc(capacity * sizeof(cpu_sequence_t));
+    if (!all) {
+        return 0;
+    }
+    if (length == 2) {
+        for (int a = 0; a < INST_COUNT; a++) {
+            for (int b = 0; b < INST_COUNT; b++) {
+                if (profile->pairs[a][b]) {
+                    cpu_sequence_t s = { { (uint8_t)a, (uint8_t)b, 0 }, 2, profile->pairs[a][b] };
+                    all[n++] = s;
+                }
+            }
+        }
+    } else {
+        for (int i = 0; i < CPU_PROFILE_TRIPLES; i++) {
+            uint32_t key = profile->triples[i].key;
+            if (key) {
+                cpu_sequence_t s = { { (uint8_t)(key >> 16), (uint8_t)(key >> 8), (uint8_t)key },
+                                     3, profile->triples[i].count };
+                all[n++] = s;
+            }
+        }
+    }
+    qsort(all, n, sizeof(cpu_sequence_t), cpu_sequence_compare);
+    if (n > max) {
+        n = max;
+    }
+    memcpy(out, all, n * sizeof(cpu_sequence_t));
+    free(all);
+    return n;
+}
+
+#endif // ALPHAAHB_CPU_SIMULATOR_H
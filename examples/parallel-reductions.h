@@ -0,0 +1,260 @@
+/*
+ * AlphaAHB V5 Deterministic Parallel Reductions
+ *
+ * Parallel sums that return bit-identical results for any thread count.
+ *
+ * Binned kernels (preduce_sum_*, preduce_column_sums_f32) cut the input into
+ * fixed PREDUCE_CHUNK-element bins whose boundaries depend only on n. Each bin
+ * is reduced with the lane kernels from reduction-kernels.h, the per-bin
+ * partials are stored by bin index, and the partials are combined with a
+ * pairwise tree whose shape also depends only on n. Threads merely decide who
+ * computes which bins, so the floating-point operation order never changes.
+ *
+ * Exact kernels (preduce_sum_exact_*, preduce_dot_exact_f32) give every
+ * worker its own long accumulator; merging long accumulators is exact, so the
+ * correctly rounded result is independent of the partition as well as of
+ * the thread count. They are slower per element but also agree with the
+ * sequential reduce_*_exact_* kernels bit for bit.
+ */
+
+#ifndef ALPHAAHB_PARALLEL_REDUCTIONS_H
+#define ALPHAAHB_PARALLEL_REDUCTIONS_H
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "reduction-kernels.h"
+#include "parallel-runtime.h"
+
+// Elements per bin: 16 KB of floats, large enough to amortize the partials
+#define PREDUCE_CHUNK 4096
+
+// Rows per bin for column reductions over a row-major record matrix
+#define PREDUCE_ROW_CHUNK 1024
+
+typedef struct {
+    const void *x;
+    const void *y;
+    size_t n;
+    double *partials;
+    reduce_exact_t *exact;
+} preduce_ctx_t;
+
+static inline void preduce_bins_f32(size_t begin, size_t end, int tid, void *arg) {
+    preduce_ctx_t *ctx = (preduce_ctx_t *)arg;
+    const float *x = (const float *)ctx->x;
+    (void)tid;
+
+    for (size_t bin = begin; bin < end; bin++) {
+        size_t first = bin * PREDUCE_CHUNK;
+        size_t count = ctx->n - first < PREDUCE_CHUNK ? ctx->n - first : PREDUCE_CHUNK;
+        ctx->partials[bin] = reduce_sum_widen_f32(x + first, count);
+    }
+}
+
+static inline void preduce_bins_f64(size_t begin, size_t end, int tid, void *arg) {
+    preduce_ctx_t *ctx = (preduce_ctx_t *)arg;
+    const double *x = (const double *)ctx->x;
+    (void)tid;
+
+    for (size_t bin = begin; bin < end; bin++) {
+        size_t first = bin * PREDUCE_CHUNK;
+        size_t count = ctx->n - first < PREDUCE_CHUNK ? ctx->n - first : PREDUCE_CHUNK;
+        ctx->partials[bin] = reduce_sum_f64(x + first, count);
+    }
+}
+
+// Binned result of bins bins from first, computed on the calling thread
+// when the partials cannot be allocated: walks the same pairwise tree as
+// reduce_sum_pairwise_f64 and fills each leaf's partials on the stack, so
+// the sum matches the parallel kernel bit for bit
+static inline double preduce_serial(const preduce_ctx_t *ctx, size_t elem_size,
+                                    parallel_body_t body, size_t first, size_t bins) {
+    if (bins <= REDUCE_PAIRWISE_BLOCK) {
+        double partials[REDUCE_PAIRWISE_BLOCK];
+        size_t skip = first * PREDUCE_CHUNK;
+        preduce_ctx_t leaf = { (const char *)ctx->x + skip * elem_size, NULL, ctx->n - skip,
+                               partials, NULL };
+        body(0, bins, 0, &leaf);
+        return reduce_sum_f64(partials, bins);
+    }
+    size_t half = ((bins / REDUCE_PAIRWISE_BLOCK + 1) / 2) * REDUCE_PAIRWISE_BLOCK;
+    return preduce_serial(ctx, elem_size, body, first, half) +
+           preduce_serial(ctx, elem_size, body, first + half, bins - half);
+}
+
+// Binned sum of floats: double partials, pairwise combine, deterministic
+static inline double preduce_sum_f32(const float *x, size_t n, int num_threads) {
+    size_t bins = (n + PREDUCE_CHUNK - 1) / PREDUCE_CHUNK;
+    preduce_ctx_t ctx = { x, NULL, n, NULL, NULL };
+    double result;
+
+    if (bins <= 1) {
+        return reduce_sum_widen_f32(x, n);
+    }
+    ctx.partials = malloc(bins * sizeof(double));
+    if (!ctx.partials) {
+        return preduce_serial(&ctx, sizeof(float), preduce_bins_f32, 0, bins);
+    }
+    parallel_for(0, bins, 1, num_threads, preduce_bins_f32, &ctx);
+    result = reduce_sum_pairwise_f64(ctx.partials, bins);
+    free(ctx.partials);
+    return result;
+}
+
+static inline double preduce_sum_f64(const double *x, size_t n, int num_threads) {
+    size_t bins = (n + PREDUCE_CHUNK - 1) / PREDUCE_CHUNK;
+    preduce_ctx_t ctx = { x, NULL, n, NULL, NULL };
+    double result;
+
+    if (bins <= 1) {
+        return reduce_sum_f64(x, n);
+    }
+    ctx.partials = malloc(bins * sizeof(double));
+    if (!ctx.partials) {
+        return preduce_serial(&ctx, sizeof(double), preduce_bins_f64, 0, bins);
+    }
+    parallel_for(0, bins, 1, num_threads, preduce_bins_f64, &ctx);
+    result = reduce_sum_pairwise_f64(ctx.partials, bins);
+    free(ctx.partials);
+    return result;
+}
+
+// Exact kernels: one long accumulator per worker, merged exactly
+static inline void preduce_exact_f32(size_t begin, size_t end, int tid, void *arg) {
+    preduce_ctx_t *ctx = (preduce_ctx_t *)arg;
+    const float *x = (const float *)ctx->x;
+    reduce_exact_t *acc = &ctx->exact[tid];
+
+    for (size_t i = begin; i < end; i++) {
+        reduce_exact_add(acc, (double)x[i]);
+    }
+}
+
+static inline void preduce_exact_f64(size_t begin, size_t end, int tid, void *arg) {
+    preduce_ctx_t *ctx = (preduce_ctx_t *)arg;
+    const double *x = (const double *)ctx->x;
+    reduce_exact_t *acc = &ctx->exact[tid];
+
+    for (size_t i = begin; i < end; i++) {
+        reduce_exact_add(acc, x[i]);
+    }
+}
+
+static inline void preduce_exact_dot_f32(size_t begin, size_t end, int tid, void *arg) {
+    preduce_ctx_t *ctx = (preduce_ctx_t *)arg;
+    const float *a = (const float *)ctx->x;
+    const float *b = (const float *)ctx->y;
+    reduce_exact_t *acc = &ctx->exact[tid];
+
+    for (size_t i = begin; i < end; i++) {
+        reduce_exact_add(acc, (double)a[i] * (double)b[i]);
+    }
+}
+
+static inline double preduce_exact_run(preduce_ctx_t *ctx, parallel_body_t body,
+                                       int num_threads) {
+    reduce_exact_t acc[PARALLEL_MAX_THREADS];
+    int used;
+
+    if (num_threads <= 0) {
+        num_threads = parallel_default_threads();
+    }
+    if (num_threads > PARALLEL_MAX_THREADS) {
+        num_threads = PARALLEL_MAX_THREADS;
+    }
+    for (int t = 0; t < num_threads; t++) {
+        reduce_exact_init(&acc[t]);
+    }
+    ctx->exact = acc;
+    used = parallel_for(0, ctx->n, PREDUCE_CHUNK, num_threads, body, ctx);
+    for (int t = 1; t < used; t++) {
+        reduce_exact_merge(&acc[0], &acc[t]);
+    }
+    return reduce_exact_value(&acc[0]);
+}
+
+static inline double preduce_sum_exact_f32(const float *x, size_t n, int num_threads) {
+    preduce_ctx_t ctx = { x, NULL, n, NULL, NULL };
+    return preduce_exact_run(&ctx, preduce_exact_f32, num_threads);
+}
+
+static inline double preduce_sum_exact_f64(const double *x, size_t n, int num_threads) {
+    preduce_ctx_t ctx = { x, NULL, n, NULL, NULL };
+    return preduce_exact_run(&ctx, preduce_exact_f64, num_threads);
+}
+
+static inline double preduce_dot_exact_f32(const float *a, const float *b, size_t n,
+                                           int num_threads) {
+    preduce_ctx_t ctx = { a, b, n, NULL, NULL };
+    return preduce_exact_run(&ctx, preduce_exact_dot_f32, num_threads);
+}
+
+// Column sums over a row-major records x features matrix (the layout used by
+// data_analytics_example). Row bins are fixed at PREDUCE_ROW_CHUNK rows.
+typedef struct {
+    const float *data;
+    size_t rows;
+    size_t cols;
+    double *partials;  // bins x cols
+} preduce_columns_ctx_t;
+
+static inline void preduce_column_bins(size_t begin, size_t end, int tid, void *arg) {
+    preduce_columns_ctx_t *ctx = (preduce_columns_ctx_t *)arg;
+    (void)tid;
+
+    for (size_t bin = begin; bin < end; bin++) {
+        size_t first = bin * PREDUCE_ROW_CHUNK;
+        size_t last = first + PREDUCE_ROW_CHUNK < ctx->rows ? first + PREDUCE_ROW_CHUNK : ctx->rows;
+        double *out = &ctx->partials[bin * ctx->cols];
+
+        for (size_t c = 0; c < ctx->cols; c++) {
+            out[c] = 0.0;
+        }
+        // Row-by-row accumulation vectorizes across the feature columns
+        for (size_t r = first; r < last; r++) {
+            const float *row = &ctx->data[r * ctx->cols];
+            for (size_t c = 0; c < ctx->cols; c++) {
+                out[c] += (double)row[c];
+            }
+        }
+    }
+}
+
+// Writes cols sums to out; returns 0 on success, -1 on allocation failure
+static inline int preduce_column_sums_f32(const float *data, size_t rows, size_t cols,
+                                          double *out, int num_threads) {
+    size_t bins = (rows + PREDUCE_ROW_CHUNK - 1) / PREDUCE_ROW_CHUNK;
+    preduce_columns_ctx_t ctx = { data, rows, cols, NULL };
+    double *column;
+
+    if (bins == 0) {
+        for (size_t c = 0; c < cols; c++) {
+            out[c] = 0.0;
+        }
+        return 0;
+    }
+    ctx.partials = malloc(bins * cols * sizeof(double));
+    column = malloc(bins * sizeof(double));
+    if (!ctx.partials || !column) {
+        free(ctx.partials);
+        free(column);
+        return -1;
+    }
+
+    parallel_for(0, bins, 1, num_threads, preduce_column_bins, &ctx);
+
+    // Combine bins per column with the same n-dependent pairwise tree
+    for (size_t c = 0; c < cols; c++) {
+        for (size_t b = 0; b < bins; b++) {
+            column[b] = ctx.partials[b * cols + c];
+        }
+        out[c] = reduce_sum_pairwise_f64(column, bins);
+    }
+
+    free(ctx.partials);
+    free(column);
+    return 0;
+}
+
+#endif // ALPHAAHB_PARALLEL_REDUCTIONS_H
@@ -0,0 +1,141 @@
+/*
+ * AlphaAHB V5 Parallel Runtime
+ *
+ * Minimal fork/join runtime used by the MIMD examples: a static-partition
+ * parallel-for over an index range. Partitioning is contiguous and aligned
+ * to a caller-supplied grain so kernels can keep their per-chunk work
+ * independent of the thread count.
+ *
+ * Built with -fopenmp, ranges run on the OpenMP runtime's persistent worker
+ * pool, so back-to-back calls (one per frame or per timestep) do not pay for
+ * thread creation. Otherwise each call forks and joins POSIX threads. Both
+ * backends produce the same partitions and worker ids.
+ *
+ * Requires _POSIX_C_SOURCE >= 200809L. Link with -pthread (and -fopenmp for
+ * the pooled backend).
+ */
+
+#ifndef ALPHAAHB_PARALLEL_RUNTIME_H
+#define ALPHAAHB_PARALLEL_RUNTIME_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Upper bound on worker threads (matches 64 cores of the AlphaAHB V5 SoC)
+#define PARALLEL_MAX_THREADS 64
+
+// Range body: processes [begin, end) on worker `tid`
+typedef void (*parallel_body_t)(size_t begin, size_t end, int tid, void *ctx);
+
+typedef struct {
+    parallel_body_t body;
+    void *ctx;
+    size_t begin;
+    size_t end;
+    int tid;
+} parallel_task_t;
+
+// Default worker count: ALPHAAHB_NUM_THREADS, else the online CPU count
+static inline int parallel_default_threads(void) {
+    const char *env = getenv("ALPHAAHB_NUM_THREADS");
+    long n = env ? strtol(env, NULL, 10) : sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (n < 1) {
+        n = 1;
+    }
+    if (n > PARALLEL_MAX_THREADS) {
+        n = PARALLEL_MAX_THREADS;
+    }
+    return (int)n;
+}
+
+// Wall-clock seconds for timing parallel regions (clock() would sum CPU
+// time over all threads)
+static inline double parallel_wall_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static inline void *parallel_task_entry(void *arg) {
+    parallel_task_t *task = (parallel_task_t *)arg;
+    task->body(task->begin, task->end, task->tid, task->ctx);
+    return NULL;
+}
+
+// Run body over [begin, end) split into num_threads contiguous ranges whose
+// boundaries are multiples of grain (relative to begin). num_threads <= 0
+// selects parallel_default_threads(). Returns the number of workers used.
+static inline int parallel_for(size_t begin, size_t end, size_t grain, int num_threads,
+                               parallel_body_t body, void *ctx) {
+    parallel_task_t tasks[PARALLEL_MAX_THREADS];
+
+    if (end <= begin) {
+        return 0;
+    }
+    if (grain == 0) {
+        grain = 1;
+    }
+    if (num_threads <= 0) {
+        num_threads = parallel_default_threads();
+    }
+    if (num_threads > PARALLEL_MAX_THREADS) {
+        num_threads = PARALLEL_MAX_THREADS;
+    }
+
+    size_t chunks = (end - begin + grain - 1) / grain;
+    if ((size_t)num_threads > chunks) {
+        num_threads = (int)chunks;
+    }
+
+    for (int t = 0; t < num_threads; t++) {
+        size_t first = chunks * t / num_threads;
+        size_t last = chunks * (t + 1) / num_threads;
+        tasks[t].body = body;
+        tasks[t].ctx = ctx;
+        tasks[t].tid = t;
+        tasks[t].begin = begin + first * grain;
+        tasks[t].end = begin + last * grain;
+        if (tasks[t].end > end) {
+            tasks[t].end = end;
+        }
+    }
+
+#ifdef _OPENMP
+    // The master thread is worker 0; if the runtime grants fewer threads than
+    // requested, each runs several ranges so every worker id is still used
+    #pragma omp parallel num_threads(num_threads)
+    {
+        for (int t = omp_get_thread_num(); t < num_threads; t += omp_get_num_threads()) {
+            parallel_task_entry(&tasks[t]);
+        }
+    }
+#else
+    pthread_t threads[PARALLEL_MAX_THREADS];
+    int started[PARALLEL_MAX_THREADS];
+
+    // Worker 0 runs on the calling thread; fall back to it if spawning fails
+    for (int t = 1; t < num_threads; t++) {
+        started[t] = pthread_create(&threads[t], NULL, parallel_task_entry, &tasks[t]) == 0;
+    }
+    parallel_task_entry(&tasks[0]);
+    for (int t = 1; t < num_threads; t++) {
+        if (started[t]) {
+            pthread_join(threads[t], NULL);
+        } else {
+            parallel_task_entry(&tasks[t]);
+        }
+    }
+#endif
+
+    return num_threads;
+}
+
+#endif // ALPHAAHB_PARALLEL_RUNTIME_H
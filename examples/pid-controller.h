@@ -0,0 +1,256 @@
+/*
+ * AlphaAHB V5 Batched PID Controller
+ *
+ * Structure-of-arrays PID bank: thousands of independent control channels
+ * updated together once per tick. Every per-channel parameter and state
+ * lives in its own 64-byte aligned array padded to PID_LANES channels, so
+ * the update loops run whole 16-lane blocks and vectorize.
+ *
+ * Per channel and tick, with e = setpoint - measurement:
+ *
+ *   candidate = I + ki_dt * e            integral term (already scaled by ki)
+ *   u         = kp * e + candidate + kd_dt * (e - prev_e)
+ *   output    = min(max(u, out_min), out_max)
+ *   I         = candidate, unless u saturates in the direction e pushes
+ *
+ * The last line is conditional-integration anti-windup: the integrator
+ * holds while the actuator is saturated and the error would drive it
+ * further, and unwinds as soon as the error changes sign. Saturation and
+ * the hold use selects, not branches. Gains are stored premultiplied by the
+ * sample period (ki_dt = ki * dt, kd_dt = kd / dt) and ki must be >= 0.
+ *
+ * pid_bank_f32_t runs in single precision. pid_bank_q16_t is the same
+ * controller in fixed point for targets without an FPU: Q16.16 signals and
+ * state, Q16.16 kp and kd_dt, and Q8.24 ki_dt (ki * dt is small), with
+ * 64-bit intermediate products saturated back to 32 bits. It is
+ * bit-exact across hosts.
+ */
+
+#ifndef ALPHAAHB_PID_CONTROLLER_H
+#define ALPHAAHB_PID_CONTROLLER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Channels per block (one 512-bit vector of 32-bit lanes)
+#define PID_LANES 16
+#define PID_ALIGN 64
+
+// Fixed-point formats
+#define PID_Q 16            // Signals, state, kp, kd_dt
+#define PID_Q_INTEGRAL 24   // ki_dt
+
+typedef struct {
+    size_t channels;
+    size_t capacity;        // channels rounded up to a multiple of PID_LANES
+    float *kp;
+    float *ki_dt;
+    float *kd_dt;
+    float *out_min;
+    float *out_max;
+    float *integral;
+    float *prev_error;
+} pid_bank_f32_t;
+
+typedef struct {
+    size_t channels;
+    size_t capacity;
+    int32_t *kp;            // Q16.16
+    int32_t *ki_dt;         // Q8.24
+    int32_t *kd_dt;         // Q16.16
+    int32_t *out_min;       // Q16.16
+    int32_t *out_max;       // Q16.16
+    int32_t *integral;      // Q16.16
+    int32_t *prev_error;    // Q16.16
+} pid_bank_q16_t;
+
+static inline void *pid_alloc(size_t capacity) {
+    void *p = NULL;
+    if (posix_memalign(&p, PID_ALIGN, capacity * sizeof(int32_t)) != 0) {
+        return NULL;
+    }
+    memset(p, 0, capacity * sizeof(int32_t));
+    return p;
+}
+
+static inline int32_t pid_to_q(double v, int q) {
+    double scaled = v * (double)((int64_t)1 << q);
+    scaled = scaled < (double)INT32_MIN ? (double)INT32_MIN : scaled;
+    scaled = scaled > (double)INT32_MAX ? (double)INT32_MAX : scaled;
+    return (int32_t)(scaled < 0 ? scaled - 0.5 : scaled + 0.5);
+}
+
+static inline double pid_from_q(int32_t v, int q) {
+    return (double)v / (double)((int64_t)1 << q);
+}
+
+// Float bank
+// ==========
+
+static inline void pid_bank_f32_free(pid_bank_f32_t *b) {
+    free(b->kp);
+    free(b->ki_dt);
+    free(b->kd_dt);
+    free(b->out_min);
+    free(b->out_max);
+    free(b->integral);
+    free(b->prev_error);
+    memset(b, 0, sizeof(*b));
+}
+
+// Every channel gets the same gains and limits; change them per channel
+// through the arrays. Returns 0 on success, -1 on allocation failure.
+static inline int pid_bank_f32_init(pid_bank_f32_t *b, size_t channels, float kp, float ki,
+                                    float kd, float dt, float out_min, float out_max) {
+    memset(b, 0, sizeof(*b));
+    b->channels = channels;
+    b->capacity = (channels + PID_LANES - 1) / PID_LANES * PID_LANES;
+    size_t alloc = b->capacity ? b->capacity : PID_LANES;
+    b->kp = pid_alloc(alloc);
+    b->ki_dt = pid_alloc(alloc);
+    b->kd_dt = pid_alloc(alloc);
+    b->out_min = pid_alloc(alloc);
+    b->out_max = pid_alloc(alloc);
+    b->integral = pid_alloc(alloc);
+    b->prev_error = pid_alloc(alloc);
+    if (!b->kp || !b->ki_dt || !b->kd_dt || !b->out_min || !b->out_max || !b->integral ||
+        !b->prev_error) {
+        pid_bank_f32_free(b);
+        return -1;
+    }
+    for (size_t c = 0; c < b->capacity; c++) {
+        b->kp[c] = kp;
+        b->ki_dt[c] = ki * dt;
+        b->kd_dt[c] = kd / dt;
+        b->out_min[c] = out_min;
+        b->out_max[c] = out_max;
+    }
+    return 0;
+}
+
+// Kernel over capacity channels. The restrict parameters (not locals) let the
+// compiler prove the arrays disjoint and vectorize each 16-lane block; the
+// integrator hold is a chain of selects so it if-converts into blends.
+static inline void pid_kernel_f32(size_t capacity, const float *restrict kp,
+                                  const float *restrict ki_dt, const float *restrict kd_dt,
+                                  const float *restrict lo, const float *restrict hi,
+                                  float *restrict integral, float *restrict prev,
+                                  const float *restrict sp, const float *restrict pv,
+                                  float *restrict out) {
+    for (size_t blk = 0; blk < capacity; blk += PID_LANES) {
+        for (int l = 0; l < PID_LANES; l++) {
+            size_t c = blk + l;
+            float i = integral[c];
+            float e = sp[c] - pv[c];
+            float candidate = i + ki_dt[c] * e;
+            float u = kp[c] * e + candidate + kd_dt[c] * (e - prev[c]);
+            // Hold the integrator when saturated in the direction of e
+            float held_lo = e < 0.0f ? i : candidate;
+            float held_hi = e > 0.0f ? i : candidate;
+            float next = u < lo[c] ? held_lo : candidate;
+            float raised = u < lo[c] ? lo[c] : u;
+            integral[c] = u > hi[c] ? held_hi : next;
+            out[c] = raised > hi[c] ? hi[c] : raised;
+            prev[c] = e;
+        }
+    }
+}
+
+// One tick for every channel. setpoint, measurement and output hold
+// capacity entries (padding lanes are computed and ignored).
+static inline void pid_update_f32(pid_bank_f32_t *b, const float *setpoint,
+                                  const float *measurement, float *output) {
+    pid_kernel_f32(b->capacity, b->kp, b->ki_dt, b->kd_dt, b->out_min, b->out_max,
+                   b->integral, b->prev_error, setpoint, measurement, output);
+}
+
+// Fixed-point bank
+// ================
+
+static inline void pid_bank_q16_free(pid_bank_q16_t *b) {
+    free(b->kp);
+    free(b->ki_dt);
+    free(b->kd_dt);
+    free(b->out_min);
+    free(b->out_max);
+    free(b->integral);
+    free(b->prev_error);
+    memset(b, 0, sizeof(*b));
+}
+
+static inline int pid_bank_q16_init(pid_bank_q16_t *b, size_t channels, double kp, double ki,
+                                    double kd, double dt, double out_min, double out_max) {
+    memset(b, 0, sizeof(*b));
+    b->channels = channels;
+    b->capacity = (channels + PID_LANES - 1) / PID_LANES * PID_LANES;
+    size_t alloc = b->capacity ? b->capacity : PID_LANES;
+    b->kp = pid_alloc(alloc);
+    b->ki_dt = pid_alloc(alloc);
+    b->kd_dt = pid_alloc(alloc);
+    b->out_min = pid_alloc(alloc);
+    b->out_max = pid_alloc(alloc);
+    b->integral = pid_alloc(alloc);
+    b->prev_error = pid_alloc(alloc);
+    if (!b->kp || !b->ki_dt || !b->kd_dt || !b->out_min || !b->out_max || !b->integral ||
+        !b->prev_error) {
+        pid_bank_q16_free(b);
+        return -1;
+    }
+    for (size_t c = 0; c < b->capacity; c++) {
+        b->kp[c] = pid_to_q(kp, PID_Q);
+        b->ki_dt[c] = pid_to_q(ki * dt, PID_Q_INTEGRAL);
+        b->kd_dt[c] = pid_to_q(kd / dt, PID_Q);
+        b->out_min[c] = pid_to_q(out_min, PID_Q);
+        b->out_max[c] = pid_to_q(out_max, PID_Q);
+    }
+    return 0;
+}
+
+static inline int64_t pid_saturate_q(int64_t v) {
+    v = v < INT32_MIN ? INT32_MIN : v;
+    return v > INT32_MAX ? INT32_MAX : v;
+}
+
+// Fixed-point kernel. Products round to nearest (half an LSB is added before
+// the arithmetic shift). The 64-bit lane multiplies vectorize on targets that
+// have them (AVX-512DQ); on the x86-64 baseline the loop runs scalar, as it
+// would on an FPU-less core.
+static inline void pid_kernel_q16(size_t capacity, const int32_t *restrict kp,
+                                  const int32_t *restrict ki_dt, const int32_t *restrict kd_dt,
+                                  const int32_t *restrict lo, const int32_t *restrict hi,
+                                  int32_t *restrict integral, int32_t *restrict prev,
+                                  const int32_t *restrict sp, const int32_t *restrict pv,
+                                  int32_t *restrict out) {
+    const int64_t half = (int64_t)1 << (PID_Q - 1);
+    const int64_t half_i = (int64_t)1 << (PID_Q_INTEGRAL - 1);
+
+    for (size_t blk = 0; blk < capacity; blk += PID_LANES) {
+        for (int l = 0; l < PID_LANES; l++) {
+            size_t c = blk + l;
+            int64_t i = integral[c];
+            int64_t e = pid_saturate_q((int64_t)sp[c] - pv[c]);
+            int64_t d = pid_saturate_q(e - prev[c]);
+            int64_t candidate = pid_saturate_q(i + ((ki_dt[c] * e + half_i) >> PID_Q_INTEGRAL));
+            int64_t u = ((kp[c] * e + half) >> PID_Q) + candidate +
+                        ((kd_dt[c] * d + half) >> PID_Q);
+            int64_t held_lo = e < 0 ? i : candidate;
+            int64_t held_hi = e > 0 ? i : candidate;
+            int64_t next = u < lo[c] ? held_lo : candidate;
+            int64_t raised = u < lo[c] ? lo[c] : u;
+            integral[c] = (int32_t)(u > hi[c] ? held_hi : next);
+            out[c] = (int32_t)(raised > hi[c] ? hi[c] : raised);
+            prev[c] = (int32_t)e;
+        }
+    }
+}
+
+// Fixed-point tick; the same control law and anti-windup as pid_update_f32
+static inline void pid_update_q16(pid_bank_q16_t *b, const int32_t *setpoint,
+                                  const int32_t *measurement, int32_t *output) {
+    pid_kernel_q16(b->capacity, b->kp, b->ki_dt, b->kd_dt, b->out_min, b->out_max,
+                   b->integral, b->prev_error, setpoint, measurement, output);
+}
+
+#endif // ALPHAAHB_PID_CONTROLLER_H
@@ -0,0 +1,257 @@
+/*
+ * AlphaAHB V5 Real-Time Harness
+ *
+ * Periodic execution harness for control loops. Cycles are released on
+ * absolute CLOCK_MONOTONIC deadlines with clock_nanosleep(TIMER_ABSTIME), so
+ * timing errors do not accumulate the way relative sleeps do. Before the
+ * first cycle the harness switches to SCHED_FIFO when the process is allowed
+ * to, locks current and future memory, and pre-faults stack pages, so that
+ * page faults and time-sharing do not show up as latency. Everything is
+ * restored when the run ends.
+ *
+ * Per cycle it records into HDR histograms:
+ *
+ * - wake-up latency: actual release time minus scheduled release (jitter)
+ * - execution time of the loop body
+ *
+ * A cycle misses its deadline when the body finishes after the next release.
+ * Releases that pass entirely during an overrun are skipped rather than run
+ * back-to-back, and counted separately.
+ *
+ * The histogram is log-linear (HdrHistogram layout): values below
+ * 2^(RT_HIST_SUB_BITS+1) ns are exact, larger values keep RT_HIST_SUB_BITS
+ * significant bits, i.e. at most 1/128 (0.8%) relative error. Percentiles
+ * report the upper edge of their bucket, so they never understate latency;
+ * min and max are exact.
+ *
+ * Requires _POSIX_C_SOURCE >= 200809L.
+ */
+
+#ifndef ALPHAAHB_REALTIME_HARNESS_H
+#define ALPHAAHB_REALTIME_HARNESS_H
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+// Histogram resolution: 2^7 sub-buckets per power of two
+#define RT_HIST_SUB_BITS 7
+#define RT_HIST_HALF (1u << RT_HIST_SUB_BITS)
+
+// Largest trackable value: 2^40 ns (about 18 minutes); larger values saturate
+#define RT_HIST_MAX_BITS 40
+#define RT_HIST_BUCKETS ((RT_HIST_MAX_BITS - RT_HIST_SUB_BITS + 1) * RT_HIST_HALF)
+
+// Stack pre-faulted before the loop starts
+#define RT_STACK_PREFAULT (256 * 1024)
+
+typedef struct {
+    uint64_t counts[RT_HIST_BUCKETS];
+    uint64_t total;
+    uint64_t min;
+    uint64_t max;
+    double sum;
+} rt_histogram_t;
+
+typedef struct {
+    long period_ns;
+    long cycles;
+    int priority;               // SCHED_FIFO priority; 0 keeps the current policy
+    int lock_memory;            // mlockall for the duration of the run
+} rt_config_t;
+
+typedef struct {
+    rt_histogram_t latency;     // Release jitter (ns)
+    rt_histogram_t execution;   // Body execution time (ns)
+    long cycles;
+    long deadline_misses;       // Body finished after the next release
+    long skipped_releases;      // Releases lost to overruns
+    int realtime_scheduling;    // SCHED_FIFO was in effect
+    int memory_locked;          // mlockall succeeded
+} rt_report_t;
+
+// Loop body, called once per released cycle
+typedef void (*rt_body_t)(long cycle, void *ctx);
+
+// HDR histogram
+// =============
+
+static inline void rt_histogram_init(rt_histogram_t *h) {
+    memset(h, 0, sizeof(*h));
+    h->min = UINT64_MAX;
+}
+
+static inline int rt_histogram_msb(uint64_t v) {
+    int msb = 0;
+    while (v >>= 1) {
+        msb++;
+    }
+    return msb;
+}
+
+static inline uint32_t rt_histogram_index(uint64_t v) {
+    int shift;
+
+    if (v >= ((uint64_t)1 << RT_HIST_MAX_BITS)) {
+        v = ((uint64_t)1 << RT_HIST_MAX_BITS) - 1;
+    }
+    shift = rt_histogram_msb(v | (2 * RT_HIST_HALF - 1)) - RT_HIST_SUB_BITS;
+    return (uint32_t)shift * RT_HIST_HALF + (uint32_t)(v >> shift);
+}
+
+// Largest value that maps to the same bucket as index
+static inline uint64_t rt_histogram_upper(uint32_t index) {
+    uint32_t shift = index < 2 * RT_HIST_HALF ? 0 : index / RT_HIST_HALF - 1;
+    uint64_t sub = index - (uint64_t)shift * RT_HIST_HALF;
+    return ((sub + 1) << shift) - 1;
+}
+
+static inline void rt_histogram_record(rt_histogram_t *h, uint64_t v) {
+    h->counts[rt_histogram_index(v)]++;
+    h->total++;
+    h->sum += (double)v;
+    h->min = v < h->min ? v : h->min;
+    h->max = v > h->max ? v : h->max;
+}
+
+static inline void rt_histogram_merge(rt_histogram_t *a, const rt_histogram_t *b) {
+    for (uint32_t i = 0; i < RT_HIST_BUCKETS; i++) {
+        a->counts[i] += b->counts[i];
+    }
+    a->total += b->total;
+    a->sum += b->sum;
+    a->min = b->min < a->min ? b->min : a->min;
+    a->max = b->max > a->max ? b->max : a->max;
+}
+
+// Value at percentile p in [0, 100]; the exact max for p = 100
+static inline uint64_t rt_histogram_percentile(const rt_histogram_t *h, double p) {
+    uint64_t rank, seen = 0;
+
+    if (h->total == 0) {
+        return 0;
+    }
+    if (p >= 100.0) {
+        return h->max;
+    }
+    rank = (uint64_t)(p / 100.0 * (double)h->total + 0.5);
+    rank = rank < 1 ? 1 : rank;
+    for (uint32_t i = 0; i < RT_HIST_BUCKETS; i++) {
+        seen += h->counts[i];
+        if (seen >= rank) {
+            uint64_t upper = rt_histogram_upper(i);
+            return upper < h->max ? upper : h->max;
+        }
+    }
+    return h->max;
+}
+
+static inline double rt_histogram_mean(const rt_histogram_t *h) {
+    return h->total ? h->sum / (double)h->total : 0.0;
+}
+
+// Harness
+// =======
+
+static inline int64_t rt_timespec_ns(const struct timespec *ts) {
+    return (int64_t)ts->tv_sec * 1000000000 + ts->tv_nsec;
+}
+
+static inline struct timespec rt_ns_timespec(int64_t ns) {
+    struct timespec ts;
+    ts.tv_sec = (time_t)(ns / 1000000000);
+    ts.tv_nsec = (long)(ns % 1000000000);
+    return ts;
+}
+
+static inline int64_t rt_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return rt_timespec_ns(&ts);
+}
+
+// Touch every page of a stack region so the loop never faults it in
+static inline void rt_prefault_stack(void) {
+    volatile unsigned char stack[RT_STACK_PREFAULT];
+    for (size_t i = 0; i < sizeof(stack); i += 4096) {
+        stack[i] = 0;
+    }
+}
+
+static inline void rt_sleep_until(int64_t deadline_ns) {
+    struct timespec ts = rt_ns_timespec(deadline_ns);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+// Run body for cfg->cycles releases of cfg->period_ns. report must not live
+// on a stack that is too small to hold it (it is about 70 KB). Returns 0 on
+// success, -1 on invalid configuration.
+static inline int rt_run(const rt_config_t *cfg, rt_body_t body, void *ctx,
+                         rt_report_t *report) {
+    struct sched_param saved_param, param;
+    int saved_policy;
+    int64_t release;
+
+    if (cfg->period_ns <= 0 || cfg->cycles < 0) {
+        return -1;
+    }
+    rt_histogram_init(&report->latency);
+    rt_histogram_init(&report->execution);
+    report->cycles = 0;
+    report->deadline_misses = 0;
+    report->skipped_releases = 0;
+    report->realtime_scheduling = 0;
+    report->memory_locked = 0;
+
+    saved_policy = sched_getscheduler(0);
+    sched_getparam(0, &saved_param);
+    if (cfg->priority > 0) {
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = cfg->priority;
+        report->realtime_scheduling = sched_setscheduler(0, SCHED_FIFO, &param) == 0;
+    }
+    if (cfg->lock_memory) {
+        report->memory_locked = mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+    }
+    rt_prefault_stack();
+
+    // Warm the body's code and data once before timing anything
+    if (cfg->cycles > 0) {
+        body(-1, ctx);
+    }
+
+    release = rt_now_ns() + cfg->period_ns;
+    for (long cycle = 0; cycle < cfg->cycles; cycle++) {
+        rt_sleep_until(release);
+        int64_t woke = rt_now_ns();
+        body(cycle, ctx);
+        int64_t done = rt_now_ns();
+
+        rt_histogram_record(&report->latency, (uint64_t)(woke > release ? woke - release : 0));
+        rt_histogram_record(&report->execution, (uint64_t)(done - woke));
+        report->cycles++;
+
+        release += cfg->period_ns;
+        if (done > release) {
+            report->deadline_misses++;
+            // Resume on the first release after the overrun, not in a burst
+            int64_t lost = (done - release) / cfg->period_ns + 1;
+            report->skipped_releases += (long)lost;
+            release += lost * cfg->period_ns;
+        }
+    }
+
+    if (report->memory_locked) {
+        munlockall();
+    }
+    if (report->realtime_scheduling) {
+        sched_setscheduler(0, saved_policy, &saved_param);
+    }
+    return 0;
+}
+
+#endif // ALPHAAHB_REALTIME_HARNESS_H
@@ -0,0 +1,438 @@
+/*
+ * AlphaAHB V5 Reduction Kernels
+ *
+ * Summation and dot-product kernels used by the analytics examples and the
+ * benchmark suite. Every kernel walks its input in a fixed order that depends
+ * only on the element count, so results are reproducible across runs,
+ * compilers and host SIMD widths (build with -ffp-contract=off or an ISO -std
+ * mode so the compiler does not fuse multiply/add pairs in the dot products).
+ *
+ * Speed/accuracy tradeoff (n elements, u = unit roundoff of the type):
+ *
+ * | Kernel                     | Relative cost | Worst-case error bound      |
+ * |----------------------------|---------------|-----------------------------|
+ * | reduce_sum_naive_f32       | 1.0 (latency) | (n - 1) u sum|x|            |
+ * | reduce_sum_f32             | ~0.1-0.2      | (n / 16 + 4) u sum|x|       |
+ * | reduce_sum_pairwise_f32    | ~0.1-0.2      | (log2(n / 128) + 12) u      |
+ * | reduce_sum_widen_f32       | ~0.2          | n u_double sum|x| (tiny)    |
+ * | reduce_sum_neumaier_f32    | ~0.5          | 2u |sum| + O(n u^2) sum|x|  |
+ * | reduce_sum_kahan_f32       | ~4 (latency)  | 2u |sum| + O(n u^2) sum|x|  |
+ * | reduce_sum_exact_f32/f64   | ~1-2          | correctly rounded (0.5 ulp) |
+ * | reduce_dot_exact_f32       | ~1-2          | correctly rounded (0.5 ulp) |
+ *
+ * The naive kernel keeps a single dependent FP add chain and is bounded by
+ * add latency (2 cycles on AlphaAHB V5 binary32, 3-4 on typical hosts). The
+ * lane kernels keep REDUCE_LANES independent chains, one per 32-bit lane of a
+ * 512-bit vector register, which the compiler maps onto host SIMD registers.
+ * The exact kernels use a Kulisch-style long accumulator (the software
+ * analogue of the posit quire): every finite double is added without
+ * rounding and the sum is rounded once when it is read out, which makes the
+ * result independent of summation order.
+ */
+
+#ifndef ALPHAAHB_REDUCTION_KERNELS_H
+#define ALPHAAHB_REDUCTION_KERNELS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+// One accumulator per 32-bit lane of a 512-bit vector register
+#define REDUCE_LANES 16
+
+// Pairwise summation falls back to the lane kernel below this block size
+#define REDUCE_PAIRWISE_BLOCK 128
+
+// Long accumulator geometry: 32-bit digits held in 64-bit limbs so that
+// carries can be deferred. Bit 0 of digit 0 has weight 2^-1074 (the smallest
+// subnormal double); 68 digits cover the full double range plus 78 bits of
+// headroom for carries out of the largest finite values.
+#define REDUCE_EXACT_DIGITS 68
+#define REDUCE_EXACT_BIAS 1074
+#define REDUCE_EXACT_NORMALIZE_INTERVAL (1u << 30)
+
+// Horizontal tree reduction of the lane accumulators (fixed order)
+static inline float reduce_lanes_f32(float acc[REDUCE_LANES]) {
+    for (int width = REDUCE_LANES / 2; width > 0; width /= 2) {
+        for (int l = 0; l < width; l++) {
+            acc[l] += acc[l + width];
+        }
+    }
+    return acc[0];
+}
+
+static inline double reduce_lanes_f64(double acc[REDUCE_LANES]) {
+    for (int width = REDUCE_LANES / 2; width > 0; width /= 2) {
+        for (int l = 0; l < width; l++) {
+            acc[l] += acc[l + width];
+        }
+    }
+    return acc[0];
+}
+
+// Reference: one dependent add chain, left to right
+static inline float reduce_sum_naive_f32(const float *x, size_t n) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < n; i++) {
+        sum += x[i];
+    }
+    return sum;
+}
+
+// Multi-accumulator lane sum: element i goes to lane i % REDUCE_LANES
+static inline float reduce_sum_f32(const float *x, size_t n) {
+    float acc[REDUCE_LANES] = {0};
+    size_t i = 0;
+
+    for (; i + REDUCE_LANES <= n; i += REDUCE_LANES) {
+        for (int l = 0; l < REDUCE_LANES; l++) {
+            acc[l] += x[i + l];
+        }
+    }
+    for (int l = 0; l < REDUCE_LANES && i < n; i++, l++) {
+        acc[l] += x[i];
+    }
+    return reduce_lanes_f32(acc);
+}
+
+static inline double reduce_sum_f64(const double *x, size_t n) {
+    double acc[REDUCE_LANES] = {0};
+    size_t i = 0;
+
+    for (; i + REDUCE_LANES <= n; i += REDUCE_LANES) {
+        for (int l = 0; l < REDUCE_LANES; l++) {
+            acc[l] += x[i + l];
+        }
+    }
+    for (int l = 0; l < REDUCE_LANES && i < n; i++, l++) {
+        acc[l] += x[i];
+    }
+    return reduce_lanes_f64(acc);
+}
+
+// Lane sum of float inputs in double accumulators
+static inline double reduce_sum_widen_f32(const float *x, size_t n) {
+    double acc[REDUCE_LANES] = {0};
+    size_t i = 0;
+
+    for (; i + REDUCE_LANES <= n; i += REDUCE_LANES) {
+        for (int l = 0; l < REDUCE_LANES; l++) {
+            acc[l] += (double)x[i + l];
+        }
+    }
+    for (int l = 0; l < REDUCE_LANES && i < n; i++, l++) {
+        acc[l] += (double)x[i];
+    }
+    return reduce_lanes_f64(acc);
+}
+
+// Lane sum of squares and plain sum in one pass
+static inline void reduce_sum_sumsq_f32(const float *x, size_t n,
+                                        float *sum, float *sum_sq) {
+    float acc[REDUCE_LANES] = {0};
+    float acc_sq[REDUCE_LANES] = {0};
+    size_t i = 0;
+
+    for (; i + REDUCE_LANES <= n; i += REDUCE_LANES) {
+        for (int l = 0; l < REDUCE_LANES; l++) {
+            float v = x[i + l];
+            acc[l] += v;
+            acc_sq[l] += v * v;
+        }
+    }
+    for (int l = 0; l < REDUCE_LANES && i < n; i++, l++) {
+        acc[l] += x[i];
+        acc_sq[l] += x[i] * x[i];
+    }
+    *sum = reduce_lanes_f32(acc);
+    *sum_sq = reduce_lanes_f32(acc_sq);
+}
+
+// Pairwise (cascade) summation with lane-summed leaf blocks
+static inline float reduce_sum_pairwise_f32(const float *x, size_t n) {
+    if (n <= REDUCE_PAIRWISE_BLOCK) {
+        return reduce_sum_f32(x, n);
+    }
+    // Split on a block boundary so the tree shape depends only on n
+    size_t half = ((n / REDUCE_PAIRWISE_BLOCK + 1) / 2) * REDUCE_PAIRWISE_BLOCK;
+    return reduce_sum_pairwise_f32(x, half) +
+           reduce_sum_pairwise_f32(x + half, n - half);
+}
+
+static inline double reduce_sum_pairwise_f64(const double *x, size_t n) {
+    if (n <= REDUCE_PAIRWISE_BLOCK) {
+        return reduce_sum_f64(x, n);
+    }
+    size_t half = ((n / REDUCE_PAIRWISE_BLOCK + 1) / 2) * REDUCE_PAIRWISE_BLOCK;
+    return reduce_sum_pairwise_f64(x, half) +
+           reduce_sum_pairwise_f64(x + half, n - half);
+}
+
+// Classic Kahan compensated summation (sequential, 4-op dependency chain).
+// The compensated kernels rely on strict IEEE evaluation: no -ffast-math.
+static inline float reduce_sum_kahan_f32(const float *x, size_t n) {
+    float sum = 0.0f;
+    float c = 0.0f;
+
+    for (size_t i = 0; i < n; i++) {
+        float y = x[i] - c;
+        float t = sum + y;
+        c = (t - sum) - y;
+        sum = t;
+    }
+    return sum;
+}
+
+// Neumaier (improved Kahan) summation, one compensated chain per lane.
+// Unlike Kahan it stays accurate when an addend is larger than the sum.
+static inline float reduce_sum_neumaier_f32(const float *x, size_t n) {
+    float acc[REDUCE_LANES] = {0};
+    float comp[REDUCE_LANES] = {0};
+    size_t i = 0;
+
+    for (; i + REDUCE_LANES <= n; i += REDUCE_LANES) {
+        for (int l = 0; l < REDUCE_LANES; l++) {
+            float v = x[i + l];
+            float t = acc[l] + v;
+            float big = fabsf(acc[l]) >= fabsf(v) ? acc[l] : v;
+            float small = fabsf(acc[l]) >= fabsf(v) ? v : acc[l];
+            comp[l] += (big - t) + small;
+            acc[l] = t;
+        }
+    }
+    for (int l = 0; l < REDUCE_LANES && i < n; i++, l++) {
+        float v = x[i];
+        float t = acc[l] + v;
+        float big = fabsf(acc[l]) >= fabsf(v) ? acc[l] : v;
+        float small = fabsf(acc[l]) >= fabsf(v) ? v : acc[l];
+        comp[l] += (big - t) + small;
+        acc[l] = t;
+    }
+
+    // Fold the lanes with the same compensated step
+    float sum = 0.0f;
+    float c = 0.0f;
+    for (int l = 0; l < REDUCE_LANES; l++) {
+        float parts[2] = { acc[l], comp[l] };
+        for (int k = 0; k < 2; k++) {
+            float t = sum + parts[k];
+            if (fabsf(sum) >= fabsf(parts[k])) {
+                c += (sum - t) + parts[k];
+            } else {
+                c += (parts[k] - t) + sum;
+            }
+            sum = t;
+        }
+    }
+    return sum + c;
+}
+
+// Multi-accumulator dot product
+static inline float reduce_dot_f32(const float *a, const float *b, size_t n) {
+    float acc[REDUCE_LANES] = {0};
+    size_t i = 0;
+
+    for (; i + REDUCE_LANES <= n; i += REDUCE_LANES) {
+        for (int l = 0; l < REDUCE_LANES; l++) {
+            acc[l] += a[i + l] * b[i + l];
+        }
+    }
+    for (int l = 0; l < REDUCE_LANES && i < n; i++, l++) {
+        acc[l] += a[i] * b[i];
+    }
+    return reduce_lanes_f32(acc);
+}
+
+// Exact long accumulator
+// =====================
+
+typedef struct {
+    int64_t digit[REDUCE_EXACT_DIGITS];  // 32-bit digits, deferred carries
+    uint32_t pending;                    // Additions since last normalize
+    double special;                      // Sum of Inf/NaN inputs
+    int has_special;
+} reduce_exact_t;
+
+static inline void reduce_exact_init(reduce_exact_t *acc) {
+    memset(acc, 0, sizeof(*acc));
+}
+
+// Propagate deferred carries so every digit but the top is in [0, 2^32)
+static inline void reduce_exact_normalize(reduce_exact_t *acc) {
+    int64_t carry = 0;
+    for (int i = 0; i < REDUCE_EXACT_DIGITS; i++) {
+        int64_t d = acc->digit[i] + carry;
+        int64_t low = d & 0xFFFFFFFFLL;
+        carry = (d - low) / 4294967296LL;
+        acc->digit[i] = low;
+    }
+    // Carry out of the top digit keeps the sign of the total
+    acc->digit[REDUCE_EXACT_DIGITS - 1] += carry * 4294967296LL;
+    acc->pending = 0;
+}
+
+static inline void reduce_exact_add(reduce_exact_t *acc, double v) {
+    uint64_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+
+    int biased = (int)((bits >> 52) & 0x7FF);
+    uint64_t mant = bits & 0xFFFFFFFFFFFFFULL;
+
+    if (biased == 0x7FF) {
+        acc->special += v;
+        acc->has_special = 1;
+        return;
+    }
+    if (biased == 0) {
+        if (mant == 0) {
+            return;
+        }
+        biased = 1;  // Subnormal: same scale as the smallest normal
+    } else {
+        mant |= 1ULL << 52;
+    }
+
+    // v = mant * 2^(biased - 1075); bit offset from 2^-1074
+    int offset = biased - 1;
+    int idx = offset / 32;
+    int shift = offset % 32;
+
+    uint64_t lo = (mant & 0xFFFFFFFFULL) << shift;
+    uint64_t hi = (mant >> 32) << shift;
+    uint64_t mid = (lo >> 32) + hi;
+    int64_t d0 = (int64_t)(lo & 0xFFFFFFFFULL);
+    int64_t d1 = (int64_t)(mid & 0xFFFFFFFFULL);
+    int64_t d2 = (int64_t)(mid >> 32);
+
+    if (bits >> 63) {
+        acc->digit[idx] -= d0;
+        acc->digit[idx + 1] -= d1;
+        acc->digit[idx + 2] -= d2;
+    } else {
+        acc->digit[idx] += d0;
+        acc->digit[idx + 1] += d1;
+        acc->digit[idx + 2] += d2;
+    }
+
+    if (++acc->pending >= REDUCE_EXACT_NORMALIZE_INTERVAL) {
+        reduce_exact_normalize(acc);
+    }
+}
+
+// Merge another accumulator (exact, order independent)
+static inline void reduce_exact_merge(reduce_exact_t *acc, const reduce_exact_t *other) {
+    reduce_exact_t tmp = *other;
+    reduce_exact_normalize(acc);
+    reduce_exact_normalize(&tmp);
+    for (int i = 0; i < REDUCE_EXACT_DIGITS; i++) {
+        acc->digit[i] += tmp.digit[i];
+    }
+    acc->pending = 1;
+    if (tmp.has_special) {
+        acc->special += tmp.special;
+        acc->has_special = 1;
+    }
+}
+
+// Round the accumulated value once, to nearest-even
+static inline double reduce_exact_value(const reduce_exact_t *src) {
+    reduce_exact_t acc = *src;
+    uint32_t mag[REDUCE_EXACT_DIGITS];
+    int negative;
+
+    if (acc.has_special) {
+        return acc.special;
+    }
+
+    reduce_exact_normalize(&acc);
+    int64_t head = acc.digit[REDUCE_EXACT_DIGITS - 1];
+    if (head >= 4294967296LL || head < -4294967296LL) {
+        return head < 0 ? -HUGE_VAL : HUGE_VAL;  // Far beyond DBL_MAX
+    }
+    negative = head < 0;
+
+    // Two's complement negate into an unsigned magnitude
+    uint64_t borrow = negative ? 1 : 0;
+    for (int i = 0; i < REDUCE_EXACT_DIGITS; i++) {
+        uint64_t d = (uint64_t)acc.digit[i] & 0xFFFFFFFFULL;
+        if (negative) {
+            d = (~d & 0xFFFFFFFFULL) + borrow;
+            borrow = d >> 32;
+        }
+        mag[i] = (uint32_t)d;
+    }
+
+    int top = REDUCE_EXACT_DIGITS - 1;
+    while (top >= 0 && mag[top] == 0) {
+        top--;
+    }
+    if (top < 0) {
+        return 0.0;
+    }
+
+    // Bit position of the most significant set bit (weight 2^(msb - 1074))
+    int msb = top * 32 + 31;
+    while (!((mag[msb / 32] >> (msb % 32)) & 1u)) {
+        msb--;
+    }
+
+    double result;
+    if (msb < 53) {
+        // Fits in the subnormal/low-normal range without rounding
+        uint64_t m = ((uint64_t)mag[1] << 32) | mag[0];
+        result = ldexp((double)m, -REDUCE_EXACT_BIAS);
+    } else {
+        // Gather the 53 bits below msb, then round on the remaining bits
+        int low = msb - 52;
+        uint64_t m = 0;
+        for (int b = msb; b >= low; b--) {
+            m = (m << 1) | ((mag[b / 32] >> (b % 32)) & 1u);
+        }
+        int round_bit = (mag[(low - 1) / 32] >> ((low - 1) % 32)) & 1u;
+        int sticky = 0;
+        for (int b = low - 2; b >= 0 && !sticky; b--) {
+            if (b % 32 == 31 && mag[b / 32] == 0) {
+                b -= 31;
+                continue;
+            }
+            sticky = (mag[b / 32] >> (b % 32)) & 1u;
+        }
+        if (round_bit && (sticky || (m & 1))) {
+            m++;  // May carry to 2^53, which ldexp handles exactly
+        }
+        result = ldexp((double)m, low - REDUCE_EXACT_BIAS);
+    }
+    return negative ? -result : result;
+}
+
+// Exact sums and dot products: rounded once, independent of element order
+static inline double reduce_sum_exact_f64(const double *x, size_t n) {
+    reduce_exact_t acc;
+    reduce_exact_init(&acc);
+    for (size_t i = 0; i < n; i++) {
+        reduce_exact_add(&acc, x[i]);
+    }
+    return reduce_exact_value(&acc);
+}
+
+static inline double reduce_sum_exact_f32(const float *x, size_t n) {
+    reduce_exact_t acc;
+    reduce_exact_init(&acc);
+    for (size_t i = 0; i < n; i++) {
+        reduce_exact_add(&acc, (double)x[i]);
+    }
+    return reduce_exact_value(&acc);
+}
+
+// A binary32 product is exact in binary64 (24 + 24 <= 53 significand bits)
+static inline double reduce_dot_exact_f32(const float *a, const float *b, size_t n) {
+    reduce_exact_t acc;
+    reduce_exact_init(&acc);
+    for (size_t i = 0; i < n; i++) {
+        reduce_exact_add(&acc, (double)a[i] * (double)b[i]);
+    }
+    return reduce_exact_value(&acc);
+}
+
+#endif // ALPHAAHB_REDUCTION_KERNELS_H
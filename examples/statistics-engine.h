@@ -0,0 +1,481 @@
+/*
+ * AlphaAHB V5 Statistics Engine
+ *
+ * Single-pass descriptive statistics over a row-major records x features
+ * float matrix (the data_analytics_example layout), producing in one sweep:
+ *
+ * - per-feature (columnar) count, mean, variance, min and max
+ * - per-record (row-batch) mean and variance
+ * - mergeable quantile sketches of the per-record means and, optionally,
+ *   of every feature column
+ *
+ * Column moments use Welford's update across the feature columns: every
+ * column of a row shares the same count, so the 1/k factor is computed once
+ * per row and the inner loop over columns has no division. Columns go in
+ * blocks of REDUCE_LANES, widened to double first, so the update vectorizes
+ * at plain -O2 (check with -fopt-info-vec); the last cols % REDUCE_LANES
+ * columns stay scalar. Record moments use the two-pass formula on the row while it is
+ * in L1, with the lane kernels from reduction-kernels.h. Both are stable
+ * where the textbook sum_sq/n - mean^2 formula cancels catastrophically.
+ *
+ * Rows are processed in fixed STATS_ROW_CHUNK bins by the parallel runtime;
+ * per-bin moments are merged in bin order with Chan's pairwise update and
+ * sketches are merged by adding integer counts, so every output is
+ * bit-identical for any thread count.
+ */
+
+#ifndef ALPHAAHB_STATISTICS_ENGINE_H
+#define ALPHAAHB_STATISTICS_ENGINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "reduction-kernels.h"
+#include "parallel-runtime.h"
+
+// Rows per bin (deterministic merge granularity)
+#define STATS_ROW_CHUNK 1024
+
+// Quantile sketch: log-linear buckets keyed on sign, exponent and the top
+// STATS_SKETCH_MANTISSA_BITS of the binary32 significand. Every value in a
+// bucket is within 2^-(bits+1) (1.6%) relative error of the bucket midpoint.
+#define STATS_SKETCH_MANTISSA_BITS 5
+#define STATS_SKETCH_BUCKETS (1u << (9 + STATS_SKETCH_MANTISSA_BITS))
+
+typedef struct {
+    uint64_t count;
+    double mean;
+    double m2;      // Sum of squared deviations from the mean
+    float min;
+    float max;
+} stats_moments_t;
+
+typedef struct {
+    uint64_t total;
+    uint32_t counts[STATS_SKETCH_BUCKETS];
+} stats_sketch_t;
+
+typedef struct {
+    int num_threads;                  // <= 0 selects the default
+    float *record_mean;               // Optional, rows entries
+    float *record_variance;           // Optional, rows entries (population)
+    stats_sketch_t *record_sketch;    // Optional, quantiles of record means
+    stats_sketch_t *column_sketches;  // Optional, cols sketches
+} stats_options_t;
+
+// Moments
+// =======
+
+static inline void stats_moments_init(stats_moments_t *m) {
+    m->count = 0;
+    m->mean = 0.0;
+    m->m2 = 0.0;
+    m->min = INFINITY;
+    m->max = -INFINITY;
+}
+
+// Chan et al. pairwise merge of two moment sets
+static inline void stats_moments_merge(stats_moments_t *a, const stats_moments_t *b) {
+    if (b->count == 0) {
+        return;
+    }
+    if (a->count == 0) {
+        *a = *b;
+        return;
+    }
+    double na = (double)a->count;
+    double nb = (double)b->count;
+    double n = na + nb;
+    double delta = b->mean - a->mean;
+
+    a->mean += delta * (nb / n);
+    a->m2 += b->m2 + delta * delta * (na * nb / n);
+    a->count += b->count;
+    a->min = b->min < a->min ? b->min : a->min;
+    a->max = b->max > a->max ? b->max : a->max;
+}
+
+static inline double stats_variance(const stats_moments_t *m) {
+    return m->count ? m->m2 / (double)m->count : 0.0;
+}
+
+static inline double stats_sample_variance(const stats_moments_t *m) {
+    return m->count > 1 ? m->m2 / (double)(m->count - 1) : 0.0;
+}
+
+// Quantile sketch
+// ===============
+
+static inline uint32_t stats_sketch_key(float v) {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    uint32_t mag = (bits & 0x7FFFFFFFu) >> (23 - STATS_SKETCH_MANTISSA_BITS);
+    uint32_t half = STATS_SKETCH_BUCKETS / 2;
+
+    // Negative values map below the midpoint in reverse magnitude order
+    return (bits >> 31) ? half - 1 - mag : half + mag;
+}
+
+static inline float stats_sketch_bucket_value(uint32_t key) {
+    uint32_t half = STATS_SKETCH_BUCKETS / 2;
+    uint32_t sign = key < half;
+    uint32_t mag = sign ? half - 1 - key : key - half;
+    uint32_t bits = (mag << (23 - STATS_SKETCH_MANTISSA_BITS)) |
+                    (1u << (22 - STATS_SKETCH_MANTISSA_BITS)) | (sign << 31);
+    float v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+static inline void stats_sketch_init(stats_sketch_t *s) {
+    memset(s, 0, sizeof(*s));
+}
+
+static inline void stats_sketch_add(stats_sketch_t *s, float v) {
+    if (v != v) {
+        return;  // NaN carries no rank information
+    }
+    s->counts[stats_sketch_key(v)]++;
+    s->total++;
+}
+
+static inline void stats_sketch_merge(stats_sketch_t *a, const stats_sketch_t *b) {
+    for (uint32_t k = 0; k < STATS_SKETCH_BUCKETS; k++) {
+        a->counts[k] += b->counts[k];
+    }
+    a->total += b->total;
+}
+
+// Value at quantile q in [0, 1] (nearest rank)
+static inline float stats_sketch_quantile(const stats_sketch_t *s, double q) {
+    if (s->total == 0) {
+        return NAN;
+    }
+    q = q < 0.0 ? 0.0 : (q > 1.0 ? 1.0 : q);
+    uint64_t rank = (uint64_t)(q * (double)(s->total - 1));
+    uint64_t seen = 0;
+
+    for (uint32_t k = 0; k < STATS_SKETCH_BUCKETS; k++) {
+        seen += s->counts[k];
+        if (seen > rank) {
+            return stats_sketch_bucket_value(k);
+        }
+    }
+    return stats_sketch_bucket_value(STATS_SKETCH_BUCKETS - 1);
+}
+
+// Engine
+// ======
+
+typedef struct {
+    double *mean;
+    double *m2;
+    float *min;
+    float *max;
+    stats_sketch_t *record_sketch;
+    stats_sketch_t *column_sketches;
+} stats_scratch_t;
+
+typedef struct {
+    const float *data;
+    size_t rows;
+    size_t cols;
+    const stats_options_t *opt;
+    stats_moments_t *partials;  // bins x cols
+    stats_scratch_t scratch[PARALLEL_MAX_THREADS];
+} stats_ctx_t;
+
+// Sum of squared deviations from mean, lane-parallel
+static inline double stats_squared_deviations_f32(const float *x, size_t n, double mean) {
+    double acc[REDUCE_LANES] = {0};
+    size_t i = 0;
+
+    for (; i + REDUCE_LANES <= n; i += REDUCE_LANES) {
+        for (int l = 0; l < REDUCE_LANES; l++) {
+            double d = (double)x[i + l] - mean;
+            acc[l] += d * d;
+        }
+    }
+    for (int l = 0; l < REDUCE_LANES && i < n; i++, l++) {
+        double d = (double)x[i] - mean;
+        acc[l] += d * d;
+    }
+    return reduce_lanes_f64(acc);
+}
+
+// Per-record mean and population variance (two-pass on an L1-resident row)
+static inline void stats_record(const float *row, size_t cols, float *mean_out, float *var_out) {
+    double mean = reduce_sum_widen_f32(row, cols) / (double)cols;
+
+    *mean_out = (float)mean;
+    *var_out = (float)(stats_squared_deviations_f32(row, cols, mean) / (double)cols);
+}
+
+// Moments of a contiguous block (two-pass; the block should fit in cache).
+// Used for columnar inputs, where every block is a single feature.
+static inline void stats_moments_f32(const float *x, size_t n, stats_moments_t *m) {
+    float lo[REDUCE_LANES], hi[REDUCE_LANES];
+    size_t i = 0;
+
+    stats_moments_init(m);
+    if (n == 0) {
+        return;
+    }
+    for (int l = 0; l < REDUCE_LANES; l++) {
+        lo[l] = INFINITY;
+        hi[l] = -INFINITY;
+    }
+    for (; i + REDUCE_LANES <= n; i += REDUCE_LANES) {
+        for (int l = 0; l < REDUCE_LANES; l++) {
+            lo[l] = x[i + l] < lo[l] ? x[i + l] : lo[l];
+            hi[l] = x[i + l] > hi[l] ? x[i + l] : hi[l];
+        }
+    }
+    for (int l = 0; l < REDUCE_LANES && i < n; i++, l++) {
+        lo[l] = x[i] < lo[l] ? x[i] : lo[l];
+        hi[l] = x[i] > hi[l] ? x[i] : hi[l];
+    }
+    for (int l = 0; l < REDUCE_LANES; l++) {
+        m->min = lo[l] < m->min ? lo[l] : m->min;
+        m->max = hi[l] > m->max ? hi[l] : m->max;
+    }
+    m->count = n;
+    m->mean = reduce_sum_widen_f32(x, n) / (double)n;
+    m->m2 = stats_squared_deviations_f32(x, n, m->mean);
+}
+
+// Welford update of every column with one row. All columns share the count,
+// so inv = 1/k is computed once per row and the loop has no division. Each
+// block of REDUCE_LANES columns widens to double before the update, so no
+// loop mixes float and double lanes and the fixed-trip loops vectorize at -O2.
+static inline void stats_welford_row(const float *restrict row, size_t cols, double inv,
+                                     double *restrict mean, double *restrict m2,
+                                     float *restrict min, float *restrict max) {
+    size_t c = 0;
+
+    for (; c + REDUCE_LANES <= cols; c += REDUCE_LANES) {
+        double x[REDUCE_LANES];
+        for (int l = 0; l < REDUCE_LANES; l++) {
+            x[l] = (double)row[c + l];
+        }
+        for (int l = 0; l < REDUCE_LANES; l++) {
+            double d = x[l] - mean[c + l];
+            mean[c + l] += d * inv;
+            m2[c + l] += d * (x[l] - mean[c + l]);
+        }
+        for (int l = 0; l < REDUCE_LANES; l++) {
+            float v = row[c + l];
+            min[c + l] = v < min[c + l] ? v : min[c + l];
+            max[c + l] = v > max[c + l] ? v : max[c + l];
+        }
+    }
+    for (; c < cols; c++) {
+        float v = row[c];
+        double d = (double)v - mean[c];
+        mean[c] += d * inv;
+        m2[c] += d * ((double)v - mean[c]);
+        min[c] = v < min[c] ? v : min[c];
+        max[c] = v > max[c] ? v : max[c];
+    }
+}
+
+static inline void stats_bins(size_t begin, size_t end, int tid, void *arg) {
+    stats_ctx_t *ctx = (stats_ctx_t *)arg;
+    stats_scratch_t *s = &ctx->scratch[tid];
+    const stats_options_t *opt = ctx->opt;
+    size_t cols = ctx->cols;
+
+    double *restrict mean = s->mean;
+    double *restrict m2 = s->m2;
+    float *restrict min = s->min;
+    float *restrict max = s->max;
+
+    for (size_t bin = begin; bin < end; bin++) {
+        size_t first = bin * STATS_ROW_CHUNK;
+        size_t last = first + STATS_ROW_CHUNK < ctx->rows ? first + STATS_ROW_CHUNK : ctx->rows;
+
+        for (size_t c = 0; c < cols; c++) {
+            mean[c] = 0.0;
+            m2[c] = 0.0;
+            min[c] = INFINITY;
+            max[c] = -INFINITY;
+        }
+
+        for (size_t r = first; r < last; r++) {
+            const float *restrict row = &ctx->data[r * cols];
+            double inv = 1.0 / (double)(r - first + 1);
+
+            stats_welford_row(row, cols, inv, mean, m2, min, max);
+
+            if (opt->record_mean || opt->record_variance || s->record_sketch) {
+                float row_mean, row_var;
+                stats_record(row, cols, &row_mean, &row_var);
+                if (opt->record_mean) {
+                    opt->record_mean[r] = row_mean;
+                }
+                if (opt->record_variance) {
+                    opt->record_variance[r] = row_var;
+                }
+                if (s->record_sketch) {
+                    stats_sketch_add(s->record_sketch, row_mean);
+                }
+            }
+            if (s->column_sketches) {
+                for (size_t c = 0; c < cols; c++) {
+                    stats_sketch_add(&s->column_sketches[c], row[c]);
+                }
+            }
+        }
+
+        stats_moments_t *out = &ctx->partials[bin * cols];
+        for (size_t c = 0; c < cols; c++) {
+            out[c].count = last - first;
+            out[c].mean = mean[c];
+            out[c].m2 = m2[c];
+            out[c].min = min[c];
+            out[c].max = max[c];
+        }
+    }
+}
+
+static inline void stats_free_scratch(stats_ctx_t *ctx, int threads) {
+    for (int t = 0; t < threads; t++) {
+        free(ctx->scratch[t].mean);
+        free(ctx->scratch[t].m2);
+        free(ctx->scratch[t].min);
+        free(ctx->scratch[t].max);
+        free(ctx->scratch[t].record_sketch);
+        free(ctx->scratch[t].column_sketches);
+    }
+}
+
+// Compute column moments (cols entries) plus the optional outputs in opt.
+// Returns 0 on success, -1 on allocation failure.
+static inline int stats_compute_f32(const float *data, size_t rows, size_t cols,
+                                    const stats_options_t *opt, stats_moments_t *columns) {
+    stats_options_t defaults = { 0, NULL, NULL, NULL, NULL };
+    size_t bins = (rows + STATS_ROW_CHUNK - 1) / STATS_ROW_CHUNK;
+    stats_ctx_t *ctx;
+    int threads;
+    int failed = 0;
+
+    if (!opt) {
+        opt = &defaults;
+    }
+    for (size_t c = 0; c < cols; c++) {
+        stats_moments_init(&columns[c]);
+    }
+    if (opt->record_sketch) {
+        stats_sketch_init(opt->record_sketch);
+    }
+    if (opt->column_sketches) {
+        for (size_t c = 0; c < cols; c++) {
+            stats_sketch_init(&opt->column_sketches[c]);
+        }
+    }
+    if (bins == 0 || cols == 0) {
+        return 0;
+    }
+
+    threads = opt->num_threads > 0 ? opt->num_threads : parallel_default_threads();
+    if (threads > PARALLEL_MAX_THREADS) {
+        threads = PARALLEL_MAX_THREADS;
+    }
+    if ((size_t)threads > bins) {
+        threads = (int)bins;
+    }
+
+    ctx = calloc(1, sizeof(*ctx));
+    if (!ctx) {
+        return -1;
+    }
+    ctx->data = data;
+    ctx->rows = rows;
+    ctx->cols = cols;
+    ctx->opt = opt;
+    ctx->partials = malloc(bins * cols * sizeof(stats_moments_t));
+    failed = ctx->partials == NULL;
+
+    for (int t = 0; t < threads && !failed; t++) {
+        stats_scratch_t *s = &ctx->scratch[t];
+        s->mean = malloc(cols * sizeof(double));
+        s->m2 = malloc(cols * sizeof(double));
+        s->min = malloc(cols * sizeof(float));
+        s->max = malloc(cols * sizeof(float));
+        failed = !s->mean || !s->m2 || !s->min || !s->max;
+        if (opt->record_sketch) {
+            s->record_sketch = calloc(1, sizeof(stats_sketch_t));
+            failed |= s->record_sketch == NULL;
+        }
+        if (opt->column_sketches) {
+            s->column_sketches = calloc(cols, sizeof(stats_sketch_t));
+            failed |= s->column_sketches == NULL;
+        }
+    }
+
+    if (!failed) {
+        parallel_for(0, bins, 1, threads, stats_bins, ctx);
+
+        // Fixed bin order keeps the floating-point merge sequence constant
+        for (size_t b = 0; b < bins; b++) {
+            for (size_t c = 0; c < cols; c++) {
+                stats_moments_merge(&columns[c], &ctx->partials[b * cols + c]);
+            }
+        }
+        for (int t = 0; t < threads; t++) {
+            if (opt->record_sketch) {
+                stats_sketch_merge(opt->record_sketch, ctx->scratch[t].record_sketch);
+            }
+            if (opt->column_sketches) {
+                for (size_t c = 0; c < cols; c++) {
+                    stats_sketch_merge(&opt->column_sketches[c],
+                                       &ctx->scratch[t].column_sketches[c]);
+                }
+            }
+        }
+    }
+
+    stats_free_scratch(ctx, threads);
+    free(ctx->partials);
+    free(ctx);
+    return failed ? -1 : 0;
+}
+
+// Memory bandwidth reference
+// ==========================
+
+typedef struct {
+    const float *data;
+    size_t n;
+    double sink[PARALLEL_MAX_THREADS];
+} stats_stream_ctx_t;
+
+static inline void stats_stream_body(size_t begin, size_t end, int tid, void *arg) {
+    stats_stream_ctx_t *ctx = (stats_stream_ctx_t *)arg;
+    ctx->sink[tid] += reduce_sum_f32(ctx->data + begin, end - begin);
+}
+
+// Sustained parallel read bandwidth over the buffer, in bytes per second.
+// The lane sum is light enough to be memory bound on any current host.
+static inline double stats_read_bandwidth(const float *data, size_t n, int num_threads) {
+    stats_stream_ctx_t ctx;
+    double best = 0.0;
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.data = data;
+    ctx.n = n;
+    for (int rep = 0; rep < 3; rep++) {
+        double start = parallel_wall_seconds();
+        parallel_for(0, n, 16384, num_threads, stats_stream_body, &ctx);
+        double secs = parallel_wall_seconds() - start;
+        if (secs > 0.0 && n * sizeof(float) / secs > best) {
+            best = n * sizeof(float) / secs;
+        }
+    }
+    return best;
+}
+
+#endif // ALPHAAHB_STATISTICS_ENGINE_H
@@ -0,0 +1,545 @@
+/*
+ * AlphaAHB V5 Synchronization Primitives
+ *
+ * Candidate primitives for the MIMD runtime, kept side by side so they can
+ * be measured under the same contention:
+ *
+ * - barriers: mutex/condition variable (the mimd_barrier of the examples,
+ *   with a generation count against spurious wakeups), pthread_barrier_t,
+ *   a centralized sense-reversing spin barrier, and a dissemination
+ *   barrier (ceil(log2 n) rounds of pairwise signals, every thread spinning
+ *   on its own cache line)
+ * - locks: pthread mutex, test-and-test-and-set spin lock, and a FIFO
+ *   ticket lock
+ * - bounded queues of 64-bit items: single-producer/single-consumer ring
+ *   with cached indices, and a multi-producer/multi-consumer ring with
+ *   per-cell sequence numbers (Vyukov)
+ * - a team runner that starts n real threads together, since barriers and
+ *   queues deadlock if the workers are serialized
+ *
+ * Spin loops pause for SYNC_SPIN_LIMIT iterations and then yield, so they
+ * degrade to sched_yield instead of burning whole time slices when threads
+ * outnumber cores. Shared state touched by different threads sits on
+ * separate SYNC_CACHE_LINE lines; structures holding it must be allocated
+ * with sync_alloc (or otherwise 64-byte aligned).
+ *
+ * Atomics are the GCC __atomic builtins (gcc, clang). Functions that can
+ * fail return 0 on success and -1 on error. Link with -pthread.
+ */
+
+#ifndef ALPHAAHB_SYNC_PRIMITIVES_H
+#define ALPHAAHB_SYNC_PRIMITIVES_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#define SYNC_CACHE_LINE 64
+
+// Upper bound on team size (matches 64 cores of the AlphaAHB V5 SoC)
+#define SYNC_MAX_THREADS 64
+
+// Dissemination rounds for SYNC_MAX_THREADS (ceil(log2 64))
+#define SYNC_MAX_ROUNDS 6
+
+// Pause iterations before a spinning thread starts yielding
+#define SYNC_SPIN_LIMIT 1024
+
+#if defined(_POSIX_BARRIERS) && _POSIX_BARRIERS > 0
+#define SYNC_HAVE_PTHREAD_BARRIER 1
+#else
+#define SYNC_HAVE_PTHREAD_BARRIER 0
+#endif
+
+typedef enum {
+    SYNC_BARRIER_CONDVAR,
+    SYNC_BARRIER_PTHREAD,
+    SYNC_BARRIER_CENTRAL,
+    SYNC_BARRIER_DISSEMINATION,
+    SYNC_BARRIER_KINDS
+} sync_barrier_kind_t;
+
+typedef enum {
+    SYNC_LOCK_MUTEX,
+    SYNC_LOCK_TTAS,
+    SYNC_LOCK_TICKET,
+    SYNC_LOCK_KINDS
+} sync_lock_kind_t;
+
+// One counter per cache line
+typedef struct {
+    uint64_t value;
+    char pad[SYNC_CACHE_LINE - sizeof(uint64_t)];
+} sync_padded_t;
+
+// Per-thread dissemination state: partners write flags, the owner spins on
+// them, so each thread's flags share a line with nothing else
+typedef struct {
+    int flags[2][SYNC_MAX_ROUNDS];
+    int parity;
+    int sense;
+    char pad[SYNC_CACHE_LINE - (2 * SYNC_MAX_ROUNDS + 2) * sizeof(int)];
+} sync_dissemination_node_t;
+
+typedef struct {
+    sync_barrier_kind_t kind;
+    int threads;
+    int rounds;                             // Dissemination
+    // Condition variable barrier
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int waiting;
+    unsigned generation;
+#if SYNC_HAVE_PTHREAD_BARRIER
+    pthread_barrier_t pthread_barrier;
+#endif
+    // Central sense-reversing barrier
+    sync_padded_t count;
+    sync_padded_t sense;
+    sync_padded_t *local_sense;             // Per thread
+    sync_dissemination_node_t *nodes;       // Per thread
+} sync_barrier_t;
+
+typedef struct {
+    sync_lock_kind_t kind;
+    pthread_mutex_t mutex;
+    sync_padded_t flag;                     // TTAS
+    sync_padded_t next_ticket;
+    sync_padded_t now_serving;
+} sync_lock_t;
+
+typedef struct {
+    sync_padded_t head;                     // Consumer position
+    sync_padded_t cached_tail;              // Consumer's copy of tail
+    sync_padded_t tail;                     // Producer position
+    sync_padded_t cached_head;              // Producer's copy of head
+    uint64_t *items;
+    uint64_t mask;
+} sync_spsc_queue_t;
+
+typedef struct {
+    uint64_t sequence;
+    uint64_t value;
+} sync_mpmc_cell_t;
+
+typedef struct {
+    sync_padded_t enqueue_pos;
+    sync_padded_t dequeue_pos;
+    sync_mpmc_cell_t *cells;
+    uint64_t mask;
+} sync_mpmc_queue_t;
+
+// Team member: worker `tid` of `threads`
+typedef void (*sync_worker_t)(int tid, int threads, void *ctx);
+
+static const char *const sync_barrier_names[SYNC_BARRIER_KINDS] = {
+    "Condvar", "Pthread", "Central", "Dissemination"
+};
+
+static const char *const sync_lock_names[SYNC_LOCK_KINDS] = {
+    "Mutex", "TTAS", "Ticket"
+};
+
+// Spinning
+// ========
+
+static inline void sync_cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+// One step of a spin-wait: pause, then yield once the wait gets long
+static inline void sync_backoff(unsigned *spins) {
+    if (*spins < SYNC_SPIN_LIMIT) {
+        (*spins)++;
+        sync_cpu_relax();
+    } else {
+        sched_yield();
+    }
+}
+
+// Zeroed, cache-line aligned; NULL on failure
+static inline void *sync_alloc(size_t size) {
+    void *p = NULL;
+    if (posix_memalign(&p, SYNC_CACHE_LINE, size) != 0) {
+        return NULL;
+    }
+    memset(p, 0, size);
+    return p;
+}
+
+// Barriers
+// ========
+
+static inline int sync_barrier_init(sync_barrier_t *b, sync_barrier_kind_t kind, int threads) {
+    if (threads < 1 || threads > SYNC_MAX_THREADS) {
+        return -1;
+    }
+    memset(b, 0, sizeof(*b));
+    b->kind = kind;
+    b->threads = threads;
+    switch (kind) {
+    case SYNC_BARRIER_CONDVAR:
+        if (pthread_mutex_init(&b->mutex, NULL) != 0) {
+            return -1;
+        }
+        if (pthread_cond_init(&b->cond, NULL) != 0) {
+            pthread_mutex_destroy(&b->mutex);
+            return -1;
+        }
+        return 0;
+    case SYNC_BARRIER_PTHREAD:
+#if SYNC_HAVE_PTHREAD_BARRIER
+        return pthread_barrier_init(&b->pthread_barrier, NULL, (unsigned)threads) == 0 ? 0 : -1;
+#else
+        return -1;
+#endif
+    case SYNC_BARRIER_CENTRAL:
+        b->count.value = (uint64_t)threads;
+        b->local_sense = sync_alloc((size_t)threads * sizeof(sync_padded_t));
+        return b->local_sense ? 0 : -1;
+    case SYNC_BARRIER_DISSEMINATION:
+        while ((1 << b->rounds) < threads) {
+            b->rounds++;
+        }
+        b->nodes = sync_alloc((size_t)threads * sizeof(sync_dissemination_node_t));
+        if (!b->nodes) {
+            return -1;
+        }
+        for (int t = 0; t < threads; t++) {
+            b->nodes[t].sense = 1;
+        }
+        return 0;
+    default:
+        return -1;
+    }
+}
+
+static inline void sync_barrier_destroy(sync_barrier_t *b) {
+    switch (b->kind) {
+    case SYNC_BARRIER_CONDVAR:
+        pthread_cond_destroy(&b->cond);
+        pthread_mutex_destroy(&b->mutex);
+        break;
+    case SYNC_BARRIER_PTHREAD:
+#if SYNC_HAVE_PTHREAD_BARRIER
+        pthread_barrier_destroy(&b->pthread_barrier);
+#endif
+        break;
+    default:
+        break;
+    }
+    free(b->local_sense);
+    free(b->nodes);
+    b->local_sense = NULL;
+    b->nodes = NULL;
+}
+
+// Blocks worker `tid` until all threads of the barrier have arrived
+static inline void sync_barrier_wait(sync_barrier_t *b, int tid) {
+    unsigned spins = 0;
+
+    switch (b->kind) {
+    case SYNC_BARRIER_CONDVAR: {
+        pthread_mutex_lock(&b->mutex);
+        unsigned generation = b->generation;
+        if (++b->waiting == b->threads) {
+            b->waiting = 0;
+            b->generation++;
+            pthread_cond_broadcast(&b->cond);
+        } else {
+            while (generation == b->generation) {
+                pthread_cond_wait(&b->cond, &b->mutex);
+            }
+        }
+        pthread_mutex_unlock(&b->mutex);
+        break;
+    }
+    case SYNC_BARRIER_PTHREAD:
+#if SYNC_HAVE_PTHREAD_BARRIER
+        pthread_barrier_wait(&b->pthread_barrier);
+#endif
+        break;
+    case SYNC_BARRIER_CENTRAL: {
+        // The last arrival resets the count and flips the shared sense
+        uint64_t sense = !b->local_sense[tid].value;
+        b->local_sense[tid].value = sense;
+        if (__atomic_sub_fetch(&b->count.value, 1, __ATOMIC_ACQ_REL) == 0) {
+            __atomic_store_n(&b->count.value, (uint64_t)b->threads, __ATOMIC_RELAXED);
+            __atomic_store_n(&b->sense.value, sense, __ATOMIC_RELEASE);
+        } else {
+            while (__atomic_load_n(&b->sense.value, __ATOMIC_ACQUIRE) != sense) {
+                sync_backoff(&spins);
+            }
+        }
+        break;
+    }
+    case SYNC_BARRIER_DISSEMINATION: {
+        // Round r: signal the thread 2^r ahead, wait for the one 2^r behind
+        sync_dissemination_node_t *self = &b->nodes[tid];
+        int parity = self->parity;
+        int sense = self->sense;
+        for (int r = 0; r < b->rounds; r++) {
+            sync_dissemination_node_t *partner = &b->nodes[(tid + (1 << r)) % b->threads];
+            __atomic_store_n(&partner->flags[parity][r], sense, __ATOMIC_RELEASE);
+            spins = 0;
+            while (__atomic_load_n(&self->flags[parity][r], __ATOMIC_ACQUIRE) != sense) {
+                sync_backoff(&spins);
+            }
+        }
+        // Two flag sets alternate; the sense flips every second episode
+        if (parity == 1) {
+            self->sense = !sense;
+        }
+        self->parity = 1 - parity;
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+// Locks
+// =====
+
+static inline int sync_lock_init(sync_lock_t *l, sync_lock_kind_t kind) {
+    memset(l, 0, sizeof(*l));
+    l->kind = kind;
+    if (kind == SYNC_LOCK_MUTEX) {
+        return pthread_mutex_init(&l->mutex, NULL) == 0 ? 0 : -1;
+    }
+    return kind < SYNC_LOCK_KINDS ? 0 : -1;
+}
+
+static inline void sync_lock_destroy(sync_lock_t *l) {
+    if (l->kind == SYNC_LOCK_MUTEX) {
+        pthread_mutex_destroy(&l->mutex);
+    }
+}
+
+static inline void sync_lock_acquire(sync_lock_t *l) {
+    unsigned spins = 0;
+
+    switch (l->kind) {
+    case SYNC_LOCK_MUTEX:
+        pthread_mutex_lock(&l->mutex);
+        break;
+    case SYNC_LOCK_TTAS:
+        // Spin on a plain load so waiters share the line until it is released
+        while (__atomic_exchange_n(&l->flag.value, 1, __ATOMIC_ACQUIRE) != 0) {
+            while (__atomic_load_n(&l->flag.value, __ATOMIC_RELAXED) != 0) {
+                sync_backoff(&spins);
+            }
+        }
+        break;
+    case SYNC_LOCK_TICKET: {
+        uint64_t ticket = __atomic_fetch_add(&l->next_ticket.value, 1, __ATOMIC_RELAXED);
+        while (__atomic_load_n(&l->now_serving.value, __ATOMIC_ACQUIRE) != ticket) {
+            sync_backoff(&spins);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+static inline void sync_lock_release(sync_lock_t *l) {
+    switch (l->kind) {
+    case SYNC_LOCK_MUTEX:
+        pthread_mutex_unlock(&l->mutex);
+        break;
+    case SYNC_LOCK_TTAS:
+        __atomic_store_n(&l->flag.value, 0, __ATOMIC_RELEASE);
+        break;
+    case SYNC_LOCK_TICKET:
+        // Only the holder writes now_serving
+        __atomic_store_n(&l->now_serving.value, l->now_serving.value + 1, __ATOMIC_RELEASE);
+        break;
+    default:
+        break;
+    }
+}
+
+// Queues
+// ======
+
+// capacity must be a power of two
+static inline int sync_spsc_init(sync_spsc_queue_t *q, size_t capacity) {
+    memset(q, 0, sizeof(*q));
+    if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+        return -1;
+    }
+    q->items = sync_alloc(capacity * sizeof(uint64_t));
+    q->mask = capacity - 1;
+    return q->items ? 0 : -1;
+}
+
+static inline void sync_spsc_destroy(sync_spsc_queue_t *q) {
+    free(q->items);
+    q->items = NULL;
+}
+
+// Producer only. Returns -1 when full.
+static inline int sync_spsc_push(sync_spsc_queue_t *q, uint64_t item) {
+    uint64_t tail = q->tail.value;
+    if (tail - q->cached_head.value > q->mask) {
+        q->cached_head.value = __atomic_load_n(&q->head.value, __ATOMIC_ACQUIRE);
+        if (tail - q->cached_head.value > q->mask) {
+            return -1;
+        }
+    }
+    q->items[tail & q->mask] = item;
+    __atomic_store_n(&q->tail.value, tail + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+// Consumer only. Returns -1 when empty.
+static inline int sync_spsc_pop(sync_spsc_queue_t *q, uint64_t *item) {
+    uint64_t head = q->head.value;
+    if (head == q->cached_tail.value) {
+        q->cached_tail.value = __atomic_load_n(&q->tail.value, __ATOMIC_ACQUIRE);
+        if (head == q->cached_tail.value) {
+            return -1;
+        }
+    }
+    *item = q->items[head & q->mask];
+    __atomic_store_n(&q->head.value, head + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+// capacity must be a power of two
+static inline int sync_mpmc_init(sync_mpmc_queue_t *q, size_t capacity) {
+    memset(q, 0, sizeof(*q));
+    if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+        return -1;
+    }
+    q->cells = sync_alloc(capacity * sizeof(sync_mpmc_cell_t));
+    if (!q->cells) {
+        return -1;
+    }
+    for (size_t i = 0; i < capacity; i++) {
+        q->cells[i].sequence = i;
+    }
+    q->mask = capacity - 1;
+    return 0;
+}
+
+static inline void sync_mpmc_destroy(sync_mpmc_queue_t *q) {
+    free(q->cells);
+    q->cells = NULL;
+}
+
+// Returns -1 when full. A cell is free for position pos when its sequence
+// equals pos, and holds the item for pos when it equals pos + 1.
+static inline int sync_mpmc_push(sync_mpmc_queue_t *q, uint64_t item) {
+    uint64_t pos = __atomic_load_n(&q->enqueue_pos.value, __ATOMIC_RELAXED);
+    for (;;) {
+        sync_mpmc_cell_t *cell = &q->cells[pos & q->mask];
+        uint64_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+        int64_t diff = (int64_t)(sequence - pos);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&q->enqueue_pos.value, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                cell->value = item;
+                __atomic_store_n(&cell->sequence, pos + 1, __ATOMIC_RELEASE);
+                return 0;
+            }
+        } else if (diff < 0) {
+            return -1;
+        } else {
+            pos = __atomic_load_n(&q->enqueue_pos.value, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+// Returns -1 when empty
+static inline int sync_mpmc_pop(sync_mpmc_queue_t *q, uint64_t *item) {
+    uint64_t pos = __atomic_load_n(&q->dequeue_pos.value, __ATOMIC_RELAXED);
+    for (;;) {
+        sync_mpmc_cell_t *cell = &q->cells[pos & q->mask];
+        uint64_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+        int64_t diff = (int64_t)(sequence - (pos + 1));
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&q->dequeue_pos.value, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                *item = cell->value;
+                __atomic_store_n(&cell->sequence, pos + q->mask + 1, __ATOMIC_RELEASE);
+                return 0;
+            }
+        } else if (diff < 0) {
+            return -1;
+        } else {
+            pos = __atomic_load_n(&q->dequeue_pos.value, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+// Teams
+// =====
+
+typedef struct {
+    sync_worker_t worker;
+    void *ctx;
+    int tid;
+    int threads;
+    int *gate;              // 0 wait, 1 run, -1 abandon
+} sync_member_t;
+
+static inline void *sync_member_entry(void *arg) {
+    sync_member_t *m = (sync_member_t *)arg;
+    unsigned spins = 0;
+    int gate;
+
+    while ((gate = __atomic_load_n(m->gate, __ATOMIC_ACQUIRE)) == 0) {
+        sync_backoff(&spins);
+    }
+    if (gate > 0) {
+        m->worker(m->tid, m->threads, m->ctx);
+    }
+    return NULL;
+}
+
+// Runs worker on `threads` concurrent threads (worker 0 on the caller) and
+// joins them. Unlike parallel_for, which may run several ranges on one
+// thread, every worker gets its own thread, so workers may wait for each
+// other. Returns -1 without running anything if a thread cannot be started.
+static inline int sync_run_team(int threads, sync_worker_t worker, void *ctx) {
+    pthread_t handles[SYNC_MAX_THREADS];
+    sync_member_t members[SYNC_MAX_THREADS];
+    int gate = 0;
+    int started = 1;
+
+    if (threads < 1 || threads > SYNC_MAX_THREADS) {
+        return -1;
+    }
+    for (int t = 0; t < threads; t++) {
+        members[t].worker = worker;
+        members[t].ctx = ctx;
+        members[t].tid = t;
+        members[t].threads = threads;
+        members[t].gate = &gate;
+    }
+    for (; started < threads; started++) {
+        if (pthread_create(&handles[started], NULL, sync_member_entry, &members[started]) != 0) {
+            break;
+        }
+    }
+    __atomic_store_n(&gate, started == threads ? 1 : -1, __ATOMIC_RELEASE);
+    if (started == threads) {
+        worker(0, threads, ctx);
+    }
+    for (int t = 1; t < started; t++) {
+        pthread_join(handles[t], NULL);
+    }
+    return started == threads ? 0 : -1;
+}
+
+#endif // ALPHAAHB_SYNC_PRIMITIVES_H
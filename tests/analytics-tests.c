@@ -0,0 +1,526 @@
+/*
+ * AlphaAHB V5 Analytics Kernel Tests
+ *
+ * This file contains correctness tests for the reduction kernels used by the
+ * analytics examples, checking each kernel against an exact reference and
+ * checking that the parallel kernels are invariant under the thread count.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+#include "../examples/reduction-kernels.h"
+#include "../examples/parallel-reductions.h"
+#include "../examples/statistics-engine.h"
+#include "../examples/columnar-store.h"
+
+// Test framework macros
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s\n", message); \
+            return 1; \
+        } \
+    } while (0)
+
+#define TEST_PASS(message) \
+    printf("PASS: %s\n", message)
+
+#define TEST_START(name) \
+    printf("\n=== Testing %s ===\n", name)
+
+// Deterministic test data (xorshift, independent of the libc rand())
+static unsigned int test_seed = 2463534242u;
+
+static float test_random_float(float scale) {
+    test_seed ^= test_seed << 13;
+    test_seed ^= test_seed >> 17;
+    test_seed ^= test_seed << 5;
+    return (float)(test_seed >> 8) / 16777216.0f * scale;
+}
+
+static double relative_error(double value, double reference) {
+    if (reference == 0.0) {
+        return fabs(value);
+    }
+    return fabs(value - reference) / fabs(reference);
+}
+
+int test_exact_accumulator() {
+    TEST_START("exact long accumulator");
+
+    // Catastrophic cancellation: naive summation returns 0
+    double values[] = { 1e100, 1.0, -1e100, 1e-100 };
+    TEST_ASSERT(reduce_sum_exact_f64(values, 4) == 1.0 + 1e-100,
+                "Cancellation not exact");
+    TEST_PASS("Cancellation across 200 orders of magnitude");
+
+    // Order independence
+    double forward[] = { 0.1, 0.2, 0.3, -0.6, 1e-17 };
+    double backward[] = { 1e-17, -0.6, 0.3, 0.2, 0.1 };
+    TEST_ASSERT(reduce_sum_exact_f64(forward, 5) == reduce_sum_exact_f64(backward, 5),
+                "Result depends on summation order");
+    TEST_PASS("Order independence");
+
+    // Subnormals and negative totals
+    double tiny[] = { DBL_MIN / 4, DBL_MIN / 4, -DBL_MIN };
+    TEST_ASSERT(reduce_sum_exact_f64(tiny, 3) == -DBL_MIN / 2,
+                "Subnormal summation failed");
+    TEST_PASS("Subnormal and negative totals");
+
+    // Round to nearest even on the final conversion
+    double halfway[] = { 1.0, ldexp(1.0, -53) };
+    TEST_ASSERT(reduce_sum_exact_f64(halfway, 2) == 1.0, "Tie not rounded to even");
+    double above[] = { 1.0, ldexp(1.0, -53), ldexp(1.0, -1000) };
+    TEST_ASSERT(reduce_sum_exact_f64(above, 3) == 1.0 + DBL_EPSILON,
+                "Sticky bit ignored");
+    TEST_PASS("Correct rounding");
+
+    // Overflow and special values
+    double big[] = { DBL_MAX, DBL_MAX, -DBL_MAX };
+    TEST_ASSERT(reduce_sum_exact_f64(big, 3) == DBL_MAX, "Intermediate overflow not absorbed");
+    double inf[] = { 1.0, INFINITY };
+    TEST_ASSERT(isinf(reduce_sum_exact_f64(inf, 2)), "Infinity not propagated");
+    TEST_PASS("Overflow headroom and special values");
+
+    return 0;
+}
+
+int test_lane_sums() {
+    TEST_START("multi-accumulator sums");
+
+    const size_t n = 1000003;
+    float *x = malloc(n * sizeof(float));
+    for (size_t i = 0; i < n; i++) {
+        x[i] = test_random_float(100.0f);
+    }
+
+    double exact = reduce_sum_exact_f32(x, n);
+    double naive_err = relative_error(reduce_sum_naive_f32(x, n), exact);
+
+    TEST_ASSERT(relative_error(reduce_sum_f32(x, n), exact) < 1e-4, "Lane sum inaccurate");
+    TEST_ASSERT(relative_error(reduce_sum_pairwise_f32(x, n), exact) < 1e-6,
+                "Pairwise sum inaccurate");
+    TEST_ASSERT(relative_error(reduce_sum_kahan_f32(x, n), exact) < 1e-7,
+                "Kahan sum inaccurate");
+    TEST_ASSERT(relative_error(reduce_sum_neumaier_f32(x, n), exact) < 1e-7,
+                "Neumaier sum inaccurate");
+    TEST_ASSERT(relative_error(reduce_sum_widen_f32(x, n), exact) < 1e-12,
+                "Widened sum inaccurate");
+    TEST_ASSERT(relative_error(reduce_sum_pairwise_f32(x, n), exact) <= naive_err,
+                "Pairwise sum worse than naive");
+    TEST_PASS("Accuracy against exact reference");
+
+    // Tails of every length hit the right lanes
+    for (size_t len = 0; len < 3 * REDUCE_LANES; len++) {
+        double ref = reduce_sum_exact_f32(x, len);
+        TEST_ASSERT(relative_error(reduce_sum_f32(x, len), ref) < 1e-5, "Tail handling failed");
+        TEST_ASSERT(relative_error(reduce_sum_neumaier_f32(x, len), ref) < 1e-7,
+                    "Neumaier tail handling failed");
+    }
+    TEST_PASS("Tail handling");
+
+    // Neumaier recovers small terms that straddle a much larger addend
+    float mixed[] = { 1.0f, 1e8f, 1.0f, -1e8f };
+    TEST_ASSERT(reduce_sum_neumaier_f32(mixed, 4) == 2.0f, "Neumaier lost small terms");
+    TEST_PASS("Neumaier large-addend compensation");
+
+    free(x);
+    return 0;
+}
+
+int test_dot_products() {
+    TEST_START("dot products");
+
+    const size_t n = 4099;
+    float *a = malloc(n * sizeof(float));
+    float *b = malloc(n * sizeof(float));
+    for (size_t i = 0; i < n; i++) {
+        a[i] = test_random_float(2.0f) - 1.0f;
+        b[i] = test_random_float(2.0f) - 1.0f;
+    }
+
+    double exact = reduce_dot_exact_f32(a, b, n);
+    TEST_ASSERT(relative_error(reduce_dot_f32(a, b, n), exact) < 1e-3, "Lane dot inaccurate");
+    TEST_PASS("Lane dot product");
+
+    // Ill-conditioned: the products cancel to a tiny remainder
+    float x[] = { 1e20f, 3.0f, -1e20f, 1.0f };
+    float y[] = { 1.0f, 1.0f, 1.0f, 0.5f };
+    TEST_ASSERT(reduce_dot_exact_f32(x, y, 4) == 3.5, "Exact dot lost the remainder");
+    TEST_PASS("Exact dot product under cancellation");
+
+    free(a);
+    free(b);
+    return 0;
+}
+
+int test_parallel_determinism() {
+    TEST_START("thread-count invariant parallel reductions");
+
+    const size_t rows = 5000;
+    const size_t cols = 100;
+    const size_t n = rows * cols + 77;
+    float *x = malloc(n * sizeof(float));
+    double *dx = malloc(n * sizeof(double));
+    double ref_cols[100];
+    double cols_out[100];
+    for (size_t i = 0; i < n; i++) {
+        x[i] = test_random_float(200.0f) - 100.0f;
+        dx[i] = (double)x[i] * 1e-3;
+    }
+
+    double ref_sum = preduce_sum_f32(x, n, 1);
+    size_t ref_bins = (n + PREDUCE_CHUNK - 1) / PREDUCE_CHUNK;
+    double ref_sum64 = preduce_sum_f64(dx, n, 1);
+    double ref_exact = preduce_sum_exact_f32(x, n, 1);
+    double ref_dot = preduce_dot_exact_f32(x, x, n, 1);
+    TEST_ASSERT(preduce_column_sums_f32(x, rows, cols, ref_cols, 1) == 0, "Column sums failed");
+
+    TEST_ASSERT(ref_exact == reduce_sum_exact_f32(x, n), "Parallel exact differs from sequential");
+    TEST_ASSERT(ref_dot == reduce_dot_exact_f32(x, x, n), "Parallel exact dot differs");
+    TEST_ASSERT(relative_error(ref_sum, ref_exact) < 1e-12, "Binned sum inaccurate");
+    TEST_PASS("Single-thread results match sequential kernels");
+
+    // Thread counts that do and do not divide the bin count
+    int thread_counts[] = { 2, 3, 4, 7, 8, 16, 64 };
+    for (size_t t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); t++) {
+        int threads = thread_counts[t];
+        TEST_ASSERT(preduce_sum_f32(x, n, threads) == ref_sum, "Binned f32 sum changed");
+        TEST_ASSERT(preduce_sum_f64(dx, n, threads) == ref_sum64, "Binned f64 sum changed");
+        TEST_ASSERT(preduce_sum_exact_f32(x, n, threads) == ref_exact, "Exact sum changed");
+        TEST_ASSERT(preduce_dot_exact_f32(x, x, n, threads) == ref_dot, "Exact dot changed");
+        preduce_column_sums_f32(x, rows, cols, cols_out, threads);
+        TEST_ASSERT(memcmp(cols_out, ref_cols, sizeof(ref_cols)) == 0, "Column sums changed");
+    }
+    TEST_PASS("Bit-identical results for 1 to 64 threads");
+
+    // The serial fallback for failed partials allocation walks the same
+    // tree, including across several leaves of bins
+    size_t big = 300 * PREDUCE_CHUNK + 77;
+    float *bx = malloc(big * sizeof(float));
+    double *bdx = malloc(big * sizeof(double));
+    TEST_ASSERT(bx && bdx, "Allocation failed");
+    for (size_t i = 0; i < big; i++) {
+        bx[i] = test_random_float(200.0f) - 100.0f;
+        bdx[i] = (double)bx[i] * 1e-3;
+    }
+    size_t bins = (big + PREDUCE_CHUNK - 1) / PREDUCE_CHUNK;
+    preduce_ctx_t fx = { bx, NULL, big, NULL, NULL }, fdx = { bdx, NULL, big, NULL, NULL };
+    preduce_ctx_t small = { x, NULL, n, NULL, NULL };
+    TEST_ASSERT(preduce_serial(&fx, sizeof(float), preduce_bins_f32, 0, bins) ==
+                preduce_sum_f32(bx, big, 4), "Serial f32 fallback differs");
+    TEST_ASSERT(preduce_serial(&fdx, sizeof(double), preduce_bins_f64, 0, bins) ==
+                preduce_sum_f64(bdx, big, 4), "Serial f64 fallback differs");
+    TEST_ASSERT(preduce_serial(&small, sizeof(float), preduce_bins_f32, 0, ref_bins) == ref_sum,
+                "Serial fallback differs within one leaf");
+    free(bx);
+    free(bdx);
+    TEST_PASS("Serial fallback matches the binned result");
+
+    free(x);
+    free(dx);
+    return 0;
+}
+
+int test_statistics_engine() {
+    TEST_START("parallel statistics engine");
+
+    const size_t rows = 3000;
+    const size_t cols = 37;
+    float *x = malloc(rows * cols * sizeof(float));
+    float *rec_mean = malloc(rows * sizeof(float));
+    float *rec_var = malloc(rows * sizeof(float));
+    stats_sketch_t *sketch = malloc(sizeof(stats_sketch_t));
+    stats_moments_t ref[37];
+    stats_moments_t cols_out[37];
+
+    // Large offset plus small noise: the naive sum_sq/n - mean^2 cancels here
+    for (size_t i = 0; i < rows * cols; i++) {
+        x[i] = 10000.0f + test_random_float(1.0f);
+    }
+
+    stats_options_t opt = { 1, rec_mean, rec_var, sketch, NULL };
+    TEST_ASSERT(stats_compute_f32(x, rows, cols, &opt, ref) == 0, "Statistics engine failed");
+
+    for (size_t c = 0; c < cols; c++) {
+        double mean = 0.0, m2 = 0.0;
+        float lo = INFINITY, hi = -INFINITY;
+        for (size_t r = 0; r < rows; r++) {
+            mean += x[r * cols + c];
+            lo = x[r * cols + c] < lo ? x[r * cols + c] : lo;
+            hi = x[r * cols + c] > hi ? x[r * cols + c] : hi;
+        }
+        mean /= (double)rows;
+        for (size_t r = 0; r < rows; r++) {
+            double d = x[r * cols + c] - mean;
+            m2 += d * d;
+        }
+        TEST_ASSERT(ref[c].count == rows, "Column count wrong");
+        TEST_ASSERT(relative_error(ref[c].mean, mean) < 1e-14, "Column mean inaccurate");
+        TEST_ASSERT(relative_error(stats_variance(&ref[c]), m2 / (double)rows) < 1e-9,
+                    "Column variance inaccurate");
+        TEST_ASSERT(ref[c].min == lo && ref[c].max == hi, "Column min/max wrong");
+    }
+    TEST_PASS("Column moments stable under a large offset");
+
+    for (size_t r = 0; r < rows; r += 97) {
+        double mean = 0.0, m2 = 0.0;
+        for (size_t c = 0; c < cols; c++) {
+            mean += x[r * cols + c];
+        }
+        mean /= (double)cols;
+        for (size_t c = 0; c < cols; c++) {
+            double d = x[r * cols + c] - mean;
+            m2 += d * d;
+        }
+        TEST_ASSERT(relative_error(rec_mean[r], mean) < 1e-7, "Record mean inaccurate");
+        TEST_ASSERT(relative_error(rec_var[r], m2 / (double)cols) < 1e-5,
+                    "Record variance inaccurate");
+    }
+    TEST_PASS("Per-record moments");
+
+    // Sketch quantiles against the sorted record means
+    float *sorted = malloc(rows * sizeof(float));
+    memcpy(sorted, rec_mean, rows * sizeof(float));
+    for (size_t i = 1; i < rows; i++) {
+        float v = sorted[i];
+        size_t j = i;
+        for (; j > 0 && sorted[j - 1] > v; j--) {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = v;
+    }
+    double qs[] = { 0.0, 0.01, 0.5, 0.99, 1.0 };
+    for (size_t i = 0; i < sizeof(qs) / sizeof(qs[0]); i++) {
+        float exact = sorted[(size_t)(qs[i] * (double)(rows - 1))];
+        TEST_ASSERT(relative_error(stats_sketch_quantile(sketch, qs[i]), exact) < 0.016,
+                    "Sketch quantile outside error bound");
+    }
+    TEST_ASSERT(sketch->total == rows, "Sketch count wrong");
+    TEST_PASS("Quantile sketch within 1.6% relative error");
+
+    int thread_counts[] = { 2, 3, 8, 64 };
+    for (size_t t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); t++) {
+        stats_sketch_t *other = malloc(sizeof(stats_sketch_t));
+        stats_options_t par = { thread_counts[t], NULL, NULL, other, NULL };
+        stats_compute_f32(x, rows, cols, &par, cols_out);
+        TEST_ASSERT(memcmp(cols_out, ref, sizeof(ref)) == 0, "Column moments changed");
+        TEST_ASSERT(memcmp(other, sketch, sizeof(*other)) == 0, "Sketch changed");
+        free(other);
+    }
+    TEST_PASS("Bit-identical results for 1 to 64 threads");
+
+    // More row chunks than PARALLEL_MAX_THREADS: a larger thread count is
+    // clamped to it
+    const size_t tall = (PARALLEL_MAX_THREADS + 37) * STATS_ROW_CHUNK;
+    float *column = malloc(tall * sizeof(float));
+    stats_moments_t one, clamped;
+    for (size_t i = 0; i < tall; i++) {
+        column[i] = test_random_float(1.0f);
+    }
+    stats_options_t serial = { 1, NULL, NULL, NULL, NULL };
+    stats_options_t wide = { PARALLEL_MAX_THREADS + 36, NULL, NULL, NULL, NULL };
+    TEST_ASSERT(stats_compute_f32(column, tall, 1, &serial, &one) == 0 &&
+                stats_compute_f32(column, tall, 1, &wide, &clamped) == 0,
+                "Statistics engine failed");
+    TEST_ASSERT(memcmp(&one, &clamped, sizeof(one)) == 0, "Column moments changed");
+    free(column);
+    TEST_PASS("Thread counts above the maximum clamped");
+
+    free(sorted);
+    free(sketch);
+    free(rec_var);
+    free(rec_mean);
+    free(x);
+    return 0;
+}
+
+int test_columnar_store() {
+    TEST_START("memory-mapped columnar store");
+
+    const size_t rows = 10000;
+    const size_t chunk_rows = 1024;
+    char path[] = "/tmp/alphaahb-colstore-XXXXXX";
+    int fd = mkstemp(path);
+    TEST_ASSERT(fd >= 0, "Could not create temporary file");
+    close(fd);
+
+    float *feature = malloc(rows * sizeof(float));
+    int32_t *timestamp = malloc(rows * sizeof(int32_t));
+    int32_t *sensor = malloc(rows * sizeof(int32_t));
+    int32_t *wide = malloc(rows * sizeof(int32_t));
+    int32_t *decoded = malloc(chunk_rows * sizeof(int32_t));
+    float *selected = malloc(rows * sizeof(float));
+    for (size_t i = 0; i < rows; i++) {
+        feature[i] = test_random_float(100.0f) - 50.0f;
+        timestamp[i] = 1000000 + (int32_t)(i * 10) + (int32_t)test_random_float(5.0f);
+        sensor[i] = (i / 3000) % 2 ? 77 : -200 + (int32_t)test_random_float(300.0f);
+        wide[i] = (i & 1) ? INT32_MAX : INT32_MIN;
+    }
+
+    colstore_column_t columns[] = {
+        { "feature", COLSTORE_F32, COLSTORE_AUTO, feature, 1 },
+        { "timestamp", COLSTORE_I32, COLSTORE_AUTO, timestamp, 1 },
+        { "sensor", COLSTORE_I32, COLSTORE_AUTO, sensor, 1 },
+        { "wide", COLSTORE_I32, COLSTORE_AUTO, wide, 1 },
+    };
+    TEST_ASSERT(colstore_write(path, columns, 4, rows, chunk_rows) == 0, "Write failed");
+
+    colstore_t cs;
+    TEST_ASSERT(colstore_open(&cs, path) == 0, "Open failed");
+    TEST_ASSERT(cs.header->num_chunks == (rows + chunk_rows - 1) / chunk_rows,
+                "Chunk count wrong");
+
+    // Encodings chosen per chunk and lossless round trips
+    int ts = colstore_find_column(&cs, "timestamp");
+    int sn = colstore_find_column(&cs, "sensor");
+    int wd = colstore_find_column(&cs, "wide");
+    TEST_ASSERT(ts == 1 && sn == 2 && wd == 3 && colstore_find_column(&cs, "x") < 0,
+                "Column lookup failed");
+    TEST_ASSERT(colstore_chunk(&cs, ts, 0)->encoding == COLSTORE_DELTA, "Timestamps not delta coded");
+    TEST_ASSERT(colstore_chunk(&cs, sn, 0)->encoding == COLSTORE_FOR, "Sensor not FOR coded");
+    TEST_ASSERT(colstore_chunk(&cs, wd, 0)->encoding == COLSTORE_PLAIN, "Wide range not plain");
+    TEST_ASSERT(colstore_chunk(&cs, sn, 3)->bit_width == 0, "Constant chunk not zero width");
+    for (size_t k = 0; k < cs.header->num_chunks; k++) {
+        size_t first = k * chunk_rows;
+        for (int c = 1; c <= 3; c++) {
+            const int32_t *src = c == ts ? timestamp : (c == sn ? sensor : wide);
+            const colstore_chunk_t *ch = colstore_chunk(&cs, c, k);
+            colstore_decode_i32(&cs, ch, decoded);
+            TEST_ASSERT(memcmp(decoded, src + first, ch->count * sizeof(int32_t)) == 0,
+                        "Decoded chunk differs");
+            TEST_ASSERT(ch->offset % COLSTORE_ALIGN == 0, "Chunk not aligned");
+        }
+    }
+    TEST_PASS("Delta, frame-of-reference and plain round trips");
+
+    // Full scan reads the float column in place and matches a direct pass
+    stats_moments_t direct, scanned, filtered;
+    colstore_scan_info_t info;
+    stats_moments_f32(feature, rows, &direct);
+    TEST_ASSERT(colstore_moments(&cs, 0, NULL, 1, &scanned, &info) == 0, "Scan failed");
+    TEST_ASSERT(scanned.count == rows && scanned.min == direct.min && scanned.max == direct.max,
+                "Scan count or range wrong");
+    TEST_ASSERT(relative_error(scanned.mean, direct.mean) < 1e-12, "Scan mean inaccurate");
+    TEST_ASSERT(relative_error(scanned.m2, direct.m2) < 1e-12, "Scan variance inaccurate");
+    TEST_ASSERT(info.chunks_zero_copy == info.chunks_total, "Float chunks were copied");
+    TEST_PASS("Zero-copy full scan");
+
+    // Range predicates: chunk skipping must not change the answer
+    colstore_filter_t filters[] = {
+        { 1, 1030000.0, 1049999.0 },   // Timestamp window inside a few chunks
+        { 2, 77.0, 77.0 },             // Only the constant sensor runs
+        { 2, 0.0, 1000.0 },            // Partial chunks everywhere
+        { 1, 0.0, 10.0 },              // Nothing selected
+    };
+    for (size_t f = 0; f < sizeof(filters) / sizeof(filters[0]); f++) {
+        const int32_t *keys = filters[f].column == 1 ? timestamp : sensor;
+        size_t kept = 0;
+        for (size_t i = 0; i < rows; i++) {
+            if (keys[i] >= filters[f].lo && keys[i] <= filters[f].hi) {
+                selected[kept++] = feature[i];
+            }
+        }
+        stats_moments_f32(selected, kept, &direct);
+        TEST_ASSERT(colstore_moments(&cs, 0, &filters[f], 1, &filtered, &info) == 0,
+                    "Filtered scan failed");
+        TEST_ASSERT(filtered.count == kept && info.rows_selected == kept,
+                    "Filtered row count wrong");
+        TEST_ASSERT(kept == 0 || relative_error(filtered.mean, direct.mean) < 1e-9,
+                    "Filtered mean wrong");
+        TEST_ASSERT(info.chunks_skipped + info.chunks_full + info.chunks_partial ==
+                    info.chunks_total, "Chunk accounting wrong");
+        if (f == 0 || f == 3) {
+            TEST_ASSERT(info.chunks_skipped >= info.chunks_total - 3, "Chunks not skipped");
+        }
+        if (f == 1) {
+            TEST_ASSERT(info.chunks_full > 0, "Full chunks not detected");
+        }
+
+        // Thread-count invariance
+        for (int threads = 2; threads <= 16; threads *= 2) {
+            stats_moments_t other;
+            colstore_moments(&cs, 0, &filters[f], threads, &other, NULL);
+            TEST_ASSERT(memcmp(&other, &filtered, sizeof(other)) == 0,
+                        "Filtered scan depends on thread count");
+        }
+    }
+    TEST_PASS("Chunk skipping with range predicates");
+
+    // Integer columns scan through the decoder
+    TEST_ASSERT(colstore_moments(&cs, sn, NULL, 4, &scanned, &info) == 0 &&
+                scanned.count == rows && info.chunks_zero_copy == 0,
+                "Integer column scan failed");
+    TEST_PASS("Decoded integer column scan");
+    colstore_close(&cs);
+
+    // More chunks than PARALLEL_MAX_THREADS: a larger thread count is
+    // clamped to it
+    stats_moments_t clamped;
+    TEST_ASSERT(colstore_write(path, columns, 4, rows, 64) == 0 && colstore_open(&cs, path) == 0 &&
+                cs.header->num_chunks > PARALLEL_MAX_THREADS + 36, "Rewrite failed");
+    TEST_ASSERT(colstore_moments(&cs, 0, NULL, 1, &scanned, NULL) == 0 &&
+                colstore_moments(&cs, 0, NULL, PARALLEL_MAX_THREADS + 36, &clamped, NULL) == 0 &&
+                memcmp(&scanned, &clamped, sizeof(scanned)) == 0,
+                "Scan with too many threads failed");
+    TEST_PASS("Thread counts above the maximum clamped");
+    colstore_close(&cs);
+
+    // Corrupt directories are rejected instead of mapped blindly
+    FILE *f = fopen(path, "r+b");
+    uint32_t bad_version = 99;
+    fseek(f, 8, SEEK_SET);
+    fwrite(&bad_version, sizeof(bad_version), 1, f);
+    fclose(f);
+    TEST_ASSERT(colstore_open(&cs, path) != 0, "Corrupt header accepted");
+    TEST_ASSERT(colstore_write(path, columns, 4, rows, COLSTORE_MAX_CHUNK_ROWS + 1) != 0,
+                "Chunk payload beyond 32 bits accepted");
+    TEST_PASS("Header and chunk size validation");
+
+    remove(path);
+    free(feature);
+    free(timestamp);
+    free(sensor);
+    free(wide);
+    free(decoded);
+    free(selected);
+    return 0;
+}
+
+int run_all_tests() {
+    printf("AlphaAHB V5 Analytics Kernel Tests\n");
+    printf("==================================\n");
+
+    int failed_tests = 0;
+
+    // Reduction kernels
+    failed_tests += test_exact_accumulator();
+    failed_tests += test_lane_sums();
+    failed_tests += test_dot_products();
+
+    // Parallel reductions
+    failed_tests += test_parallel_determinism();
+
+    // Statistics engine
+    failed_tests += test_statistics_engine();
+    failed_tests += test_columnar_store();
+
+    printf("\n=== Test Summary ===\n");
+    if (failed_tests == 0) {
+        printf("ALL TESTS PASSED!\n");
+    } else {
+        printf("FAILED: %d tests\n", failed_tests);
+    }
+
+    return failed_tests;
+}
+
+int main() {
+    return run_all_tests();
+}
@@ -0,0 +1,853 @@
+/*
+ * AlphaAHB V5 Microbenchmark Harness
+ *
+ * Timing harness for the performance benchmarks. A benchmark is a kernel
+ * that runs its workload a given number of times; the harness
+ *
+ * - calibrates that count until one sample lasts at least min_sample_ns
+ * - runs warmup samples untimed (caches, branch predictors, page faults)
+ * - times `repetitions` samples with CLOCK_MONOTONIC
+ * - rejects outliers by modified z-score (0.6745 * |x - median| / MAD above
+ *   BENCH_OUTLIER_Z, the Iglewicz-Hoaglin rule) and reports median, MAD and
+ *   min of the remaining samples per operation
+ *
+ * The clock resolution does not matter once a sample lasts milliseconds, so
+ * the portable monotonic clock is used instead of rdtsc (whose rate differs
+ * from the core clock and needs its own calibration).
+ *
+ * Kernels must feed their results to bench_do_not_optimize or
+ * bench_clobber_memory, or the compiler may delete the measured work.
+ *
+ * Results can be collected into a bench_results_t and written as JSON or
+ * CSV together with host metadata (CPU model and frequency, compiler, build
+ * flags, git revision), which tooling/benchmarking/compare_benchmarks.py
+ * diffs between runs. Build flags and revision come from the BENCH_CFLAGS
+ * and BENCH_GIT_SHA string macros when the build defines them.
+ *
+ * Benchmarks can be selected by substring and POSIX extended regex
+ * (bench_filter_t). Size sweeps cover working sets from L1-resident to
+ * DRAM-resident (bench_sweep_sizes); their points carry size_bytes and
+ * threads, count bytes as operations, and print as throughput-vs-size
+ * curves (bench_print_curve). Contention benchmarks carry threads only and
+ * print as scaling curves over thread counts (bench_print_scaling).
+ *
+ * On Linux the timed samples can also be counted with hardware performance
+ * counters (bench_counters_t, perf_event_open): cycles, instructions, L1D
+ * and last-level cache misses, branch misses and dTLB misses, reported per
+ * operation next to the timings. Counters that cannot be opened (no PMU, as
+ * in most VMs, or perf_event_paranoid forbidding it) are reported as absent
+ * and the benchmark runs as before. Only user-space events of the measuring
+ * thread and threads it creates while counting are seen, so work on a
+ * thread pool started earlier is not included.
+ *
+ * Requires _POSIX_C_SOURCE >= 200809L; hardware counters additionally need
+ * _DEFAULT_SOURCE (syscall) and are compiled out without it.
+ */
+
+#ifndef ALPHAAHB_BENCHMARK_HARNESS_H
+#define ALPHAAHB_BENCHMARK_HARNESS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <regex.h>
+#include <sys/utsname.h>
+
+#if defined(__linux__) && (defined(_DEFAULT_SOURCE) || defined(_GNU_SOURCE))
+#include <errno.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#define BENCH_HAVE_PERF 1
+#else
+#define BENCH_HAVE_PERF 0
+#endif
+
+#define BENCH_MAX_REPETITIONS 64
+#define BENCH_OUTLIER_Z 3.5
+
+// Points in a size sweep (4 KiB to 1 TiB in steps of 4x at most)
+#define BENCH_MAX_SWEEP_POINTS 16
+
+// Calibration stops growing the count past this many kernel calls
+#define BENCH_MAX_ITERATIONS ((uint64_t)1 << 40)
+
+typedef enum {
+    BENCH_CYCLES,
+    BENCH_INSTRUCTIONS,
+    BENCH_L1D_MISSES,
+    BENCH_LLC_MISSES,
+    BENCH_BRANCH_MISSES,
+    BENCH_DTLB_MISSES,
+    BENCH_NUM_COUNTERS
+} bench_counter_t;
+
+typedef struct {
+    int fd[BENCH_NUM_COUNTERS];     // -1 where the event could not be opened
+    int opened;
+    char status[128];               // Human-readable availability
+} bench_counters_t;
+
+typedef struct {
+    int64_t min_sample_ns;      // Shortest acceptable timed sample
+    int warmup;                 // Untimed samples after calibration
+    int repetitions;            // Timed samples, at most BENCH_MAX_REPETITIONS
+    bench_counters_t *counters; // Counts the timed samples; NULL for none
+} bench_config_t;
+
+#define BENCH_NAME_MAX 64
+
+typedef struct {
+    char name[BENCH_NAME_MAX];
+    uint64_t iterations;        // Kernel calls per sample
+    double ops_per_iteration;   // Operations counted in one kernel call
+    double median_ns;           // Per operation, outliers removed
+    double mad_ns;              // Median absolute deviation per operation
+    double min_ns;              // Fastest kept sample per operation
+    double ops_per_sec;         // From the median
+    int samples;                // Timed samples taken
+    int outliers;               // Samples rejected
+    uint64_t size_bytes;        // Working set of a sweep point, else 0
+    int threads;                // Threads of a sweep point, else 0
+    double sample_ns[BENCH_MAX_REPETITIONS];    // Kept samples per operation, sorted
+    double counters[BENCH_NUM_COUNTERS];        // Per operation over all timed samples,
+                                                // negative when not counted
+} bench_result_t;
+
+typedef struct {
+    bench_result_t *items;
+    size_t count;
+    size_t capacity;
+} bench_results_t;
+
+typedef struct {
+    char cpu_model[128];
+    double cpu_mhz;             // cpufreq maximum, else /proc/cpuinfo; 0 if unknown
+    long logical_cpus;
+    char hostname[64];
+    char kernel[224];           // uname sysname, release and machine
+    char compiler[128];
+    char cflags[256];
+    char git_sha[64];
+    char timestamp[32];         // UTC, ISO 8601
+} bench_host_t;
+
+typedef struct {
+    const char *substring;      // NULL matches everything
+    regex_t regex;
+    int has_regex;
+} bench_filter_t;
+
+// Runs the measured workload `iterations` times
+typedef void (*bench_kernel_t)(void *ctx, uint64_t iterations);
+
+static inline bench_config_t bench_default_config(void) {
+    bench_config_t cfg = { 10000000, 2, 15, NULL };
+    return cfg;
+}
+
+// Compiler barriers
+// =================
+
+// Forces the value behind p to be materialized in memory
+static inline void bench_do_not_optimize(const void *p) {
+#if defined(__GNUC__)
+    __asm__ __volatile__("" : : "r"(p) : "memory");
+#else
+    static const void *volatile sink;
+    sink = p;
+#endif
+}
+
+// Makes every prior store observable, so stores cannot be elided
+static inline void bench_clobber_memory(void) {
+#if defined(__GNUC__)
+    __asm__ __volatile__("" : : : "memory");
+#endif
+}
+
+// Statistics
+// ==========
+
+static inline int64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Insertion sort; sample counts are tiny
+static inline void bench_sort(double *v, int n) {
+    for (int i = 1; i < n; i++) {
+        double x = v[i];
+        int j = i - 1;
+        while (j >= 0 && v[j] > x) {
+            v[j + 1] = v[j];
+            j--;
+        }
+        v[j + 1] = x;
+    }
+}
+
+// Median of a sorted array
+static inline double bench_median(const double *sorted, int n) {
+    if (n == 0) {
+        return 0.0;
+    }
+    return n % 2 ? sorted[n / 2] : 0.5 * (sorted[n / 2 - 1] + sorted[n / 2]);
+}
+
+static inline double bench_mad(const double *sorted, int n, double median) {
+    double dev[BENCH_MAX_REPETITIONS];
+    for (int i = 0; i < n; i++) {
+        dev[i] = sorted[i] > median ? sorted[i] - median : median - sorted[i];
+    }
+    bench_sort(dev, n);
+    return bench_median(dev, n);
+}
+
+// Drops outliers from a sorted array in place; returns the kept count
+static inline int bench_reject_outliers(double *sorted, int n) {
+    double median = bench_median(sorted, n);
+    double mad = bench_mad(sorted, n, median);
+    int kept = 0;
+
+    if (mad == 0.0) {
+        return n;
+    }
+    for (int i = 0; i < n; i++) {
+        double dev = sorted[i] > median ? sorted[i] - median : median - sorted[i];
+        if (0.6745 * dev / mad <= BENCH_OUTLIER_Z) {
+            sorted[kept++] = sorted[i];
+        }
+    }
+    return kept;
+}
+
+// Hardware counters
+// =================
+
+static const char *const bench_counter_names[BENCH_NUM_COUNTERS] = {
+    "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses", "dtlb_misses"
+};
+
+#if BENCH_HAVE_PERF
+static inline void bench_counter_event(bench_counter_t counter, struct perf_event_attr *attr) {
+    const uint64_t read_miss = (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                               (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    uint32_t *type = &attr->type;
+    __u64 *config = &attr->config;
+
+    *type = PERF_TYPE_HARDWARE;
+    switch (counter) {
+    case BENCH_CYCLES:
+        *config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+    case BENCH_INSTRUCTIONS:
+        *config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+    case BENCH_L1D_MISSES:
+        *type = PERF_TYPE_HW_CACHE;
+        *config = PERF_COUNT_HW_CACHE_L1D | read_miss;
+        break;
+    case BENCH_LLC_MISSES:
+        *config = PERF_COUNT_HW_CACHE_MISSES;
+        break;
+    case BENCH_BRANCH_MISSES:
+        *config = PERF_COUNT_HW_BRANCH_MISSES;
+        break;
+    default:
+        *type = PERF_TYPE_HW_CACHE;
+        *config = PERF_COUNT_HW_CACHE_DTLB | read_miss;
+        break;
+    }
+}
+#endif
+
+// Opens every counter the host allows. Returns the number opened; 0 leaves
+// the harness timing-only, with the reason in status.
+static inline int bench_counters_open(bench_counters_t *c) {
+    int error = 0;
+
+    memset(c, 0, sizeof(*c));
+    for (int i = 0; i < BENCH_NUM_COUNTERS; i++) {
+        c->fd[i] = -1;
+    }
+#if BENCH_HAVE_PERF
+    for (int i = 0; i < BENCH_NUM_COUNTERS; i++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        bench_counter_event((bench_counter_t)i, &attr);
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        // Scale for multiplexing when more events than PMU slots are open
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        c->fd[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (c->fd[i] >= 0) {
+            c->opened++;
+        } else if (!error) {
+            error = errno;
+        }
+    }
+    if (c->opened == BENCH_NUM_COUNTERS) {
+        snprintf(c->status, sizeof(c->status), "all %d events", BENCH_NUM_COUNTERS);
+    } else if (c->opened > 0) {
+        snprintf(c->status, sizeof(c->status), "%d of %d events", c->opened,
+                 BENCH_NUM_COUNTERS);
+    } else if (error == EACCES || error == EPERM) {
+        snprintf(c->status, sizeof(c->status),
+                 "unavailable (not permitted, see /proc/sys/kernel/perf_event_paranoid)");
+    } else if (error == ENOENT || error == EOPNOTSUPP || error == ENODEV) {
+        snprintf(c->status, sizeof(c->status), "unavailable (no hardware PMU)");
+    } else {
+        snprintf(c->status, sizeof(c->status), "unavailable (%s)", strerror(error));
+    }
+#else
+    (void)error;
+    snprintf(c->status, sizeof(c->status), "unavailable (not supported on this build)");
+#endif
+    return c->opened;
+}
+
+static inline void bench_counters_close(bench_counters_t *c) {
+    for (int i = 0; i < BENCH_NUM_COUNTERS; i++) {
+        if (c->fd[i] >= 0) {
+            close(c->fd[i]);
+        }
+        c->fd[i] = -1;
+    }
+    c->opened = 0;
+}
+
+static inline void bench_counters_start(const bench_counters_t *c) {
+#if BENCH_HAVE_PERF
+    for (int i = 0; i < BENCH_NUM_COUNTERS; i++) {
+        if (c->fd[i] >= 0) {
+            ioctl(c->fd[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(c->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#else
+    (void)c;
+#endif
+}
+
+// Adds the counts since bench_counters_start to totals; counters that did
+// not run are marked negative
+static inline void bench_counters_stop(const bench_counters_t *c, double *totals) {
+#if BENCH_HAVE_PERF
+    for (int i = 0; i < BENCH_NUM_COUNTERS; i++) {
+        uint64_t value[3];      // count, time enabled, time running
+        if (c->fd[i] < 0) {
+            continue;
+        }
+        ioctl(c->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+        if (totals[i] < 0.0 || read(c->fd[i], value, sizeof(value)) != sizeof(value) ||
+            value[2] == 0) {
+            totals[i] = -1.0;
+            continue;
+        }
+        totals[i] += (double)value[0] * ((double)value[1] / (double)value[2]);
+    }
+#else
+    (void)c;
+    (void)totals;
+#endif
+}
+
+// Runner
+// ======
+
+static inline int64_t bench_time_sample(bench_kernel_t kernel, void *ctx, uint64_t iterations) {
+    int64_t start = bench_now_ns();
+    kernel(ctx, iterations);
+    bench_clobber_memory();
+    return bench_now_ns() - start;
+}
+
+// Measures kernel and fills result. Returns 0 on success, -1 on invalid
+// configuration.
+static inline int bench_run(const bench_config_t *cfg, const char *name, bench_kernel_t kernel,
+                            void *ctx, double ops_per_iteration, bench_result_t *result) {
+    double samples[BENCH_MAX_REPETITIONS];
+    double counts[BENCH_NUM_COUNTERS];
+    uint64_t iterations = 1;
+    int64_t elapsed;
+
+    if (cfg->repetitions < 1 || cfg->repetitions > BENCH_MAX_REPETITIONS ||
+        ops_per_iteration <= 0.0) {
+        return -1;
+    }
+
+    // Grow geometrically, then scale straight to the target duration
+    for (;;) {
+        elapsed = bench_time_sample(kernel, ctx, iterations);
+        if (elapsed >= cfg->min_sample_ns || iterations >= BENCH_MAX_ITERATIONS) {
+            break;
+        }
+        if (elapsed > cfg->min_sample_ns / 16) {
+            double scale = 1.2 * (double)cfg->min_sample_ns / (double)elapsed;
+            iterations = (uint64_t)((double)iterations * scale) + 1;
+        } else {
+            iterations *= 8;
+        }
+    }
+
+    for (int w = 0; w < cfg->warmup; w++) {
+        bench_time_sample(kernel, ctx, iterations);
+    }
+    for (int i = 0; i < BENCH_NUM_COUNTERS; i++) {
+        counts[i] = cfg->counters && cfg->counters->fd[i] >= 0 ? 0.0 : -1.0;
+    }
+    for (int r = 0; r < cfg->repetitions; r++) {
+        if (cfg->counters) {
+            bench_counters_start(cfg->counters);
+        }
+        elapsed = bench_time_sample(kernel, ctx, iterations);
+        if (cfg->counters) {
+            bench_counters_stop(cfg->counters, counts);
+        }
+        samples[r] = (double)elapsed / ((double)iterations * ops_per_iteration);
+    }
+
+    bench_sort(samples, cfg->repetitions);
+    memset(result, 0, sizeof(*result));
+    for (int i = 0; i < BENCH_NUM_COUNTERS; i++) {
+        result->counters[i] = counts[i] < 0.0 ? -1.0 :
+            counts[i] / ((double)cfg->repetitions * (double)iterations * ops_per_iteration);
+    }
+    snprintf(result->name, sizeof(result->name), "%s", name);
+    result->iterations = iterations;
+    result->ops_per_iteration = ops_per_iteration;
+    result->samples = cfg->repetitions;
+
+    int kept = bench_reject_outliers(samples, cfg->repetitions);
+    memcpy(result->sample_ns, samples, kept * sizeof(double));
+    result->min_ns = samples[0];
+    result->outliers = cfg->repetitions - kept;
+    result->median_ns = bench_median(samples, kept);
+    result->mad_ns = bench_mad(samples, kept, result->median_ns);
+    result->ops_per_sec = result->median_ns > 0.0 ? 1e9 / result->median_ns : 0.0;
+    return 0;
+}
+
+static inline void bench_print_header(void) {
+    printf("%-30s %12s %10s %12s %16s %8s\n", "Benchmark", "median ns/op", "MAD", "min ns/op",
+           "ops/sec", "outliers");
+}
+
+// Instructions per cycle, negative when either was not counted
+static inline double bench_ipc(const bench_result_t *r) {
+    if (r->counters[BENCH_CYCLES] <= 0.0 || r->counters[BENCH_INSTRUCTIONS] < 0.0) {
+        return -1.0;
+    }
+    return r->counters[BENCH_INSTRUCTIONS] / r->counters[BENCH_CYCLES];
+}
+
+static inline int bench_has_counters(const bench_result_t *r) {
+    for (int i = 0; i < BENCH_NUM_COUNTERS; i++) {
+        if (r->counters[i] >= 0.0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static inline void bench_print(const bench_result_t *r) {
+    static const char *const labels[BENCH_NUM_COUNTERS] = {
+        "cycles", "instr", "L1D miss", "LLC miss", "br miss", "dTLB miss"
+    };
+
+    printf("%-30s %12.4f %9.2f%% %12.4f %16.2f %5d/%d\n", r->name, r->median_ns,
+           r->median_ns > 0.0 ? 100.0 * r->mad_ns / r->median_ns : 0.0, r->min_ns,
+           r->ops_per_sec, r->outliers, r->samples);
+    if (!bench_has_counters(r)) {
+        return;
+    }
+    // Per operation, on a second line under the timing
+    printf("%30s", "");
+    for (int i = 0; i < BENCH_NUM_COUNTERS; i++) {
+        if (r->counters[i] >= 0.0) {
+            printf(" %s %.4g", labels[i], r->counters[i]);
+        }
+        if (i == BENCH_INSTRUCTIONS && bench_ipc(r) >= 0.0) {
+            printf(" IPC %.2f", bench_ipc(r));
+        }
+    }
+    printf("\n");
+}
+
+// Result collection
+// =================
+
+static inline int bench_results_add(bench_results_t *list, const bench_result_t *r) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 32;
+        bench_result_t *items = realloc(list->items, capacity * sizeof(*items));
+        if (!items) {
+            return -1;
+        }
+        list->items = items;
+        list->capacity = capacity;
+    }
+    list->items[list->count++] = *r;
+    return 0;
+}
+
+static inline void bench_results_free(bench_results_t *list) {
+    free(list->items);
+    memset(list, 0, sizeof(*list));
+}
+
+// Host metadata
+// =============
+
+#ifndef BENCH_CFLAGS
+#define BENCH_CFLAGS "unknown"
+#endif
+#ifndef BENCH_GIT_SHA
+#define BENCH_GIT_SHA "unknown"
+#endif
+
+// Value of the first "key : value" line in a /proc style file
+static inline int bench_read_field(const char *path, const char *key, char *out, size_t size) {
+    char line[256];
+    size_t len = strlen(key);
+    FILE *f = fopen(path, "r");
+
+    if (!f) {
+        return -1;
+    }
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, key, len) == 0) {
+            char *value = strchr(line + len, ':');
+            if (!value) {
+                continue;
+            }
+            value++;
+            while (*value == ' ' || *value == '\t') {
+                value++;
+            }
+            value[strcspn(value, "\n")] = '\0';
+            snprintf(out, size, "%s", value);
+            fclose(f);
+            return 0;
+        }
+    }
+    fclose(f);
+    return -1;
+}
+
+static inline void bench_host_info(bench_host_t *host) {
+    struct utsname uts;
+    char value[64];
+    time_t now = time(NULL);
+    struct tm tm_utc;
+    FILE *f;
+
+    memset(host, 0, sizeof(*host));
+    if (bench_read_field("/proc/cpuinfo", "model name", host->cpu_model,
+                         sizeof(host->cpu_model)) != 0) {
+        snprintf(host->cpu_model, sizeof(host->cpu_model), "unknown");
+    }
+    f = fopen("/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq", "r");
+    if (f) {
+        long khz = 0;
+        if (fscanf(f, "%ld", &khz) == 1) {
+            host->cpu_mhz = khz / 1000.0;
+        }
+        fclose(f);
+    }
+    if (host->cpu_mhz == 0.0 && bench_read_field("/proc/cpuinfo", "cpu MHz", value,
+                                                 sizeof(value)) == 0) {
+        host->cpu_mhz = atof(value);
+    }
+    host->logical_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (gethostname(host->hostname, sizeof(host->hostname) - 1) != 0) {
+        snprintf(host->hostname, sizeof(host->hostname), "unknown");
+    }
+    if (uname(&uts) == 0) {
+        snprintf(host->kernel, sizeof(host->kernel), "%s %s %s", uts.sysname, uts.release,
+                 uts.machine);
+    }
+#if defined(__VERSION__)
+#if defined(__clang__)
+    snprintf(host->compiler, sizeof(host->compiler), "clang %s", __VERSION__);
+#elif defined(__GNUC__)
+    snprintf(host->compiler, sizeof(host->compiler), "gcc %s", __VERSION__);
+#else
+    snprintf(host->compiler, sizeof(host->compiler), "%s", __VERSION__);
+#endif
+#else
+    snprintf(host->compiler, sizeof(host->compiler), "unknown");
+#endif
+    snprintf(host->cflags, sizeof(host->cflags), "%s", BENCH_CFLAGS);
+    snprintf(host->git_sha, sizeof(host->git_sha), "%s", BENCH_GIT_SHA);
+    gmtime_r(&now, &tm_utc);
+    strftime(host->timestamp, sizeof(host->timestamp), "%Y-%m-%dT%H:%M:%SZ", &tm_utc);
+}
+
+// Writers
+// =======
+
+static inline void bench_json_string(FILE *f, const char *s) {
+    fputc('"', f);
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            fprintf(f, "\\%c", c);
+        } else if (c < 0x20) {
+            fprintf(f, "\\u%04x", c);
+        } else {
+            fputc(c, f);
+        }
+    }
+    fputc('"', f);
+}
+
+static inline void bench_json_field(FILE *f, const char *key, const char *value, int last) {
+    fprintf(f, "    ");
+    bench_json_string(f, key);
+    fprintf(f, ": ");
+    bench_json_string(f, value);
+    fprintf(f, last ? "\n" : ",\n");
+}
+
+// Negative values are "not measured" and print as null
+static inline void bench_json_number(FILE *f, double value) {
+    if (value < 0.0) {
+        fprintf(f, "null");
+    } else {
+        fprintf(f, "%.17g", value);
+    }
+}
+
+// Returns 0 on success, -1 if the file cannot be written
+static inline int bench_write_json(const char *path, const bench_host_t *host,
+                                   const bench_config_t *cfg, const bench_results_t *list) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        return -1;
+    }
+    fprintf(f, "{\n  \"schema\": \"alphaahb-benchmarks-1\",\n  \"host\": {\n");
+    bench_json_field(f, "cpu_model", host->cpu_model, 0);
+    fprintf(f, "    \"cpu_mhz\": %.1f,\n    \"logical_cpus\": %ld,\n", host->cpu_mhz,
+            host->logical_cpus);
+    bench_json_field(f, "hostname", host->hostname, 0);
+    bench_json_field(f, "kernel", host->kernel, 0);
+    bench_json_field(f, "compiler", host->compiler, 0);
+    bench_json_field(f, "cflags", host->cflags, 0);
+    bench_json_field(f, "git_sha", host->git_sha, 0);
+    bench_json_field(f, "timestamp", host->timestamp, 1);
+    fprintf(f, "  },\n  \"config\": {\"min_sample_ns\": %lld, \"warmup\": %d, "
+            "\"repetitions\": %d, \"outlier_z\": %.2f, \"counters\": ",
+            (long long)cfg->min_sample_ns, cfg->warmup, cfg->repetitions, BENCH_OUTLIER_Z);
+    bench_json_string(f, cfg->counters ? cfg->counters->status : "disabled");
+    fprintf(f, "},\n  \"benchmarks\": [");
+    for (size_t i = 0; i < list->count; i++) {
+        const bench_result_t *r = &list->items[i];
+        int kept = r->samples - r->outliers;
+        fprintf(f, "%s\n    {\"name\": ", i ? "," : "");
+        bench_json_string(f, r->name);
+        fprintf(f, ", \"iterations\": %llu, \"ops_per_iteration\": %.17g, "
+                "\"median_ns\": %.17g, \"mad_ns\": %.17g, \"min_ns\": %.17g, "
+                "\"ops_per_sec\": %.17g, \"samples\": %d, \"outliers\": %d, "
+                "\"size_bytes\": %llu, \"threads\": %d, \"sample_ns\": [",
+                (unsigned long long)r->iterations, r->ops_per_iteration, r->median_ns,
+                r->mad_ns, r->min_ns, r->ops_per_sec, r->samples, r->outliers,
+                (unsigned long long)r->size_bytes, r->threads);
+        for (int k = 0; k < kept; k++) {
+            fprintf(f, "%s%.17g", k ? ", " : "", r->sample_ns[k]);
+        }
+        // Counts per operation; null when the host could not count them
+        if (!bench_has_counters(r)) {
+            fprintf(f, "], \"counters\": null}");
+            continue;
+        }
+        fprintf(f, "], \"counters\": {");
+        for (int c = 0; c < BENCH_NUM_COUNTERS; c++) {
+            fprintf(f, "%s\"%s\": ", c ? ", " : "", bench_counter_names[c]);
+            bench_json_number(f, r->counters[c]);
+        }
+        fprintf(f, ", \"ipc\": ");
+        bench_json_number(f, bench_ipc(r));
+        fprintf(f, "}}");
+    }
+    fprintf(f, "\n  ]\n}\n");
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+// Quoted CSV field; embedded quotes are doubled (RFC 4180)
+static inline void bench_csv_string(FILE *f, const char *s) {
+    fputc('"', f);
+    for (; *s; s++) {
+        if (*s == '"') {
+            fputc('"', f);
+        }
+        fputc(*s, f);
+    }
+    fputc('"', f);
+}
+
+// One row per benchmark; host metadata repeats in every row so files from
+// several runs can be concatenated
+static inline int bench_write_csv(const char *path, const bench_host_t *host,
+                                  const bench_results_t *list) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        return -1;
+    }
+    fprintf(f, "name,median_ns,mad_ns,min_ns,ops_per_sec,iterations,samples,outliers,"
+            "size_bytes,threads,");
+    for (int c = 0; c < BENCH_NUM_COUNTERS; c++) {
+        fprintf(f, "%s,", bench_counter_names[c]);
+    }
+    fprintf(f, "ipc,cpu_model,cpu_mhz,compiler,cflags,git_sha,timestamp\n");
+    for (size_t i = 0; i < list->count; i++) {
+        const bench_result_t *r = &list->items[i];
+        bench_csv_string(f, r->name);
+        fprintf(f, ",%.6g,%.6g,%.6g,%.6g,%llu,%d,%d,%llu,%d,", r->median_ns,
+                r->mad_ns, r->min_ns, r->ops_per_sec, (unsigned long long)r->iterations,
+                r->samples, r->outliers, (unsigned long long)r->size_bytes, r->threads);
+        // Counts per operation; empty when not counted
+        for (int c = 0; c <= BENCH_NUM_COUNTERS; c++) {
+            double value = c < BENCH_NUM_COUNTERS ? r->counters[c] : bench_ipc(r);
+            if (value >= 0.0) {
+                fprintf(f, "%.6g", value);
+            }
+            fputc(',', f);
+        }
+        bench_csv_string(f, host->cpu_model);
+        fprintf(f, ",%.1f,", host->cpu_mhz);
+        bench_csv_string(f, host->compiler);
+        fputc(',', f);
+        bench_csv_string(f, host->cflags);
+        fputc(',', f);
+        bench_csv_string(f, host->git_sha);
+        fprintf(f, ",%s\n", host->timestamp);
+    }
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+// Selection and sweeps
+// ====================
+
+// Returns 0 on success, -1 if pattern is not a valid extended regex
+static inline int bench_filter_init(bench_filter_t *f, const char *substring,
+                                    const char *pattern) {
+    memset(f, 0, sizeof(*f));
+    f->substring = substring;
+    if (pattern) {
+        if (regcomp(&f->regex, pattern, REG_EXTENDED | REG_NOSUB) != 0) {
+            return -1;
+        }
+        f->has_regex = 1;
+    }
+    return 0;
+}
+
+static inline void bench_filter_free(bench_filter_t *f) {
+    if (f->has_regex) {
+        regfree(&f->regex);
+    }
+    f->has_regex = 0;
+}
+
+static inline int bench_lower(int c) {
+    return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+}
+
+// Case-insensitive substring test
+static inline int bench_contains(const char *haystack, const char *needle) {
+    for (; *haystack; haystack++) {
+        const char *h = haystack, *n = needle;
+        while (*h && *n && bench_lower((unsigned char)*h) == bench_lower((unsigned char)*n)) {
+            h++;
+            n++;
+        }
+        if (!*n) {
+            return 1;
+        }
+    }
+    return !*needle;
+}
+
+// Both the substring (case-insensitive) and the regex must match
+static inline int bench_filter_match(const bench_filter_t *f, const char *name) {
+    if (f->substring && !bench_contains(name, f->substring)) {
+        return 0;
+    }
+    return !f->has_regex || regexec(&f->regex, name, 0, NULL, 0) == 0;
+}
+
+// Working-set sizes from min_bytes to max_bytes in steps of 4x. Returns the
+// number of sizes written (at most BENCH_MAX_SWEEP_POINTS).
+static inline int bench_sweep_sizes(uint64_t min_bytes, uint64_t max_bytes, uint64_t *sizes) {
+    int count = 0;
+    for (uint64_t size = min_bytes; size && size <= max_bytes &&
+         count < BENCH_MAX_SWEEP_POINTS; size *= 4) {
+        sizes[count++] = size;
+    }
+    return count;
+}
+
+// "4KiB", "16MiB", ... for power-of-two sizes
+static inline void bench_format_size(uint64_t bytes, char *out, size_t size) {
+    static const char *units[] = { "B", "KiB", "MiB", "GiB", "TiB" };
+    int u = 0;
+    while (bytes >= 1024 && bytes % 1024 == 0 && u < 4) {
+        bytes /= 1024;
+        u++;
+    }
+    snprintf(out, size, "%llu%s", (unsigned long long)bytes, units[u]);
+}
+
+// Throughput-vs-size curve of sweep points that count bytes as operations
+static inline void bench_print_curve(const char *title, const bench_result_t *points, int n) {
+    const int width = 50;
+    double peak = 0.0;
+    char size[24];
+
+    for (int i = 0; i < n; i++) {
+        peak = points[i].ops_per_sec > peak ? points[i].ops_per_sec : peak;
+    }
+    printf("\n%s\n", title);
+    for (int i = 0; i < n; i++) {
+        int bar = peak > 0.0 ? (int)(width * points[i].ops_per_sec / peak + 0.5) : 0;
+        bench_format_size(points[i].size_bytes, size, sizeof(size));
+        printf("  %8s %8.2f GB/s |", size, points[i].ops_per_sec * 1e-9);
+        for (int b = 0; b < bar; b++) {
+            putchar('#');
+        }
+        putchar('\n');
+    }
+}
+
+// Throughput-vs-threads curve; scaling is relative to the first point
+static inline void bench_print_scaling(const char *title, const bench_result_t *points, int n) {
+    const int width = 40;
+    double peak = 0.0;
+
+    for (int i = 0; i < n; i++) {
+        peak = points[i].ops_per_sec > peak ? points[i].ops_per_sec : peak;
+    }
+    printf("\n%s\n", title);
+    for (int i = 0; i < n; i++) {
+        int bar = peak > 0.0 ? (int)(width * points[i].ops_per_sec / peak + 0.5) : 0;
+        double scaling = points[0].ops_per_sec > 0.0 ?
+                         points[i].ops_per_sec / points[0].ops_per_sec : 0.0;
+        printf("  %3dT %10.2f ns/op %10.2f Mops/s %6.2fx |", points[i].threads,
+               points[i].median_ns, points[i].ops_per_sec * 1e-6, scaling);
+        for (int b = 0; b < bar; b++) {
+            putchar('#');
+        }
+        putchar('\n');
+    }
+}
+
+#endif // ALPHAAHB_BENCHMARK_HARNESS_H
@@ -0,0 +1,283 @@
+/*
+ * AlphaAHB V5 Simulation Engine ABI Tests
+ *
+ * This file tests libalphaahb's C interface (alphaahb_engine.h) the way a
+ * binding uses it: programs loaded as words, raw images and ELF
+ * executables, registers and memory written through the in-place views
+ * between runs, and the program re-predecoded after the host patches it.
+ * The Makefile compiles the engine into the test binary, so it runs without
+ * the shared library.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../tooling/simulator/alphaahb_engine.h"
+#include "../examples/cpu-assembler.h"
+
+// Test framework macros
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s\n", message); \
+            return 1; \
+        } \
+    } while (0)
+
+#define TEST_PASS(message) \
+    printf("PASS: %s\n", message)
+
+#define TEST_START(name) \
+    printf("\n=== Testing %s ===\n", name)
+
+#define ENGINE_MEMORY ((uint64_t)1 << 20)
+
+static int assemble(cpu_asm_t *a, uint64_t base, const char *source) {
+    if (cpu_asm_init(a, base) != 0) {
+        return -1;
+    }
+    if (cpu_asm_source(a, source, strlen(source)) != 0 || cpu_asm_finish(a) != 0) {
+        printf("%s\n", a->error);
+        cpu_asm_free(a);
+        return -1;
+    }
+    return 0;
+}
+
+int test_engine_lifecycle() {
+    TEST_START("Engine creation and argument checks");
+
+    TEST_ASSERT(alphaahb_engine_abi_version() == ALPHAAHB_ENGINE_ABI_VERSION,
+                "ABI version differs from the header");
+    int max = alphaahb_engine_max_cores();
+    TEST_ASSERT(max >= 2, "Engine models fewer than two cores");
+    TEST_ASSERT(!alphaahb_engine_create(0, ENGINE_MEMORY) &&
+                !alphaahb_engine_create(max + 1, ENGINE_MEMORY),
+                "Bad core counts accepted");
+
+    alphaahb_engine_t *engine = alphaahb_engine_create(2, ENGINE_MEMORY);
+    uint64_t size = 0;
+    TEST_ASSERT(engine && alphaahb_engine_num_cores(engine) == 2, "Engine creation failed");
+    TEST_ASSERT(alphaahb_engine_memory(engine, &size) && size == ENGINE_MEMORY,
+                "Memory view has the wrong size");
+    TEST_ASSERT(!alphaahb_engine_registers(engine, 2) && !alphaahb_engine_registers(engine, -1) &&
+                !alphaahb_engine_fp_registers(engine, 2) &&
+                alphaahb_engine_core_state(engine, 2) == -1 && alphaahb_engine_retired(engine, 2) == 0,
+                "Bad core index accepted");
+    TEST_ASSERT(alphaahb_engine_run(engine, -1, 1) == -1 &&
+                alphaahb_engine_run(engine, ALPHAAHB_MODE_JIT + 1, 1) == -1,
+                "Bad engine mode accepted");
+
+    // An undefined instruction faults the core and fails the run
+    const uint64_t invalid[] = { UINT64_MAX };
+    TEST_ASSERT(alphaahb_engine_load(engine, CPU_RESET_PC, invalid, 1) == 0,
+                "Program load failed");
+    TEST_ASSERT(alphaahb_engine_run(engine, ALPHAAHB_MODE_SWITCH, 100) == -1 &&
+                alphaahb_engine_core_state(engine, 0) == ALPHAAHB_CORE_FAULTED,
+                "Undefined instruction did not fault");
+    alphaahb_engine_destroy(engine);
+    alphaahb_engine_destroy(NULL);
+    TEST_PASS("Creation, views and argument checks");
+
+    return 0;
+}
+
+int test_engine_register_views() {
+    TEST_START("Register block layout");
+
+    // R3 = R1 + R2 from the host's inputs; the entry point, LR and SP
+    // are read through their ALPHAAHB_REG_* slots
+    static const char source[] =
+        "        ADDI R4, R4, #1\n"
+        "entry:  ADD R3, R1, R2\n"
+        "        JAL done\n"
+        "        NOP\n"
+        "done:   HALT\n";
+    cpu_asm_t a;
+    TEST_ASSERT(assemble(&a, CPU_RESET_PC, source) == 0, "Assembly failed");
+
+    alphaahb_engine_t *engine = alphaahb_engine_create(2, ENGINE_MEMORY);
+    TEST_ASSERT(engine && alphaahb_engine_load(engine, CPU_RESET_PC, a.words, a.count) == 0,
+                "Program load failed");
+    for (int mode = ALPHAAHB_MODE_SWITCH; mode <= ALPHAAHB_MODE_JIT; mode++) {
+        char message[96];
+        snprintf(message, sizeof(message), "Register block wrong in %s mode", cpu_mode_names[mode]);
+        alphaahb_engine_reset(engine, CPU_RESET_PC);
+        for (int core = 0; core < 2; core++) {
+            uint64_t *regs = alphaahb_engine_registers(engine, core);
+            TEST_ASSERT(regs && regs[ALPHAAHB_REG_PC] == CPU_RESET_PC &&
+                        regs[ALPHAAHB_REG_SP] == CPU_RESET_SP, message);
+            regs[1] = 40 + (uint64_t)core;
+            regs[2] = 2;
+            regs[ALPHAAHB_REG_PC] = CPU_RESET_PC + CPU_INST_BYTES;
+        }
+        TEST_ASSERT(alphaahb_engine_run(engine, mode, UINT64_MAX) == 0 &&
+                    alphaahb_engine_halted(engine), message);
+        for (int core = 0; core < 2; core++) {
+            uint64_t *regs = alphaahb_engine_registers(engine, core);
+            TEST_ASSERT(regs[3] == 42 + (uint64_t)core && regs[4] == 0 &&
+                        regs[ALPHAAHB_REG_LR] == CPU_RESET_PC + 3 * CPU_INST_BYTES &&
+                        alphaahb_engine_core_state(engine, core) == ALPHAAHB_CORE_HALTED &&
+                        alphaahb_engine_retired(engine, core) == 3, message);
+        }
+        TEST_ASSERT(alphaahb_engine_retired(engine, -1) == 6, message);
+    }
+    TEST_ASSERT((char *)alphaahb_engine_registers(engine, 1) - (char *)alphaahb_engine_registers(engine, 0) ==
+                (char *)alphaahb_engine_fp_registers(engine, 1) - (char *)alphaahb_engine_fp_registers(engine, 0),
+                "Register blocks of the cores are not evenly spaced");
+    alphaahb_engine_destroy(engine);
+    cpu_asm_free(&a);
+    TEST_PASS("Inputs, entry point and results through the register views");
+
+    return 0;
+}
+
+int test_engine_load_image() {
+    TEST_START("Raw and ELF images");
+
+    static const char source[] =
+        "start:  LI R1, #7\n"
+        "        LI R4, data\n"
+        "        LOAD R2, [R4]\n"
+        "        MUL R2, R2, R1\n"
+        "        HALT\n"
+        "        NOP\n"
+        "data:   .dword 6\n";
+    const uint64_t base = 0x4000;
+    cpu_asm_t raw, linked;
+    TEST_ASSERT(assemble(&raw, CPU_RESET_PC, source) == 0 && assemble(&linked, base, source) == 0,
+                "Assembly failed");
+
+    const char *elf_path = "engine-tests.elf";
+    unsigned char *elf = NULL;
+    long elf_size = 0;
+    FILE *f;
+    TEST_ASSERT(cpu_asm_write_elf(&linked, elf_path) == 0 && (f = fopen(elf_path, "rb")),
+                "ELF write failed");
+    if (fseek(f, 0, SEEK_END) == 0 && (elf_size = ftell(f)) > 0 && fseek(f, 0, SEEK_SET) == 0 &&
+        (elf = malloc((size_t)elf_size)) && fread(elf, 1, (size_t)elf_size, f) != (size_t)elf_size) {
+        elf_size = 0;
+    }
+    fclose(f);
+    remove(elf_path);
+    TEST_ASSERT(elf && elf_size > 0, "ELF read failed");
+
+    alphaahb_engine_t *engine = alphaahb_engine_create(1, ENGINE_MEMORY);
+    uint64_t *regs = engine ? alphaahb_engine_registers(engine, 0) : NULL;
+    uint8_t *memory = engine ? alphaahb_engine_memory(engine, NULL) : NULL;
+    TEST_ASSERT(regs && memory, "Engine creation failed");
+
+    // Raw words start at the reset PC
+    TEST_ASSERT(alphaahb_engine_load_image(engine, raw.words, raw.count * CPU_INST_BYTES) == 0 &&
+                regs[ALPHAAHB_REG_PC] == CPU_RESET_PC &&
+                memcmp(memory + CPU_RESET_PC, raw.words, raw.count * CPU_INST_BYTES) == 0,
+                "Raw image not loaded at the reset PC");
+    TEST_ASSERT(alphaahb_engine_run(engine, ALPHAAHB_MODE_JIT, UINT64_MAX) == 0 && regs[2] == 42,
+                "Raw image ran wrong");
+
+    // An ELF executable is loaded at its segment and entered at e_entry
+    TEST_ASSERT(alphaahb_engine_load_image(engine, elf, (size_t)elf_size) == 0 &&
+                regs[ALPHAAHB_REG_PC] == base && regs[2] == 0 &&
+                memcmp(memory + base, linked.words, linked.count * CPU_INST_BYTES) == 0,
+                "ELF image not loaded at its base");
+    TEST_ASSERT(alphaahb_engine_run(engine, ALPHAAHB_MODE_JIT, UINT64_MAX) == 0 && regs[2] == 42,
+                "ELF image ran wrong");
+
+    // Truncated words and a damaged ELF header are rejected
+    TEST_ASSERT(alphaahb_engine_load_image(engine, raw.words, raw.count * CPU_INST_BYTES - 1) == -1,
+                "Partial instruction word accepted");
+    elf[18] ^= 0xFF;                                   // e_machine
+    TEST_ASSERT(alphaahb_engine_load_image(engine, elf, (size_t)elf_size) == -1,
+                "ELF of another machine accepted");
+    TEST_ASSERT(alphaahb_engine_load_image(engine, elf, 16) == -1, "Truncated ELF accepted");
+
+    free(elf);
+    alphaahb_engine_destroy(engine);
+    cpu_asm_free(&raw);
+    cpu_asm_free(&linked);
+    TEST_PASS("Raw words at the reset PC, ELF at its base and entry");
+
+    return 0;
+}
+
+int test_engine_memory_written() {
+    TEST_START("Host writes into the program");
+
+    static const char source[] =
+        "loop:   ADDI R2, R2, #1\n"
+        "        SUBI R1, R1, #1\n"
+        "        BNZ R1, loop\n"
+        "        HALT\n";
+    static const char patch[] = "ADDI R2, R2, #5\n";
+    cpu_asm_t a, p;
+    TEST_ASSERT(assemble(&a, CPU_RESET_PC, source) == 0 && assemble(&p, CPU_RESET_PC, patch) == 0,
+                "Assembly failed");
+
+    alphaahb_engine_t *engine = alphaahb_engine_create(1, ENGINE_MEMORY);
+    TEST_ASSERT(engine && alphaahb_engine_load(engine, CPU_RESET_PC, a.words, a.count) == 0,
+                "Program load failed");
+    uint64_t *regs = alphaahb_engine_registers(engine, 0);
+    uint8_t *memory = alphaahb_engine_memory(engine, NULL);
+    for (int mode = ALPHAAHB_MODE_SWITCH; mode <= ALPHAAHB_MODE_JIT; mode++) {
+        char message[96];
+        snprintf(message, sizeof(message), "Patched program ran stale code in %s mode",
+                 cpu_mode_names[mode]);
+
+        // Warm the predecoded blocks and the translation cache first
+        memcpy(memory + CPU_RESET_PC, a.words, CPU_INST_BYTES);
+        alphaahb_engine_memory_written(engine, CPU_RESET_PC, CPU_INST_BYTES);
+        alphaahb_engine_reset(engine, CPU_RESET_PC);
+        regs[1] = 100;
+        TEST_ASSERT(alphaahb_engine_run(engine, mode, UINT64_MAX) == 0 && regs[2] == 100, message);
+
+        memcpy(memory + CPU_RESET_PC, p.words, CPU_INST_BYTES);
+        alphaahb_engine_memory_written(engine, CPU_RESET_PC, CPU_INST_BYTES);
+        alphaahb_engine_reset(engine, CPU_RESET_PC);
+        regs[1] = 100;
+        TEST_ASSERT(alphaahb_engine_run(engine, mode, UINT64_MAX) == 0 && regs[2] == 500, message);
+    }
+
+    // Writes outside the program need no report and change nothing
+    alphaahb_engine_memory_written(engine, 0, 0);
+    alphaahb_engine_memory_written(engine, CPU_RESET_PC + a.count * CPU_INST_BYTES, 64);
+    alphaahb_engine_reset(engine, CPU_RESET_PC);
+    regs[1] = 3;
+    TEST_ASSERT(alphaahb_engine_run(engine, ALPHAAHB_MODE_JIT, UINT64_MAX) == 0 && regs[2] == 15,
+                "Write past the program disturbed it");
+
+    alphaahb_engine_destroy(engine);
+    cpu_asm_free(&a);
+    cpu_asm_free(&p);
+    TEST_PASS("Reported writes re-predecode the program in every engine");
+
+    return 0;
+}
+
+int run_all_tests() {
+    printf("AlphaAHB V5 Simulation Engine ABI Tests\n");
+    printf("=======================================\n");
+
+    int failed_tests = 0;
+
+    failed_tests += test_engine_lifecycle();
+    failed_tests += test_engine_register_views();
+    failed_tests += test_engine_load_image();
+    failed_tests += test_engine_memory_written();
+
+    printf("\n=== Test Summary ===\n");
+    if (failed_tests == 0) {
+        printf("ALL TESTS PASSED!\n");
+    } else {
+        printf("FAILED: %d tests\n", failed_tests);
+    }
+
+    return failed_tests;
+}
+
+int main() {
+    return run_all_tests();
+}
@@ -0,0 +1,281 @@
+/*
+ * AlphaAHB V5 Guest Kernels
+ *
+ * Small guest programs, assembled into cpu_system_t memory, that exercise
+ * the simulator the way real workloads do: an integer ALU loop, a
+ * floating-point loop, byte-lane vector arithmetic, a streaming
+ * load/add/store loop, data-dependent branches with calls, and a four-core
+ * loop around LOCK, ATOMIC and BARRIER. Each runs about a million guest
+ * instructions from reset to HALT, so one run is a meaningful sample for
+ * the simulator benchmarks and the engines can be checked against each
+ * other on identical work.
+ *
+ * Runs are repeatable: every run resets the cores and re-initializes the
+ * data the kernel reads, and kernels only write data they do not read back
+ * across runs.
+ */
+
+#ifndef ALPHAAHB_GUEST_KERNELS_H
+#define ALPHAAHB_GUEST_KERNELS_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "../examples/cpu-simulator.h"
+
+#define GUEST_MEMORY ((uint64_t)4 << 20)
+#define GUEST_MAX_WORDS 64
+
+// Kernel data lives above the text and the reset stack
+#define GUEST_DATA 0x100000
+#define GUEST_DST 0x200000
+#define GUEST_SYNC 0x300000
+
+// Streaming kernel: 512 KiB read, 256 KiB written per pass
+#define GUEST_STREAM_PAIRS 32768
+#define GUEST_STREAM_PASSES 4
+
+#define GUEST_SYNC_CORES 4
+#define GUEST_SYNC_ITERATIONS 16384
+
+typedef struct {
+    uint64_t words[GUEST_MAX_WORDS];
+    size_t count;
+} guest_program_t;
+
+typedef struct {
+    const char *name;
+    int cores;
+    void (*assemble)(guest_program_t *p);
+    void (*setup)(cpu_system_t *cpu);       // After reset, before every run
+} guest_kernel_t;
+
+static inline size_t guest_emit(guest_program_t *p, uint64_t word) {
+    if (p->count < GUEST_MAX_WORDS) {
+        p->words[p->count] = word;
+    }
+    return p->count++;
+}
+
+static inline size_t guest_op(guest_program_t *p, unsigned opcode, unsigned funct, unsigned rd,
+                              unsigned rs1, unsigned rs2, int32_t imm) {
+    return guest_emit(p, cpu_encode_op(opcode, funct, rd, rs1, rs2, imm));
+}
+
+// 64-bit constant: LI of the low half, LUI of the high half when needed
+static inline void guest_li(guest_program_t *p, unsigned rd, uint64_t value) {
+    guest_emit(p, cpu_encode_long(CPU_OPC_U, 0x0, rd, (int32_t)(uint32_t)value));
+    if ((uint64_t)(int64_t)(int32_t)(uint32_t)value != value) {
+        guest_emit(p, cpu_encode_long(CPU_OPC_U, 0x1, rd, (int32_t)(uint32_t)(value >> 32)));
+    }
+}
+
+// Byte offset from instruction `from` to instruction `to`
+static inline int32_t guest_offset(size_t from, size_t to) {
+    return (int32_t)((int64_t)to - (int64_t)from) * CPU_INST_BYTES;
+}
+
+// Points the branch or jump at `at` to instruction `to`
+static inline void guest_patch(guest_program_t *p, size_t at, size_t to) {
+    uint64_t word = p->words[at];
+    int32_t offset = guest_offset(at, to);
+
+    if ((word >> 60) == CPU_OPC_J) {
+        word = (word & ~0xFFFFFFFFULL) | (uint32_t)offset;
+    } else {
+        word = (word & ~(0xFFFFULL << 32)) | ((uint64_t)(uint16_t)offset << 32);
+    }
+    p->words[at] = word;
+}
+
+// Integer: multiply/xor/shift mixing, 9 instructions per iteration
+static inline void guest_integer(guest_program_t *p) {
+    guest_li(p, 1, 100000);                                  // LI R1, #iterations
+    guest_li(p, 2, 1);                                       // LI R2, #1
+    guest_li(p, 3, 0x9E3779B9);                              // LI R3, #golden
+    size_t loop = guest_op(p, CPU_OPC_R, 0x2, 5, 2, 3, 0);   // MUL R5, R2, R3
+    guest_op(p, CPU_OPC_R, 0x0, 4, 4, 5, 0);                 // ADD R4, R4, R5
+    guest_op(p, CPU_OPC_R, 0x7, 2, 2, 4, 0);                 // XOR R2, R2, R4
+    guest_op(p, CPU_OPC_I, 0x7, 6, 2, 0, 3);                 // SHLI R6, R2, #3
+    guest_op(p, CPU_OPC_I, 0x8, 7, 4, 0, 5);                 // SHRI R7, R4, #5
+    guest_op(p, CPU_OPC_R, 0x6, 2, 6, 7, 0);                 // OR R2, R6, R7
+    guest_op(p, CPU_OPC_I, 0x0, 2, 2, 0, 7);                 // ADDI R2, R2, #7
+    guest_op(p, CPU_OPC_I, 0x1, 1, 1, 0, 1);                 // SUBI R1, R1, #1
+    guest_patch(p, guest_op(p, CPU_OPC_B, 0xB, 0, 1, 0, 0), loop);  // BNZ R1, loop
+    guest_op(p, CPU_OPC_C, 0x1, 0, 0, 0, 0);                 // HALT
+}
+
+// Floating point: add/multiply/FMA chains with a square root, 8 per iteration
+static inline void guest_fp(guest_program_t *p) {
+    guest_li(p, 1, 100000);                                  // LI R1, #iterations
+    guest_li(p, 2, 3);
+    guest_op(p, CPU_OPC_F, 0x7, 1, 2, 0, 0);                 // FCVT F1, R2
+    guest_li(p, 2, 2);
+    guest_op(p, CPU_OPC_F, 0x7, 2, 2, 0, 0);                 // FCVT F2, R2
+    guest_li(p, 2, 1024);
+    guest_op(p, CPU_OPC_F, 0x7, 5, 2, 0, 0);                 // FCVT F5, R2
+    guest_li(p, 2, 1);
+    guest_op(p, CPU_OPC_F, 0x7, 6, 2, 0, 0);                 // FCVT F6, R2
+    guest_op(p, CPU_OPC_F, 0x3, 4, 6, 5, 0);                 // FDIV F4, F6, F5
+    size_t loop = guest_op(p, CPU_OPC_F, 0x2, 7, 1, 4, 0);   // FMUL F7, F1, F4
+    guest_op(p, CPU_OPC_F, 0x0, 3, 3, 7, 0);                 // FADD F3, F3, F7
+    guest_op(p, CPU_OPC_F, 0x5, 8, 1, 4, 0);                 // FMA F8, F1, F4
+    guest_op(p, CPU_OPC_F, 0x1, 9, 3, 8, 0);                 // FSUB F9, F3, F8
+    guest_op(p, CPU_OPC_F, 0x4, 10, 2, 0, 0);                // FSQRT F10, F2
+    guest_op(p, CPU_OPC_F, 0x0, 1, 1, 4, 0);                 // FADD F1, F1, F4
+    guest_op(p, CPU_OPC_I, 0x1, 1, 1, 0, 1);                 // SUBI R1, R1, #1
+    guest_patch(p, guest_op(p, CPU_OPC_B, 0xB, 0, 1, 0, 0), loop);  // BNZ R1, loop
+    guest_op(p, CPU_OPC_F, 0x7, 3, 9, 0, 1);                 // FCVT R3, F9
+    guest_op(p, CPU_OPC_C, 0x1, 0, 0, 0, 0);                 // HALT
+}
+
+// Vector: 512-bit byte-lane arithmetic and a reduction, 9 per iteration
+static inline void guest_vector(guest_program_t *p) {
+    guest_li(p, 1, 100000);                                  // LI R1, #iterations
+    size_t loop = guest_op(p, CPU_OPC_V, 0x0, 4, 1, 2, 0);   // VADD V4, V1, V2
+    guest_op(p, CPU_OPC_V, 0x2, 5, 4, 3, 0);                 // VMUL V5, V4, V3
+    guest_op(p, CPU_OPC_V, 0x7, 1, 5, 2, 0);                 // VXOR V1, V5, V2
+    guest_op(p, CPU_OPC_V, 0x9, 6, 1, 0, 1);                 // VSHR V6, V1, #1
+    guest_op(p, CPU_OPC_V, 0x0, 2, 2, 6, 0);                 // VADD V2, V2, V6
+    guest_op(p, CPU_OPC_V, 0xB, 2, 1, 0, 0);                 // VREDUCE R2, V1
+    guest_op(p, CPU_OPC_R, 0x0, 3, 3, 2, 0);                 // ADD R3, R3, R2
+    guest_op(p, CPU_OPC_I, 0x1, 1, 1, 0, 1);                 // SUBI R1, R1, #1
+    guest_patch(p, guest_op(p, CPU_OPC_B, 0xB, 0, 1, 0, 0), loop);  // BNZ R1, loop
+    guest_op(p, CPU_OPC_C, 0x1, 0, 0, 0, 0);                 // HALT
+}
+
+static inline void guest_vector_setup(cpu_system_t *cpu) {
+    register_file_t *regs = &cpu->cores[0].regs;
+    for (int i = 0; i < 64; i++) {
+        regs->vector[1][i] = (uint8_t)(i * 7 + 1);
+        regs->vector[2][i] = (uint8_t)(255 - i);
+        regs->vector[3][i] = (uint8_t)(i | 1);
+    }
+}
+
+// Memory: sum pairs of words from a 512 KiB array, store running sums
+static inline void guest_stream(guest_program_t *p) {
+    guest_li(p, 1, GUEST_STREAM_PASSES);                     // LI R1, #passes
+    size_t outer = p->count;
+    guest_li(p, 2, GUEST_DATA);                              // LI R2, #src
+    guest_li(p, 3, GUEST_STREAM_PAIRS);                      // LI R3, #pairs
+    guest_li(p, 9, GUEST_DST);                               // LI R9, #dst
+    size_t inner = guest_op(p, CPU_OPC_I, 0x9, 4, 2, 0, 0);  // LOAD R4, [R2]
+    guest_op(p, CPU_OPC_I, 0x9, 5, 2, 0, 8);                 // LOAD R5, [R2 + #8]
+    guest_op(p, CPU_OPC_R, 0x0, 6, 6, 4, 0);                 // ADD R6, R6, R4
+    guest_op(p, CPU_OPC_R, 0x0, 6, 6, 5, 0);                 // ADD R6, R6, R5
+    guest_op(p, CPU_OPC_S, 0x0, 0, 9, 6, 0);                 // STORE R6, [R9]
+    guest_op(p, CPU_OPC_I, 0x0, 2, 2, 0, 16);                // ADDI R2, R2, #16
+    guest_op(p, CPU_OPC_I, 0x0, 9, 9, 0, 8);                 // ADDI R9, R9, #8
+    guest_op(p, CPU_OPC_I, 0x1, 3, 3, 0, 1);                 // SUBI R3, R3, #1
+    guest_patch(p, guest_op(p, CPU_OPC_B, 0xB, 0, 3, 0, 0), inner);  // BNZ R3, inner
+    guest_op(p, CPU_OPC_I, 0x1, 1, 1, 0, 1);                 // SUBI R1, R1, #1
+    guest_patch(p, guest_op(p, CPU_OPC_B, 0xB, 0, 1, 0, 0), outer);  // BNZ R1, outer
+    guest_op(p, CPU_OPC_C, 0x1, 0, 0, 0, 0);                 // HALT
+}
+
+static inline void guest_stream_setup(cpu_system_t *cpu) {
+    for (uint64_t i = 0; i < 2 * GUEST_STREAM_PAIRS; i++) {
+        uint64_t value = i * 3 + 1;
+        memcpy(cpu->memory + GUEST_DATA + i * sizeof(uint64_t), &value, sizeof(value));
+    }
+}
+
+// Branchy: a 64-bit LCG drives two unpredictable branches and a call
+static inline void guest_branchy(guest_program_t *p) {
+    guest_li(p, 1, 100000);                                  // LI R1, #iterations
+    guest_li(p, 2, 12345);                                   // LI R2, #seed
+    guest_li(p, 3, 0x5851F42D4C957F2DULL);                   // LI R3, #multiplier
+    size_t loop = guest_op(p, CPU_OPC_R, 0x2, 2, 2, 3, 0);   // MUL R2, R2, R3
+    guest_op(p, CPU_OPC_I, 0x0, 2, 2, 0, 1);                 // ADDI R2, R2, #1
+    guest_op(p, CPU_OPC_I, 0x8, 4, 2, 0, 33);                // SHRI R4, R2, #33
+    guest_op(p, CPU_OPC_I, 0x4, 5, 4, 0, 1);                 // ANDI R5, R4, #1
+    size_t skip1 = guest_op(p, CPU_OPC_B, 0xA, 0, 5, 0, 0);  // BZ R5, skip1
+    guest_op(p, CPU_OPC_I, 0x0, 6, 6, 0, 1);                 // ADDI R6, R6, #1
+    guest_patch(p, skip1, p->count);                         // skip1:
+    guest_op(p, CPU_OPC_I, 0x4, 5, 4, 0, 6);                 // ANDI R5, R4, #6
+    size_t skip2 = guest_op(p, CPU_OPC_B, 0xA, 0, 5, 0, 0);  // BZ R5, skip2
+    size_t call = guest_emit(p, cpu_encode_long(CPU_OPC_J, 0x1, 0, 0));  // JAL func
+    guest_patch(p, skip2, p->count);                         // skip2:
+    guest_op(p, CPU_OPC_I, 0x1, 1, 1, 0, 1);                 // SUBI R1, R1, #1
+    guest_patch(p, guest_op(p, CPU_OPC_B, 0xB, 0, 1, 0, 0), loop);  // BNZ R1, loop
+    guest_op(p, CPU_OPC_C, 0x1, 0, 0, 0, 0);                 // HALT
+    guest_patch(p, call, p->count);                          // func:
+    guest_op(p, CPU_OPC_R, 0x0, 7, 7, 4, 0);                 // ADD R7, R7, R4
+    guest_emit(p, cpu_encode_long(CPU_OPC_J, 0x4, 0, 0));    // RET
+}
+
+// Multi-core: lock-protected counter, atomic counter, barrier every 64
+static inline void guest_sync(guest_program_t *p) {
+    guest_li(p, 1, GUEST_SYNC_ITERATIONS);                   // LI R1, #iterations
+    guest_li(p, 10, GUEST_SYNC);                             // LI R10, #lock
+    guest_li(p, 13, 1);                                      // LI R13, #1
+    size_t loop = guest_op(p, CPU_OPC_M, 0x1, 0, 10, 0, 0);  // LOCK [R10]
+    guest_op(p, CPU_OPC_I, 0x9, 2, 10, 0, 64);               // LOAD R2, [R10 + #64]
+    guest_op(p, CPU_OPC_I, 0x0, 2, 2, 0, 1);                 // ADDI R2, R2, #1
+    guest_op(p, CPU_OPC_S, 0x0, 0, 10, 2, 64);               // STORE R2, [R10 + #64]
+    guest_op(p, CPU_OPC_M, 0x2, 0, 10, 0, 0);                // UNLOCK [R10]
+    guest_op(p, CPU_OPC_M, 0x3, 3, 10, 13, 128);             // ATOMIC R3, [R10 + #128], R13
+    guest_op(p, CPU_OPC_I, 0x4, 4, 1, 0, 63);                // ANDI R4, R1, #63
+    size_t skip = guest_op(p, CPU_OPC_B, 0xB, 0, 4, 0, 0);   // BNZ R4, skip
+    guest_op(p, CPU_OPC_M, 0x0, 0, 0, 0, 0);                 // BARRIER
+    guest_patch(p, skip, p->count);                          // skip:
+    guest_op(p, CPU_OPC_I, 0x1, 1, 1, 0, 1);                 // SUBI R1, R1, #1
+    guest_patch(p, guest_op(p, CPU_OPC_B, 0xB, 0, 1, 0, 0), loop);  // BNZ R1, loop
+    guest_op(p, CPU_OPC_C, 0x1, 0, 0, 0, 0);                 // HALT
+}
+
+static inline void guest_sync_setup(cpu_system_t *cpu) {
+    memset(cpu->memory + GUEST_SYNC, 0, 192);
+}
+
+// Lock-protected and atomic counters after a guest_sync run
+static inline uint64_t guest_sync_counter(const cpu_system_t *cpu, int atomic) {
+    uint64_t value;
+    memcpy(&value, cpu->memory + GUEST_SYNC + (atomic ? 128 : 64), sizeof(value));
+    return value;
+}
+
+#define GUEST_KERNELS 6
+
+static const guest_kernel_t guest_kernels[GUEST_KERNELS] = {
+    { "Integer", 1, guest_integer, NULL },
+    { "FP", 1, guest_fp, NULL },
+    { "Vector", 1, guest_vector, guest_vector_setup },
+    { "Memory", 1, guest_stream, guest_stream_setup },
+    { "Branchy", 1, guest_branchy, NULL },
+    { "Sync", GUEST_SYNC_CORES, guest_sync, guest_sync_setup },
+};
+
+// System with the kernel loaded at the reset PC, NULL on failure
+static inline cpu_system_t *guest_kernel_create(const guest_kernel_t *kernel) {
+    guest_program_t program;
+    cpu_system_t *cpu = cpu_create(kernel->cores, GUEST_MEMORY);
+
+    if (!cpu) {
+        return NULL;
+    }
+    program.count = 0;
+    kernel->assemble(&program);
+    if (program.count > GUEST_MAX_WORDS ||
+        cpu_load_program(cpu, CPU_RESET_PC, program.words, program.count) != 0) {
+        cpu_destroy(cpu);
+        return NULL;
+    }
+    return cpu;
+}
+
+// One run from reset to HALT. Returns 0 when every core halted.
+static inline int guest_kernel_run(cpu_system_t *cpu, const guest_kernel_t *kernel,
+                                   cpu_mode_t mode) {
+    cpu_reset(cpu, cpu->text_base);
+    if (kernel->setup) {
+        kernel->setup(cpu);
+    }
+    if (cpu_run(cpu, mode, UINT64_MAX) != 0 || !cpu_halted(cpu)) {
+        return -1;
+    }
+    return 0;
+}
+
+#endif // ALPHAAHB_GUEST_KERNELS_H
@@ -0,0 +1,363 @@
+/*
+ * AlphaAHB V5 Memory Hierarchy Characterization
+ *
+ * Kernels for measuring the host memory hierarchy under the benchmark
+ * harness:
+ *
+ * - load-to-use latency by pointer chasing: one pointer per cache line,
+ *   linked into a single random cycle (Sattolo's algorithm) so hardware
+ *   prefetchers cannot predict the next line and every load depends on the
+ *   previous one
+ * - read, write and copy bandwidth, single- and multi-threaded; copy counts
+ *   bytes read plus bytes written, as STREAM does
+ * - non-temporal store bandwidth (SSE2 streaming stores, which bypass the
+ *   caches and skip the read-for-ownership)
+ * - TLB miss cost: a chase touching one line per 4 KiB page over more pages
+ *   than the TLB covers, once with transparent huge pages disabled and once
+ *   with them requested; the difference is the page-walk cost
+ *
+ * Cache sizes, associativity and line size come from Linux sysfs.
+ * Buffers are mmap'd (2 MiB aligned so huge pages can back them) and
+ * advised with madvise where the platform has it.
+ *
+ * Requires _POSIX_C_SOURCE >= 200809L and _DEFAULT_SOURCE (MAP_ANONYMOUS,
+ * madvise), and -pthread.
+ */
+
+#ifndef ALPHAAHB_MEMORY_HIERARCHY_H
+#define ALPHAAHB_MEMORY_HIERARCHY_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "benchmark-harness.h"
+#include "../examples/parallel-runtime.h"
+
+#define MEM_LINE 64
+#define MEM_PAGE 4096
+#define MEM_HUGE_PAGE (2u << 20)
+#define MEM_MAX_CACHES 8
+
+// Loads per chase kernel call
+#define MEM_CHASE_STEPS 1024
+
+// Bytes per parallel grain of the bandwidth kernels
+#define MEM_BW_GRAIN (64u << 10)
+
+typedef struct {
+    int level;
+    char type[16];          // "Data", "Instruction" or "Unified"
+    uint64_t size;
+    int ways;               // 0 if unknown
+    int line;
+} mem_cache_info_t;
+
+typedef struct {
+    void *base;             // 2 MiB aligned
+    size_t size;
+    void *mapping;
+    size_t mapped;
+} mem_buffer_t;
+
+typedef enum {
+    MEM_PAGES_DEFAULT,      // Leave the system policy alone
+    MEM_PAGES_SMALL,        // MADV_NOHUGEPAGE
+    MEM_PAGES_HUGE          // MADV_HUGEPAGE
+} mem_pages_t;
+
+typedef struct {
+    void **cursor;          // Carried across calls so every call continues the cycle
+} mem_chase_t;
+
+typedef enum {
+    MEM_READ,
+    MEM_WRITE,
+    MEM_COPY,
+    MEM_WRITE_NT
+} mem_bw_kind_t;
+
+typedef struct {
+    mem_bw_kind_t kind;
+    char *src;
+    char *dst;
+    size_t bytes;           // Per buffer
+    int threads;
+    uint64_t iterations;
+} mem_bw_ctx_t;
+
+// Topology
+// ========
+
+static inline int mem_read_sysfs(const char *dir, const char *file, char *out, size_t size) {
+    char path[256];
+    FILE *f;
+
+    snprintf(path, sizeof(path), "%s/%s", dir, file);
+    f = fopen(path, "r");
+    if (!f) {
+        return -1;
+    }
+    if (!fgets(out, (int)size, f)) {
+        fclose(f);
+        return -1;
+    }
+    out[strcspn(out, "\n")] = '\0';
+    fclose(f);
+    return 0;
+}
+
+// Caches of CPU 0, in sysfs order (L1D, L1I, L2, L3 on most hosts). Returns
+// the number of caches found, 0 where sysfs does not describe them.
+static inline int mem_cache_topology(mem_cache_info_t *caches, int max) {
+    int count = 0;
+
+    for (int index = 0; index < 16 && count < max; index++) {
+        char dir[128], value[64];
+        mem_cache_info_t *c = &caches[count];
+
+        snprintf(dir, sizeof(dir), "/sys/devices/system/cpu/cpu0/cache/index%d", index);
+        if (mem_read_sysfs(dir, "level", value, sizeof(value)) != 0) {
+            break;
+        }
+        memset(c, 0, sizeof(*c));
+        c->level = atoi(value);
+        if (mem_read_sysfs(dir, "type", c->type, sizeof(c->type)) != 0 ||
+            mem_read_sysfs(dir, "size", value, sizeof(value)) != 0) {
+            continue;
+        }
+        c->size = strtoull(value, NULL, 10);
+        if (strchr(value, 'K')) {
+            c->size <<= 10;
+        } else if (strchr(value, 'M')) {
+            c->size <<= 20;
+        }
+        if (mem_read_sysfs(dir, "ways_of_associativity", value, sizeof(value)) == 0) {
+            c->ways = atoi(value);
+        }
+        c->line = MEM_LINE;
+        if (mem_read_sysfs(dir, "coherency_line_size", value, sizeof(value)) == 0) {
+            c->line = atoi(value);
+        }
+        count++;
+    }
+    return count;
+}
+
+static inline uint64_t mem_physical_bytes(void) {
+    long pages = sysconf(_SC_PHYS_PAGES);
+    long page = sysconf(_SC_PAGESIZE);
+    return pages > 0 && page > 0 ? (uint64_t)pages * (uint64_t)page : 0;
+}
+
+// Buffers
+// =======
+
+// Returns 0 on success, -1 if the mapping fails
+static inline int mem_buffer_alloc(mem_buffer_t *b, size_t size, mem_pages_t pages) {
+    memset(b, 0, sizeof(*b));
+    b->mapped = size + MEM_HUGE_PAGE;
+#if defined(MAP_ANONYMOUS)
+    b->mapping = mmap(NULL, b->mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                      -1, 0);
+    if (b->mapping == MAP_FAILED) {
+        b->mapping = NULL;
+        return -1;
+    }
+#else
+    b->mapping = malloc(b->mapped);
+    if (!b->mapping) {
+        return -1;
+    }
+#endif
+    b->base = (void *)(((uintptr_t)b->mapping + MEM_HUGE_PAGE - 1) &
+                       ~(uintptr_t)(MEM_HUGE_PAGE - 1));
+    b->size = size;
+#if defined(MADV_HUGEPAGE) && defined(MADV_NOHUGEPAGE)
+    if (pages == MEM_PAGES_HUGE) {
+        madvise(b->base, size, MADV_HUGEPAGE);
+    } else if (pages == MEM_PAGES_SMALL) {
+        madvise(b->base, size, MADV_NOHUGEPAGE);
+    }
+#else
+    (void)pages;
+#endif
+    // Fault every page in now rather than inside a timed sample
+    memset(b->base, 0, size);
+    return 0;
+}
+
+static inline void mem_buffer_free(mem_buffer_t *b) {
+#if defined(MAP_ANONYMOUS)
+    if (b->mapping) {
+        munmap(b->mapping, b->mapped);
+    }
+#else
+    free(b->mapping);
+#endif
+    memset(b, 0, sizeof(*b));
+}
+
+// AnonHugePages of this process in KiB, -1 if unknown
+static inline long mem_huge_page_kib(void) {
+    char value[64];
+    if (bench_read_field("/proc/self/smaps_rollup", "AnonHugePages", value,
+                         sizeof(value)) != 0) {
+        return -1;
+    }
+    return atol(value);
+}
+
+// Pointer chasing
+// ===============
+
+static inline uint64_t mem_xorshift(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+// Links `count` slots, `stride` bytes apart, into one random cycle visiting
+// every slot. With `rotate`, slot i of a page-strided chase sits at line
+// (i / 32) % 64 of its page: page bits 12-16 and the line offset then cover
+// every set of a 2048-set cache even when huge pages make physical and
+// virtual bits equal, so the data stays cache resident and only the
+// translation misses. Returns the first slot, or NULL if the order array
+// cannot be allocated.
+static inline void **mem_chase_build(char *base, size_t count, size_t stride, int rotate,
+                                     uint64_t seed) {
+    uint32_t *order = malloc(count * sizeof(uint32_t));
+    uint64_t state = seed ? seed : 88172645463325252ull;
+
+    if (!order || count == 0) {
+        free(order);
+        return NULL;
+    }
+    for (size_t i = 0; i < count; i++) {
+        order[i] = (uint32_t)i;
+    }
+    // Sattolo's algorithm: a uniformly random single cycle
+    for (size_t i = count - 1; i > 0; i--) {
+        size_t j = (size_t)(mem_xorshift(&state) % i);
+        uint32_t t = order[i];
+        order[i] = order[j];
+        order[j] = t;
+    }
+#define MEM_SLOT(i) ((void **)(base + (size_t)(i) * stride + \
+                               (rotate ? (size_t)(i) / 32 % (MEM_PAGE / MEM_LINE) * MEM_LINE : 0)))
+    for (size_t i = 0; i < count; i++) {
+        *MEM_SLOT(i) = (void *)MEM_SLOT(order[i]);
+    }
+    void **first = MEM_SLOT(0);
+#undef MEM_SLOT
+    free(order);
+    return first;
+}
+
+static inline void mem_chase_kernel(void *arg, uint64_t iterations) {
+    mem_chase_t *chase = (mem_chase_t *)arg;
+    void **p = chase->cursor;
+
+    for (uint64_t iter = 0; iter < iterations; iter++) {
+        for (int s = 0; s < MEM_CHASE_STEPS; s++) {
+            p = (void **)*p;
+        }
+    }
+    chase->cursor = p;
+    bench_do_not_optimize(p);
+}
+
+// Bandwidth
+// =========
+
+// Independent lane sums so the loads vectorize and no add chain limits them
+static inline uint64_t mem_read_sum(const uint64_t *restrict src, size_t words) {
+    uint64_t lanes[8] = { 0 };
+    uint64_t sum = 0;
+
+    for (size_t i = 0; i + 8 <= words; i += 8) {
+#if defined(__GNUC__) && !defined(__clang__)
+        #pragma GCC unroll 8
+#endif
+        for (int l = 0; l < 8; l++) {
+            lanes[l] += src[i + l];
+        }
+    }
+    for (int l = 0; l < 8; l++) {
+        sum += lanes[l];
+    }
+    return sum;
+}
+
+static inline void mem_bw_range(size_t begin, size_t end, int tid, void *arg) {
+    mem_bw_ctx_t *ctx = (mem_bw_ctx_t *)arg;
+    size_t len = end - begin;
+    (void)tid;
+
+    for (uint64_t iter = 0; iter < ctx->iterations; iter++) {
+        switch (ctx->kind) {
+        case MEM_READ:
+            bench_do_not_optimize((const void *)(uintptr_t)
+                                  mem_read_sum((const uint64_t *)(ctx->src + begin), len / 8));
+            break;
+        case MEM_WRITE:
+            memset(ctx->dst + begin, (int)iter, len);
+            break;
+        case MEM_COPY:
+            memcpy(ctx->dst + begin, ctx->src + begin, len);
+            break;
+        case MEM_WRITE_NT: {
+#if defined(__SSE2__)
+            __m128i v = _mm_set1_epi32((int)iter);
+            __m128i *dst = (__m128i *)(ctx->dst + begin);
+            for (size_t i = 0; i < len / 16; i += 4) {
+                _mm_stream_si128(dst + i, v);
+                _mm_stream_si128(dst + i + 1, v);
+                _mm_stream_si128(dst + i + 2, v);
+                _mm_stream_si128(dst + i + 3, v);
+            }
+            _mm_sfence();
+#else
+            memset(ctx->dst + begin, (int)iter, len);
+#endif
+            break;
+        }
+        }
+        bench_clobber_memory();
+    }
+}
+
+// Every worker runs its slice for the whole sample: one fork per sample
+static inline void mem_bw_kernel(void *arg, uint64_t iterations) {
+    mem_bw_ctx_t *ctx = (mem_bw_ctx_t *)arg;
+    ctx->iterations = iterations;
+    if (ctx->threads <= 1) {
+        mem_bw_range(0, ctx->bytes, 0, ctx);
+    } else {
+        parallel_for(0, ctx->bytes, MEM_BW_GRAIN, ctx->threads, mem_bw_range, ctx);
+    }
+}
+
+// Bytes one kernel call moves
+static inline double mem_bw_bytes(const mem_bw_ctx_t *ctx) {
+    return ctx->kind == MEM_COPY ? 2.0 * ctx->bytes : (double)ctx->bytes;
+}
+
+static inline int mem_streaming_stores(void) {
+#if defined(__SSE2__)
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+#endif // ALPHAAHB_MEMORY_HIERARCHY_H
@@ -1,31 +1,41 @@
 /*
  * AlphaAHB V5 ISA Performance Benchmarks
- * 
+ *
  * This file contains comprehensive performance benchmarks for all AlphaAHB V5 ISA
  * instruction types, including timing measurements and throughput analysis.
+ * Every kernel runs under the microbenchmark harness (benchmark-harness.h):
+ * calibrated iteration counts, warmup, repeated samples and robust statistics.
+ * --sweep additionally runs the streaming kernels over working sets from
+ * L1-resident to DRAM-resident and across thread counts. --memory
+ * characterizes the host memory hierarchy (memory-hierarchy.h): latency
+ * curve, bandwidth per level, TLB miss cost, and a table in the layout of
+ * instruction-timing.md section 5.1. The MIMD benchmarks run real threads
+ * against the barriers, atomics, locks and queues of sync-primitives.h and
+ * print scaling curves over thread counts. --simulator measures the
+ * simulator itself: guest MIPS of assembled guest kernels (guest-kernels.h)
+ * under each execution engine of cpu-simulator.h, and how fast the in-process
+ * assembler (cpu-assembler.h) generates guest programs, the disassembler
+ * (cpu-disassembler.h) formats them back into listings and the static
+ * analyzer (cpu-analyzer.h) estimates their loops.
  */
 
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
 #include <time.h>
-#include <sys/time.h>
-
-// Performance measurement macros
-#define BENCHMARK_START() \
-    struct timeval start, end; \
-    gettimeofday(&start, NULL)
 
-#define BENCHMARK_END() \
-    gettimeofday(&end, NULL); \
-    long seconds = end.tv_sec - start.tv_sec; \
-    long microseconds = end.tv_usec - start.tv_usec; \
-    double elapsed = seconds + microseconds * 1e-6
-
-#define BENCHMARK_PRINT(name, iterations, elapsed) \
-    printf("%-30s: %10d iterations in %8.6f seconds (%12.2f ops/sec)\n", \
-           name, iterations, elapsed, iterations / elapsed)
+#include "benchmark-harness.h"
+#include "memory-hierarchy.h"
+#include "guest-kernels.h"
+#include "../examples/cpu-assembler.h"
+#include "../examples/cpu-disassembler.h"
+#include "../examples/cpu-analyzer.h"
+#include "../examples/parallel-runtime.h"
+#include "../examples/sync-primitives.h"
 
 // Test data sizes
 #define SMALL_SIZE 1000
@@ -33,577 +43,1800 @@
 #define LARGE_SIZE 100000
 #define HUGE_SIZE 1000000
 
+// Fixed seed so every run measures the same data
+#define BENCHMARK_SEED 12345
+
+// Default sweep: 4 KiB (L1) to 256 MiB (DRAM)
+#define SWEEP_MIN_BYTES ((uint64_t)4 << 10)
+#define SWEEP_MAX_BYTES ((uint64_t)256 << 20)
+
+// Elements per parallel grain in sweeps (one 4 KiB page of ints)
+#define SWEEP_GRAIN 1024
+
+static bench_config_t bench_config;
+static bench_results_t bench_results;
+static bench_filter_t bench_filter;
+static bench_counters_t bench_counters;
+static int list_only;
+
+// Runs a benchmark unless the filter excludes it. Returns 0 when a result
+// was produced.
+static int run_benchmark_result(const char *name, bench_kernel_t kernel, void *ctx,
+                                double ops_per_iteration, bench_result_t *result) {
+    if (!bench_filter_match(&bench_filter, name)) {
+        return -1;
+    }
+    if (list_only) {
+        printf("%s\n", name);
+        return -1;
+    }
+    if (bench_run(&bench_config, name, kernel, ctx, ops_per_iteration, result) != 0) {
+        printf("%-30s: invalid benchmark configuration\n", name);
+        return -1;
+    }
+    return 0;
+}
+
+static void record_result(const bench_result_t *result) {
+    bench_print(result);
+    if (bench_results_add(&bench_results, result) != 0) {
+        printf("%-30s: result not recorded (out of memory)\n", result->name);
+    }
+}
+
+static void run_benchmark(const char *name, bench_kernel_t kernel, void *ctx,
+                          double ops_per_iteration) {
+    bench_result_t result;
+    if (run_benchmark_result(name, kernel, ctx, ops_per_iteration, &result) == 0) {
+        record_result(&result);
+    }
+}
+
+static void usage(const char *prog) {
+    printf("Usage: %s [options]\n", prog);
+    printf("  --json FILE        Write results as JSON\n");
+    printf("  --csv FILE         Write results as CSV\n");
+    printf("  --filter TEXT      Run benchmarks whose name contains TEXT (any case)\n");
+    printf("  --regex PATTERN    Run benchmarks whose name matches an extended regex\n");
+    printf("  --list             List matching benchmark names without running them\n");
+    printf("  --sweep            Add working-set sweeps of the streaming kernels\n");
+    printf("  --memory           Add the memory hierarchy characterization\n");
+    printf("  --memory-max BYTES Largest latency working set (default 1073741824)\n");
+    printf("  --simulator        Add guest MIPS of the simulator's execution engines\n");
+    printf("  --min-size BYTES   Smallest sweep working set (default 4096)\n");
+    printf("  --max-size BYTES   Largest sweep working set (default 268435456)\n");
+    printf("  --threads LIST     Sweep/memory/MIMD thread counts, e.g. 1,2,4 or max (default 1)\n");
+    printf("  --repetitions N    Timed samples per benchmark (default 15)\n");
+    printf("  --min-time MS      Shortest timed sample (default 10)\n");
+    printf("  --no-counters      Do not open hardware performance counters\n");
+}
+
+// Operands and result of an element-wise kernel
+typedef struct {
+    void *a;
+    void *b;
+    void *result;
+    int size;
+} array_ctx_t;
+
+static int array_ctx_init(array_ctx_t *ctx, int size, size_t elem_size) {
+    ctx->size = size;
+    ctx->a = malloc(size * elem_size);
+    ctx->b = malloc(size * elem_size);
+    ctx->result = malloc(size * elem_size);
+    if (!ctx->a || !ctx->b || !ctx->result) {
+        free(ctx->a);
+        free(ctx->b);
+        free(ctx->result);
+        return -1;
+    }
+    return 0;
+}
+
+static void array_ctx_free(array_ctx_t *ctx) {
+    free(ctx->a);
+    free(ctx->b);
+    free(ctx->result);
+}
+
 // Integer arithmetic benchmarks
-void benchmark_add() {
-    printf("\n=== Integer Addition Benchmark ===\n");
-    
-    int *a = malloc(LARGE_SIZE * sizeof(int));
-    int *b = malloc(LARGE_SIZE * sizeof(int));
-    int *result = malloc(LARGE_SIZE * sizeof(int));
-    
-    // Initialize test data
-    for (int i = 0; i < LARGE_SIZE; i++) {
-        a[i] = rand() % 1000;
-        b[i] = rand() % 1000;
+static void add_kernel(void *arg, uint64_t iterations) {
+    array_ctx_t *ctx = (array_ctx_t *)arg;
+    const int *a = ctx->a, *b = ctx->b;
+    int *result = ctx->result;
+    for (uint64_t iter = 0; iter < iterations; iter++) {
+        for (int i = 0; i < ctx->size; i++) {
+            result[i] = a[i] + b[i];
+        }
+        bench_do_not_optimize(result);
     }
-    
-    // Benchmark addition
-    BENCHMARK_START();
-    for (int i = 0; i < LARGE_SIZE; i++) {
-        result[i] = a[i] + b[i];
-    }
-    BENCHMARK_END();
-    
-    BENCHMARK_PRINT("Integer Addition", LARGE_SIZE, elapsed);
-    
-    free(a);
-    free(b);
-    free(result);
-}
-
-void benchmark_mul() {
-    printf("\n=== Integer Multiplication Benchmark ===\n");
-    
-    int *a = malloc(LARGE_SIZE * sizeof(int));
-    int *b = malloc(LARGE_SIZE * sizeof(int));
-    int *result = malloc(LARGE_SIZE * sizeof(int));
-    
-    // Initialize test data
-    for (int i = 0; i < LARGE_SIZE; i++) {
-        a[i] = rand() % 100;
-        b[i] = rand() % 100;
+}
+
+static void mul_kernel(void *arg, uint64_t iterations) {
+    array_ctx_t *ctx = (array_ctx_t *)arg;
+    const int *a = ctx->a, *b = ctx->b;
+    int *result = ctx->result;
+    for (uint64_t iter = 0; iter < iterations; iter++) {
+        for (int i = 0; i < ctx->size; i++) {
+            result[i] = a[i] * b[i];
+        }
+        bench_do_not_optimize(result);
     }
-    
-    // Benchmark multiplication
-    BENCHMARK_START();
-    for (int i = 0; i < LARGE_SIZE; i++) {
-        result[i] = a[i] * b[i];
-    }
-    BENCHMARK_END();
-    
-    BENCHMARK_PRINT("Integer Multiplication", LARGE_SIZE, elapsed);
-    
-    free(a);
-    free(b);
-    free(result);
-}
-
-void benchmark_div() {
-    printf("\n=== Integer Division Benchmark ===\n");
-    
-    int *a = malloc(LARGE_SIZE * sizeof(int));
-    int *b = malloc(LARGE_SIZE * sizeof(int));
-    int *result = malloc(LARGE_SIZE * sizeof(int));
-    
+}
+
+static void div_kernel(void *arg, uint64_t iterations) {
+    array_ctx_t *ctx = (array_ctx_t *)arg;
+    const int *a = ctx->a, *b = ctx->b;
+    int *result = ctx->result;
+    for (uint64_t iter = 0; iter < iterations; iter++) {
+        for (int i = 0; i < ctx->size; i++) {
+            result[i] = a[i] / b[i];
+        }
+        bench_do_not_optimize(result);
+    }
+}
+
+void benchmark_integer() {
+    array_ctx_t ctx;
+    if (array_ctx_init(&ctx, LARGE_SIZE, sizeof(int)) != 0) {
+        printf("Integer benchmark allocation failed\n");
+        return;
+    }
+    int *a = ctx.a, *b = ctx.b;
+
     // Initialize test data
     for (int i = 0; i < LARGE_SIZE; i++) {
         a[i] = rand() % 1000 + 1;
         b[i] = rand() % 100 + 1;
     }
-    
-    // Benchmark division
-    BENCHMARK_START();
-    for (int i = 0; i < LARGE_SIZE; i++) {
-        result[i] = a[i] / b[i];
-    }
-    BENCHMARK_END();
-    
-    BENCHMARK_PRINT("Integer Division", LARGE_SIZE, elapsed);
-    
-    free(a);
-    free(b);
-    free(result);
+
+    run_benchmark("Integer Addition", add_kernel, &ctx, LARGE_SIZE);
+    run_benchmark("Integer Multiplication", mul_kernel, &ctx, LARGE_SIZE);
+    run_benchmark("Integer Division", div_kernel, &ctx, LARGE_SIZE);
+
+    array_ctx_free(&ctx);
 }
 
 // Floating-point benchmarks
-void benchmark_fadd() {
-    printf("\n=== Floating-Point Addition Benchmark ===\n");
-    
-    float *a = malloc(LARGE_SIZE * sizeof(float));
-    float *b = malloc(LARGE_SIZE * sizeof(float));
-    float *result = malloc(LARGE_SIZE * sizeof(float));
-    
-    // Initialize test data
-    for (int i = 0; i < LARGE_SIZE; i++) {
-        a[i] = (float)rand() / RAND_MAX * 1000.0f;
-        b[i] = (float)rand() / RAND_MAX * 1000.0f;
+static void fadd_kernel(void *arg, uint64_t iterations) {
+    array_ctx_t *ctx = (array_ctx_t *)arg;
+    const float *a = ctx->a, *b = ctx->b;
+    float *result = ctx->result;
+    for (uint64_t iter = 0; iter < iterations; iter++) {
+        for (int i = 0; i < ctx->size; i++) {
+            result[i] = a[i] + b[i];
+        }
+        bench_do_not_optimize(result);
     }
-    
-    // Benchmark floating-point addition
-    BENCHMARK_START();
-    for (int i = 0; i < LARGE_SIZE; i++) {
-        result[i] = a[i] + b[i];
-    }
-    BENCHMARK_END();
-    
-    BENCHMARK_PRINT("Floating-Point Addition", LARGE_SIZE, elapsed);
-    
-    free(a);
-    free(b);
-    free(result);
-}
-
-void benchmark_fmul() {
-    printf("\n=== Floating-Point Multiplication Benchmark ===\n");
-    
-    float *a = malloc(LARGE_SIZE * sizeof(float));
-    float *b = malloc(LARGE_SIZE * sizeof(float));
-    float *result = malloc(LARGE_SIZE * sizeof(float));
-    
-    // Initialize test data
-    for (int i = 0; i < LARGE_SIZE; i++) {
-        a[i] = (float)rand() / RAND_MAX * 100.0f;
-        b[i] = (float)rand() / RAND_MAX * 100.0f;
+}
+
+static void fmul_kernel(void *arg, uint64_t iterations) {
+    array_ctx_t *ctx = (array_ctx_t *)arg;
+    const float *a = ctx->a, *b = ctx->b;
+    float *result = ctx->result;
+    for (uint64_t iter = 0; iter < iterations; iter++) {
+        for (int i = 0; i < ctx->size; i++) {
+            result[i] = a[i] * b[i];
+        }
+        bench_do_not_optimize(result);
     }
-    
-    // Benchmark floating-point multiplication
-    BENCHMARK_START();
-    for (int i = 0; i < LARGE_SIZE; i++) {
-        result[i] = a[i] * b[i];
-    }
-    BENCHMARK_END();
-    
-    BENCHMARK_PRINT("Floating-Point Multiplication", LARGE_SIZE, elapsed);
-    
-    free(a);
-    free(b);
-    free(result);
-}
-
-void benchmark_fdiv() {
-    printf("\n=== Floating-Point Division Benchmark ===\n");
-    
-    float *a = malloc(LARGE_SIZE * sizeof(float));
-    float *b = malloc(LARGE_SIZE * sizeof(float));
-    float *result = malloc(LARGE_SIZE * sizeof(float));
-    
+}
+
+static void fdiv_kernel(void *arg, uint64_t iterations) {
+    array_ctx_t *ctx = (array_ctx_t *)arg;
+    const float *a = ctx->a, *b = ctx->b;
+    float *result = ctx->result;
+    for (uint64_t iter = 0; iter < iterations; iter++) {
+        for (int i = 0; i < ctx->size; i++) {
+            result[i] = a[i] / b[i];
+        }
+        bench_do_not_optimize(result);
+    }
+}
+
+static void fsqrt_kernel(void *arg, uint64_t iterations) {
+    array_ctx_t *ctx = (array_ctx_t *)arg;
+    const float *a = ctx->a;
+    float *result = ctx->result;
+    for (uint64_t iter = 0; iter < iterations; iter++) {
+        for (int i = 0; i < ctx->size; i++) {
+            result[i] = sqrtf(a[i]);
+        }
+        bench_do_not_optimize(result);
+    }
+}
+
+void benchmark_floating_point() {
+    array_ctx_t ctx;
+    if (array_ctx_init(&ctx, LARGE_SIZE, sizeof(float)) != 0) {
+        printf("Floating-point benchmark allocation failed\n");
+        return;
+    }
+    float *a = ctx.a, *b = ctx.b;
+
     // Initialize test data
     for (int i = 0; i < LARGE_SIZE; i++) {
         a[i] = (float)rand() / RAND_MAX * 1000.0f;
         b[i] = (float)rand() / RAND_MAX * 100.0f + 0.1f;
     }
-    
-    // Benchmark floating-point division
-    BENCHMARK_START();
-    for (int i = 0; i < LARGE_SIZE; i++) {
-        result[i] = a[i] / b[i];
-    }
-    BENCHMARK_END();
-    
-    BENCHMARK_PRINT("Floating-Point Division", LARGE_SIZE, elapsed);
-    
-    free(a);
-    free(b);
-    free(result);
-}
-
-void benchmark_fsqrt() {
-    printf("\n=== Floating-Point Square Root Benchmark ===\n");
-    
-    float *a = malloc(LARGE_SIZE * sizeof(float));
-    float *result = malloc(LARGE_SIZE * sizeof(float));
-    
-    // Initialize test data
-    for (int i = 0; i < LARGE_SIZE; i++) {
-        a[i] = (float)rand() / RAND_MAX * 10000.0f;
-    }
-    
-    // Benchmark floating-point square root
-    BENCHMARK_START();
-    for (int i = 0; i < LARGE_SIZE; i++) {
-        result[i] = sqrtf(a[i]);
-    }
-    BENCHMARK_END();
-    
-    BENCHMARK_PRINT("Floating-Point Square Root", LARGE_SIZE, elapsed);
-    
-    free(a);
-    free(result);
+
+    run_benchmark("Floating-Point Addition", fadd_kernel, &ctx, LARGE_SIZE);
+    run_benchmark("Floating-Point Multiplication", fmul_kernel, &ctx, LARGE_SIZE);
+    run_benchmark("Floating-Point Division", fdiv_kernel, &ctx, LARGE_SIZE);
+    run_benchmark("Floating-Point Square Root", fsqrt_kernel, &ctx, LARGE_SIZE);
+
+    array_ctx_free(&ctx);
 }
 
 // Vector benchmarks
-void benchmark_vector_add() {
-    printf("\n=== Vector Addition Benchmark ===\n");
-    
+void benchmark_vector() {
     int vector_size = 512;  // 512-bit vector = 16 x 32-bit elements
-    int *a = malloc(vector_size * sizeof(int));
-    int *b = malloc(vector_size * sizeof(int));
-    int *result = malloc(vector_size * sizeof(int));
-    
-    // Initialize test data
-    for (int i = 0; i < vector_size; i++) {
-        a[i] = rand() % 1000;
-        b[i] = rand() % 1000;
-    }
-    
-    // Benchmark vector addition
-    BENCHMARK_START();
-    for (int iter = 0; iter < LARGE_SIZE; iter++) {
-        for (int i = 0; i < vector_size; i++) {
-            result[i] = a[i] + b[i];
-        }
+    array_ctx_t ctx;
+    if (array_ctx_init(&ctx, vector_size, sizeof(int)) != 0) {
+        printf("Vector benchmark allocation failed\n");
+        return;
     }
-    BENCHMARK_END();
-    
-    BENCHMARK_PRINT("Vector Addition", LARGE_SIZE * vector_size, elapsed);
-    
-    free(a);
-    free(b);
-    free(result);
-}
+    int *a = ctx.a, *b = ctx.b;
 
-void benchmark_vector_mul() {
-    printf("\n=== Vector Multiplication Benchmark ===\n");
-    
-    int vector_size = 512;  // 512-bit vector = 16 x 32-bit elements
-    int *a = malloc(vector_size * sizeof(int));
-    int *b = malloc(vector_size * sizeof(int));
-    int *result = malloc(vector_size * sizeof(int));
-    
     // Initialize test data
     for (int i = 0; i < vector_size; i++) {
-        a[i] = rand() % 100;
+        a[i] = rand() % 1000;
         b[i] = rand() % 100;
     }
-    
-    // Benchmark vector multiplication
-    BENCHMARK_START();
-    for (int iter = 0; iter < LARGE_SIZE; iter++) {
-        for (int i = 0; i < vector_size; i++) {
-            result[i] = a[i] * b[i];
+
+    // Cache-resident operands: measures the arithmetic, not memory
+    run_benchmark("Vector Addition", add_kernel, &ctx, vector_size);
+    run_benchmark("Vector Multiplication", mul_kernel, &ctx, vector_size);
+
+    array_ctx_free(&ctx);
+}
+
+// AI/ML benchmarks
+typedef struct {
+    float *input;
+    float *kernel;
+    float *output;
+} conv_ctx_t;
+
+static void convolution_kernel(void *arg, uint64_t iterations) {
+    conv_ctx_t *ctx = (conv_ctx_t *)arg;
+    for (uint64_t iter = 0; iter < iterations; iter++) {
+        for (int y = 0; y < 26; y++) {
+            for (int x = 0; x < 26; x++) {
+                float sum = 0.0f;
+                for (int ky = 0; ky < 3; ky++) {
+                    for (int kx = 0; kx < 3; kx++) {
+                        sum += ctx->input[(y + ky) * 28 + (x + kx)] * ctx->kernel[ky * 3 + kx];
+                    }
+                }
+                ctx->output[y * 26 + x] = sum;
+            }
         }
+        bench_do_not_optimize(ctx->output);
     }
-    BENCHMARK_END();
-    
-    BENCHMARK_PRINT("Vector Multiplication", LARGE_SIZE * vector_size, elapsed);
-    
-    free(a);
-    free(b);
-    free(result);
 }
 
-// AI/ML benchmarks
 void benchmark_convolution() {
-    printf("\n=== Convolution Benchmark ===\n");
-    
     int input_size = 28 * 28;  // 28x28 input image
     int kernel_size = 3 * 3;   // 3x3 kernel
     int output_size = 26 * 26; // 26x26 output
-    
-    float *input = malloc(input_size * sizeof(float));
-    float *kernel = malloc(kernel_size * sizeof(float));
-    float *output = malloc(output_size * sizeof(float));
-    
+
+    conv_ctx_t ctx;
+    ctx.input = malloc(input_size * sizeof(float));
+    ctx.kernel = malloc(kernel_size * sizeof(float));
+    ctx.output = malloc(output_size * sizeof(float));
+    if (!ctx.input || !ctx.kernel || !ctx.output) {
+        printf("Convolution benchmark allocation failed\n");
+        free(ctx.input);
+        free(ctx.kernel);
+        free(ctx.output);
+        return;
+    }
+
     // Initialize test data
     for (int i = 0; i < input_size; i++) {
-        input[i] = (float)rand() / RAND_MAX * 255.0f;
+        ctx.input[i] = (float)rand() / RAND_MAX * 255.0f;
     }
     for (int i = 0; i < kernel_size; i++) {
-        kernel[i] = (float)rand() / RAND_MAX * 2.0f - 1.0f;
+        ctx.kernel[i] = (float)rand() / RAND_MAX * 2.0f - 1.0f;
     }
-    
-    // Benchmark convolution
-    BENCHMARK_START();
-    for (int iter = 0; iter < 100; iter++) {
-        for (int y = 0; y < 26; y++) {
-            for (int x = 0; x < 26; x++) {
+
+    // One operation per output pixel
+    run_benchmark("Convolution", convolution_kernel, &ctx, output_size);
+
+    free(ctx.input);
+    free(ctx.kernel);
+    free(ctx.output);
+}
+
+static void matrix_multiply_kernel(void *arg, uint64_t iterations) {
+    array_ctx_t *ctx = (array_ctx_t *)arg;
+    const float *a = ctx->a, *b = ctx->b;
+    float *c = ctx->result;
+    int size = ctx->size;
+    for (uint64_t iter = 0; iter < iterations; iter++) {
+        for (int i = 0; i < size; i++) {
+            for (int j = 0; j < size; j++) {
                 float sum = 0.0f;
-                for (int ky = 0; ky < 3; ky++) {
-                    for (int kx = 0; kx < 3; kx++) {
-                        sum += input[(y + ky) * 28 + (x + kx)] * kernel[ky * 3 + kx];
-                    }
+                for (int k = 0; k < size; k++) {
+                    sum += a[i * size + k] * b[k * size + j];
                 }
-                output[y * 26 + x] = sum;
+                c[i * size + j] = sum;
             }
         }
+        bench_do_not_optimize(c);
     }
-    BENCHMARK_END();
-    
-    BENCHMARK_PRINT("Convolution", 100 * output_size, elapsed);
-    
-    free(input);
-    free(kernel);
-    free(output);
 }
 
 void benchmark_matrix_multiply() {
-    printf("\n=== Matrix Multiplication Benchmark ===\n");
-    
     int size = 256;  // 256x256 matrices
-    float *a = malloc(size * size * sizeof(float));
-    float *b = malloc(size * size * sizeof(float));
-    float *c = malloc(size * size * sizeof(float));
-    
+    array_ctx_t ctx;
+    if (array_ctx_init(&ctx, size * size, sizeof(float)) != 0) {
+        printf("Matrix benchmark allocation failed\n");
+        return;
+    }
+    ctx.size = size;
+    float *a = ctx.a, *b = ctx.b;
+
     // Initialize test data
     for (int i = 0; i < size * size; i++) {
         a[i] = (float)rand() / RAND_MAX * 10.0f;
         b[i] = (float)rand() / RAND_MAX * 10.0f;
     }
-    
-    // Benchmark matrix multiplication
-    BENCHMARK_START();
-    for (int i = 0; i < size; i++) {
-        for (int j = 0; j < size; j++) {
-            float sum = 0.0f;
-            for (int k = 0; k < size; k++) {
-                sum += a[i * size + k] * b[k * size + j];
-            }
-            c[i * size + j] = sum;
+
+    // One operation per multiply-add
+    run_benchmark("Matrix Multiplication", matrix_multiply_kernel, &ctx,
+                  (double)size * size * size);
+
+    array_ctx_free(&ctx);
+}
+
+static void relu_kernel(void *arg, uint64_t iterations) {
+    array_ctx_t *ctx = (array_ctx_t *)arg;
+    const float *input = ctx->a;
+    float *output = ctx->result;
+    for (uint64_t iter = 0; iter < iterations; iter++) {
+        for (int i = 0; i < ctx->size; i++) {
+            output[i] = (input[i] > 0) ? input[i] : 0.0f;
         }
+        bench_do_not_optimize(output);
     }
-    BENCHMARK_END();
-    
-    BENCHMARK_PRINT("Matrix Multiplication", size * size * size, elapsed);
-    
-    free(a);
-    free(b);
-    free(c);
 }
 
 void benchmark_relu() {
-    printf("\n=== ReLU Activation Benchmark ===\n");
-    
-    float *input = malloc(LARGE_SIZE * sizeof(float));
-    float *output = malloc(LARGE_SIZE * sizeof(float));
-    
+    array_ctx_t ctx;
+    if (array_ctx_init(&ctx, LARGE_SIZE, sizeof(float)) != 0) {
+        printf("ReLU benchmark allocation failed\n");
+        return;
+    }
+    float *input = ctx.a;
+
     // Initialize test data
     for (int i = 0; i < LARGE_SIZE; i++) {
         input[i] = (float)rand() / RAND_MAX * 20.0f - 10.0f;
     }
-    
-    // Benchmark ReLU activation
-    BENCHMARK_START();
-    for (int i = 0; i < LARGE_SIZE; i++) {
-        output[i] = (input[i] > 0) ? input[i] : 0.0f;
+
+    run_benchmark("ReLU Activation", relu_kernel, &ctx, LARGE_SIZE);
+
+    array_ctx_free(&ctx);
+}
+
+// Memory benchmarks (operations are bytes)
+static void memory_copy_kernel(void *arg, uint64_t iterations) {
+    array_ctx_t *ctx = (array_ctx_t *)arg;
+    for (uint64_t iter = 0; iter < iterations; iter++) {
+        memcpy(ctx->result, ctx->a, ctx->size);
+        bench_do_not_optimize(ctx->result);
+    }
+}
+
+static void memory_set_kernel(void *arg, uint64_t iterations) {
+    array_ctx_t *ctx = (array_ctx_t *)arg;
+    for (uint64_t iter = 0; iter < iterations; iter++) {
+        memset(ctx->result, 0xAA, ctx->size);
+        bench_do_not_optimize(ctx->result);
     }
-    BENCHMARK_END();
-    
-    BENCHMARK_PRINT("ReLU Activation", LARGE_SIZE, elapsed);
-    
-    free(input);
-    free(output);
 }
 
-// Memory benchmarks
-void benchmark_memory_copy() {
-    printf("\n=== Memory Copy Benchmark ===\n");
-    
+void benchmark_memory() {
     int size = 1024 * 1024;  // 1MB
-    char *src = malloc(size);
-    char *dst = malloc(size);
-    
+    array_ctx_t ctx;
+    if (array_ctx_init(&ctx, size, 1) != 0) {
+        printf("Memory benchmark allocation failed\n");
+        return;
+    }
+    char *src = ctx.a;
+
     // Initialize test data
     for (int i = 0; i < size; i++) {
         src[i] = rand() % 256;
     }
-    
-    // Benchmark memory copy
-    BENCHMARK_START();
-    for (int iter = 0; iter < 100; iter++) {
-        memcpy(dst, src, size);
+    memset(ctx.result, 0, size);
+
+    run_benchmark("Memory Copy", memory_copy_kernel, &ctx, size);
+    run_benchmark("Memory Set", memory_set_kernel, &ctx, size);
+
+    array_ctx_free(&ctx);
+}
+
+// Cache benchmarks
+static void cache_read_kernel(void *arg, uint64_t iterations) {
+    array_ctx_t *ctx = (array_ctx_t *)arg;
+    const int *data = ctx->a;
+    int sum = 0;
+    for (uint64_t iter = 0; iter < iterations; iter++) {
+        for (int i = 0; i < ctx->size; i++) {
+            sum += data[i];
+        }
     }
-    BENCHMARK_END();
-    
-    BENCHMARK_PRINT("Memory Copy", 100 * size, elapsed);
-    
-    free(src);
-    free(dst);
+    bench_do_not_optimize(&sum);
 }
 
-void benchmark_memory_set() {
-    printf("\n=== Memory Set Benchmark ===\n");
-    
-    int size = 1024 * 1024;  // 1MB
-    char *dst = malloc(size);
-    
-    // Benchmark memory set
-    BENCHMARK_START();
-    for (int iter = 0; iter < 100; iter++) {
-        memset(dst, 0xAA, size);
+static void cache_write_kernel(void *arg, uint64_t iterations) {
+    array_ctx_t *ctx = (array_ctx_t *)arg;
+    int *data = ctx->a;
+    for (uint64_t iter = 0; iter < iterations; iter++) {
+        for (int i = 0; i < ctx->size; i++) {
+            data[i] = i + (int)iter;
+        }
+        bench_do_not_optimize(data);
     }
-    BENCHMARK_END();
-    
-    BENCHMARK_PRINT("Memory Set", 100 * size, elapsed);
-    
-    free(dst);
 }
 
-// Cache benchmarks
-void benchmark_cache_read() {
-    printf("\n=== Cache Read Benchmark ===\n");
-    
-    int size = 1024 * 1024;  // 1MB
-    int *data = malloc(size * sizeof(int));
-    
+void benchmark_cache() {
+    int size = 1024 * 1024;  // 1M ints
+    array_ctx_t ctx;
+    if (array_ctx_init(&ctx, size, sizeof(int)) != 0) {
+        printf("Cache benchmark allocation failed\n");
+        return;
+    }
+    int *data = ctx.a;
+
     // Initialize test data
     for (int i = 0; i < size; i++) {
         data[i] = i;
     }
-    
-    // Benchmark cache read
-    BENCHMARK_START();
-    int sum = 0;
-    for (int iter = 0; iter < 100; iter++) {
-        for (int i = 0; i < size; i++) {
-            sum += data[i];
-        }
-    }
-    BENCHMARK_END();
-    
-    BENCHMARK_PRINT("Cache Read", 100 * size, elapsed);
-    
-    free(data);
+
+    run_benchmark("Cache Read", cache_read_kernel, &ctx, size);
+    run_benchmark("Cache Write", cache_write_kernel, &ctx, size);
+
+    array_ctx_free(&ctx);
 }
 
-void benchmark_cache_write() {
-    printf("\n=== Cache Write Benchmark ===\n");
-    
-    int size = 1024 * 1024;  // 1MB
-    int *data = malloc(size * sizeof(int));
-    
-    // Benchmark cache write
-    BENCHMARK_START();
-    for (int iter = 0; iter < 100; iter++) {
-        for (int i = 0; i < size; i++) {
-            data[i] = i + iter;
+// Branch prediction benchmarks
+static void branch_kernel(void *arg, uint64_t iterations) {
+    array_ctx_t *ctx = (array_ctx_t *)arg;
+    const int *data = ctx->a;
+    int *result = ctx->result;
+    for (uint64_t iter = 0; iter < iterations; iter++) {
+        for (int i = 0; i < ctx->size; i++) {
+            if (data[i] == 0) {
+                result[i] = 1;
+            } else {
+                result[i] = 0;
+            }
         }
+        bench_do_not_optimize(result);
     }
-    BENCHMARK_END();
-    
-    BENCHMARK_PRINT("Cache Write", 100 * size, elapsed);
-    
-    free(data);
 }
 
-// Branch prediction benchmarks
 void benchmark_branch_prediction() {
-    printf("\n=== Branch Prediction Benchmark ===\n");
-    
     int size = LARGE_SIZE;
-    int *data = malloc(size * sizeof(int));
-    int *result = malloc(size * sizeof(int));
-    
+    array_ctx_t ctx;
+    if (array_ctx_init(&ctx, size, sizeof(int)) != 0) {
+        printf("Branch benchmark allocation failed\n");
+        return;
+    }
+    int *data = ctx.a;
+
     // Initialize test data with predictable pattern
     for (int i = 0; i < size; i++) {
         data[i] = i % 2;  // Alternating 0 and 1
     }
-    
-    // Benchmark predictable branches
-    BENCHMARK_START();
+    run_benchmark("Predictable Branches", branch_kernel, &ctx, size);
+
+    // Benchmark unpredictable branches
     for (int i = 0; i < size; i++) {
-        if (data[i] == 0) {
-            result[i] = 1;
+        data[i] = rand() % 2;  // Random 0 and 1
+    }
+    run_benchmark("Unpredictable Branches", branch_kernel, &ctx, size);
+
+    array_ctx_free(&ctx);
+}
+
+// MIMD benchmarks
+// ===============
+//
+// Real threads (sync_run_team) contending on the primitives of
+// sync-primitives.h. Each point is one primitive at one thread count; a
+// primitive's points print as a scaling curve. A sample starts and joins
+// its team, which calibration amortizes over milliseconds of contention.
+
+#define CONTENTION_QUEUE_CAPACITY 1024
+
+typedef enum {
+    PLACEMENT_SHARED,           // One counter for all threads
+    PLACEMENT_FALSE_SHARED,     // Own counters, packed into shared lines
+    PLACEMENT_PADDED,           // Own counters on own lines
+    PLACEMENTS
+} placement_t;
+
+static const char *placement_names[PLACEMENTS] = { "Shared", "False Shared", "Padded" };
+
+typedef struct {
+    sync_worker_t worker;
+    int threads;
+    uint64_t iterations;        // Per worker, per sample
+    int failed;                 // A team could not be started
+    sync_barrier_t barrier;
+    sync_lock_t lock;
+    uint64_t protected_count;   // Only touched under lock
+    int use_cas;
+    placement_t placement;
+    uint64_t *packed;           // SYNC_MAX_THREADS adjacent counters
+    sync_padded_t *padded;      // SYNC_MAX_THREADS padded counters
+    sync_spsc_queue_t spsc;
+    sync_mpmc_queue_t mpmc;
+} contention_ctx_t;
+
+static void barrier_worker(int tid, int threads, void *arg) {
+    contention_ctx_t *ctx = (contention_ctx_t *)arg;
+    (void)threads;
+    for (uint64_t iter = 0; iter < ctx->iterations; iter++) {
+        sync_barrier_wait(&ctx->barrier, tid);
+    }
+}
+
+// Relaxed read-modify-writes: the cost of the line transfer, no ordering
+static void atomic_worker(int tid, int threads, void *arg) {
+    contention_ctx_t *ctx = (contention_ctx_t *)arg;
+    uint64_t *target = ctx->placement == PLACEMENT_SHARED ? &ctx->padded[0].value :
+                       ctx->placement == PLACEMENT_FALSE_SHARED ? &ctx->packed[tid] :
+                       &ctx->padded[tid].value;
+    (void)threads;
+
+    if (ctx->use_cas) {
+        for (uint64_t iter = 0; iter < ctx->iterations; iter++) {
+            uint64_t seen = __atomic_load_n(target, __ATOMIC_RELAXED);
+            while (!__atomic_compare_exchange_n(target, &seen, seen + 1, 1, __ATOMIC_RELAXED,
+                                                __ATOMIC_RELAXED)) {
+            }
+        }
+    } else {
+        for (uint64_t iter = 0; iter < ctx->iterations; iter++) {
+            __atomic_fetch_add(target, 1, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+// Empty critical sections: under contention every acquisition is a handoff
+static void lock_worker(int tid, int threads, void *arg) {
+    contention_ctx_t *ctx = (contention_ctx_t *)arg;
+    (void)tid;
+    (void)threads;
+    for (uint64_t iter = 0; iter < ctx->iterations; iter++) {
+        sync_lock_acquire(&ctx->lock);
+        ctx->protected_count++;
+        sync_lock_release(&ctx->lock);
+    }
+}
+
+// Worker 0 produces, worker 1 consumes
+static void spsc_worker(int tid, int threads, void *arg) {
+    contention_ctx_t *ctx = (contention_ctx_t *)arg;
+    uint64_t item = 0;
+    (void)threads;
+
+    for (uint64_t iter = 0; iter < ctx->iterations; iter++) {
+        unsigned spins = 0;
+        if (tid == 0) {
+            while (sync_spsc_push(&ctx->spsc, iter) != 0) {
+                sync_backoff(&spins);
+            }
         } else {
-            result[i] = 0;
+            while (sync_spsc_pop(&ctx->spsc, &item) != 0) {
+                sync_backoff(&spins);
+            }
         }
     }
-    BENCHMARK_END();
-    
-    BENCHMARK_PRINT("Predictable Branches", size, elapsed);
-    
-    // Benchmark unpredictable branches
-    for (int i = 0; i < size; i++) {
-        data[i] = rand() % 2;  // Random 0 and 1
+    bench_do_not_optimize(&item);
+}
+
+// The first half of the team produces, the second half consumes
+static void mpmc_worker(int tid, int threads, void *arg) {
+    contention_ctx_t *ctx = (contention_ctx_t *)arg;
+    uint64_t item = 0;
+
+    for (uint64_t iter = 0; iter < ctx->iterations; iter++) {
+        unsigned spins = 0;
+        if (tid < threads / 2) {
+            while (sync_mpmc_push(&ctx->mpmc, iter) != 0) {
+                sync_backoff(&spins);
+            }
+        } else {
+            while (sync_mpmc_pop(&ctx->mpmc, &item) != 0) {
+                sync_backoff(&spins);
+            }
+        }
     }
-    
-    BENCHMARK_START();
-    for (int i = 0; i < size; i++) {
-        if (data[i] == 0) {
-            result[i] = 1;
+    bench_do_not_optimize(&item);
+}
+
+static void contention_kernel(void *arg, uint64_t iterations) {
+    contention_ctx_t *ctx = (contention_ctx_t *)arg;
+    ctx->iterations = iterations;
+    if (sync_run_team(ctx->threads, ctx->worker, ctx) != 0) {
+        ctx->failed = 1;
+    }
+}
+
+// Measures ctx->worker on ctx->threads threads and appends the point to curve
+static void contention_point(const char *name, contention_ctx_t *ctx,
+                             double ops_per_iteration, bench_result_t *curve, int *points) {
+    bench_result_t *r = &curve[*points];
+
+    ctx->failed = 0;
+    if (run_benchmark_result(name, contention_kernel, ctx, ops_per_iteration, r) != 0) {
+        return;
+    }
+    if (ctx->failed) {
+        printf("%-30s: cannot start %d threads\n", name, ctx->threads);
+        return;
+    }
+    r->threads = ctx->threads;
+    record_result(r);
+    (*points)++;
+}
+
+static void contention_curve(const char *title, const bench_result_t *curve, int points) {
+    if (points > 1) {
+        bench_print_scaling(title, curve, points);
+        printf("\n");
+    }
+}
+
+// Barrier round trips, atomic RMW throughput by cache-line placement, lock
+// handoffs and queue transfers, each over the thread counts
+void benchmark_mimd(const int *thread_counts, int num_thread_counts) {
+    contention_ctx_t ctx;
+    bench_result_t curve[PARALLEL_MAX_THREADS];
+    char name[BENCH_NAME_MAX], title[BENCH_NAME_MAX];
+    int points;
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.packed = sync_alloc(SYNC_MAX_THREADS * sizeof(uint64_t));
+    ctx.padded = sync_alloc(SYNC_MAX_THREADS * sizeof(sync_padded_t));
+    if (!ctx.packed || !ctx.padded) {
+        printf("MIMD benchmark allocation failed\n");
+        free(ctx.packed);
+        free(ctx.padded);
+        return;
+    }
+
+    // Operations are barrier episodes
+    ctx.worker = barrier_worker;
+    for (int k = 0; k < SYNC_BARRIER_KINDS; k++) {
+        points = 0;
+        for (int t = 0; t < num_thread_counts; t++) {
+            if (sync_barrier_init(&ctx.barrier, (sync_barrier_kind_t)k, thread_counts[t]) != 0) {
+                continue;
+            }
+            ctx.threads = thread_counts[t];
+            snprintf(name, sizeof(name), "Barrier %s/%dT", sync_barrier_names[k], ctx.threads);
+            contention_point(name, &ctx, 1, curve, &points);
+            sync_barrier_destroy(&ctx.barrier);
+        }
+        snprintf(title, sizeof(title), "Barrier %s round trip", sync_barrier_names[k]);
+        contention_curve(title, curve, points);
+    }
+
+    // Operations are read-modify-writes summed over threads
+    ctx.worker = atomic_worker;
+    for (int cas = 0; cas <= 1; cas++) {
+        for (int p = 0; p < PLACEMENTS; p++) {
+            points = 0;
+            ctx.use_cas = cas;
+            ctx.placement = (placement_t)p;
+            for (int t = 0; t < num_thread_counts; t++) {
+                ctx.threads = thread_counts[t];
+                snprintf(name, sizeof(name), "Atomic %s %s/%dT", cas ? "CAS" : "FetchAdd",
+                         placement_names[p], ctx.threads);
+                contention_point(name, &ctx, ctx.threads, curve, &points);
+            }
+            snprintf(title, sizeof(title), "Atomic %s, %s lines", cas ? "CAS" : "fetch-add",
+                     placement_names[p]);
+            contention_curve(title, curve, points);
+        }
+    }
+
+    // Operations are lock acquisitions summed over threads
+    ctx.worker = lock_worker;
+    for (int k = 0; k < SYNC_LOCK_KINDS; k++) {
+        if (sync_lock_init(&ctx.lock, (sync_lock_kind_t)k) != 0) {
+            continue;
+        }
+        points = 0;
+        for (int t = 0; t < num_thread_counts; t++) {
+            ctx.threads = thread_counts[t];
+            snprintf(name, sizeof(name), "Lock %s/%dT", sync_lock_names[k], ctx.threads);
+            contention_point(name, &ctx, ctx.threads, curve, &points);
+        }
+        sync_lock_destroy(&ctx.lock);
+        snprintf(title, sizeof(title), "Lock %s handoff", sync_lock_names[k]);
+        contention_curve(title, curve, points);
+    }
+
+    // Operations are items transferred
+    if (sync_spsc_init(&ctx.spsc, CONTENTION_QUEUE_CAPACITY) == 0) {
+        points = 0;
+        ctx.worker = spsc_worker;
+        ctx.threads = 2;
+        contention_point("Queue SPSC/2T", &ctx, 1, curve, &points);
+        sync_spsc_destroy(&ctx.spsc);
+    }
+    if (sync_mpmc_init(&ctx.mpmc, CONTENTION_QUEUE_CAPACITY) == 0) {
+        points = 0;
+        ctx.worker = mpmc_worker;
+        for (int t = 0; t < num_thread_counts; t++) {
+            // Equal numbers of producers and consumers
+            ctx.threads = thread_counts[t] & ~1;
+            if (ctx.threads < 2 || (t > 0 && (thread_counts[t - 1] & ~1) == ctx.threads)) {
+                continue;
+            }
+            snprintf(name, sizeof(name), "Queue MPMC/%dT", ctx.threads);
+            contention_point(name, &ctx, ctx.threads / 2, curve, &points);
+        }
+        sync_mpmc_destroy(&ctx.mpmc);
+        contention_curve("Queue MPMC transfer", curve, points);
+    }
+
+    free(ctx.packed);
+    free(ctx.padded);
+}
+
+// Working-set sweeps
+// ==================
+
+typedef enum {
+    SWEEP_INT_ADD,
+    SWEEP_FLOAT_MUL,
+    SWEEP_RELU,
+    SWEEP_COPY,
+    SWEEP_SET,
+    SWEEP_READ,
+    SWEEP_WRITE,
+    SWEEP_KERNELS
+} sweep_kind_t;
+
+typedef struct {
+    const char *name;
+    int arrays;             // Arrays in the working set
+} sweep_info_t;
+
+static const sweep_info_t sweep_info[SWEEP_KERNELS] = {
+    { "Integer Addition", 3 },
+    { "Floating-Point Multiplication", 3 },
+    { "ReLU Activation", 2 },
+    { "Memory Copy", 2 },
+    { "Memory Set", 1 },
+    { "Cache Read", 1 },
+    { "Cache Write", 1 },
+};
+
+typedef struct {
+    sweep_kind_t kind;
+    int32_t *a;
+    int32_t *b;
+    int32_t *result;
+    size_t n;               // Elements per array
+    int threads;
+    uint64_t iterations;
+} sweep_ctx_t;
+
+// Every worker streams over its own slice `iterations` times, so a sample
+// forks once and measures steady-state bandwidth rather than fork cost
+static void sweep_range(size_t begin, size_t end, int tid, void *arg) {
+    sweep_ctx_t *ctx = (sweep_ctx_t *)arg;
+    size_t len = end - begin;
+    int32_t *a = ctx->a + begin, *b = ctx->b + begin, *r = ctx->result + begin;
+    float *fa = (float *)a, *fb = (float *)b, *fr = (float *)r;
+    int32_t sum = 0;
+    (void)tid;
+
+    for (uint64_t iter = 0; iter < ctx->iterations; iter++) {
+        switch (ctx->kind) {
+        case SWEEP_INT_ADD:
+            for (size_t i = 0; i < len; i++) {
+                r[i] = a[i] + b[i];
+            }
+            break;
+        case SWEEP_FLOAT_MUL:
+            for (size_t i = 0; i < len; i++) {
+                fr[i] = fa[i] * fb[i];
+            }
+            break;
+        case SWEEP_RELU:
+            for (size_t i = 0; i < len; i++) {
+                fr[i] = fa[i] > 0.0f ? fa[i] : 0.0f;
+            }
+            break;
+        case SWEEP_COPY:
+            memcpy(r, a, len * sizeof(int32_t));
+            break;
+        case SWEEP_SET:
+            memset(r, 0xAA, len * sizeof(int32_t));
+            break;
+        case SWEEP_READ: {
+            // Independent lane sums, so the loop is bound by loads, not adds
+            int32_t lanes[16] = { 0 };
+            size_t i = 0;
+            for (; i + 16 <= len; i += 16) {
+#if defined(__GNUC__) && !defined(__clang__)
+                #pragma GCC unroll 16
+#endif
+                for (int l = 0; l < 16; l++) {
+                    lanes[l] += a[i + l];
+                }
+            }
+            for (; i < len; i++) {
+                sum += a[i];
+            }
+            for (int l = 0; l < 16; l++) {
+                sum += lanes[l];
+            }
+            break;
+        }
+        case SWEEP_WRITE:
+            for (size_t i = 0; i < len; i++) {
+                r[i] = (int32_t)(i + iter);
+            }
+            break;
+        default:
+            break;
+        }
+        bench_do_not_optimize(r);
+    }
+    bench_do_not_optimize(&sum);
+}
+
+static void sweep_kernel(void *arg, uint64_t iterations) {
+    sweep_ctx_t *ctx = (sweep_ctx_t *)arg;
+    ctx->iterations = iterations;
+    if (ctx->threads == 1) {
+        sweep_range(0, ctx->n, 0, ctx);
+    } else {
+        parallel_for(0, ctx->n, SWEEP_GRAIN, ctx->threads, sweep_range, ctx);
+    }
+}
+
+static void sweep_name(char *out, size_t size, sweep_kind_t kind, uint64_t bytes,
+                       int threads) {
+    char label[24];
+    bench_format_size(bytes, label, sizeof(label));
+    snprintf(out, size, "%s/%s/%dT", sweep_info[kind].name, label, threads);
+}
+
+// Curves of every sweep kernel over sizes, once per thread count
+void benchmark_sweeps(uint64_t min_bytes, uint64_t max_bytes, const int *thread_counts,
+                      int num_thread_counts) {
+    uint64_t sizes[BENCH_MAX_SWEEP_POINTS];
+    int num_sizes = bench_sweep_sizes(min_bytes, max_bytes, sizes);
+    size_t max_elems = num_sizes ? sizes[num_sizes - 1] / sizeof(int32_t) : 0;
+    char name[BENCH_NAME_MAX];
+    int wanted = 0;
+
+    // Decide before allocating up to three DRAM-sized arrays
+    for (int k = 0; k < SWEEP_KERNELS; k++) {
+        for (int t = 0; t < num_thread_counts; t++) {
+            for (int s = 0; s < num_sizes; s++) {
+                sweep_name(name, sizeof(name), (sweep_kind_t)k, sizes[s], thread_counts[t]);
+                wanted |= bench_filter_match(&bench_filter, name);
+            }
+        }
+    }
+    if (!wanted) {
+        return;
+    }
+
+    sweep_ctx_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.a = malloc(max_elems * sizeof(int32_t));
+    ctx.b = malloc(max_elems * sizeof(int32_t));
+    ctx.result = malloc(max_elems * sizeof(int32_t));
+    if (!ctx.a || !ctx.b || !ctx.result) {
+        printf("Sweep allocation failed (%llu bytes per array)\n",
+               (unsigned long long)(max_elems * sizeof(int32_t)));
+        free(ctx.a);
+        free(ctx.b);
+        free(ctx.result);
+        return;
+    }
+    for (size_t i = 0; i < max_elems; i++) {
+        ((float *)ctx.a)[i] = (float)rand() / RAND_MAX * 20.0f - 10.0f;
+        ((float *)ctx.b)[i] = (float)rand() / RAND_MAX * 10.0f;
+        ctx.result[i] = 0;
+    }
+
+    for (int k = 0; k < SWEEP_KERNELS; k++) {
+        for (int t = 0; t < num_thread_counts; t++) {
+            bench_result_t curve[BENCH_MAX_SWEEP_POINTS];
+            int points = 0;
+
+            ctx.kind = (sweep_kind_t)k;
+            ctx.threads = thread_counts[t];
+            for (int s = 0; s < num_sizes; s++) {
+                ctx.n = sizes[s] / (sweep_info[k].arrays * sizeof(int32_t));
+                if (ctx.n == 0) {
+                    continue;
+                }
+                sweep_name(name, sizeof(name), (sweep_kind_t)k, sizes[s], ctx.threads);
+                // Operations are bytes moved, so ops/sec reads as bandwidth
+                double bytes = (double)ctx.n * sweep_info[k].arrays * sizeof(int32_t);
+                bench_result_t *r = &curve[points];
+                if (run_benchmark_result(name, sweep_kernel, &ctx, bytes, r) == 0) {
+                    r->size_bytes = sizes[s];
+                    r->threads = ctx.threads;
+                    record_result(r);
+                    points++;
+                }
+            }
+            if (points > 1) {
+                snprintf(name, sizeof(name), "%s, %d thread%s", sweep_info[k].name,
+                         ctx.threads, ctx.threads == 1 ? "" : "s");
+                bench_print_curve(name, curve, points);
+                printf("\n");
+            }
+        }
+    }
+
+    free(ctx.a);
+    free(ctx.b);
+    free(ctx.result);
+}
+
+// Memory hierarchy characterization
+// =================================
+
+// Default top of the latency curve; clamped to a quarter of physical memory
+#define MEMORY_MAX_BYTES ((uint64_t)1 << 30)
+#define MEMORY_MAX_POINTS 32
+
+// TLB chase: one line per 4 KiB page over 64 MiB, 16x a typical STLB reach
+// while the touched lines (1 MiB) stay cache resident
+#define MEMORY_TLB_BYTES ((uint64_t)64 << 20)
+
+static const char *memory_bw_names[] = { "Read", "Write", "Copy", "Write NT" };
+
+typedef struct {
+    char level[16];
+    uint64_t size;
+    int ways;               // 0 prints N/A
+    int data;               // Measured by the data-side kernels
+} memory_level_t;
+
+static double memory_cycles(double ns, double cpu_mhz) {
+    return ns * cpu_mhz * 1e-3;
+}
+
+static void memory_format_latency(char *out, size_t size, double ns, double cpu_mhz) {
+    if (ns <= 0.0) {
+        snprintf(out, size, "n/a");
+    } else if (cpu_mhz > 0.0) {
+        snprintf(out, size, "%.0f cycles (%.1f ns)", memory_cycles(ns, cpu_mhz), ns);
+    } else {
+        snprintf(out, size, "%.1f ns", ns);
+    }
+}
+
+static void memory_format_bandwidth(char *out, size_t size, double bytes_per_sec) {
+    if (bytes_per_sec <= 0.0) {
+        snprintf(out, size, "n/a");
+    } else if (bytes_per_sec >= 1e12) {
+        snprintf(out, size, "%.2f TB/s", bytes_per_sec * 1e-12);
+    } else {
+        snprintf(out, size, "%.1f GB/s", bytes_per_sec * 1e-9);
+    }
+}
+
+// Sizes to the nearest unit; physical memory is rarely a power of two
+static void memory_format_capacity(char *out, size_t size, uint64_t bytes) {
+    if (bytes >= ((uint64_t)1 << 30)) {
+        snprintf(out, size, "%.0f GB", (double)bytes / (double)((uint64_t)1 << 30));
+    } else if (bytes >= ((uint64_t)1 << 20)) {
+        snprintf(out, size, "%.0f MB", (double)bytes / (double)((uint64_t)1 << 20));
+    } else {
+        snprintf(out, size, "%.0f KB", (double)bytes / 1024.0);
+    }
+}
+
+// Levels in the order of instruction-timing.md section 5.1: caches from sysfs,
+// then main memory
+static int memory_levels(memory_level_t *levels, int max) {
+    mem_cache_info_t caches[MEM_MAX_CACHES];
+    int num_caches = mem_cache_topology(caches, MEM_MAX_CACHES);
+    int n = 0;
+
+    for (int c = 0; c < num_caches && n < max - 1; c++) {
+        memory_level_t *l = &levels[n++];
+        int instruction = strcmp(caches[c].type, "Instruction") == 0;
+        snprintf(l->level, sizeof(l->level), "L%d%s", caches[c].level,
+                 instruction ? "I" : strcmp(caches[c].type, "Data") == 0 ? "D" : "");
+        l->size = caches[c].size;
+        l->ways = caches[c].ways;
+        l->data = !instruction;
+    }
+    snprintf(levels[n].level, sizeof(levels[n].level), "Main Memory");
+    levels[n].size = mem_physical_bytes();
+    levels[n].ways = 0;
+    levels[n].data = 1;
+    return n + 1;
+}
+
+// Working set that exercises a level: half of it, so the level above does
+// not hold the data and conflicts in this one stay rare. 0 for a cache whose
+// working set exceeds the DRAM working set the buffers were sized for
+static uint64_t memory_level_working_set(const memory_level_t *level, uint64_t dram_bytes,
+                                         int is_memory) {
+    uint64_t bytes = is_memory ? dram_bytes : level->size / 2;
+    return bytes > dram_bytes ? 0 : bytes / MEM_PAGE * MEM_PAGE;
+}
+
+// Latency of the largest curve point not above `bytes`
+static double memory_latency_at(const bench_result_t *curve, int points, uint64_t bytes) {
+    double ns = 0.0;
+    for (int i = 0; i < points; i++) {
+        if (curve[i].size_bytes <= bytes) {
+            ns = curve[i].median_ns;
+        }
+    }
+    return ns;
+}
+
+static int memory_latency_curve(uint64_t max_bytes, bench_result_t *curve) {
+    mem_buffer_t buffer;
+    mem_chase_t chase;
+    char name[BENCH_NAME_MAX], label[24];
+    int points = 0, allocated = 0;
+
+    for (uint64_t bytes = MEM_PAGE; bytes <= max_bytes && points < MEMORY_MAX_POINTS;
+         bytes *= 2) {
+        bench_format_size(bytes, label, sizeof(label));
+        snprintf(name, sizeof(name), "Latency/%s", label);
+        if (!bench_filter_match(&bench_filter, name)) {
+            continue;
+        }
+        if (list_only) {
+            printf("%s\n", name);
+            continue;
+        }
+        if (!allocated) {
+            if (mem_buffer_alloc(&buffer, max_bytes, MEM_PAGES_DEFAULT) != 0) {
+                printf("Latency buffer allocation failed (%llu bytes)\n",
+                       (unsigned long long)max_bytes);
+                return 0;
+            }
+            allocated = 1;
+        }
+        chase.cursor = mem_chase_build(buffer.base, bytes / MEM_LINE, MEM_LINE, 0,
+                                       BENCHMARK_SEED);
+        if (!chase.cursor) {
+            continue;
+        }
+        bench_result_t *r = &curve[points];
+        if (run_benchmark_result(name, mem_chase_kernel, &chase, MEM_CHASE_STEPS, r) == 0) {
+            r->size_bytes = bytes;
+            r->threads = 1;
+            record_result(r);
+            points++;
+        }
+    }
+    if (allocated) {
+        mem_buffer_free(&buffer);
+    }
+    return points;
+}
+
+// Bandwidth of every kind at `bytes` per buffer. Returns the read bandwidth in
+// bytes/sec, 0 if it was not measured.
+static double memory_bandwidth_point(mem_buffer_t *src, mem_buffer_t *dst, uint64_t bytes,
+                                     int threads) {
+    char name[BENCH_NAME_MAX], label[24];
+    double read_rate = 0.0;
+
+    bench_format_size(bytes, label, sizeof(label));
+    for (int k = MEM_READ; k <= MEM_WRITE_NT; k++) {
+        mem_bw_ctx_t ctx = { (mem_bw_kind_t)k, src->base, dst->base, bytes, threads, 0 };
+        bench_result_t r;
+
+        if (k == MEM_WRITE_NT && !mem_streaming_stores()) {
+            continue;
+        }
+        snprintf(name, sizeof(name), "Bandwidth %s/%s/%dT", memory_bw_names[k], label,
+                 threads);
+        // Operations are bytes moved, so ops/sec reads as bandwidth
+        if (run_benchmark_result(name, mem_bw_kernel, &ctx, mem_bw_bytes(&ctx), &r) == 0) {
+            r.size_bytes = bytes;
+            r.threads = threads;
+            record_result(&r);
+            if (k == MEM_READ) {
+                read_rate = r.ops_per_sec;
+            }
+        }
+    }
+    return read_rate;
+}
+
+// Chase cost per page with small pages and with huge pages requested
+static void memory_tlb(double cpu_mhz) {
+    static const struct { const char *name; mem_pages_t pages; } modes[] = {
+        { "TLB Chase/4KiB pages", MEM_PAGES_SMALL },
+        { "TLB Chase/2MiB pages", MEM_PAGES_HUGE },
+    };
+    double ns[2] = { 0.0, 0.0 };
+    long huge_kib = 0;
+
+    for (int m = 0; m < 2; m++) {
+        mem_buffer_t buffer;
+        mem_chase_t chase;
+        bench_result_t r;
+        long before;
+
+        if (!bench_filter_match(&bench_filter, modes[m].name)) {
+            continue;
+        }
+        if (list_only) {
+            printf("%s\n", modes[m].name);
+            continue;
+        }
+        before = mem_huge_page_kib();
+        if (mem_buffer_alloc(&buffer, MEMORY_TLB_BYTES, modes[m].pages) != 0) {
+            printf("TLB buffer allocation failed\n");
+            continue;
+        }
+        if (modes[m].pages == MEM_PAGES_HUGE && before >= 0) {
+            huge_kib = mem_huge_page_kib() - before;
+        }
+        chase.cursor = mem_chase_build(buffer.base, MEMORY_TLB_BYTES / MEM_PAGE, MEM_PAGE, 1,
+                                       BENCHMARK_SEED);
+        if (chase.cursor &&
+            run_benchmark_result(modes[m].name, mem_chase_kernel, &chase, MEM_CHASE_STEPS,
+                                 &r) == 0) {
+            r.size_bytes = MEMORY_TLB_BYTES;
+            r.threads = 1;
+            record_result(&r);
+            ns[m] = r.median_ns;
+        }
+        mem_buffer_free(&buffer);
+    }
+
+    if (ns[0] > 0.0 && ns[1] > 0.0) {
+        char cost[48];
+        memory_format_latency(cost, sizeof(cost), ns[0] - ns[1], cpu_mhz);
+        printf("\nTLB miss cost: %s per access", cost);
+        if (huge_kib > 0) {
+            printf(" (%ld KiB backed by huge pages)\n", huge_kib);
         } else {
-            result[i] = 0;
+            printf(" (huge pages not granted, both runs used 4 KiB pages)\n");
         }
     }
-    BENCHMARK_END();
-    
-    BENCHMARK_PRINT("Unpredictable Branches", size, elapsed);
-    
-    free(data);
-    free(result);
 }
 
-// MIMD benchmarks
-void benchmark_barrier() {
-    printf("\n=== Barrier Synchronization Benchmark ===\n");
-    
-    int iterations = 1000;
-    int num_threads = 4;  // Simulated 4 threads
-    
-    BENCHMARK_START();
-    for (int iter = 0; iter < iterations; iter++) {
-        // Simulate barrier synchronization
-        for (int thread = 0; thread < num_threads; thread++) {
-            // Simulate work
-            volatile int dummy = 0;
-            for (int i = 0; i < 1000; i++) {
-                dummy += i;
-            }
-        }
-    }
-    BENCHMARK_END();
-    
-    BENCHMARK_PRINT("Barrier Synchronization", iterations * num_threads, elapsed);
-}
-
-void benchmark_atomic() {
-    printf("\n=== Atomic Operations Benchmark ===\n");
-    
-    int iterations = LARGE_SIZE;
-    volatile int atomic_var = 0;
-    
-    BENCHMARK_START();
-    for (int i = 0; i < iterations; i++) {
-        // Simulate atomic increment
-        atomic_var++;
-    }
-    BENCHMARK_END();
-    
-    BENCHMARK_PRINT("Atomic Operations", iterations, elapsed);
+// Latency curve, bandwidth per level, TLB miss cost, and a summary table in
+// the layout of instruction-timing.md section 5.1 for comparison with the spec
+void benchmark_memory_hierarchy(uint64_t max_bytes, const int *thread_counts,
+                                int num_thread_counts, double cpu_mhz) {
+    memory_level_t levels[MEM_MAX_CACHES + 1];
+    int num_levels = memory_levels(levels, MEM_MAX_CACHES + 1);
+    double latency[MEM_MAX_CACHES + 1] = { 0.0 };
+    double bandwidth[MEM_MAX_CACHES + 1] = { 0.0 };
+    bench_result_t curve[MEMORY_MAX_POINTS];
+    uint64_t physical = mem_physical_bytes();
+    uint64_t last_cache = 0, dram_bytes;
+    int points;
+
+    if (physical && max_bytes > physical / 4) {
+        max_bytes = physical / 4;
+    }
+    for (int l = 0; l < num_levels - 1; l++) {
+        last_cache = levels[l].size > last_cache ? levels[l].size : last_cache;
+    }
+    // DRAM bandwidth: well past the last-level cache, bounded like the curve
+    dram_bytes = last_cache * 4 > ((uint64_t)64 << 20) ? last_cache * 4 : (uint64_t)64 << 20;
+    dram_bytes = dram_bytes > max_bytes ? max_bytes : dram_bytes;
+
+    points = memory_latency_curve(max_bytes, curve);
+    if (points > 1) {
+        printf("\n  Load-to-use latency (ns) by working set\n");
+        for (int i = 0; i < points; i++) {
+            char label[24];
+            bench_format_size(curve[i].size_bytes, label, sizeof(label));
+            printf("  %8s %8.2f ns |", label, curve[i].median_ns);
+            for (int b = 0; b < (int)(curve[i].median_ns / 2.0) && b < 60; b++) {
+                putchar('#');
+            }
+            printf("\n");
+        }
+        printf("\n");
+    }
+
+    // One buffer pair sized for the largest level, reused by every point
+    mem_buffer_t src, dst;
+    int have_buffers = 0;
+    memset(&src, 0, sizeof(src));
+    memset(&dst, 0, sizeof(dst));
+    if (!list_only) {
+        have_buffers = mem_buffer_alloc(&src, dram_bytes, MEM_PAGES_DEFAULT) == 0;
+        if (have_buffers && mem_buffer_alloc(&dst, dram_bytes, MEM_PAGES_DEFAULT) != 0) {
+            mem_buffer_free(&src);
+            have_buffers = 0;
+        }
+        if (!have_buffers) {
+            printf("Bandwidth buffer allocation failed (%llu bytes)\n",
+                   (unsigned long long)dram_bytes);
+        }
+    }
+    uint64_t measured = 0;
+    for (int l = 0; l < num_levels; l++) {
+        int is_memory = l == num_levels - 1;
+        uint64_t bytes = memory_level_working_set(&levels[l], dram_bytes, is_memory);
+
+        // A level that does not fit past the one below (small --memory-max)
+        // would repeat its working set, and its benchmark names, so skip it
+        if (!levels[l].data || bytes <= measured) {
+            continue;
+        }
+        measured = bytes;
+        latency[l] = memory_latency_at(curve, points, is_memory ? max_bytes : bytes);
+        for (int t = 0; t < num_thread_counts && (have_buffers || list_only); t++) {
+            double rate = memory_bandwidth_point(&src, &dst, bytes, thread_counts[t]);
+            bandwidth[l] = rate > bandwidth[l] ? rate : bandwidth[l];
+        }
+    }
+    if (have_buffers) {
+        mem_buffer_free(&src);
+        mem_buffer_free(&dst);
+    }
+
+    memory_tlb(cpu_mhz);
+    if (list_only) {
+        return;
+    }
+
+    printf("\nMemory hierarchy (read bandwidth at the best thread count)\n\n");
+    printf("| Level | Size | Latency | Bandwidth | Associativity |\n");
+    printf("|-------|------|---------|-----------|---------------|\n");
+    for (int l = 0; l < num_levels; l++) {
+        char size[24], lat[48], bw[24], ways[16];
+        memory_format_capacity(size, sizeof(size), levels[l].size);
+        memory_format_latency(lat, sizeof(lat), latency[l], cpu_mhz);
+        memory_format_bandwidth(bw, sizeof(bw), bandwidth[l]);
+        if (levels[l].ways > 0) {
+            snprintf(ways, sizeof(ways), "%d-way", levels[l].ways);
+        } else {
+            snprintf(ways, sizeof(ways), "N/A");
+        }
+        printf("| %s | %s | %s | %s | %s |\n", levels[l].level, size, lat, bw, ways);
+    }
+    printf("\n");
+}
+
+// Simulator benchmarks
+// ====================
+//
+// The guest kernels of guest-kernels.h run from reset to HALT under each
+// execution engine of cpu-simulator.h. One operation is one retired guest
+// instruction, so ops/sec is guest instructions per second and ns/op the
+// host time per guest instruction; with counters, "instr" is host
+// instructions per guest instruction.
+
+typedef struct {
+    cpu_system_t *cpu;
+    const guest_kernel_t *kernel;
+    cpu_mode_t mode;
+    int failed;
+} sim_ctx_t;
+
+static void sim_kernel(void *arg, uint64_t iterations) {
+    sim_ctx_t *ctx = (sim_ctx_t *)arg;
+    for (uint64_t iter = 0; iter < iterations; iter++) {
+        if (guest_kernel_run(ctx->cpu, ctx->kernel, ctx->mode) != 0) {
+            ctx->failed = 1;
+        }
+        bench_do_not_optimize(ctx->cpu->cores[0].regs.gpr);
+    }
+}
+
+// "A+B+C 12.3%": a sequence and the share of retired instructions it covers
+static void sim_print_sequences(const cpu_sequence_t *seq, size_t n, uint64_t retired) {
+    for (size_t i = 0; i < n; i++) {
+        printf("%s", i ? ", " : " ");
+        for (int j = 0; j < seq[i].length; j++) {
+            printf("%s%s", j ? "+" : "", cpu_instruction_names[seq[i].type[j]]);
+        }
+        printf(" %.1f%%", 100.0 * (double)(seq[i].count * seq[i].length) / (double)retired);
+    }
+    printf(" |");
+}
+
+// Per kernel: the most frequent adjacent pairs and triples the switch engine
+// retires, then which superinstructions the block engine ran and the share
+// of retired instructions they covered
+static void sim_fusion_report(void) {
+    cpu_profile_t *profile = malloc(sizeof(cpu_profile_t));
+    cpu_sequence_t seq[3];
+
+    if (!profile) {
+        return;
+    }
+    printf("Superinstructions (top profiled sequences, fusions fired in the block engine)\n\n");
+    printf("| Kernel | Top pairs | Top triples | Fused | Fused share |\n");
+    printf("|--------|-----------|-------------|-------|-------------|\n");
+    for (int k = 0; k < GUEST_KERNELS; k++) {
+        const guest_kernel_t *kernel = &guest_kernels[k];
+        cpu_system_t *cpu = guest_kernel_create(kernel);
+        uint64_t retired, covered = 0;
+        int shown = 0;
+
+        if (!cpu) {
+            continue;
+        }
+        memset(profile, 0, sizeof(cpu_profile_t));
+        cpu_reset(cpu, cpu->text_base);
+        if (kernel->setup) {
+            kernel->setup(cpu);
+        }
+        if (cpu_profile_sequences(cpu, UINT64_MAX, profile) != 0 ||
+            guest_kernel_run(cpu, kernel, CPU_MODE_BLOCK) != 0) {
+            cpu_destroy(cpu);
+            continue;
+        }
+        retired = cpu_retired(cpu);
+        printf("| %s |", kernel->name);
+        sim_print_sequences(seq, cpu_profile_top(profile, 2, seq, 3), profile->instructions);
+        sim_print_sequences(seq, cpu_profile_top(profile, 3, seq, 3), profile->instructions);
+        for (int f = 0; f < CPU_FUSED_COUNT; f++) {
+            uint64_t n = cpu->fused_hits[f] * (uint64_t)cpu_fused_length(INST_COUNT + f);
+            // Fusions under 1% are left out of the list but not the total
+            covered += n;
+            if (n * 100 >= retired) {
+                printf("%s%s %.1f%%", shown++ ? ", " : " ", cpu_fused_names[f],
+                       100.0 * (double)n / (double)retired);
+            }
+        }
+        printf("%s | %.1f%% |\n", shown ? "" : " -", 100.0 * (double)covered / (double)retired);
+        cpu_destroy(cpu);
+    }
+    printf("\n");
+    free(profile);
+}
+
+// Assembler throughput: one operation is one assembled instruction of a
+// generated stress program, ASM_BENCH_LOOPS loops of 8 instructions each,
+// built through the emitters or from source text with named labels. The
+// disassembler formats the same program back into listing lines, and the
+// static analyzer reports on each of its loops
+#define ASM_BENCH_LOOPS 32768
+#define ASM_BENCH_INSTRUCTIONS (ASM_BENCH_LOOPS * 8)
+
+typedef struct {
+    char *text;
+    size_t length;
+    uint64_t *words;
+    int failed;
+} asm_ctx_t;
+
+static void asm_emit_kernel(void *arg, uint64_t iterations) {
+    asm_ctx_t *ctx = (asm_ctx_t *)arg;
+    for (uint64_t iter = 0; iter < iterations; iter++) {
+        cpu_asm_t a;
+        cpu_asm_init(&a, CPU_RESET_PC);
+        for (unsigned i = 0; i < ASM_BENCH_LOOPS; i++) {
+            cpu_label_t loop = cpu_asm_label(&a);
+            cpu_asm_bind(&a, loop);
+            cpu_emit_addi(&a, 2, 2, (int64_t)(i & 0x7FFF));
+            cpu_emit_mul(&a, 3, 2, 4);
+            cpu_emit_xor(&a, 5, 3, 2);
+            cpu_emit_shli(&a, 6, 5, 3);
+            cpu_emit_load(&a, 7, 8, 16);
+            cpu_emit_store(&a, 6, 8, 24);
+            cpu_emit_subi(&a, 1, 1, 1);
+            cpu_emit_bnz(&a, 1, loop);
+        }
+        if (cpu_asm_finish(&a) != 0 || a.count != ASM_BENCH_INSTRUCTIONS) {
+            ctx->failed = 1;
+        }
+        bench_do_not_optimize(a.words);
+        if (!ctx->words && !ctx->failed) {
+            ctx->words = a.words;
+            a.words = NULL;
+        }
+        cpu_asm_free(&a);
+    }
+}
+
+static void disasm_kernel(void *arg, uint64_t iterations) {
+    asm_ctx_t *ctx = (asm_ctx_t *)arg;
+    char line[CPU_DISASM_LINE_MAX];
+    size_t bytes = 0;
+
+    for (uint64_t iter = 0; iter < iterations; iter++) {
+        for (size_t i = 0; i < ASM_BENCH_INSTRUCTIONS; i++) {
+            bytes += cpu_disasm_line(ctx->words[i], CPU_RESET_PC + i * CPU_INST_BYTES, NULL,
+                                     line, sizeof(line));
+        }
+        bench_do_not_optimize(line);
+    }
+    bench_do_not_optimize(&bytes);
+}
+
+static void mca_kernel(void *arg, uint64_t iterations) {
+    asm_ctx_t *ctx = (asm_ctx_t *)arg;
+    static cpu_mca_t m;
+
+    for (uint64_t iter = 0; iter < iterations; iter++) {
+        for (size_t i = 0; i < ASM_BENCH_LOOPS; i++) {
+            if (cpu_mca_analyze(ctx->words + i * 8, 8, &m) != 0) {
+                ctx->failed = 1;
+            }
+            bench_do_not_optimize(&m.cycles_per_iteration);
+        }
+    }
+}
+
+static void asm_text_kernel(void *arg, uint64_t iterations) {
+    asm_ctx_t *ctx = (asm_ctx_t *)arg;
+    for (uint64_t iter = 0; iter < iterations; iter++) {
+        cpu_asm_t a;
+        cpu_asm_init(&a, CPU_RESET_PC);
+        if (cpu_asm_source(&a, ctx->text, ctx->length) != 0 || cpu_asm_finish(&a) != 0 ||
+            a.count != ASM_BENCH_INSTRUCTIONS) {
+            ctx->failed = 1;
+        }
+        bench_do_not_optimize(a.words);
+        cpu_asm_free(&a);
+    }
+}
+
+// The emitter program as source text
+static char *asm_bench_source(size_t *length) {
+    size_t capacity = (size_t)ASM_BENCH_LOOPS * 200, n = 0;
+    char *text = malloc(capacity);
+
+    if (!text) {
+        return NULL;
+    }
+    for (unsigned i = 0; i < ASM_BENCH_LOOPS; i++) {
+        n += (size_t)snprintf(text + n, capacity - n,
+                              "loop_%u:\n"
+                              "    ADDI R2, R2, #%u\n"
+                              "    MUL R3, R2, R4\n"
+                              "    XOR R5, R3, R2\n"
+                              "    SHLI R6, R5, #3\n"
+                              "    LOAD R7, [R8 + #16]\n"
+                              "    STORE R6, [R8 + #24]    ; spill\n"
+                              "    SUBI R1, R1, #1\n"
+                              "    BNZ R1, loop_%u\n",
+                              i, i & 0x7FFF, i);
+    }
+    *length = n;
+    return text;
+}
+
+static void benchmark_assembler(void) {
+    asm_ctx_t ctx;
+    bench_result_t r;
+
+    memset(&ctx, 0, sizeof(ctx));
+    if (run_benchmark_result("Asm emitters", asm_emit_kernel, &ctx, ASM_BENCH_INSTRUCTIONS,
+                             &r) == 0) {
+        if (ctx.failed) {
+            printf("%-30s: assembly failed\n", r.name);
+        } else {
+            record_result(&r);
+        }
+    }
+    // The program the emitters built, even when their benchmark was filtered out
+    if ((bench_filter_match(&bench_filter, "Disasm lines") ||
+         bench_filter_match(&bench_filter, "MCA loops")) && !list_only && !ctx.words) {
+        asm_emit_kernel(&ctx, 1);
+    }
+    if (bench_filter_match(&bench_filter, "Disasm lines") && (list_only || ctx.words) &&
+        run_benchmark_result("Disasm lines", disasm_kernel, &ctx, ASM_BENCH_INSTRUCTIONS,
+                             &r) == 0) {
+        record_result(&r);
+    }
+    if (bench_filter_match(&bench_filter, "MCA loops") && (list_only || ctx.words) &&
+        run_benchmark_result("MCA loops", mca_kernel, &ctx, ASM_BENCH_LOOPS, &r) == 0) {
+        if (ctx.failed) {
+            printf("%-30s: analysis failed\n", r.name);
+        } else {
+            record_result(&r);
+        }
+    }
+    free(ctx.words);
+    if (!bench_filter_match(&bench_filter, "Asm text") ||
+        (!list_only && !(ctx.text = asm_bench_source(&ctx.length)))) {
+        return;
+    }
+    if (run_benchmark_result("Asm text", asm_text_kernel, &ctx, ASM_BENCH_INSTRUCTIONS, &r) == 0) {
+        if (ctx.failed) {
+            printf("%-30s: assembly failed\n", r.name);
+        } else {
+            record_result(&r);
+        }
+    }
+    free(ctx.text);
+}
+
+// Every kernel under every engine, then guest MIPS per kernel and engine,
+// then the assembler, disassembler and static analyzer
+void benchmark_simulator(void) {
+    double ns[GUEST_KERNELS][CPU_MODES];
+    uint64_t retired[GUEST_KERNELS];
+    char name[BENCH_NAME_MAX];
+    sim_ctx_t ctx;
+    bench_result_t r;
+
+    memset(ns, 0, sizeof(ns));
+    memset(retired, 0, sizeof(retired));
+    for (int k = 0; k < GUEST_KERNELS; k++) {
+        const guest_kernel_t *kernel = &guest_kernels[k];
+
+        ctx.kernel = kernel;
+        ctx.cpu = guest_kernel_create(kernel);
+        if (!ctx.cpu) {
+            printf("Sim %s: cannot load kernel\n", kernel->name);
+            continue;
+        }
+        // Instructions per run, the same under every engine
+        if (!list_only) {
+            if (guest_kernel_run(ctx.cpu, kernel, CPU_MODE_SWITCH) != 0) {
+                printf("Sim %s: guest did not halt\n", kernel->name);
+                cpu_destroy(ctx.cpu);
+                continue;
+            }
+            retired[k] = cpu_retired(ctx.cpu);
+        }
+        for (int m = 0; m < CPU_MODES; m++) {
+            snprintf(name, sizeof(name), "Sim %s/%s", kernel->name, cpu_mode_names[m]);
+            ctx.mode = (cpu_mode_t)m;
+            ctx.failed = 0;
+            if (run_benchmark_result(name, sim_kernel, &ctx, (double)retired[k], &r) != 0) {
+                continue;
+            }
+            if (ctx.failed) {
+                printf("%-30s: guest did not halt\n", name);
+                continue;
+            }
+            record_result(&r);
+            ns[k][m] = r.median_ns;
+        }
+        cpu_destroy(ctx.cpu);
+    }
+    if (list_only) {
+        benchmark_assembler();
+        return;
+    }
+
+    printf("\nSimulator throughput (guest MIPS, host ns per guest instruction)\n\n");
+    printf("| Kernel | Instructions/run |");
+    for (int m = 0; m < CPU_MODES; m++) {
+        printf(" %s |", cpu_mode_names[m]);
+    }
+    printf("\n|--------|------------------|");
+    for (int m = 0; m < CPU_MODES; m++) {
+        printf("------|");
+    }
+    printf("\n");
+    for (int k = 0; k < GUEST_KERNELS; k++) {
+        if (retired[k] == 0) {
+            continue;
+        }
+        printf("| %s | %lu |", guest_kernels[k].name, (unsigned long)retired[k]);
+        for (int m = 0; m < CPU_MODES; m++) {
+            if (ns[k][m] > 0.0) {
+                printf(" %.1f MIPS (%.2f ns) |", 1e3 / ns[k][m], ns[k][m]);
+            } else {
+                printf(" - |");
+            }
+        }
+        printf("\n");
+    }
+    printf("\n");
+    sim_fusion_report();
+    benchmark_assembler();
+}
+
+// "1,2,4" or "max" (1, 2, 4, ... up to the default thread count). Returns the
+// number of counts parsed, 0 on error.
+static int parse_thread_counts(const char *arg, int *counts, int max_counts) {
+    int n = 0;
+
+    if (strcmp(arg, "max") == 0) {
+        int limit = parallel_default_threads();
+        for (int t = 1; n < max_counts; t *= 2) {
+            counts[n++] = t < limit ? t : limit;
+            if (t >= limit) {
+                break;
+            }
+        }
+        return n;
+    }
+    while (*arg && n < max_counts) {
+        char *end;
+        long t = strtol(arg, &end, 10);
+        if (end == arg || t < 1 || t > PARALLEL_MAX_THREADS) {
+            return 0;
+        }
+        counts[n++] = (int)t;
+        arg = *end == ',' ? end + 1 : end;
+        if (*end && *end != ',') {
+            return 0;
+        }
+    }
+    return n;
 }
 
 // Main benchmark runner
-int main() {
-    printf("AlphaAHB V5 ISA Performance Benchmarks\n");
-    printf("======================================\n");
-    
-    // Initialize random seed
-    srand(time(NULL));
-    
+int main(int argc, char **argv) {
+    const char *json_path = NULL;
+    const char *csv_path = NULL;
+    const char *substring = NULL;
+    const char *pattern = NULL;
+    int sweep = 0;
+    int memory = 0;
+    int simulator = 0;
+    uint64_t memory_max = MEMORY_MAX_BYTES;
+    int threads_given = 0;
+    int counters = 1;
+    uint64_t min_bytes = SWEEP_MIN_BYTES;
+    uint64_t max_bytes = SWEEP_MAX_BYTES;
+    int thread_counts[PARALLEL_MAX_THREADS] = { 1 };
+    int num_thread_counts = 1;
+    bench_host_t host;
+
+    bench_config = bench_default_config();
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            csv_path = argv[++i];
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            substring = argv[++i];
+        } else if (strcmp(argv[i], "--regex") == 0 && i + 1 < argc) {
+            pattern = argv[++i];
+        } else if (strcmp(argv[i], "--list") == 0) {
+            list_only = 1;
+        } else if (strcmp(argv[i], "--sweep") == 0) {
+            sweep = 1;
+        } else if (strcmp(argv[i], "--memory") == 0) {
+            memory = 1;
+        } else if (strcmp(argv[i], "--simulator") == 0) {
+            simulator = 1;
+        } else if (strcmp(argv[i], "--memory-max") == 0 && i + 1 < argc) {
+            memory_max = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--min-size") == 0 && i + 1 < argc) {
+            min_bytes = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--max-size") == 0 && i + 1 < argc) {
+            max_bytes = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            num_thread_counts = parse_thread_counts(argv[++i], thread_counts,
+                                                    PARALLEL_MAX_THREADS);
+            if (num_thread_counts == 0) {
+                printf("Invalid thread list: %s\n", argv[i]);
+                return 1;
+            }
+            threads_given = 1;
+        } else if (strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) {
+            bench_config.repetitions = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            bench_config.min_sample_ns = (int64_t)(atof(argv[++i]) * 1e6);
+        } else if (strcmp(argv[i], "--no-counters") == 0) {
+            counters = 0;
+        } else {
+            usage(argv[0]);
+            return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+    if (bench_config.repetitions < 1 || bench_config.repetitions > BENCH_MAX_REPETITIONS) {
+        printf("--repetitions must be between 1 and %d\n", BENCH_MAX_REPETITIONS);
+        return 1;
+    }
+    if (bench_filter_init(&bench_filter, substring, pattern) != 0) {
+        printf("Invalid regular expression: %s\n", pattern);
+        return 1;
+    }
+    srand(BENCHMARK_SEED);
+    if (!list_only) {
+        printf("AlphaAHB V5 ISA Performance Benchmarks\n");
+        printf("======================================\n");
+
+        bench_host_info(&host);
+        printf("Host: %s, %.0f MHz, %ld CPUs\n", host.cpu_model, host.cpu_mhz,
+               host.logical_cpus);
+        printf("Build: %s [%s], revision %s\n", host.compiler, host.cflags, host.git_sha);
+        printf("%d samples of >= %.0f ms after %d warmup samples, outliers beyond "
+               "modified z-score %.1f rejected\n\n", bench_config.repetitions,
+               bench_config.min_sample_ns * 1e-6, bench_config.warmup, BENCH_OUTLIER_Z);
+        if (counters) {
+            bench_counters_open(&bench_counters);
+            bench_config.counters = &bench_counters;
+            printf("Hardware counters: %s\n\n", bench_counters.status);
+        }
+        bench_print_header();
+    }
+
     // Integer arithmetic benchmarks
-    benchmark_add();
-    benchmark_mul();
-    benchmark_div();
-    
+    benchmark_integer();
+
     // Floating-point benchmarks
-    benchmark_fadd();
-    benchmark_fmul();
-    benchmark_fdiv();
-    benchmark_fsqrt();
-    
+    benchmark_floating_point();
+
     // Vector benchmarks
-    benchmark_vector_add();
-    benchmark_vector_mul();
-    
+    benchmark_vector();
+
     // AI/ML benchmarks
     benchmark_convolution();
     benchmark_matrix_multiply();
     benchmark_relu();
-    
+
     // Memory benchmarks
-    benchmark_memory_copy();
-    benchmark_memory_set();
-    benchmark_cache_read();
-    benchmark_cache_write();
-    
+    benchmark_memory();
+    benchmark_cache();
+
     // Branch prediction benchmarks
     benchmark_branch_prediction();
-    
-    // MIMD benchmarks
-    benchmark_barrier();
-    benchmark_atomic();
-    
+
+    // MIMD contention curves: 1, 2, 4, ... up to the CPU count and at least
+    // two threads, unless --threads says otherwise
+    int mimd_threads[PARALLEL_MAX_THREADS];
+    int num_mimd_threads = parse_thread_counts("max", mimd_threads, PARALLEL_MAX_THREADS);
+    if (mimd_threads[num_mimd_threads - 1] < 2) {
+        mimd_threads[num_mimd_threads++] = 2;
+    }
+    benchmark_mimd(threads_given ? thread_counts : mimd_threads,
+                   threads_given ? num_thread_counts : num_mimd_threads);
+
+    // Throughput-vs-size curves
+    if (sweep) {
+        benchmark_sweeps(min_bytes, max_bytes, thread_counts, num_thread_counts);
+    }
+    // Latency, bandwidth per level and TLB cost; one and all threads unless
+    // --threads says otherwise
+    if (memory) {
+        int memory_threads[2] = { 1, parallel_default_threads() };
+        int num_memory_threads = memory_threads[1] > 1 ? 2 : 1;
+        benchmark_memory_hierarchy(memory_max,
+                                   threads_given ? thread_counts : memory_threads,
+                                   threads_given ? num_thread_counts : num_memory_threads,
+                                   list_only ? 0.0 : host.cpu_mhz);
+    }
+    // Guest MIPS of the simulator engines
+    if (simulator) {
+        benchmark_simulator();
+    }
+    if (list_only) {
+        bench_filter_free(&bench_filter);
+        return 0;
+    }
+
+    int status = 0;
+    if (json_path && bench_write_json(json_path, &host, &bench_config, &bench_results) != 0) {
+        printf("Cannot write %s\n", json_path);
+        status = 1;
+    }
+    if (csv_path && bench_write_csv(csv_path, &host, &bench_results) != 0) {
+        printf("Cannot write %s\n", csv_path);
+        status = 1;
+    }
+    bench_results_free(&bench_results);
+    bench_filter_free(&bench_filter);
+    if (bench_config.counters) {
+        bench_counters_close(&bench_counters);
+    }
+
     printf("\n=== Benchmark Summary ===\n");
     printf("All benchmarks completed successfully!\n");
-    
-    return 0;
+
+    return status;
 }
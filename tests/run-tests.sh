@@ -9,7 +9,7 @@ echo "================================="
 # Set compiler flags
 CC=gcc
 CFLAGS="-Wall -Wextra -O2 -std=c99"
-LDFLAGS="-lm"
+LDFLAGS="-lm -pthread"
 
 # Test directories
 TEST_DIR="tests"
@@ -109,6 +109,43 @@ fi
 
 echo ""
 
+# Run analytics kernel tests
+echo "=== Analytics Kernel Tests ==="
+run_test "Analytics Kernel Tests" "$TEST_DIR/analytics-tests.c" "analytics-tests"
+if [ $? -eq 0 ]; then
+    ((passed_tests++))
+else
+    ((failed_tests++))
+fi
+((total_tests++))
+
+echo ""
+
+# Run workload kernel tests
+echo "=== Workload Kernel Tests ==="
+run_test "Workload Kernel Tests" "$TEST_DIR/workload-tests.c" "workload-tests"
+if [ $? -eq 0 ]; then
+    ((passed_tests++))
+else
+    ((failed_tests++))
+fi
+((total_tests++))
+
+echo ""
+
+# Run simulation engine ABI tests (the engine is compiled in)
+echo "=== Simulation Engine ABI Tests ==="
+run_test "Simulation Engine ABI Tests" \
+    "$TEST_DIR/engine-tests.c tooling/simulator/alphaahb_engine.c" "engine-tests"
+if [ $? -eq 0 ]; then
+    ((passed_tests++))
+else
+    ((failed_tests++))
+fi
+((total_tests++))
+
+echo ""
+
 # Run performance benchmarks
 echo "=== Performance Benchmarks ==="
 run_benchmark "Performance Benchmarks" "$TEST_DIR/performance-benchmarks.c" "performance-benchmarks"
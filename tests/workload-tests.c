@@ -0,0 +1,1251 @@
+/*
+ * AlphaAHB V5 Workload Kernel Tests
+ *
+ * This file contains correctness tests for the kernels behind the
+ * application examples (physics, HPC, real-time control and the other
+ * workload engines), checking each optimized kernel against a plain scalar
+ * reference. The Makefile builds it with -fopenmp so the pooled parallel runtime is
+ * exercised here; the analytics tests cover the pthreads backend.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "../examples/physics-engine.h"
+#include "../examples/hpc-kernels.h"
+#include "../examples/realtime-harness.h"
+#include "../examples/pid-controller.h"
+#include "../examples/sync-primitives.h"
+#include "guest-kernels.h"
+#include "../examples/cpu-assembler.h"
+#include "../examples/cpu-disassembler.h"
+#include "../examples/cpu-analyzer.h"
+#include "../examples/cpu-profiler.h"
+
+// Test framework macros
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s\n", message); \
+            return 1; \
+        } \
+    } while (0)
+
+#define TEST_PASS(message) \
+    printf("PASS: %s\n", message)
+
+#define TEST_START(name) \
+    printf("\n=== Testing %s ===\n", name)
+
+// Deterministic test data (xorshift, independent of the libc rand())
+static unsigned int test_seed = 2463534242u;
+
+static float test_random_float(float scale) {
+    test_seed ^= test_seed << 13;
+    test_seed ^= test_seed >> 17;
+    test_seed ^= test_seed << 5;
+    return (float)(test_seed >> 8) / 16777216.0f * scale;
+}
+
+static void random_world(physics_world_t *w, float extent, float speed) {
+    for (size_t i = 0; i < w->count; i++) {
+        for (int a = 0; a < 3; a++) {
+            w->pos[a][i] = test_random_float(extent);
+            w->vel[a][i] = test_random_float(2.0f * speed) - speed;
+        }
+        w->mass[i] = 1.0f + test_random_float(9.0f);
+    }
+}
+
+int test_physics_integrators() {
+    TEST_START("SoA physics integrators");
+
+    const size_t n = 1000;  // Not a multiple of the block size
+    const float dt = 0.016f;
+    physics_world_t w;
+    TEST_ASSERT(physics_world_init(&w, n, 0.0f, 100.0f) == 0, "World allocation failed");
+    TEST_ASSERT(w.capacity % PHYSICS_LANES == 0 && w.capacity >= n, "Capacity not padded");
+    random_world(&w, 100.0f, 5.0f);
+
+    // Scalar reference with the original branchy bounce
+    float *ref = malloc(6 * n * sizeof(float));
+    for (size_t i = 0; i < n; i++) {
+        for (int a = 0; a < 3; a++) {
+            ref[6 * i + a] = w.pos[a][i];
+            ref[6 * i + 3 + a] = w.vel[a][i];
+        }
+    }
+    for (int frame = 0; frame < 500; frame++) {
+        physics_step_euler(&w, dt, 3);
+        for (size_t i = 0; i < n; i++) {
+            float *p = &ref[6 * i];
+            float *v = &ref[6 * i + 3];
+            for (int a = 0; a < 3; a++) {
+                p[a] += v[a] * dt;
+            }
+            v[1] -= 9.8f * dt;
+            for (int a = 0; a < 3; a++) {
+                if (p[a] < 0 || p[a] > 100) {
+                    v[a] *= -0.8f;
+                    p[a] = (p[a] < 0) ? 0 : 100;
+                }
+            }
+        }
+    }
+    for (size_t i = 0; i < n; i++) {
+        for (int a = 0; a < 3; a++) {
+            TEST_ASSERT(w.pos[a][i] == ref[6 * i + a], "Euler position differs from scalar");
+            TEST_ASSERT(w.vel[a][i] == ref[6 * i + 3 + a], "Euler velocity differs from scalar");
+        }
+    }
+    TEST_PASS("Branchless Euler matches the branchy scalar update");
+
+    // Verlet is exact for constant acceleration away from the walls
+    physics_world_t free_fall;
+    TEST_ASSERT(physics_world_init(&free_fall, 33, -1e6f, 1e6f) == 0, "World allocation failed");
+    for (size_t i = 0; i < free_fall.count; i++) {
+        free_fall.vel[0][i] = (float)i;
+        free_fall.vel[1][i] = 20.0f;
+        free_fall.pos[0][i] = 0.0f;
+        free_fall.pos[1][i] = 0.0f;
+    }
+    physics_verlet_prime(&free_fall, dt);
+    // Priming with x - v*dt starts the displacement half a step of gravity
+    // early: the trajectory is x0 + v0 t - g (t^2 + t dt) / 2
+    for (int frame = 0; frame < 100; frame++) {
+        physics_step_verlet(&free_fall, dt, 2);
+    }
+    double t = 100 * dt;
+    for (size_t i = 0; i < free_fall.count; i++) {
+        double x = (double)i * t;
+        double y = 20.0 * t - 0.5 * 9.8 * (t * t + t * dt);
+        TEST_ASSERT(fabs(free_fall.pos[0][i] - x) < 1e-3, "Verlet drifted along x");
+        TEST_ASSERT(fabs(free_fall.pos[1][i] - y) < 1e-3, "Verlet free fall inaccurate");
+    }
+    TEST_PASS("Verlet free fall");
+
+    // Bounces keep every entity inside the box and damp the motion
+    physics_verlet_prime(&w, dt);
+    for (int frame = 0; frame < 2000; frame++) {
+        physics_step_verlet(&w, dt, 4);
+    }
+    for (size_t i = 0; i < w.capacity; i++) {
+        for (int a = 0; a < 3; a++) {
+            TEST_ASSERT(w.pos[a][i] >= 0.0f && w.pos[a][i] <= 100.0f, "Entity escaped the box");
+        }
+    }
+    TEST_PASS("Verlet boundary reflection");
+
+    physics_world_free(&free_fall);
+    physics_world_free(&w);
+    free(ref);
+    return 0;
+}
+
+static int compare_pairs(const void *x, const void *y) {
+    const physics_pair_t *p = (const physics_pair_t *)x;
+    const physics_pair_t *q = (const physics_pair_t *)y;
+    if (p->a != q->a) {
+        return p->a < q->a ? -1 : 1;
+    }
+    return p->b < q->b ? -1 : (p->b > q->b);
+}
+
+int test_physics_broadphase() {
+    TEST_START("spatial-hash broadphase");
+
+    const size_t n = 3000;
+    const float radius = 0.4f;
+    physics_world_t w;
+    physics_broadphase_t bp;
+    TEST_ASSERT(physics_world_init(&w, n, 0.0f, 20.0f) == 0, "World allocation failed");
+    random_world(&w, 20.0f, 1.0f);
+    memset(&bp, 0, sizeof(bp));
+
+    // Brute-force reference
+    size_t expected = 0;
+    physics_pair_t *ref = malloc(n * 64 * sizeof(physics_pair_t));
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = i + 1; j < n; j++) {
+            float ex = w.pos[0][i] - w.pos[0][j];
+            float ey = w.pos[1][i] - w.pos[1][j];
+            float ez = w.pos[2][i] - w.pos[2][j];
+            if (ex * ex + ey * ey + ez * ez < 4.0f * radius * radius) {
+                ref[expected].a = (uint32_t)i;
+                ref[expected].b = (uint32_t)j;
+                expected++;
+            }
+        }
+    }
+    TEST_ASSERT(expected > 100, "Reference produced too few contacts");
+
+    TEST_ASSERT(physics_broadphase(&w, radius, 1, &bp) == 0, "Broadphase failed");
+    TEST_ASSERT(bp.count == expected, "Broadphase pair count differs from brute force");
+    physics_pair_t *found = malloc(bp.count * sizeof(physics_pair_t));
+    memcpy(found, bp.pairs, bp.count * sizeof(physics_pair_t));
+    qsort(found, bp.count, sizeof(physics_pair_t), compare_pairs);
+    TEST_ASSERT(memcmp(found, ref, expected * sizeof(physics_pair_t)) == 0,
+                "Broadphase pairs differ from brute force");
+    TEST_PASS("Pairs match brute force");
+
+    // Reusing the structure with more threads yields the same ordered list
+    memcpy(found, bp.pairs, bp.count * sizeof(physics_pair_t));
+    int thread_counts[] = { 2, 3, 8 };
+    for (size_t t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); t++) {
+        TEST_ASSERT(physics_broadphase(&w, radius, thread_counts[t], &bp) == 0,
+                    "Broadphase failed");
+        TEST_ASSERT(bp.count == expected &&
+                    memcmp(found, bp.pairs, bp.count * sizeof(physics_pair_t)) == 0,
+                    "Pair order depends on thread count");
+    }
+    TEST_PASS("Thread-count invariant pair order");
+    physics_world_free(&w);
+
+    // Entities on and just below cell boundaries: the query cube of the one
+    // at 0.5 - 2^-25 rounds out to 3 cells per axis
+    static const float edges[] = { 0.5f - 0x1p-25f, 0.5f, 1.0f - 0x1p-24f, 1.0f, 0.25f, 0.75f };
+    const size_t m = 200;
+    TEST_ASSERT(physics_world_init(&w, m, 0.0f, 2.0f) == 0, "World allocation failed");
+    for (size_t i = 0; i < m; i++) {
+        for (int a = 0; a < 3; a++) {
+            w.pos[a][i] = i == 0 ? edges[0] : edges[(int)test_random_float(6.0f) % 6];
+        }
+    }
+    expected = 0;
+    for (size_t i = 0; i < m; i++) {
+        for (size_t j = i + 1; j < m; j++) {
+            float ex = w.pos[0][i] - w.pos[0][j];
+            float ey = w.pos[1][i] - w.pos[1][j];
+            float ez = w.pos[2][i] - w.pos[2][j];
+            if (ex * ex + ey * ey + ez * ez < 4.0f * 0.25f * 0.25f) {
+                ref[expected].a = (uint32_t)i;
+                ref[expected].b = (uint32_t)j;
+                expected++;
+            }
+        }
+    }
+    TEST_ASSERT(physics_broadphase(&w, 0.25f, 1, &bp) == 0 && bp.count == expected,
+                "Boundary pair count differs from brute force");
+    found = realloc(found, (bp.count + 1) * sizeof(physics_pair_t));
+    TEST_ASSERT(found, "Pair copy allocation failed");
+    memcpy(found, bp.pairs, bp.count * sizeof(physics_pair_t));
+    qsort(found, bp.count, sizeof(physics_pair_t), compare_pairs);
+    TEST_ASSERT(memcmp(found, ref, expected * sizeof(physics_pair_t)) == 0,
+                "Boundary pairs differ from brute force");
+    TEST_PASS("Entities on cell boundaries");
+
+    physics_broadphase_free(&bp);
+    physics_world_free(&w);
+    free(found);
+    free(ref);
+    return 0;
+}
+
+int test_hpc_iterated_map() {
+    TEST_START("vectorized iterated map");
+
+    const size_t n = 10007;  // Tail shorter than one lane block
+    float *in = malloc(n * sizeof(float));
+    float *ref = malloc(n * sizeof(float));
+    float *out = malloc(n * sizeof(float));
+    for (size_t i = 0; i < n; i++) {
+        // Mix converging (|x| < 0.5) and diverging inputs
+        in[i] = (i % 3) ? test_random_float(1.0f) - 0.5f : test_random_float(100.0f);
+    }
+
+    float constants[] = { 0.25f, -1.0f, 0.1f };
+    for (size_t k = 0; k < sizeof(constants) / sizeof(constants[0]); k++) {
+        hpc_iterate_map_scalar(in, ref, n, constants[k], 100);
+        hpc_iterate_map_lanes(in, out, n, constants[k], 100);
+        TEST_ASSERT(memcmp(ref, out, n * sizeof(float)) == 0, "Lane map differs from scalar");
+        for (int threads = 1; threads <= 8; threads++) {
+            memset(out, 0, n * sizeof(float));
+            hpc_iterate_map(in, out, n, constants[k], 100, threads);
+            TEST_ASSERT(memcmp(ref, out, n * sizeof(float)) == 0,
+                        "Parallel map differs from scalar");
+        }
+    }
+    TEST_PASS("Bit-identical to the scalar recurrence for 1 to 8 threads");
+
+    hpc_scaling_point_t points[HPC_SCALING_POINTS];
+    int count = hpc_scaling_report(in, out, n, 0.25f, 10, 64, 1, points);
+    TEST_ASSERT(count == 7 && points[0].threads == 1 && points[6].threads == 64,
+                "Scaling report thread counts wrong");
+    TEST_ASSERT(points[0].speedup == 1.0 && points[3].efficiency > 0.0,
+                "Scaling report fields wrong");
+    count = hpc_scaling_report(in, out, n, 0.25f, 10, 6, 1, points);
+    TEST_ASSERT(count == 4 && points[3].threads == 6, "Scaling report misses the last count");
+    TEST_PASS("Scaling report covers 1 to N threads");
+
+    free(in);
+    free(ref);
+    free(out);
+    return 0;
+}
+
+int test_hdr_histogram() {
+    TEST_START("HDR latency histogram");
+
+    rt_histogram_t *h = malloc(sizeof(rt_histogram_t));
+    rt_histogram_init(h);
+
+    // Small values are exact
+    for (uint64_t v = 0; v < 2 * RT_HIST_HALF; v++) {
+        TEST_ASSERT(rt_histogram_upper(rt_histogram_index(v)) == v, "Small value not exact");
+    }
+    // Bucket edges are contiguous and keep the relative error bound
+    for (uint32_t i = 1; i < RT_HIST_BUCKETS; i++) {
+        uint64_t lower = rt_histogram_upper(i - 1) + 1;
+        TEST_ASSERT(rt_histogram_index(lower) == i, "Bucket edges not contiguous");
+        TEST_ASSERT((double)(rt_histogram_upper(i) - lower) <= lower / (double)RT_HIST_HALF,
+                    "Bucket wider than the precision bound");
+    }
+    TEST_PASS("Exact small values, contiguous log-linear buckets");
+
+    // Uniform 1..100000 ns: percentiles within 1%, never understated
+    for (uint64_t v = 1; v <= 100000; v++) {
+        rt_histogram_record(h, v);
+    }
+    double ps[] = { 50.0, 99.0, 99.9 };
+    for (size_t i = 0; i < sizeof(ps) / sizeof(ps[0]); i++) {
+        double exact = ps[i] * 1000.0;
+        double got = (double)rt_histogram_percentile(h, ps[i]);
+        TEST_ASSERT(got >= exact && got <= exact * 1.01, "Percentile outside 1%");
+    }
+    TEST_ASSERT(rt_histogram_percentile(h, 100.0) == 100000 && h->min == 1, "Min/max not exact");
+    TEST_ASSERT(fabs(rt_histogram_mean(h) - 50000.5) < 1e-6, "Mean wrong");
+    TEST_PASS("Percentiles within 1%, exact min/max");
+
+    free(h);
+    return 0;
+}
+
+static void busy_wait_ns(int64_t ns) {
+    int64_t end = rt_now_ns() + ns;
+    while (rt_now_ns() < end) {
+    }
+}
+
+typedef struct {
+    long calls;
+    long period_ns;
+} overrun_body_t;
+
+// Overruns by two and a half periods on every 10th cycle
+static void overrun_cycle(long cycle, void *ctx) {
+    overrun_body_t *body = (overrun_body_t *)ctx;
+    body->calls++;
+    if (cycle >= 0 && cycle % 10 == 9) {
+        busy_wait_ns(body->period_ns * 5 / 2);
+    }
+}
+
+int test_realtime_harness() {
+    TEST_START("real-time harness");
+
+    rt_report_t *report = malloc(sizeof(rt_report_t));
+    overrun_body_t body = { 0, 2000000 };
+    rt_config_t config = { body.period_ns, 40, 0, 0 };
+
+    int64_t start = rt_now_ns();
+    TEST_ASSERT(rt_run(&config, overrun_cycle, &body, report) == 0, "Harness failed");
+    int64_t elapsed = rt_now_ns() - start;
+
+    TEST_ASSERT(report->cycles == 40 && body.calls == 41, "Cycle count wrong");
+    TEST_ASSERT(report->latency.total == 40 && report->execution.total == 40,
+                "Histograms missed cycles");
+    // Every forced overrun misses and skips two or three releases; scheduling
+    // noise on a loaded host can only add misses, each skipping at least one
+    TEST_ASSERT(report->deadline_misses >= 4, "Overruns not counted as misses");
+    TEST_ASSERT(report->skipped_releases >= 4 + report->deadline_misses,
+                "Skipped releases wrong");
+    // 40 run cycles plus the skipped releases, each one period apart
+    TEST_ASSERT(elapsed >= (40 + report->skipped_releases) * config.period_ns,
+                "Releases not on absolute deadlines");
+    TEST_ASSERT(rt_histogram_percentile(&report->execution, 100.0) >=
+                (uint64_t)(body.period_ns * 5 / 2), "Execution max wrong");
+    TEST_PASS("Absolute releases, deadline misses and skipped releases");
+
+    config.period_ns = 0;
+    TEST_ASSERT(rt_run(&config, overrun_cycle, &body, report) == -1, "Bad period accepted");
+    TEST_PASS("Configuration validation");
+
+    free(report);
+    return 0;
+}
+
+// Per-channel reference with the same operation order as pid_update_f32
+static float pid_reference(float kp, float ki_dt, float kd_dt, float lo, float hi,
+                           float *integral, float *prev, float sp, float pv) {
+    float e = sp - pv;
+    float candidate = *integral + ki_dt * e;
+    float u = kp * e + candidate + kd_dt * (e - *prev);
+    int hold = (u > hi && e > 0.0f) || (u < lo && e < 0.0f);
+    *integral = hold ? *integral : candidate;
+    *prev = e;
+    return u > hi ? hi : (u < lo ? lo : u);
+}
+
+int test_pid_controller() {
+    TEST_START("batched PID controller");
+
+    const size_t n = 37;    // Not a multiple of PID_LANES
+    const float dt = 0.001f;
+    pid_bank_f32_t bank;
+    pid_bank_q16_t bank_q;
+    TEST_ASSERT(pid_bank_f32_init(&bank, n, 0.5f, 0.1f, 0.05f, dt, -1.0f, 1.0f) == 0,
+                "Float bank allocation failed");
+    TEST_ASSERT(pid_bank_q16_init(&bank_q, n, 0.5, 0.1, 0.05, dt, -1.0, 1.0) == 0,
+                "Fixed-point bank allocation failed");
+    TEST_ASSERT(bank.capacity == 48 && ((uintptr_t)bank.integral % PID_ALIGN) == 0,
+                "Bank not padded and aligned");
+
+    float sp[48] = { 0 }, pv[48] = { 0 }, out[48], ref_i[48] = { 0 }, ref_p[48] = { 0 };
+    int32_t sp_q[48] = { 0 }, pv_q[48] = { 0 }, out_q[48];
+    int mismatches = 0, unclamped = 0;
+    double max_q_error = 0.0;
+
+    for (int tick = 0; tick < 500; tick++) {
+        for (size_t c = 0; c < n; c++) {
+            // Mostly small errors, with bursts that drive the output into saturation
+            sp[c] = test_random_float(tick % 100 < 20 ? 8.0f : 0.5f);
+            pv[c] = test_random_float(0.5f);
+            sp_q[c] = pid_to_q(sp[c], PID_Q);
+            pv_q[c] = pid_to_q(pv[c], PID_Q);
+        }
+        pid_update_f32(&bank, sp, pv, out);
+        pid_update_q16(&bank_q, sp_q, pv_q, out_q);
+        for (size_t c = 0; c < n; c++) {
+            float ref = pid_reference(bank.kp[c], bank.ki_dt[c], bank.kd_dt[c],
+                                      bank.out_min[c], bank.out_max[c], &ref_i[c], &ref_p[c],
+                                      sp[c], pv[c]);
+            mismatches += fabsf(out[c] - ref) > 1e-6f || fabsf(bank.integral[c] - ref_i[c]) > 1e-6f;
+            unclamped += out[c] < -1.0f || out[c] > 1.0f;
+            double q_error = fabs(pid_from_q(out_q[c], PID_Q) - out[c]);
+            max_q_error = q_error > max_q_error ? q_error : max_q_error;
+        }
+    }
+    TEST_ASSERT(mismatches == 0, "Batched update differs from scalar reference");
+    TEST_PASS("Batched update matches the scalar reference");
+    TEST_ASSERT(unclamped == 0, "Output outside limits");
+    TEST_PASS("Output clamped to limits");
+    // kd / dt = 50 amplifies the 2^-16 input quantization of the error
+    TEST_ASSERT(max_q_error < 2e-3, "Fixed-point output diverges from float");
+    TEST_PASS("Q16.16 variant tracks the float controller");
+
+    // Held error far beyond the limit: the integrator must not wind up, so the
+    // output follows a reversal on the very next tick
+    pid_bank_f32_free(&bank);
+    TEST_ASSERT(pid_bank_f32_init(&bank, 1, 0.5f, 10.0f, 0.0f, dt, -1.0f, 1.0f) == 0,
+                "Float bank allocation failed");
+    float sp1[PID_LANES] = { 10.0f }, pv1[PID_LANES] = { 0.0f }, out1[PID_LANES];
+    for (int tick = 0; tick < 1000; tick++) {
+        pid_update_f32(&bank, sp1, pv1, out1);
+    }
+    TEST_ASSERT(out1[0] == 1.0f && bank.integral[0] == 0.0f, "Integrator wound up");
+    sp1[0] = -10.0f;
+    pid_update_f32(&bank, sp1, pv1, out1);
+    TEST_ASSERT(out1[0] == -1.0f, "Output lagged the reversal");
+    TEST_PASS("Anti-windup holds the integrator while saturated");
+
+    // Saturated high with an error of the opposite sign: the integrator unwinds
+    bank.integral[0] = 3.0f;
+    sp1[0] = -0.1f;
+    pid_update_f32(&bank, sp1, pv1, out1);
+    TEST_ASSERT(out1[0] == 1.0f && bank.integral[0] < 3.0f, "Integrator did not unwind");
+    TEST_PASS("Integrator unwinds when the error reverses");
+
+    pid_bank_f32_free(&bank);
+    pid_bank_q16_free(&bank_q);
+    return 0;
+}
+
+// Shared state of the synchronization tests
+typedef struct {
+    sync_barrier_t barrier;
+    sync_lock_t lock;
+    sync_spsc_queue_t spsc;
+    sync_mpmc_queue_t mpmc;
+    int rounds;
+    uint64_t arrivals;
+    uint64_t protected_count;
+    uint64_t consumed_sum;
+    int errors;
+} sync_test_t;
+
+// Nobody may leave round r before everyone arrived in it, nor arrive twice
+// ahead of the slowest thread
+static void sync_test_barrier_worker(int tid, int threads, void *arg) {
+    sync_test_t *t = (sync_test_t *)arg;
+    for (int r = 0; r < t->rounds; r++) {
+        __atomic_fetch_add(&t->arrivals, 1, __ATOMIC_RELAXED);
+        sync_barrier_wait(&t->barrier, tid);
+        uint64_t seen = __atomic_load_n(&t->arrivals, __ATOMIC_RELAXED);
+        if (seen < (uint64_t)(r + 1) * threads || seen >= (uint64_t)(r + 2) * threads) {
+            __atomic_fetch_add(&t->errors, 1, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static void sync_test_lock_worker(int tid, int threads, void *arg) {
+    sync_test_t *t = (sync_test_t *)arg;
+    (void)tid;
+    (void)threads;
+    for (int r = 0; r < t->rounds; r++) {
+        sync_lock_acquire(&t->lock);
+        t->protected_count++;
+        sync_lock_release(&t->lock);
+    }
+}
+
+// Worker 0 sends 0..rounds-1, worker 1 checks they arrive in order
+static void sync_test_spsc_worker(int tid, int threads, void *arg) {
+    sync_test_t *t = (sync_test_t *)arg;
+    (void)threads;
+    for (int r = 0; r < t->rounds; r++) {
+        unsigned spins = 0;
+        uint64_t item;
+        if (tid == 0) {
+            while (sync_spsc_push(&t->spsc, (uint64_t)r) != 0) {
+                sync_backoff(&spins);
+            }
+        } else {
+            while (sync_spsc_pop(&t->spsc, &item) != 0) {
+                sync_backoff(&spins);
+            }
+            t->errors += item != (uint64_t)r;
+        }
+    }
+}
+
+// Producers send 1..rounds each, consumers add up what they receive
+static void sync_test_mpmc_worker(int tid, int threads, void *arg) {
+    sync_test_t *t = (sync_test_t *)arg;
+    uint64_t sum = 0;
+    for (int r = 1; r <= t->rounds; r++) {
+        unsigned spins = 0;
+        uint64_t item;
+        if (tid < threads / 2) {
+            while (sync_mpmc_push(&t->mpmc, (uint64_t)r) != 0) {
+                sync_backoff(&spins);
+            }
+        } else {
+            while (sync_mpmc_pop(&t->mpmc, &item) != 0) {
+                sync_backoff(&spins);
+            }
+            sum += item;
+        }
+    }
+    __atomic_fetch_add(&t->consumed_sum, sum, __ATOMIC_RELAXED);
+}
+
+int test_sync_primitives() {
+    TEST_START("synchronization primitives");
+
+    const int threads = 4;
+    sync_test_t t;
+    char message[96];
+
+    for (int k = 0; k < SYNC_BARRIER_KINDS; k++) {
+        memset(&t, 0, sizeof(t));
+        if (sync_barrier_init(&t.barrier, (sync_barrier_kind_t)k, threads) != 0) {
+            printf("SKIP: %s barrier not available\n", sync_barrier_names[k]);
+            continue;
+        }
+        t.rounds = 200;
+        TEST_ASSERT(sync_run_team(threads, sync_test_barrier_worker, &t) == 0,
+                    "Team did not start");
+        sync_barrier_destroy(&t.barrier);
+        snprintf(message, sizeof(message), "%s barrier let a thread through early",
+                 sync_barrier_names[k]);
+        TEST_ASSERT(t.errors == 0 && t.arrivals == (uint64_t)threads * 200, message);
+    }
+    TEST_PASS("Barriers hold every thread until all arrive");
+
+    for (int k = 0; k < SYNC_LOCK_KINDS; k++) {
+        memset(&t, 0, sizeof(t));
+        TEST_ASSERT(sync_lock_init(&t.lock, (sync_lock_kind_t)k) == 0, "Lock init failed");
+        t.rounds = 2000;
+        TEST_ASSERT(sync_run_team(threads, sync_test_lock_worker, &t) == 0,
+                    "Team did not start");
+        sync_lock_destroy(&t.lock);
+        snprintf(message, sizeof(message), "%s lock lost updates", sync_lock_names[k]);
+        TEST_ASSERT(t.protected_count == (uint64_t)threads * 2000, message);
+    }
+    TEST_PASS("Locks are mutually exclusive");
+
+    memset(&t, 0, sizeof(t));
+    TEST_ASSERT(sync_spsc_init(&t.spsc, 12) != 0, "Non power-of-two capacity accepted");
+    TEST_ASSERT(sync_spsc_init(&t.spsc, 16) == 0, "SPSC init failed");
+    t.rounds = 10000;
+    TEST_ASSERT(sync_run_team(2, sync_test_spsc_worker, &t) == 0, "Team did not start");
+    sync_spsc_destroy(&t.spsc);
+    TEST_ASSERT(t.errors == 0, "SPSC queue reordered or lost items");
+    TEST_PASS("SPSC queue delivers in order");
+
+    memset(&t, 0, sizeof(t));
+    TEST_ASSERT(sync_mpmc_init(&t.mpmc, 16) == 0, "MPMC init failed");
+    t.rounds = 5000;
+    TEST_ASSERT(sync_run_team(threads, sync_test_mpmc_worker, &t) == 0, "Team did not start");
+    sync_mpmc_destroy(&t.mpmc);
+    TEST_ASSERT(t.consumed_sum == (uint64_t)(threads / 2) * 5000 * 5001 / 2,
+                "MPMC queue lost or duplicated items");
+    TEST_PASS("MPMC queue delivers every item exactly once");
+
+    return 0;
+}
+
+int test_simulator_engines() {
+    TEST_START("Simulator execution engines");
+    char message[128];
+
+    for (int k = 0; k < GUEST_KERNELS; k++) {
+        const guest_kernel_t *kernel = &guest_kernels[k];
+        cpu_system_t *ref = guest_kernel_create(kernel);
+        cpu_system_t *cpu = guest_kernel_create(kernel);
+        TEST_ASSERT(ref && cpu, "Guest system allocation failed");
+
+        snprintf(message, sizeof(message), "%s kernel did not halt", kernel->name);
+        TEST_ASSERT(guest_kernel_run(ref, kernel, CPU_MODE_SWITCH) == 0, message);
+        for (int m = CPU_MODE_THREADED; m < CPU_MODES; m++) {
+            snprintf(message, sizeof(message), "%s kernel did not halt in %s mode",
+                     kernel->name, cpu_mode_names[m]);
+            TEST_ASSERT(guest_kernel_run(cpu, kernel, (cpu_mode_t)m) == 0, message);
+            snprintf(message, sizeof(message), "%s kernel: %s mode differs from switch",
+                     kernel->name, cpu_mode_names[m]);
+            TEST_ASSERT(cpu_retired(cpu) == cpu_retired(ref), message);
+            for (int c = 0; c < ref->num_cores; c++) {
+                TEST_ASSERT(memcmp(&cpu->cores[c].regs, &ref->cores[c].regs,
+                                   sizeof(register_file_t)) == 0, message);
+            }
+            TEST_ASSERT(memcmp(cpu->memory, ref->memory, ref->memory_size) == 0, message);
+            if (m == CPU_MODE_BLOCK && CPU_HAVE_COMPUTED_GOTO) {
+                uint64_t fused = 0;
+                for (int f = 0; f < CPU_FUSED_COUNT; f++) {
+                    fused += cpu->fused_hits[f];
+                }
+                snprintf(message, sizeof(message), "%s kernel ran no superinstructions",
+                         kernel->name);
+                TEST_ASSERT(fused > 0, message);
+            }
+        }
+        if (kernel->cores > 1) {
+            uint64_t expected = (uint64_t)kernel->cores * GUEST_SYNC_ITERATIONS;
+            TEST_ASSERT(guest_sync_counter(ref, 0) == expected, "LOCK lost updates");
+            TEST_ASSERT(guest_sync_counter(ref, 1) == expected, "ATOMIC lost updates");
+        }
+        cpu_destroy(ref);
+        cpu_destroy(cpu);
+    }
+    TEST_PASS("Predecoded and translated engines match the switch interpreter");
+
+    // Self-modifying code: every 32 iterations the loop rewrites the
+    // immediate of its own first instruction, long after the block got hot
+    guest_program_t p = { { 0 }, 0 };
+    guest_li(&p, 1, 256);                                    // LI R1, #iterations
+    guest_li(&p, 6, cpu_encode_op(CPU_OPC_I, 0x0, 2, 2, 0, 1));  // LI R6, #"ADDI R2, R2, #1"
+    guest_li(&p, 7, 1ULL << 32);                             // LI R7, #(IMM += 1)
+    guest_li(&p, 5, CPU_RESET_PC + (p.count + 1) * CPU_INST_BYTES);  // LI R5, #patched
+    size_t loop = guest_op(&p, CPU_OPC_I, 0x0, 2, 2, 0, 0);  // patched: ADDI R2, R2, #0
+    guest_op(&p, CPU_OPC_I, 0x0, 3, 3, 0, 1);                // ADDI R3, R3, #1 (fused with it)
+    guest_op(&p, CPU_OPC_I, 0x4, 4, 1, 0, 31);               // ANDI R4, R1, #31
+    size_t skip = guest_op(&p, CPU_OPC_B, 0xB, 0, 4, 0, 0);  // BNZ R4, skip
+    guest_op(&p, CPU_OPC_S, 0x0, 0, 5, 6, 0);                // STORE R6, [R5]
+    guest_op(&p, CPU_OPC_R, 0x0, 6, 6, 7, 0);                // ADD R6, R6, R7
+    guest_patch(&p, skip, p.count);                          // skip:
+    guest_op(&p, CPU_OPC_I, 0x1, 1, 1, 0, 1);                // SUBI R1, R1, #1
+    guest_patch(&p, guest_op(&p, CPU_OPC_B, 0xB, 0, 1, 0, 0), loop);  // BNZ R1, loop
+    guest_op(&p, CPU_OPC_C, 0x1, 0, 0, 0, 0);                // HALT
+
+    for (int m = 0; m < CPU_MODES; m++) {
+        cpu_system_t *cpu = cpu_create(1, GUEST_MEMORY);
+        TEST_ASSERT(cpu && cpu_load_program(cpu, CPU_RESET_PC, p.words, p.count) == 0,
+                    "Guest system allocation failed");
+        snprintf(message, sizeof(message), "Stale code executed in %s mode", cpu_mode_names[m]);
+        TEST_ASSERT(cpu_run(cpu, (cpu_mode_t)m, UINT64_MAX) == 0 && cpu_halted(cpu), message);
+        // IMM 1..7 for 32 iterations each, then 8 for the last 31
+        TEST_ASSERT(cpu->cores[0].regs.gpr[2] == 32 * 28 + 8 * 31, message);
+        TEST_ASSERT(cpu->cores[0].regs.gpr[3] == 256, message);
+        if (m == CPU_MODE_JIT && CPU_HAVE_JIT) {
+            TEST_ASSERT(cpu->jit.translations > 0 && cpu->jit.flushes >= 8,
+                        "Hot blocks were not translated and invalidated");
+        }
+        cpu_destroy(cpu);
+    }
+    TEST_PASS("Stores into the text invalidate predecoded and translated code");
+
+    // MIMD stores rewrite the text too (a differential fuzz case): UNLOCK
+    // clears the two words after it across their boundary, and ATOMIC adds
+    // to a later one, so none of the three ADDIs runs as assembled
+    cpu_asm_t smc;
+    cpu_system_t *smc_ref = NULL;
+    cpu_asm_init(&smc, CPU_RESET_PC);
+    cpu_emit_li(&smc, 5, CPU_RESET_PC + 3 * CPU_INST_BYTES + 4 + 3);
+    cpu_emit_li(&smc, 6, 5);
+    cpu_emit_unlock(&smc, 5, -3);
+    cpu_emit_addi(&smc, 2, 2, 7);
+    cpu_emit_addi(&smc, 3, 3, 9);
+    cpu_emit_atomic(&smc, 4, 6, 5, 3 * CPU_INST_BYTES - 4 - 3);
+    cpu_emit_addi(&smc, 7, 7, 1);
+    cpu_emit_halt(&smc);
+    TEST_ASSERT(cpu_asm_finish(&smc) == 0, smc.error);
+    for (int m = 0; m < CPU_MODES; m++) {
+        cpu_system_t *cpu = cpu_create(1, GUEST_MEMORY);
+        TEST_ASSERT(cpu && cpu_load_program(cpu, CPU_RESET_PC, smc.words, smc.count) == 0,
+                    "Guest system allocation failed");
+        snprintf(message, sizeof(message), "Stale code after a MIMD store in %s mode",
+                 cpu_mode_names[m]);
+        TEST_ASSERT(cpu_run(cpu, (cpu_mode_t)m, UINT64_MAX) == 0 && cpu_halted(cpu), message);
+        TEST_ASSERT(cpu->cores[0].regs.gpr[2] == 0 && cpu->cores[0].regs.gpr[3] == 0 &&
+                    cpu->cores[0].regs.gpr[7] == 0, message);
+        if (smc_ref) {
+            TEST_ASSERT(memcmp(&cpu->cores[0].regs, &smc_ref->cores[0].regs,
+                               sizeof(register_file_t)) == 0, message);
+            cpu_destroy(cpu);
+        } else {
+            smc_ref = cpu;
+        }
+    }
+    cpu_destroy(smc_ref);
+    cpu_asm_free(&smc);
+    TEST_PASS("UNLOCK and ATOMIC stores into the text");
+
+    // Lazy flags: every ALU op only records itself, MFSR folds in Z/S/C/V
+    guest_program_t f = { { 0 }, 0 };
+    guest_li(&f, 1, 64);                                     // LI R1, #iterations
+    guest_li(&f, 2, 0x7FFFFFFFFFFFFFFFULL);                  // LI R2, #INT64_MAX
+    guest_li(&f, 3, 1);                                      // LI R3, #1
+    guest_li(&f, 4, ~0ULL);                                  // LI R4, #-1
+    guest_li(&f, 5, 3);                                      // LI R5, #3
+    loop = guest_op(&f, CPU_OPC_R, 0x0, 6, 2, 3, 0);         // ADD R6, R2, R3
+    guest_op(&f, CPU_OPC_C, 0x2, 10, 0, 0, CPU_SR_FLAGS);    // MFSR R10, FLAGS
+    guest_op(&f, CPU_OPC_R, 0xB, 0, 3, 5, 0);                // CMP R3, R5
+    guest_op(&f, CPU_OPC_C, 0x2, 11, 0, 0, CPU_SR_FLAGS);    // MFSR R11, FLAGS
+    guest_op(&f, CPU_OPC_R, 0x0, 6, 4, 3, 0);                // ADD R6, R4, R3
+    guest_op(&f, CPU_OPC_C, 0x2, 12, 0, 0, CPU_SR_FLAGS);    // MFSR R12, FLAGS
+    guest_op(&f, CPU_OPC_R, 0x2, 6, 2, 5, 0);                // MUL R6, R2, R5
+    guest_op(&f, CPU_OPC_C, 0x2, 13, 0, 0, CPU_SR_FLAGS);    // MFSR R13, FLAGS
+    guest_op(&f, CPU_OPC_I, 0xD, 0, 6, 0, 0);                // TESTI R6, #0
+    guest_op(&f, CPU_OPC_C, 0x2, 14, 0, 0, CPU_SR_FLAGS);    // MFSR R14, FLAGS
+    guest_op(&f, CPU_OPC_I, 0x1, 1, 1, 0, 1);                // SUBI R1, R1, #1
+    guest_patch(&f, guest_op(&f, CPU_OPC_B, 0xB, 0, 1, 0, 0), loop);  // BNZ R1, loop
+    guest_op(&f, CPU_OPC_C, 0x1, 0, 0, 0, 0);                // HALT
+
+    for (int m = 0; m < CPU_MODES; m++) {
+        cpu_system_t *cpu = cpu_create(1, GUEST_MEMORY);
+        const register_file_t *regs;
+        TEST_ASSERT(cpu && cpu_load_program(cpu, CPU_RESET_PC, f.words, f.count) == 0,
+                    "Guest system allocation failed");
+        snprintf(message, sizeof(message), "Wrong flags in %s mode", cpu_mode_names[m]);
+        TEST_ASSERT(cpu_run(cpu, (cpu_mode_t)m, UINT64_MAX) == 0 && cpu_halted(cpu), message);
+        regs = &cpu->cores[0].regs;
+        TEST_ASSERT(regs->gpr[10] == (CPU_FLAG_S | CPU_FLAG_V), message);  // Signed overflow
+        TEST_ASSERT(regs->gpr[11] == (CPU_FLAG_S | CPU_FLAG_C), message);  // Borrow
+        TEST_ASSERT(regs->gpr[12] == (CPU_FLAG_Z | CPU_FLAG_C), message);  // Carry out
+        TEST_ASSERT(regs->gpr[13] == (CPU_FLAG_C | CPU_FLAG_V), message);  // Product overflow
+        TEST_ASSERT(regs->gpr[14] == CPU_FLAG_Z, message);
+        // Pending SUBI flags are folded in once cpu_run returns
+        TEST_ASSERT(regs->flags == CPU_FLAG_Z, message);
+        cpu_destroy(cpu);
+    }
+    TEST_PASS("Lazily evaluated Z/S/C/V flags in every engine");
+
+    // FCVT to integer: NaN and out-of-range values give INT64_MIN in every
+    // engine, as cvttss2si does in the JIT
+    static const float fcvt_inputs[] = { NAN, INFINITY, 1e30f, -2.75f };
+    static const uint64_t fcvt_expected[] = {
+        (uint64_t)INT64_MIN, (uint64_t)INT64_MIN, (uint64_t)INT64_MIN, (uint64_t)-2
+    };
+    guest_program_t fc = { { 0 }, 0 };
+    guest_li(&fc, 1, 64);                                    // LI R1, #iterations
+    loop = guest_op(&fc, CPU_OPC_F, 0x7, 2, 0, 0, 1);        // FCVT R2, F0, #1
+    guest_op(&fc, CPU_OPC_F, 0x7, 3, 1, 0, 1);               // FCVT R3, F1, #1
+    guest_op(&fc, CPU_OPC_F, 0x7, 4, 2, 0, 1);               // FCVT R4, F2, #1
+    guest_op(&fc, CPU_OPC_F, 0x7, 5, 3, 0, 1);               // FCVT R5, F3, #1
+    guest_op(&fc, CPU_OPC_I, 0x1, 1, 1, 0, 1);               // SUBI R1, R1, #1
+    guest_patch(&fc, guest_op(&fc, CPU_OPC_B, 0xB, 0, 1, 0, 0), loop);  // BNZ R1, loop
+    guest_op(&fc, CPU_OPC_C, 0x1, 0, 0, 0, 0);               // HALT
+
+    for (int m = 0; m < CPU_MODES; m++) {
+        cpu_system_t *cpu = cpu_create(1, GUEST_MEMORY);
+        TEST_ASSERT(cpu && cpu_load_program(cpu, CPU_RESET_PC, fc.words, fc.count) == 0,
+                    "Guest system allocation failed");
+        memcpy(cpu->cores[0].regs.fpr, fcvt_inputs, sizeof(fcvt_inputs));
+        snprintf(message, sizeof(message), "FCVT out of range in %s mode", cpu_mode_names[m]);
+        TEST_ASSERT(cpu_run(cpu, (cpu_mode_t)m, UINT64_MAX) == 0 && cpu_halted(cpu), message);
+        TEST_ASSERT(memcmp(&cpu->cores[0].regs.gpr[2], fcvt_expected, sizeof(fcvt_expected)) == 0,
+                    message);
+        cpu_destroy(cpu);
+    }
+    TEST_PASS("FCVT of NaN and out-of-range values in every engine");
+
+    // Hot core state: engine fields, GPRs, PC and flags in the first ten
+    // lines of a core that starts on its own line, the model kept apart
+    cpu_system_t *sys = cpu_create(MAX_CORES, GUEST_MEMORY);
+    TEST_ASSERT(sys, "Guest system allocation failed");
+    TEST_ASSERT(offsetof(cpu_core_t, regs.flags) + sizeof(uint64_t) <= 10 * CPU_CACHE_LINE,
+                "Hot core state spills past ten cache lines");
+    for (int c = 0; c < MAX_CORES; c++) {
+        TEST_ASSERT(sys->cores[c].model == &sys->models[c], "Core model not attached");
+        if (CPU_HAVE_ALIGNED_ALLOC) {
+            TEST_ASSERT((uintptr_t)&sys->cores[c] % CPU_CACHE_LINE == 0 &&
+                        (uintptr_t)sys->cores[c].model % CPU_CACHE_LINE == 0,
+                        "Core state shares a cache line with its neighbour");
+        }
+    }
+    cpu_destroy(sys);
+    TEST_PASS("Cache-line aligned hot core state");
+
+    // Generated ISA tables: every type's encoding decodes back to it, and
+    // the mnemonic table names every decodable byte
+    int decodable = 0;
+    for (int t = INST_ADD; t < INST_COUNT; t++) {
+        instruction_t inst;
+        instruction_type_t type;
+        cpu_unpack((uint64_t)(cpu_isa[t].opcode << 4 | cpu_isa[t].funct) << 56, &inst);
+        TEST_ASSERT(cpu_decode_instruction(&inst, &type) == 0 && type == (instruction_type_t)t,
+                    "ISA table encoding does not decode back");
+        TEST_ASSERT(strcmp(cpu_isa[t].name, cpu_instruction_names[t]) == 0,
+                    "ISA table out of enum order");
+    }
+    for (int b = 0; b < 256; b++) {
+        instruction_t inst;
+        instruction_type_t type;
+        cpu_unpack((uint64_t)b << 56, &inst);
+        int valid = cpu_decode_instruction(&inst, &type) == 0;
+        TEST_ASSERT(valid == (cpu_isa_mnemonics[b] != NULL), "Mnemonic table disagrees with decoder");
+        decodable += valid;
+    }
+    TEST_ASSERT(cpu_decode_table[CPU_OPC_S << 4 | 0x6] == INST_FENCE &&
+                cpu_decode_table[0xA0] == INST_INVALID && decodable == INST_COUNT - 1 + 3,
+                "Aliases or reserved opcodes decoded wrongly");
+    TEST_PASS("Decode tables generated from the ISA description");
+
+    // In-process assembler: the emitters and the text front end build the
+    // same program, which runs in every engine and survives an ELF round trip
+    static const char source[] =
+        "; R2 = 1 + 2 + ... + 100, stored to data, R5 = data[1]\n"
+        "start:  LI R1, #100\n"
+        "        LI R2, 0\n"
+        "loop:   ADD R2, R2, R1      # accumulate\n"
+        "        SUBI R1, R1, #1\n"
+        "        BNZ R1, loop\n"
+        "        LI R4, data\n"
+        "        STORE R2, [R4]\n"
+        "        LOAD R5, [R4 + #8]\n"
+        "        JAL done\n"
+        "        NOP\n"
+        "done:   HALT\n"
+        ".align 4\n"
+        "data:   .dword 0, 0x42\n";
+    cpu_asm_t text, emit;
+    cpu_label_t start, body, done, data;
+    TEST_ASSERT(cpu_asm_init(&text, CPU_RESET_PC) == 0 &&
+                cpu_asm_source(&text, source, strlen(source)) == 0 && cpu_asm_finish(&text) == 0,
+                text.error);
+    cpu_asm_init(&emit, CPU_RESET_PC);
+    start = cpu_asm_named(&emit, "start", 5);
+    body = cpu_asm_label(&emit);
+    done = cpu_asm_label(&emit);
+    data = cpu_asm_label(&emit);
+    cpu_asm_bind(&emit, start);
+    cpu_emit_li(&emit, 1, 100);
+    cpu_emit_li(&emit, 2, 0);
+    cpu_asm_bind(&emit, body);
+    cpu_emit_add(&emit, 2, 2, 1);
+    cpu_emit_subi(&emit, 1, 1, 1);
+    cpu_emit_bnz(&emit, 1, body);
+    cpu_asm_emit_label(&emit, CPU_OPC_U << 4, 4, 0, 0, data);   // LI R4, data
+    cpu_emit_store(&emit, 2, 4, 0);
+    cpu_emit_load(&emit, 5, 4, 8);
+    cpu_emit_jal(&emit, done);
+    cpu_emit_nop(&emit);
+    cpu_asm_bind(&emit, done);
+    cpu_emit_halt(&emit);
+    cpu_emit_nop(&emit);                                         // .align 4
+    cpu_asm_bind(&emit, data);
+    cpu_asm_word(&emit, 0);
+    cpu_asm_word(&emit, 0x42);
+    TEST_ASSERT(cpu_asm_finish(&emit) == 0, emit.error);
+    TEST_ASSERT(emit.count == text.count &&
+                memcmp(emit.words, text.words, text.count * sizeof(uint64_t)) == 0,
+                "Emitters and text front end assemble differently");
+
+    const char *elf_path = "workload-tests-asm.elf";
+    cpu_elf_image_t image;
+    TEST_ASSERT(cpu_asm_write_elf(&text, elf_path) == 0 && cpu_elf_read(elf_path, &image) == 0,
+                "ELF round trip failed");
+    TEST_ASSERT(image.count == text.count && image.base == CPU_RESET_PC &&
+                memcmp(image.words, text.words, text.count * sizeof(uint64_t)) == 0 &&
+                image.symbol_count == 4 && cpu_elf_symbolize(&image, CPU_RESET_PC + 24) &&
+                strcmp(cpu_elf_symbolize(&image, CPU_RESET_PC + 24)->name, "loop") == 0,
+                "ELF image differs from the assembled program");
+    cpu_elf_free(&image);
+    for (int m = 0; m < CPU_MODES; m++) {
+        cpu_system_t *cpu = cpu_create(1, GUEST_MEMORY);
+        uint64_t stored;
+        TEST_ASSERT(cpu && cpu_elf_load(cpu, elf_path) == 0, "ELF load failed");
+        snprintf(message, sizeof(message), "Assembled program wrong in %s mode",
+                 cpu_mode_names[m]);
+        TEST_ASSERT(cpu_run(cpu, (cpu_mode_t)m, UINT64_MAX) == 0 && cpu_halted(cpu), message);
+        memcpy(&stored, cpu->memory + cpu_asm_address(&emit, data), sizeof(stored));
+        TEST_ASSERT(cpu->cores[0].regs.gpr[2] == 5050 && stored == 5050 &&
+                    cpu->cores[0].regs.gpr[5] == 0x42, message);
+        cpu_destroy(cpu);
+    }
+    remove(elf_path);
+
+    // Labels sharing an address are sized up to the next distinct one
+    static const char aliased[] = "f:\ng:  NOP\n     NOP\nh:   HALT\n";
+    cpu_asm_t alias;
+    cpu_elf_symbol_t symbols[3];
+    TEST_ASSERT(cpu_asm_init(&alias, CPU_RESET_PC) == 0 &&
+                cpu_asm_source(&alias, aliased, strlen(aliased)) == 0 &&
+                cpu_asm_finish(&alias) == 0 && alias.named == 3, alias.error);
+    TEST_ASSERT(cpu_asm_symbols(&alias, alias.names, symbols) == 3 &&
+                symbols[0].size == 2 * CPU_INST_BYTES && symbols[1].size == 2 * CPU_INST_BYTES &&
+                symbols[2].address == CPU_RESET_PC + 2 * CPU_INST_BYTES &&
+                symbols[2].size == CPU_INST_BYTES, "Aliased labels sized wrong");
+    cpu_asm_free(&alias);
+
+    // Errors carry the source line; labels must be defined once
+    static const char *const bad[] = {
+        "NOP\nADD R1, R2\n", "NOP\nFOO R1\n", "NOP\nADDI R1, R1, #70000\n",
+        "NOP\nBNZ R1, nowhere\n", "x: NOP\nx: NOP\n"
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        cpu_asm_t b;
+        cpu_asm_init(&b, CPU_RESET_PC);
+        TEST_ASSERT((cpu_asm_source(&b, bad[i], strlen(bad[i])) != 0 || cpu_asm_finish(&b) != 0) &&
+                    strncmp(b.error, "line 2: ", 8) == 0, "Bad source accepted");
+        cpu_asm_free(&b);
+    }
+    cpu_asm_free(&text);
+    cpu_asm_free(&emit);
+    TEST_PASS("Assembler emitters, text front end and ELF images");
+
+    // Disassembler: assembling its output reproduces the text for random
+    // valid words, and traces format the same in parallel chunks
+    char dis[CPU_DISASM_MAX], again[CPU_DISASM_MAX];
+    uint64_t word = 88172645463325252ULL;
+    for (int i = 0, checked = 0; checked < 20000; i++) {
+        cpu_asm_t round;
+        word ^= word << 13;
+        word ^= word >> 7;
+        word ^= word << 17;
+        if (cpu_decode_table[word >> 56] == INST_INVALID) {
+            continue;
+        }
+        size_t n = cpu_disasm(word, GUEST_DATA, NULL, dis, sizeof(dis));
+        TEST_ASSERT(n < sizeof(dis) - 1, "Disassembly truncated");
+        dis[n] = '\n';
+        cpu_asm_init(&round, GUEST_DATA);
+        TEST_ASSERT(cpu_asm_source(&round, dis, n + 1) == 0 && cpu_asm_finish(&round) == 0,
+                    round.error);
+        dis[n] = '\0';
+        cpu_disasm(round.words[0], GUEST_DATA, NULL, again, sizeof(again));
+        TEST_ASSERT(strcmp(dis, again) == 0, "Disassembly does not reassemble");
+        cpu_asm_free(&round);
+        checked++;
+    }
+    TEST_ASSERT(cpu_disasm(0x3b01fff800000000ULL, 0x1010, NULL, dis, 8) > 7 &&
+                strcmp(dis, "BNZ R1,") == 0, "Truncated disassembly not terminated");
+
+    cpu_trace_entry_t *trace = malloc(3 * CPU_DISASM_CHUNK * sizeof(cpu_trace_entry_t));
+    FILE *serial = tmpfile(), *parallel = tmpfile();
+    TEST_ASSERT(trace && serial && parallel, "Trace allocation failed");
+    for (size_t i = 0; i < 3 * CPU_DISASM_CHUNK; i++) {
+        trace[i].pc = CPU_RESET_PC + (i % 64) * CPU_INST_BYTES;
+        trace[i].word = cpu_encode_op(CPU_OPC_B, 0xB, 0, 1, 0, -(int32_t)(i % 64) * 8);
+    }
+    TEST_ASSERT(cpu_disasm_trace(trace, 3 * CPU_DISASM_CHUNK - 5, NULL, 1, serial) == 0 &&
+                cpu_disasm_trace(trace, 3 * CPU_DISASM_CHUNK - 5, NULL, 4, parallel) == 0,
+                "Trace disassembly failed");
+    TEST_ASSERT(ftell(serial) > 0 && ftell(serial) == ftell(parallel), "Parallel trace differs");
+    cpu_disasm_trace_ctx_t wide;
+    TEST_ASSERT(cpu_disasm_trace_init(&wide, NULL, 1000) == 0 &&
+                wide.threads == PARALLEL_MAX_THREADS, "Trace threads not clamped");
+    cpu_disasm_trace_free(&wide);
+    rewind(serial);
+    rewind(parallel);
+    for (int c = fgetc(serial); c != EOF; c = fgetc(serial)) {
+        TEST_ASSERT(c == fgetc(parallel), "Parallel trace differs");
+    }
+    fclose(serial);
+    fclose(parallel);
+    free(trace);
+    TEST_PASS("Disassembler round trip and parallel trace formatting");
+
+    return 0;
+}
+
+int test_static_analyzer() {
+    TEST_START("static throughput analyzer");
+
+    static cpu_mca_t m;
+    cpu_asm_t a;
+    cpu_label_t loop;
+
+    // Independent ALU work: 10 instructions dispatch in 2.5 cycles, the 9 ALU
+    // operations spread evenly over the 4 ALU ports
+    cpu_asm_init(&a, CPU_RESET_PC);
+    loop = cpu_asm_label(&a);
+    cpu_asm_bind(&a, loop);
+    for (unsigned r = 2; r < 10; r++) {
+        cpu_emit_add(&a, r, 10, 11);
+    }
+    cpu_emit_subi(&a, 1, 1, 1);
+    cpu_emit_bnz(&a, 1, loop);
+    TEST_ASSERT(cpu_asm_finish(&a) == 0 && cpu_mca_analyze(a.words, a.count, &m) == 0,
+                "Analysis failed");
+    TEST_ASSERT(m.dispatch_bound == 2.5 && m.port_bound == 2.25 && m.recurrence_bound == 1.0,
+                "Wrong bounds for independent ALU work");
+    TEST_ASSERT(m.cycles_per_iteration == 2.5 && strcmp(m.bottleneck, "dispatch") == 0,
+                "Independent ALU work not dispatch bound");
+    TEST_ASSERT(m.chain_length == 1 && m.chain[0] == 8, "Wrong critical chain for the counter");
+    cpu_asm_free(&a);
+    TEST_PASS("Dispatch-bound loop");
+
+    // A multiply chain through R2 carries 4 x 3 cycles into the next iteration
+    cpu_asm_init(&a, CPU_RESET_PC);
+    loop = cpu_asm_label(&a);
+    cpu_asm_bind(&a, loop);
+    cpu_emit_subi(&a, 1, 1, 1);
+    for (int i = 0; i < 4; i++) {
+        cpu_emit_mul(&a, 2, 2, 3);
+    }
+    cpu_emit_fadd(&a, 1, 1, 2);
+    cpu_emit_bnz(&a, 1, loop);
+    TEST_ASSERT(cpu_asm_finish(&a) == 0 && cpu_mca_analyze(a.words, a.count, &m) == 0,
+                "Analysis failed");
+    TEST_ASSERT(m.recurrence_bound == 12.0 && m.cycles_per_iteration == 12.0 &&
+                strcmp(m.bottleneck, "recurrence") == 0, "Multiply chain not recurrence bound");
+    TEST_ASSERT(m.chain_length == 4 && m.chain[0] == 1 && m.chain[3] == 4 &&
+                m.inst[2].critical && !m.inst[5].critical, "Wrong critical chain");
+    TEST_ASSERT(m.critical_path == 12 && m.latency == CPU_MCA_PIPELINE_DEPTH - 1 + 12 &&
+                cpu_mca_cycles(&m, 10) == m.latency + 9 * 12.0, "Wrong iteration latency");
+    cpu_asm_free(&a);
+    TEST_PASS("Recurrence-bound loop and its critical chain");
+
+    // FMA and VFMA accumulate into their destination: a dot-product loop is
+    // bound by the 4-cycle accumulator recurrence, not the ports
+    for (int vector = 0; vector < 2; vector++) {
+        cpu_asm_init(&a, CPU_RESET_PC);
+        loop = cpu_asm_label(&a);
+        cpu_asm_bind(&a, loop);
+        if (vector) {
+            cpu_emit_vfma(&a, 1, 2, 3);
+        } else {
+            cpu_emit_fma(&a, 1, 2, 3);
+        }
+        cpu_emit_subi(&a, 1, 1, 1);
+        cpu_emit_bnz(&a, 1, loop);
+        TEST_ASSERT(cpu_asm_finish(&a) == 0 && cpu_mca_analyze(a.words, a.count, &m) == 0,
+                    "Analysis failed");
+        TEST_ASSERT(m.recurrence_bound == 4.0 && m.cycles_per_iteration == 4.0 &&
+                    strcmp(m.bottleneck, "recurrence") == 0 && m.chain_length == 1 &&
+                    m.chain[0] == 0, vector ? "VFMA accumulator missed" : "FMA accumulator missed");
+        cpu_asm_free(&a);
+    }
+    TEST_PASS("Accumulator recurrence of FMA and VFMA");
+
+    // DIV issues on one ALU port only: 3 divides there, the 4 adds balanced
+    // over the other three
+    cpu_asm_init(&a, CPU_RESET_PC);
+    for (unsigned r = 2; r < 5; r++) {
+        cpu_emit_div(&a, r, 10, 11);
+    }
+    for (unsigned r = 5; r < 9; r++) {
+        cpu_emit_add(&a, r, 10, 11);
+    }
+    cpu_emit_vadd(&a, 1, 2, 3);
+    TEST_ASSERT(cpu_asm_finish(&a) == 0 && cpu_mca_analyze(a.words, a.count, &m) == 0,
+                "Analysis failed");
+    TEST_ASSERT(m.port_bound == 3.0 && m.port_pressure[0] == 3.0 &&
+                fabs(m.port_pressure[1] - 4.0 / 3.0) < 1e-12 &&
+                fabs(m.port_pressure[3] - 4.0 / 3.0) < 1e-12, "Divides not balanced");
+    TEST_ASSERT(m.port_pressure[cpu_mca_unit_first[CPU_MCA_VEC]] == 0.5 &&
+                m.port_pressure[cpu_mca_unit_first[CPU_MCA_VEC] + 2] == 0.0,
+                "VADD not on two vector ports");
+    TEST_ASSERT(strcmp(m.bottleneck, "ports") == 0 && m.chain_length == 0,
+                "Divides not port bound");
+    TEST_ASSERT(cpu_decode_table[0xFF] == INST_INVALID, "Opcode byte 0xFF is assigned");
+    cpu_asm_word(&a, 0xFFULL << 56);
+    TEST_ASSERT(cpu_asm_finish(&a) == 0 && cpu_mca_analyze(a.words, a.count, &m) != 0,
+                "Invalid instruction accepted");
+    cpu_asm_free(&a);
+    TEST_PASS("Port pressure balancing");
+
+    return 0;
+}
+
+// Saves { FP, LR } below SP and points FP and SP at the record
+static void emit_frame_enter(cpu_asm_t *a) {
+    cpu_emit_mfsr(a, 13, CPU_SR_SP);
+    cpu_emit_subi(a, 13, 13, 16);
+    cpu_emit_mfsr(a, 12, CPU_SR_FP);
+    cpu_emit_store(a, 12, 13, 0);
+    cpu_emit_mfsr(a, 12, CPU_SR_LR);
+    cpu_emit_store(a, 12, 13, 8);
+    cpu_emit_mtsr(a, CPU_SR_FP, 13);
+    cpu_emit_mtsr(a, CPU_SR_SP, 13);
+}
+
+static void emit_frame_leave(cpu_asm_t *a) {
+    cpu_emit_load(a, 12, 13, 8);
+    cpu_emit_mtsr(a, CPU_SR_LR, 12);
+    cpu_emit_load(a, 12, 13, 0);
+    cpu_emit_mtsr(a, CPU_SR_FP, 12);
+    cpu_emit_addi(a, 13, 13, 16);
+    cpu_emit_mtsr(a, CPU_SR_SP, 13);
+}
+
+// Leaf spinning count times through R3
+static void emit_leaf(cpu_asm_t *a, cpu_label_t entry, int64_t count) {
+    cpu_label_t loop = cpu_asm_label(a);
+    cpu_asm_bind(a, entry);
+    cpu_emit_li(a, 3, count);
+    cpu_asm_bind(a, loop);
+    cpu_emit_subi(a, 3, 3, 1);
+    cpu_emit_bnz(a, 3, loop);
+    cpu_emit_ret(a);
+}
+
+int test_guest_profiler() {
+    TEST_START("guest sampling profiler");
+
+    // main calls f and h 200 times; f keeps a frame record and calls the
+    // leaf g 4 times, so g dominates and is only reached through f
+    const char *elf_path = "workload-tests-prof.elf";
+    cpu_asm_t a;
+    cpu_label_t f, g, h, loop;
+    cpu_asm_init(&a, CPU_RESET_PC);
+    cpu_asm_bind(&a, cpu_asm_named(&a, "main", 4));
+    f = cpu_asm_named(&a, "f", 1);
+    g = cpu_asm_named(&a, "g", 1);
+    h = cpu_asm_named(&a, "h", 1);
+    cpu_emit_li(&a, 1, 200);
+    loop = cpu_asm_label(&a);
+    cpu_asm_bind(&a, loop);
+    cpu_emit_jal(&a, f);
+    cpu_emit_jal(&a, h);
+    cpu_emit_subi(&a, 1, 1, 1);
+    cpu_emit_bnz(&a, 1, loop);
+    cpu_emit_halt(&a);
+    cpu_asm_bind(&a, f);
+    emit_frame_enter(&a);
+    cpu_emit_li(&a, 2, 4);
+    loop = cpu_asm_label(&a);
+    cpu_asm_bind(&a, loop);
+    cpu_emit_jal(&a, g);
+    cpu_emit_subi(&a, 2, 2, 1);
+    cpu_emit_bnz(&a, 2, loop);
+    emit_frame_leave(&a);
+    cpu_emit_ret(&a);
+    emit_leaf(&a, g, 50);
+    emit_leaf(&a, h, 30);
+    cpu_elf_image_t image;
+    TEST_ASSERT(cpu_asm_write_elf(&a, elf_path) == 0 && cpu_elf_read(elf_path, &image) == 0,
+                "Profiled program not written");
+    cpu_asm_free(&a);
+
+    cpu_prof_t p;
+    TEST_ASSERT(cpu_prof_init(&p, 0, &image) != 0, "Zero sampling period accepted");
+    for (int m = 0; m < CPU_MODES; m++) {
+        cpu_system_t *plain = cpu_create(1, GUEST_MEMORY), *cpu = cpu_create(1, GUEST_MEMORY);
+        char message[96];
+        snprintf(message, sizeof(message), "Sampling changed the run in %s mode",
+                 cpu_mode_names[m]);
+        TEST_ASSERT(plain && cpu && cpu_elf_load(plain, elf_path) == 0 &&
+                    cpu_elf_load(cpu, elf_path) == 0 && cpu_prof_init(&p, 97, &image) == 0,
+                    "Profiler setup failed");
+        TEST_ASSERT(cpu_run(plain, (cpu_mode_t)m, UINT64_MAX) == 0 &&
+                    cpu_prof_run(cpu, (cpu_mode_t)m, UINT64_MAX, &p) == 0 && cpu_halted(cpu),
+                    message);
+        TEST_ASSERT(cpu->sampler == NULL && cpu->cores[0].retired == plain->cores[0].retired &&
+                    memcmp(&cpu->cores[0].regs, &plain->cores[0].regs, sizeof(register_file_t)) == 0,
+                    message);
+        TEST_ASSERT(p.count > 0 && p.total <= cpu->cores[0].retired &&
+                    p.total > cpu->cores[0].retired - 97 && !p.failed, "Samples missing");
+
+        // g is hottest, every stack is rooted in main and symbolized
+        size_t n;
+        cpu_prof_function_t *fn = cpu_prof_functions(&p, &n);
+        TEST_ASSERT(fn && n == 4, "Unsymbolized frames in the profile");
+        for (size_t i = 0; i < n; i++) {
+            const char *name = image.symbols[fn[i].key & ~(UINT64_C(1) << 63)].name;
+            TEST_ASSERT(fn[i].key >> 63, "Unsymbolized frames in the profile");
+            TEST_ASSERT(i > 0 || strcmp(name, "g") == 0, "g is not the hottest function");
+            TEST_ASSERT(strcmp(name, "main") != 0 || fn[i].total == p.total,
+                        "Stacks not rooted in main");
+            TEST_ASSERT(strcmp(name, "f") != 0 || fn[i].total > fn[0].self,
+                        "f does not include g");
+        }
+        free(fn);
+
+        FILE *folded = tmpfile();
+        char line[128];
+        int through_f = 0, other = 0;
+        TEST_ASSERT(folded && cpu_prof_write_folded(&p, folded) == 0, "Folded output failed");
+        rewind(folded);
+        while (fgets(line, sizeof(line), folded)) {
+            through_f += strncmp(line, "main;f;g ", 9) == 0;
+            other += strstr(line, "g ") && strncmp(line, "main;f;g ", 9) != 0;
+        }
+        TEST_ASSERT(through_f == 1 && other == 0, "g not reached through main;f");
+        fclose(folded);
+        cpu_prof_free(&p);
+        cpu_destroy(plain);
+        cpu_destroy(cpu);
+    }
+    cpu_elf_free(&image);
+    remove(elf_path);
+    TEST_PASS("Sampled call stacks and self/total weights");
+
+    return 0;
+}
+
+int run_all_tests() {
+    printf("AlphaAHB V5 Workload Kernel Tests\n");
+    printf("=================================\n");
+
+    int failed_tests = 0;
+
+    // Physics engine
+    failed_tests += test_physics_integrators();
+    failed_tests += test_physics_broadphase();
+
+    // HPC kernels
+    failed_tests += test_hpc_iterated_map();
+
+    // Real-time harness
+    failed_tests += test_hdr_histogram();
+    failed_tests += test_realtime_harness();
+    failed_tests += test_pid_controller();
+
+    // MIMD synchronization
+    failed_tests += test_sync_primitives();
+
+    // Simulator
+    failed_tests += test_simulator_engines();
+    failed_tests += test_static_analyzer();
+    failed_tests += test_guest_profiler();
+
+    printf("\n=== Test Summary ===\n");
+    if (failed_tests == 0) {
+        printf("ALL TESTS PASSED!\n");
+    } else {
+        printf("FAILED: %d tests\n", failed_tests);
+    }
+
+    return failed_tests;
+}
+
+int main() {
+    return run_all_tests();
+}
@@ -0,0 +1,236 @@
+#!/usr/bin/env python3
+"""
+AlphaAHB V5 Benchmark Comparison Tool
+Developed and Maintained by GLCTC Corp.
+
+Compares two JSON result files written by tests/performance-benchmarks
+(--json) and flags regressions. A benchmark regresses when its median time
+per operation grew by more than the threshold AND a two-sided Mann-Whitney
+U test on the per-sample timings rejects "same distribution" at the chosen
+significance level. Requiring both keeps noisy benchmarks from failing the
+check on a lucky run and ignores statistically real but negligible changes.
+
+Small samples cap the significance the test can reach: with n1 and n2 samples
+no p-value is below 2 / C(n1 + n2, n1), which is 0.0079 at 5 per side but
+0.029 at 4. Comparisons that cannot reach the significance level are listed
+in a warning, since they can never be reported as regressions.
+
+Exit status: 0 when nothing regressed, 1 on regressions, 2 on bad input.
+"""
+
+import sys
+import json
+import math
+import argparse
+from typing import Dict, List, Optional, Any
+from dataclasses import dataclass, asdict
+
+# Host fields that make timings incomparable when they differ
+HOST_FIELDS = ["cpu_model", "cpu_mhz", "compiler", "cflags"]
+
+# Largest sample count per side for the exact U distribution (the harness's
+# BENCH_MAX_REPETITIONS); larger or tied samples use the normal approximation
+EXACT_MAX_SAMPLES = 64
+
+
+@dataclass
+class Comparison:
+    """Result of comparing one benchmark between two runs"""
+    name: str
+    baseline_ns: float
+    current_ns: float
+    change: float           # Relative change of the median (+ is slower)
+    p_value: float
+    min_p_value: float      # Smallest p-value the sample counts allow
+    status: str             # regression, improvement, unchanged, noise
+
+
+def u_distribution(n1: int, n2: int) -> List[int]:
+    """Number of orderings of n1 + n2 distinct values giving each U = 0..n1*n2.
+
+    These are the coefficients of the Gaussian binomial [n1 + n2, n1]_q, built
+    as the product of (1 - q^(n2 + i)) / (1 - q^i) for i = 1..n1; every partial
+    product is itself a polynomial, so the division is exact.
+    """
+    counts = [1]
+    for i in range(1, n1 + 1):
+        counts += [0] * n2
+        for k in range(len(counts) - 1, n2 + i - 1, -1):
+            counts[k] -= counts[k - n2 - i]
+        for k in range(i, len(counts)):
+            counts[k] += counts[k - i]
+    return counts
+
+
+def min_p_value(n1: int, n2: int) -> float:
+    """Smallest two-sided p-value of the exact test with n1 and n2 samples"""
+    if n1 == 0 or n2 == 0:
+        return 1.0
+    return min(1.0, 2.0 / math.comb(n1 + n2, n1))
+
+
+def mann_whitney_u(a: List[float], b: List[float]) -> float:
+    """Two-sided p-value of the Mann-Whitney U test.
+
+    Exact when there are no ties and at most EXACT_MAX_SAMPLES per side,
+    which covers every result the harness writes; otherwise the normal
+    approximation with tie and continuity corrections. The approximation
+    overstates p for small samples: at 5 per side it never goes below 0.012,
+    where the exact test reaches 0.0079.
+    """
+    n1, n2 = len(a), len(b)
+    if n1 == 0 or n2 == 0:
+        return 1.0
+
+    # Average ranks over the pooled samples
+    pooled = sorted([(v, 0) for v in a] + [(v, 1) for v in b])
+    ranks = [0.0] * len(pooled)
+    tie_term = 0.0
+    i = 0
+    while i < len(pooled):
+        j = i
+        while j + 1 < len(pooled) and pooled[j + 1][0] == pooled[i][0]:
+            j += 1
+        rank = (i + j) / 2.0 + 1.0
+        for k in range(i, j + 1):
+            ranks[k] = rank
+        t = j - i + 1
+        tie_term += t ** 3 - t
+        i = j + 1
+
+    rank_sum_a = sum(r for r, (_, group) in zip(ranks, pooled) if group == 0)
+    u = rank_sum_a - n1 * (n1 + 1) / 2.0
+    if tie_term == 0.0 and max(n1, n2) <= EXACT_MAX_SAMPLES:
+        counts = u_distribution(n1, n2)
+        u = int(u)
+        tail = min(sum(counts[:u + 1]), sum(counts[u:]))
+        return min(1.0, 2.0 * tail / math.comb(n1 + n2, n1))
+
+    mean = n1 * n2 / 2.0
+    n = n1 + n2
+    variance = n1 * n2 / 12.0 * ((n + 1) - tie_term / (n * (n - 1)))
+    if variance <= 0.0:
+        return 1.0
+    z = (abs(u - mean) - 0.5) / math.sqrt(variance)
+    if z <= 0.0:
+        return 1.0
+    return math.erfc(z / math.sqrt(2.0))
+
+
+def load_results(path: str) -> Dict[str, Any]:
+    """Load a benchmark JSON file"""
+    with open(path, "r") as f:
+        data = json.load(f)
+    if data.get("schema") != "alphaahb-benchmarks-1":
+        raise ValueError(f"{path}: not an AlphaAHB benchmark result file")
+    return data
+
+
+def compare_runs(baseline: Dict[str, Any], current: Dict[str, Any], threshold: float,
+                 alpha: float) -> List[Comparison]:
+    """Compare every benchmark present in both runs"""
+    base_by_name = {b["name"]: b for b in baseline["benchmarks"]}
+    comparisons = []
+    for bench in current["benchmarks"]:
+        base = base_by_name.get(bench["name"])
+        if base is None or base["median_ns"] <= 0.0:
+            continue
+        change = bench["median_ns"] / base["median_ns"] - 1.0
+        base_samples = base.get("sample_ns", [])
+        samples = bench.get("sample_ns", [])
+        p_value = mann_whitney_u(base_samples, samples)
+        if p_value >= alpha:
+            status = "noise" if abs(change) > threshold else "unchanged"
+        elif change > threshold:
+            status = "regression"
+        elif change < -threshold:
+            status = "improvement"
+        else:
+            status = "unchanged"
+        comparisons.append(Comparison(bench["name"], base["median_ns"], bench["median_ns"],
+                                      change, p_value,
+                                      min_p_value(len(base_samples), len(samples)), status))
+    return comparisons
+
+
+def host_differences(baseline: Dict[str, Any], current: Dict[str, Any]) -> List[str]:
+    """Host metadata fields that differ between the runs"""
+    diffs = []
+    for field in HOST_FIELDS:
+        old = baseline.get("host", {}).get(field)
+        new = current.get("host", {}).get(field)
+        if old != new:
+            diffs.append(f"{field}: {old!r} -> {new!r}")
+    return diffs
+
+
+def print_report(comparisons: List[Comparison], baseline: Dict[str, Any],
+                 current: Dict[str, Any], threshold: float, alpha: float,
+                 missing: List[str]) -> None:
+    """Human-readable comparison table"""
+    print(f"Baseline: {baseline['host'].get('git_sha', '?')} "
+          f"({baseline['host'].get('timestamp', '?')})")
+    print(f"Current:  {current['host'].get('git_sha', '?')} "
+          f"({current['host'].get('timestamp', '?')})")
+    for diff in host_differences(baseline, current):
+        print(f"WARNING: host differs, {diff}")
+    for c in comparisons:
+        if c.min_p_value >= alpha:
+            print(f"WARNING: {c.name} has too few samples to reach p < {alpha} "
+                  f"(at best {c.min_p_value:.3g}); raise its repetitions")
+    print(f"Threshold {threshold * 100:.1f}%, significance level {alpha}\n")
+    print(f"{'Benchmark':<32} {'base ns/op':>12} {'new ns/op':>12} {'change':>9} "
+          f"{'p-value':>9}  status")
+    for c in comparisons:
+        print(f"{c.name:<32} {c.baseline_ns:>12.4f} {c.current_ns:>12.4f} "
+              f"{c.change * 100:>+8.1f}% {c.p_value:>9.4f}  {c.status}")
+    for name in missing:
+        print(f"{name:<32} {'':>12} {'':>12} {'':>9} {'':>9}  missing in current run")
+
+    regressions = [c for c in comparisons if c.status == "regression"]
+    improvements = [c for c in comparisons if c.status == "improvement"]
+    print(f"\n{len(regressions)} regressions, {len(improvements)} improvements, "
+          f"{len(comparisons)} benchmarks compared")
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    parser = argparse.ArgumentParser(description="Compare two AlphaAHB benchmark runs")
+    parser.add_argument("baseline", help="Baseline JSON from performance-benchmarks --json")
+    parser.add_argument("current", help="Current JSON from performance-benchmarks --json")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="Regression threshold in percent of the median (default 5)")
+    parser.add_argument("--alpha", type=float, default=0.01,
+                        help="Significance level of the Mann-Whitney U test (default 0.01)")
+    parser.add_argument("--json", metavar="FILE", help="Also write the comparison as JSON")
+    args = parser.parse_args(argv)
+
+    try:
+        baseline = load_results(args.baseline)
+        current = load_results(args.current)
+    except (OSError, ValueError) as e:
+        print(f"Error: {e}", file=sys.stderr)
+        return 2
+
+    threshold = args.threshold / 100.0
+    comparisons = compare_runs(baseline, current, threshold, args.alpha)
+    current_names = {b["name"] for b in current["benchmarks"]}
+    missing = [b["name"] for b in baseline["benchmarks"] if b["name"] not in current_names]
+    print_report(comparisons, baseline, current, threshold, args.alpha, missing)
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump({
+                "baseline": baseline["host"],
+                "current": current["host"],
+                "threshold": threshold,
+                "alpha": args.alpha,
+                "host_differences": host_differences(baseline, current),
+                "missing": missing,
+                "comparisons": [asdict(c) for c in comparisons],
+            }, f, indent=2)
+
+    return 1 if any(c.status == "regression" for c in comparisons) else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
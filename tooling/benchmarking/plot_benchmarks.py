@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+"""
+AlphaAHB V5 Benchmark Curve Plotter
+Developed and Maintained by GLCTC Corp.
+
+Renders the working-set sweeps of tests/performance-benchmarks (--sweep
+--json FILE) as throughput-vs-size curves, one line per kernel and thread
+count, so cache cliffs line up across kernels. Sweep points are the results
+with a non-zero size_bytes; their operations are bytes, so ops_per_sec is
+bandwidth.
+
+With --scaling it plots the contention benchmarks instead: results with a
+thread count but no working set, as throughput vs threads, one line per
+primitive.
+"""
+
+import sys
+import json
+import argparse
+from collections import defaultdict
+from typing import Dict, List, Optional, Tuple
+
+
+def load_curves(path: str) -> Dict[Tuple[str, int], List[Tuple[int, float]]]:
+    """Group sweep points into (kernel, threads) -> [(bytes, GB/s)]"""
+    with open(path, "r") as f:
+        data = json.load(f)
+    curves = defaultdict(list)
+    for bench in data.get("benchmarks", []):
+        size = bench.get("size_bytes", 0)
+        if not size:
+            continue
+        kernel = bench["name"].split("/")[0]
+        curves[(kernel, bench.get("threads", 1))].append((size, bench["ops_per_sec"] * 1e-9))
+    for points in curves.values():
+        points.sort()
+    return dict(curves)
+
+
+def load_scaling(path: str) -> Dict[str, List[Tuple[int, float]]]:
+    """Group contention points into primitive -> [(threads, Mops/s)]"""
+    with open(path, "r") as f:
+        data = json.load(f)
+    curves = defaultdict(list)
+    for bench in data.get("benchmarks", []):
+        if bench.get("size_bytes", 0) or not bench.get("threads", 0):
+            continue
+        primitive = bench["name"].split("/")[0]
+        curves[primitive].append((bench["threads"], bench["ops_per_sec"] * 1e-6))
+    for points in curves.values():
+        points.sort()
+    return {k: v for k, v in curves.items() if len(v) > 1}
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    parser = argparse.ArgumentParser(description="Plot AlphaAHB benchmark sweeps")
+    parser.add_argument("results", help="JSON from performance-benchmarks --sweep --json")
+    parser.add_argument("-o", "--output", default="benchmark-curves.png",
+                        help="Output image (default benchmark-curves.png)")
+    parser.add_argument("--filter", help="Only plot kernels whose name contains this text")
+    parser.add_argument("--scaling", action="store_true",
+                        help="Plot contention benchmarks as throughput vs threads")
+    args = parser.parse_args(argv)
+
+    try:
+        import matplotlib
+        matplotlib.use("Agg")
+        import matplotlib.pyplot as plt
+    except ImportError:
+        print("Error: matplotlib is required for plotting", file=sys.stderr)
+        return 2
+
+    if args.scaling:
+        return plot_scaling(plt, args)
+
+    curves = load_curves(args.results)
+    if args.filter:
+        curves = {k: v for k, v in curves.items() if args.filter.lower() in k[0].lower()}
+    if not curves:
+        print("No sweep results found (run performance-benchmarks with --sweep)",
+              file=sys.stderr)
+        return 1
+
+    fig, ax = plt.subplots(figsize=(10, 6))
+    for (kernel, threads), points in sorted(curves.items()):
+        sizes = [p[0] for p in points]
+        rates = [p[1] for p in points]
+        label = kernel if threads == 1 else f"{kernel} ({threads} threads)"
+        ax.plot(sizes, rates, marker="o", label=label)
+    ax.set_xscale("log", base=2)
+    ax.set_xlabel("Working set (bytes)")
+    ax.set_ylabel("Throughput (GB/s)")
+    ax.set_title("AlphaAHB V5 benchmark throughput vs working-set size")
+    ax.grid(True, which="both", alpha=0.3)
+    ax.legend(fontsize="small")
+    fig.tight_layout()
+    fig.savefig(args.output, dpi=120)
+    print(f"Wrote {args.output} ({len(curves)} curves)")
+    return 0
+
+
+def plot_scaling(plt, args) -> int:
+    """Throughput vs thread count of every contention benchmark"""
+    curves = load_scaling(args.results)
+    if args.filter:
+        curves = {k: v for k, v in curves.items() if args.filter.lower() in k.lower()}
+    if not curves:
+        print("No scaling results found (need points at two or more thread counts)",
+              file=sys.stderr)
+        return 1
+
+    fig, ax = plt.subplots(figsize=(10, 6))
+    for primitive, points in sorted(curves.items()):
+        ax.plot([p[0] for p in points], [p[1] for p in points], marker="o", label=primitive)
+    ax.set_xscale("log", base=2)
+    ax.set_yscale("log")
+    ax.set_xlabel("Threads")
+    ax.set_ylabel("Throughput (Mops/s)")
+    ax.set_title("AlphaAHB V5 synchronization primitive scaling")
+    ax.grid(True, which="both", alpha=0.3)
+    ax.legend(fontsize="small")
+    fig.tight_layout()
+    fig.savefig(args.output, dpi=120)
+    print(f"Wrote {args.output} ({len(curves)} curves)")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,142 @@
+/*
+ * AlphaAHB V5 Object Dump
+ * Developed and Maintained by GLCTC Corp.
+ *
+ * Native counterpart of alphaahb_objdump.py on the simulator's encoding
+ * (cpu-disassembler.h): disassembles ELF executables written by
+ * cpu-assembler.h or raw instruction images, prints their symbol tables,
+ * and formats instruction traces (cpu_trace_entry_t records) in parallel,
+ * symbolized against the executable.
+ *
+ * Build with `make tools`; the binary is build/alphaahb-objdump.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "../../examples/cpu-disassembler.h"
+
+static void usage(const char *prog) {
+    printf("Usage: %s [options] FILE\n", prog);
+    printf("  -d, --disassemble  Disassemble the text of FILE (default)\n");
+    printf("  -t, --syms         Print the symbol table of FILE\n");
+    printf("  --raw ADDRESS      FILE holds raw instruction words loaded at ADDRESS\n");
+    printf("  --trace TRACE      Disassemble the trace records in TRACE, symbolized\n");
+    printf("                     against FILE\n");
+    printf("  --threads N        Worker threads for --trace (default: all CPUs)\n");
+    printf("  -h, --help         Show this help message\n");
+}
+
+// Raw image: the whole file is instruction words
+static int read_raw(const char *path, uint64_t base, cpu_elf_image_t *image) {
+    FILE *f = fopen(path, "rb");
+    long size;
+
+    memset(image, 0, sizeof(*image));
+    if (!f) {
+        return -1;
+    }
+    if (fseek(f, 0, SEEK_END) != 0 || (size = ftell(f)) <= 0 || size % CPU_INST_BYTES != 0 ||
+        fseek(f, 0, SEEK_SET) != 0 || !(image->words = malloc((size_t)size)) ||
+        fread(image->words, 1, (size_t)size, f) != (size_t)size) {
+        fclose(f);
+        cpu_elf_free(image);
+        return -1;
+    }
+    fclose(f);
+    image->count = (size_t)size / CPU_INST_BYTES;
+    image->base = image->entry = base;
+    return 0;
+}
+
+static void print_symbols(const cpu_elf_image_t *image) {
+    printf("\nSYMBOL TABLE:\n");
+    for (size_t i = 0; i < image->symbol_count; i++) {
+        printf("%016llx g     F .text\t%016llx %s\n",
+               (unsigned long long)image->symbols[i].address,
+               (unsigned long long)image->symbols[i].size, image->symbols[i].name);
+    }
+}
+
+static void print_disassembly(const cpu_elf_image_t *image) {
+    char text[CPU_DISASM_MAX];
+    size_t next = 0;
+
+    printf("\nDisassembly of section .text:\n");
+    for (size_t i = 0; i < image->count; i++) {
+        uint64_t address = image->base + i * CPU_INST_BYTES;
+
+        while (next < image->symbol_count && image->symbols[next].address < address) {
+            next++;
+        }
+        if (next < image->symbol_count && image->symbols[next].address == address) {
+            printf("\n%016llx <%s>:\n", (unsigned long long)address, image->symbols[next].name);
+        } else if (i == 0) {
+            printf("\n%016llx <.text>:\n", (unsigned long long)address);
+        }
+        cpu_disasm(image->words[i], address, image, text, sizeof(text));
+        printf("%8llx:\t%016llx\t%s\n", (unsigned long long)address,
+               (unsigned long long)image->words[i], text);
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *path = NULL, *trace = NULL;
+    int disassemble = 0, syms = 0, raw = 0, threads = 0;
+    uint64_t raw_base = 0;
+    cpu_elf_image_t image;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-d") == 0 || strcmp(argv[i], "--disassemble") == 0) {
+            disassemble = 1;
+        } else if (strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--syms") == 0) {
+            syms = 1;
+        } else if (strcmp(argv[i], "--raw") == 0 && i + 1 < argc) {
+            raw = 1;
+            raw_base = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+            return strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+    if (!path) {
+        usage(argv[0]);
+        return 1;
+    }
+    if ((raw ? read_raw(path, raw_base, &image) : cpu_elf_read(path, &image)) != 0) {
+        fprintf(stderr, "%s: not an AlphaAHB %s\n", path, raw ? "image" : "executable");
+        return 1;
+    }
+
+    int rc = 0;
+    if (trace) {
+        FILE *in = fopen(trace, "rb");
+        if (!in || cpu_disasm_trace_file(in, &image, threads, stdout) != 0) {
+            fprintf(stderr, "%s: cannot read trace\n", trace);
+            rc = 1;
+        }
+        if (in) {
+            fclose(in);
+        }
+    } else {
+        printf("\n%s:     file format %s\n", path, raw ? "binary" : "elf64-alphaahb");
+        if (syms) {
+            print_symbols(&image);
+        }
+        if (disassemble || !syms) {
+            print_disassembly(&image);
+        }
+    }
+    cpu_elf_free(&image);
+    return rc;
+}
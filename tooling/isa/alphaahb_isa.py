@@ -0,0 +1,223 @@
+#!/usr/bin/env python3
+"""
+AlphaAHB V5 Instruction Set Description
+Developed and Maintained by GLCTC Corp.
+
+Loads the machine-readable ISA description (specs/instruction-set.json) and
+generates the C tables the simulator decodes and dispatches with
+(examples/cpu-isa.h):
+
+- CPU_INSTRUCTIONS(X): X(name, handler) per instruction in enum order; the
+  engines run each one through cpu_execute_<handler>
+- cpu_isa[]: encoding, operand syntax, timing and properties per type
+- cpu_decode_table[256]: instruction type of every opcode/funct byte, so
+  decoding is one indexed load of the word's top byte
+- cpu_isa_mnemonics[256]: assembler mnemonic of every opcode/funct byte,
+  aliases included
+- CPU_ISA_OPERANDS(X): X(NAME, name, SIGNATURE) per instruction, the
+  operand signature of its syntax (cpu-assembler.h builds its emitters
+  from it)
+
+Adding an instruction means adding it to the description, regenerating
+(make isa) and implementing it in its handler; dispatch code is untouched.
+"""
+
+import sys
+import json
+import argparse
+from pathlib import Path
+from typing import Dict, List, Optional
+
+ROOT = Path(__file__).resolve().parents[2]
+DEFAULT_ISA = ROOT / "specs" / "instruction-set.json"
+DEFAULT_OUTPUT = ROOT / "examples" / "cpu-isa.h"
+
+# Operand signature tokens: destination, first and second source, immediate
+# (including special register numbers) and branch target
+SIGNATURE = {
+    "rd": "D", "fd": "D", "vd": "D",
+    "rs1": "S1", "fs1": "S1", "vs1": "S1",
+    "rs2": "S2", "fs2": "S2", "vs2": "S2",
+    "imm": "IMM", "sr": "IMM", "target": "TARGET",
+    "[rs1 + imm]": "S1_IMM",
+}
+
+PROPERTIES = {
+    "writes_gpr": "CPU_ISA_WRITES_GPR",
+    "sets_flags": "CPU_ISA_SETS_FLAGS",
+    "ends_block": "CPU_ISA_ENDS_BLOCK",
+    "reads_rd": "CPU_ISA_READS_RD",
+}
+
+
+def load(path: Optional[Path] = None) -> Dict:
+    """Read and validate the description"""
+    with open(path or DEFAULT_ISA, "r") as f:
+        isa = json.load(f)
+    seen = {}
+    for inst in isa["instructions"]:
+        fmt = isa["formats"].get(inst["format"])
+        if fmt is None:
+            raise ValueError(f"{inst['name']}: unknown format {inst['format']}")
+        signature(inst["syntax"])
+        for prop in inst["properties"]:
+            if prop not in PROPERTIES:
+                raise ValueError(f"{inst['name']}: unknown property {prop}")
+        for mnemonic, funct in encodings(inst):
+            key = (fmt["opcode"], funct)
+            if key in seen:
+                raise ValueError(f"{mnemonic}: encoding {key} already used by {seen[key]}")
+            seen[key] = mnemonic
+    return isa
+
+
+def encodings(inst: Dict) -> List:
+    """(mnemonic, funct) of the instruction and its aliases"""
+    result = [(inst["name"], inst["funct"])]
+    result += sorted(inst.get("aliases", {}).items(), key=lambda a: a[1])
+    return result
+
+
+def operands(syntax: str) -> List[str]:
+    """Operand names of an assembler syntax string"""
+    return [o.strip() for o in syntax.split(",")] if syntax else []
+
+
+def signature(syntax: str) -> str:
+    """Emitter signature of a syntax string, e.g. "rd, [rs1 + imm]" -> D_S1_IMM"""
+    return "_".join(SIGNATURE[o] for o in operands(syntax)) or "NONE"
+
+
+def generate_c(isa: Dict) -> str:
+    """The examples/cpu-isa.h header"""
+    insts = isa["instructions"]
+    decode = ["INST_INVALID"] * 256
+    mnemonics = ["NULL"] * 256
+    for inst in insts:
+        opcode = isa["formats"][inst["format"]]["opcode"]
+        for mnemonic, funct in encodings(inst):
+            decode[opcode << 4 | funct] = "INST_" + inst["name"]
+            mnemonics[opcode << 4 | funct] = f'"{mnemonic}"'
+
+    out = []
+    out.append("""/*
+ * AlphaAHB V5 Instruction Set Tables
+ *
+ * Generated by tooling/isa/alphaahb_isa.py from specs/instruction-set.json.
+ * Do not edit: change the description and run `make isa`.
+ *
+ * - CPU_INSTRUCTIONS(X): X(name, handler) for every instruction, in
+ *   instruction_type_t order; cpu_execute_<handler> runs it
+ * - cpu_isa: encoding, operand syntax, timing and properties per type
+ * - cpu_decode_table: type of every opcode/funct byte (instruction bits
+ *   63-56), INST_INVALID for unassigned encodings
+ * - cpu_isa_mnemonics: mnemonic of every opcode/funct byte (aliases
+ *   included), NULL for unassigned encodings
+ * - CPU_ISA_OPERANDS(X): X(NAME, name, SIGNATURE) for every instruction,
+ *   SIGNATURE naming its operands in syntax order (D destination, S1/S2
+ *   sources, IMM immediate or special register, TARGET branch target)
+ *
+ * Included by cpu-simulator.h.
+ */
+
+#ifndef ALPHAAHB_CPU_ISA_H
+#define ALPHAAHB_CPU_ISA_H
+
+#include <stddef.h>
+#include <stdint.h>
+""")
+    out.append("#define CPU_INSTRUCTIONS(X) \\")
+    rows = ["    X(INVALID, invalid)"] + [f"    X({i['name']}, {i['handler']})" for i in insts]
+    out.append(" \\\n".join(rows))
+    out.append("""
+#define CPU_ENUM(name, handler) INST_##name,
+typedef enum {
+    CPU_INSTRUCTIONS(CPU_ENUM)
+    INST_COUNT
+} instruction_type_t;
+#undef CPU_ENUM
+
+// cpu_isa_t.properties""")
+    for bit, (prop, macro) in enumerate(PROPERTIES.items()):
+        out.append(f"#define {macro} 0x{1 << bit:02X}  // {isa['properties'][prop]}")
+    out.append("""
+typedef struct {
+    const char *name;
+    uint8_t opcode;          // Primary opcode (bits 63-60)
+    uint8_t funct;           // Function code (bits 59-56)
+    char format;             // 'R', 'I', 'S', ...; 0 for INVALID
+    uint8_t properties;      // CPU_ISA_*
+    uint8_t latency;         // Cycles (instruction-timing.md), 0 = unspecified
+    uint8_t throughput;      // Per cycle, 0 = unspecified
+    const char *syntax;      // Assembler operands, e.g. "rd, rs1, imm"
+} cpu_isa_t;
+
+static const cpu_isa_t cpu_isa[INST_COUNT] = {
+    { "INVALID", 0x0, 0x0, 0, CPU_ISA_ENDS_BLOCK, 0, 0, "" },""")
+    for inst in insts:
+        opcode = isa["formats"][inst["format"]]["opcode"]
+        props = " | ".join(PROPERTIES[p] for p in inst["properties"]) or "0"
+        out.append(f'    {{ "{inst["name"]}", 0x{opcode:X}, 0x{inst["funct"]:X}, '
+                   f'\'{inst["format"]}\', {props}, {inst["latency"] or 0}, '
+                   f'{inst["throughput"] or 0}, "{inst["syntax"]}" }},')
+    out.append("};")
+    out.append("")
+    out.append("// Instruction type by opcode << 4 | funct: cpu_decode_table[word >> 56]")
+    out.append("static const uint8_t cpu_decode_table[256] = {")
+    for opcode in range(16):
+        row = decode[opcode * 16:opcode * 16 + 16]
+        if all(t == "INST_INVALID" for t in row):
+            out.append(f"    /* 0x{opcode:X}_ */ " + ", ".join(["0"] * 16) + ",")
+            continue
+        out.append(f"    /* 0x{opcode:X}_ */")
+        for start in range(0, 16, 4):
+            out.append("    " + ", ".join(row[start:start + 4]) + ",")
+    out.append("};")
+    out.append("")
+    out.append("// Mnemonic by opcode << 4 | funct")
+    out.append("static const char *const cpu_isa_mnemonics[256] = {")
+    for opcode in range(16):
+        row = mnemonics[opcode * 16:opcode * 16 + 16]
+        if all(m == "NULL" for m in row):
+            continue
+        for funct, mnemonic in enumerate(row):
+            if mnemonic != "NULL":
+                out.append(f"    [0x{opcode:X}{funct:X}] = {mnemonic},")
+    out.append("};")
+    out.append("")
+    out.append("#define CPU_ISA_OPERANDS(X) \\")
+    rows = [f"    X({i['name']}, {i['name'].lower()}, {signature(i['syntax'])})" for i in insts]
+    out.append(" \\\n".join(rows))
+    out.append("")
+    out.append("#endif // ALPHAAHB_CPU_ISA_H")
+    return "\n".join(out) + "\n"
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    parser = argparse.ArgumentParser(description="Generate the C ISA tables")
+    parser.add_argument("--isa", type=Path, default=DEFAULT_ISA,
+                        help="ISA description (default specs/instruction-set.json)")
+    parser.add_argument("-o", "--output", type=Path, default=DEFAULT_OUTPUT,
+                        help="Header to write (default examples/cpu-isa.h)")
+    parser.add_argument("--check", action="store_true",
+                        help="Fail if the header is not up to date instead of writing it")
+    args = parser.parse_args(argv)
+
+    try:
+        header = generate_c(load(args.isa))
+    except (OSError, ValueError, KeyError) as e:
+        print(f"Error: {e}", file=sys.stderr)
+        return 1
+    if args.check:
+        current = args.output.read_text() if args.output.exists() else ""
+        if current != header:
+            print(f"{args.output} is out of date (run make isa)", file=sys.stderr)
+            return 1
+        return 0
+    args.output.write_text(header)
+    print(f"Wrote {args.output}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
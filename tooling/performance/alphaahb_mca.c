@@ -0,0 +1,240 @@
+/*
+ * AlphaAHB V5 Machine Code Analyzer
+ * Developed and Maintained by GLCTC Corp.
+ *
+ * Static throughput report for a region of guest code (cpu-analyzer.h), in
+ * the layout of llvm-mca: steady-state cycles per iteration and the bound
+ * that sets them, the loop-carried critical dependency chain, port
+ * pressure and per-instruction timing. Input is an ELF executable written
+ * by cpu-assembler.h or assembler source; the region is the whole text, a
+ * symbol (--symbol) or an address range (--range).
+ *
+ * Build with `make tools`; the binary is build/alphaahb-mca.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "../../examples/cpu-analyzer.h"
+#include "../../examples/cpu-assembler.h"
+#include "../../examples/cpu-disassembler.h"
+
+static void usage(const char *prog) {
+    printf("Usage: %s [options] FILE\n", prog);
+    printf("  FILE               ELF executable, or assembler source\n");
+    printf("  --symbol NAME      Analyze the function or label NAME, up to its last\n");
+    printf("                     branch back to NAME when that makes it a loop\n");
+    printf("  --range START:END  Analyze the addresses [START, END)\n");
+    printf("  --iterations N     Iterations for the total cycle count (default 100)\n");
+    printf("  -h, --help         Show this help message\n");
+}
+
+// Whole file, NUL-terminated
+static char *read_file(const char *path, size_t *size) {
+    FILE *f = fopen(path, "rb");
+    char *data = NULL;
+    long n;
+
+    if (!f) {
+        return NULL;
+    }
+    if (fseek(f, 0, SEEK_END) != 0 || (n = ftell(f)) < 0 || fseek(f, 0, SEEK_SET) != 0 ||
+        !(data = malloc((size_t)n + 1)) || fread(data, 1, (size_t)n, f) != (size_t)n) {
+        free(data);
+        data = NULL;
+    } else {
+        data[n] = '\0';
+        *size = (size_t)n;
+    }
+    fclose(f);
+    return data;
+}
+
+// Assembles source into an image whose symbols are its named labels, each
+// running to the next one
+static int assemble(const char *text, size_t size, cpu_elf_image_t *image) {
+    cpu_asm_t a;
+
+    memset(image, 0, sizeof(*image));
+    cpu_asm_init(&a, CPU_RESET_PC);
+    if (cpu_asm_source(&a, text, size) != 0 || cpu_asm_finish(&a) != 0) {
+        fprintf(stderr, "%s\n", a.error);
+        cpu_asm_free(&a);
+        return -1;
+    }
+    image->symbols = malloc((a.named + 1) * sizeof(cpu_elf_symbol_t));
+    image->strings = malloc(a.names_size + 1);
+    if (!image->symbols || !image->strings) {
+        cpu_asm_free(&a);
+        cpu_elf_free(image);
+        return -1;
+    }
+    if (a.names_size) {
+        memcpy(image->strings, a.names, a.names_size);
+    }
+    image->symbol_count = cpu_asm_symbols(&a, image->strings, image->symbols);
+    image->words = a.words;
+    image->count = a.count;
+    image->base = image->entry = a.base;
+    a.words = NULL;
+    cpu_asm_free(&a);
+    return 0;
+}
+
+// End of the loop starting at start: just past the last branch back to it,
+// or end if there is none
+static uint64_t loop_end(const cpu_elf_image_t *image, uint64_t start, uint64_t end) {
+    uint64_t last = end;
+
+    for (uint64_t pc = start; pc < end; pc += CPU_INST_BYTES) {
+        cpu_op_t op;
+        cpu_predecode(image->words[(pc - image->base) / CPU_INST_BYTES], &op);
+        if ((cpu_isa[op.type].format == 'B' || op.type == INST_J) &&
+            pc + (uint64_t)(int64_t)op.imm == start) {
+            last = pc + CPU_INST_BYTES;
+        }
+    }
+    return last;
+}
+
+static void print_report(const cpu_mca_t *m, const cpu_elf_image_t *image, uint64_t start,
+                         uint64_t iterations) {
+    const uint64_t *words = image->words + (start - image->base) / CPU_INST_BYTES;
+    double cycles = cpu_mca_cycles(m, iterations);
+    char text[CPU_DISASM_MAX], name[16];
+
+    printf("Iterations:        %llu\n", (unsigned long long)iterations);
+    printf("Instructions:      %llu\n", (unsigned long long)(iterations * m->count));
+    printf("Total Cycles:      %.0f\n", cycles);
+    printf("Dispatch Width:    %d\n", CPU_MCA_DISPATCH_WIDTH);
+    printf("IPC:               %.2f\n", cycles > 0 ? (double)(iterations * m->count) / cycles : 0.0);
+    printf("Block RThroughput: %.2f\n", m->cycles_per_iteration);
+    printf("Bottleneck:        %s\n", m->bottleneck);
+
+    printf("\nCycles per iteration bounds:\n");
+    printf("  dispatch    %8.2f\n", m->dispatch_bound);
+    printf("  ports       %8.2f\n", m->port_bound);
+    printf("  recurrence  %8.2f\n", m->recurrence_bound);
+    printf("  latency     %8u  (one iteration, %d-stage pipeline)\n", m->latency,
+           CPU_MCA_PIPELINE_DEPTH);
+
+    printf("\nCritical dependency chain (%.0f cycles, carried to the next iteration):\n",
+           m->recurrence_bound);
+    if (m->chain_length == 0) {
+        printf("  none\n");
+    }
+    for (size_t c = 0; c < m->chain_length; c++) {
+        size_t i = m->chain[c];
+        cpu_disasm(words[i], start + i * CPU_INST_BYTES, image, text, sizeof(text));
+        printf("  [%zu] %-40s +%u\n", i, text, m->inst[i].latency);
+    }
+
+    printf("\nResource pressure per iteration:\n");
+    for (unsigned p = 0; p < CPU_MCA_PORTS; p++) {
+        if (m->port_pressure[p] > 0) {
+            cpu_mca_port_name(p, name, sizeof(name));
+            printf("%-7s", name);
+        }
+    }
+    printf("\n");
+    for (unsigned p = 0; p < CPU_MCA_PORTS; p++) {
+        if (m->port_pressure[p] > 0) {
+            printf("%-7.2f", m->port_pressure[p]);
+        }
+    }
+    printf("\n");
+
+    printf("\nInstruction Info:\n");
+    printf("[1]: Latency\n[2]: RThroughput\n[3]: Unit\n[4]: On the critical chain\n\n");
+    printf("[1]    [2]    [3]    [4]    Instructions:\n");
+    for (size_t i = 0; i < m->count; i++) {
+        const cpu_mca_inst_t *in = &m->inst[i];
+        cpu_disasm(words[i], start + i * CPU_INST_BYTES, image, text, sizeof(text));
+        printf(" %-6u %-6.2f %-6s %-6s %s\n", in->latency, 1.0 / in->ports,
+               cpu_mca_unit_names[in->unit], in->critical ? "*" : "", text);
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *path = NULL, *symbol = NULL, *range = NULL;
+    uint64_t iterations = 100;
+    cpu_elf_image_t image;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--symbol") == 0 && i + 1 < argc) {
+            symbol = argv[++i];
+        } else if (strcmp(argv[i], "--range") == 0 && i + 1 < argc) {
+            range = argv[++i];
+        } else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = strtoull(argv[++i], NULL, 0);
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+            return strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+    if (!path) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    size_t size = 0;
+    char *data = read_file(path, &size);
+    if (!data) {
+        fprintf(stderr, "%s: cannot read\n", path);
+        return 1;
+    }
+    int rc = size >= 4 && memcmp(data, "\177ELF", 4) == 0
+                 ? cpu_elf_parse((const unsigned char *)data, size, &image)
+                 : assemble(data, size, &image);
+    free(data);
+    if (rc != 0) {
+        fprintf(stderr, "%s: not an AlphaAHB executable or assembler source\n", path);
+        return 1;
+    }
+
+    // Region: the whole text unless narrowed
+    uint64_t start = image.base, end = image.base + image.count * CPU_INST_BYTES;
+    if (symbol) {
+        size_t s = 0;
+        while (s < image.symbol_count && strcmp(image.symbols[s].name, symbol) != 0) s++;
+        if (s == image.symbol_count) {
+            fprintf(stderr, "%s: no symbol %s\n", path, symbol);
+            cpu_elf_free(&image);
+            return 1;
+        }
+        start = image.symbols[s].address;
+        end = start + image.symbols[s].size;
+    } else if (range) {
+        char *colon;
+        start = strtoull(range, &colon, 0);
+        end = *colon == ':' ? strtoull(colon + 1, NULL, 0) : 0;
+    }
+    if (start < image.base || end > image.base + image.count * CPU_INST_BYTES || end <= start ||
+        (start - image.base) % CPU_INST_BYTES != 0 || (end - start) % CPU_INST_BYTES != 0) {
+        fprintf(stderr, "%s: region outside the text\n", path);
+        cpu_elf_free(&image);
+        return 1;
+    }
+    if (symbol) {
+        end = loop_end(&image, start, end);
+    }
+
+    cpu_mca_t *m = malloc(sizeof(cpu_mca_t));
+    if (!m || cpu_mca_analyze(image.words + (start - image.base) / CPU_INST_BYTES,
+                              (size_t)(end - start) / CPU_INST_BYTES, m) != 0) {
+        fprintf(stderr, "%s: region has invalid instructions or more than %d\n", path,
+                CPU_MCA_MAX);
+        rc = 1;
+    } else {
+        print_report(m, &image, start, iterations);
+    }
+    free(m);
+    cpu_elf_free(&image);
+    return rc;
+}
@@ -0,0 +1,102 @@
+/*
+ * AlphaAHB V5 Guest Profiler
+ * Developed and Maintained by GLCTC Corp.
+ *
+ * Runs an ELF executable written by cpu-assembler.h on the simulator with
+ * the sampling profiler attached (cpu-profiler.h) and prints where the
+ * guest spent its instructions: self and total per function, and
+ * optionally folded stacks for flame graphs (flamegraph.pl, speedscope).
+ *
+ * Build with `make tools`; the binary is build/alphaahb-prof.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "../../examples/cpu-profiler.h"
+
+static void usage(const char *prog) {
+    printf("Usage: %s [options] FILE\n", prog);
+    printf("  FILE               ELF executable\n");
+    printf("  --period N         Sample every N instructions per core (default 1000)\n");
+    printf("  --mode MODE        Engine: switch, threaded, block or jit (default jit)\n");
+    printf("  --cores N          Cores running FILE (default 1)\n");
+    printf("  --max N            Stop after N instructions in total (default: until halt)\n");
+    printf("  --folded OUT       Write folded stacks to OUT\n");
+    printf("  -h, --help         Show this help message\n");
+}
+
+int main(int argc, char **argv) {
+    const char *path = NULL, *folded = NULL;
+    uint64_t period = 1000, max = UINT64_MAX;
+    int mode = CPU_MODE_JIT, cores = 1, rc = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--period") == 0 && i + 1 < argc) {
+            period = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--mode") == 0 && i + 1 < argc) {
+            i++;
+            for (mode = 0; mode < CPU_MODES && strcmp(cpu_mode_names[mode], argv[i]) != 0; mode++) {
+            }
+            if (mode == CPU_MODES) {
+                fprintf(stderr, "unknown mode %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--cores") == 0 && i + 1 < argc) {
+            cores = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--max") == 0 && i + 1 < argc) {
+            max = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--folded") == 0 && i + 1 < argc) {
+            folded = argv[++i];
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+            return strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+    if (!path || cores < 1 || cores > MAX_CORES) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    cpu_elf_image_t image;
+    if (cpu_elf_read(path, &image) != 0) {
+        fprintf(stderr, "%s: not an AlphaAHB executable\n", path);
+        return 1;
+    }
+    cpu_system_t *cpu = cpu_create(cores, (uint64_t)16 << 20);
+    cpu_prof_t p;
+    if (!cpu || cpu_load_program(cpu, image.base, image.words, image.count) != 0 ||
+        cpu_prof_init(&p, period, &image) != 0) {
+        fprintf(stderr, "%s: cannot load, or the period is zero\n", path);
+        cpu_destroy(cpu);
+        cpu_elf_free(&image);
+        return 1;
+    }
+    cpu_reset(cpu, image.entry);
+
+    if (cpu_prof_run(cpu, (cpu_mode_t)mode, max, &p) != 0) {
+        fprintf(stderr, "%s: a core faulted or the cores deadlocked\n", path);
+        rc = 1;
+    }
+    cpu_prof_write_table(&p, stdout);
+    if (folded) {
+        FILE *out = fopen(folded, "w");
+        if (!out || cpu_prof_write_folded(&p, out) != 0) {
+            fprintf(stderr, "%s: cannot write\n", folded);
+            rc = 1;
+        }
+        if (out) {
+            fclose(out);
+        }
+    }
+    cpu_prof_free(&p);
+    cpu_destroy(cpu);
+    cpu_elf_free(&image);
+    return rc;
+}
@@ -0,0 +1,161 @@
+/*
+ * AlphaAHB V5 Simulation Engine C ABI
+ * Developed and Maintained by GLCTC Corp.
+ *
+ * libalphaahb.so: the functions of alphaahb_engine.h over cpu_system_t.
+ * Built with -fvisibility=hidden, so only the ALPHAAHB_API functions are
+ * exported and the inlined simulator stays private to the library.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+#define ALPHAAHB_ENGINE_BUILD
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "alphaahb_engine.h"
+#include "../../examples/cpu-elf.h"
+
+struct alphaahb_engine {
+    cpu_system_t *cpu;
+};
+
+// The register block is the start of register_file_t
+typedef char alphaahb_register_layout_check[
+    offsetof(register_file_t, flags) == ALPHAAHB_REG_FLAGS * sizeof(uint64_t) &&
+    offsetof(register_file_t, pc) == ALPHAAHB_REG_PC * sizeof(uint64_t) &&
+    offsetof(register_file_t, lr) == ALPHAAHB_REG_LR * sizeof(uint64_t) ? 1 : -1];
+
+static cpu_core_t *engine_core(const alphaahb_engine_t *engine, int core) {
+    if (core < 0 || core >= engine->cpu->num_cores) {
+        return NULL;
+    }
+    return &engine->cpu->cores[core];
+}
+
+ALPHAAHB_API unsigned alphaahb_engine_abi_version(void) {
+    return ALPHAAHB_ENGINE_ABI_VERSION;
+}
+
+ALPHAAHB_API int alphaahb_engine_max_cores(void) {
+    return MAX_CORES;
+}
+
+ALPHAAHB_API alphaahb_engine_t *alphaahb_engine_create(int num_cores, uint64_t memory_size) {
+    alphaahb_engine_t *engine = malloc(sizeof(*engine));
+
+    if (!engine) {
+        return NULL;
+    }
+    engine->cpu = cpu_create(num_cores, memory_size);
+    if (!engine->cpu) {
+        free(engine);
+        return NULL;
+    }
+    return engine;
+}
+
+ALPHAAHB_API void alphaahb_engine_destroy(alphaahb_engine_t *engine) {
+    if (engine) {
+        cpu_destroy(engine->cpu);
+        free(engine);
+    }
+}
+
+ALPHAAHB_API int alphaahb_engine_load(alphaahb_engine_t *engine, uint64_t address,
+                                      const uint64_t *words, size_t count) {
+    return cpu_load_program(engine->cpu, address, words, count);
+}
+
+ALPHAAHB_API int alphaahb_engine_load_image(alphaahb_engine_t *engine, const void *data,
+                                            size_t size) {
+    cpu_elf_image_t image;
+    int rc;
+
+    if (size >= 4 && memcmp(data, "\177ELF", 4) == 0) {
+        if (cpu_elf_parse(data, size, &image) != 0) {
+            return -1;
+        }
+        rc = cpu_load_program(engine->cpu, image.base, image.words, image.count);
+        if (rc == 0) {
+            cpu_reset(engine->cpu, image.entry);
+        }
+        cpu_elf_free(&image);
+        return rc;
+    }
+    if (size % CPU_INST_BYTES != 0) {
+        return -1;
+    }
+    // Raw words may be unaligned in the caller's buffer
+    uint64_t *words = malloc(size ? size : 1);
+    if (!words) {
+        return -1;
+    }
+    memcpy(words, data, size);
+    rc = cpu_load_program(engine->cpu, CPU_RESET_PC, words, size / CPU_INST_BYTES);
+    free(words);
+    return rc;
+}
+
+ALPHAAHB_API void alphaahb_engine_reset(alphaahb_engine_t *engine, uint64_t entry) {
+    cpu_reset(engine->cpu, entry);
+}
+
+ALPHAAHB_API int alphaahb_engine_run(alphaahb_engine_t *engine, int mode,
+                                     uint64_t max_instructions) {
+    if (mode < 0 || mode >= CPU_MODES) {
+        return -1;
+    }
+    return cpu_run(engine->cpu, (cpu_mode_t)mode, max_instructions);
+}
+
+ALPHAAHB_API int alphaahb_engine_num_cores(const alphaahb_engine_t *engine) {
+    return engine->cpu->num_cores;
+}
+
+ALPHAAHB_API int alphaahb_engine_halted(const alphaahb_engine_t *engine) {
+    return cpu_halted(engine->cpu);
+}
+
+ALPHAAHB_API int alphaahb_engine_core_state(const alphaahb_engine_t *engine, int core) {
+    cpu_core_t *c = engine_core(engine, core);
+    return c ? (int)c->state : -1;
+}
+
+ALPHAAHB_API uint64_t alphaahb_engine_retired(const alphaahb_engine_t *engine, int core) {
+    cpu_core_t *c = engine_core(engine, core);
+
+    if (core == -1) {
+        return cpu_retired(engine->cpu);
+    }
+    return c ? c->retired : 0;
+}
+
+ALPHAAHB_API uint64_t *alphaahb_engine_registers(alphaahb_engine_t *engine, int core) {
+    cpu_core_t *c = engine_core(engine, core);
+    return c ? c->regs.gpr : NULL;
+}
+
+ALPHAAHB_API float *alphaahb_engine_fp_registers(alphaahb_engine_t *engine, int core) {
+    cpu_core_t *c = engine_core(engine, core);
+    return c ? c->regs.fpr : NULL;
+}
+
+ALPHAAHB_API uint8_t *alphaahb_engine_memory(alphaahb_engine_t *engine, uint64_t *size) {
+    if (size) {
+        *size = engine->cpu->memory_size;
+    }
+    return engine->cpu->memory;
+}
+
+ALPHAAHB_API void alphaahb_engine_memory_written(alphaahb_engine_t *engine, uint64_t address,
+                                                 uint64_t bytes) {
+    cpu_system_t *cpu = engine->cpu;
+    uint64_t end = cpu->text_base + cpu->text_count * CPU_INST_BYTES;
+
+    if (cpu->text_count && bytes && address < end && address + bytes > cpu->text_base) {
+        cpu_text_written(cpu, address, bytes);
+    }
+}
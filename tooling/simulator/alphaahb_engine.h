@@ -0,0 +1,119 @@
+/*
+ * AlphaAHB V5 Simulation Engine C ABI
+ * Developed and Maintained by GLCTC Corp.
+ *
+ * Stable C interface to the native simulator (examples/cpu-simulator.h),
+ * built as the shared library libalphaahb.so by `make tools`. It is what
+ * alphaahb_native.py binds with ctypes, and what other languages should
+ * bind as well: the engine is an opaque handle, every parameter is a fixed
+ * width integer or a pointer, and no simulator structure crosses the
+ * boundary.
+ *
+ * Registers and memory are exposed in place, so bindings can wrap them in
+ * array views without copying. A core's register block is
+ * ALPHAAHB_REG_COUNT uint64_t values: R0-R63, then PC, SP, FP, LR and
+ * FLAGS. FLAGS is current whenever alphaahb_engine_run is not executing.
+ * Hosts may write registers and memory between runs, except that R0 must
+ * stay zero and writes into the loaded program must be reported with
+ * alphaahb_engine_memory_written before the next run.
+ *
+ * Compatibility: functions are only ever added. A change to the meaning of
+ * an existing function or constant bumps ALPHAAHB_ENGINE_ABI_VERSION, and
+ * bindings compare it with alphaahb_engine_abi_version() at load time.
+ *
+ * Functions that can fail return 0 on success and -1 on error.
+ */
+
+#ifndef ALPHAAHB_ENGINE_H
+#define ALPHAAHB_ENGINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ALPHAAHB_ENGINE_ABI_VERSION 1
+
+#if defined(ALPHAAHB_ENGINE_BUILD) && defined(__GNUC__)
+#define ALPHAAHB_API __attribute__((visibility("default")))
+#else
+#define ALPHAAHB_API
+#endif
+
+// Execution engines (cpu_mode_t)
+#define ALPHAAHB_MODE_SWITCH 0
+#define ALPHAAHB_MODE_THREADED 1
+#define ALPHAAHB_MODE_BLOCK 2
+#define ALPHAAHB_MODE_JIT 3
+
+// Core states (cpu_state_t)
+#define ALPHAAHB_CORE_RUNNING 0
+#define ALPHAAHB_CORE_WAITING 1
+#define ALPHAAHB_CORE_BARRIER 2
+#define ALPHAAHB_CORE_HALTED 3
+#define ALPHAAHB_CORE_FAULTED 4
+
+// Register block layout
+#define ALPHAAHB_GPR_COUNT 64
+#define ALPHAAHB_REG_PC 64
+#define ALPHAAHB_REG_SP 65
+#define ALPHAAHB_REG_FP 66
+#define ALPHAAHB_REG_LR 67
+#define ALPHAAHB_REG_FLAGS 68
+#define ALPHAAHB_REG_COUNT 69
+#define ALPHAAHB_FPR_COUNT 64
+
+typedef struct alphaahb_engine alphaahb_engine_t;
+
+ALPHAAHB_API unsigned alphaahb_engine_abi_version(void);
+
+// Most cores one engine can model
+ALPHAAHB_API int alphaahb_engine_max_cores(void);
+
+// A system of num_cores cores sharing memory_size bytes of zeroed memory,
+// or NULL
+ALPHAAHB_API alphaahb_engine_t *alphaahb_engine_create(int num_cores, uint64_t memory_size);
+ALPHAAHB_API void alphaahb_engine_destroy(alphaahb_engine_t *engine);
+
+// Loads count instruction words at address as the program and resets every
+// core to start there
+ALPHAAHB_API int alphaahb_engine_load(alphaahb_engine_t *engine, uint64_t address,
+                                      const uint64_t *words, size_t count);
+
+// Loads an ELF executable written by cpu-assembler.h, or raw instruction
+// words at the reset PC, and resets every core to the entry point
+ALPHAAHB_API int alphaahb_engine_load_image(alphaahb_engine_t *engine, const void *data,
+                                            size_t size);
+
+// Resets registers and counters of every core to start at entry
+ALPHAAHB_API void alphaahb_engine_reset(alphaahb_engine_t *engine, uint64_t entry);
+
+// Runs until every core halts or max_instructions have retired in total;
+// -1 when a core faults or the cores deadlock
+ALPHAAHB_API int alphaahb_engine_run(alphaahb_engine_t *engine, int mode,
+                                     uint64_t max_instructions);
+
+ALPHAAHB_API int alphaahb_engine_num_cores(const alphaahb_engine_t *engine);
+ALPHAAHB_API int alphaahb_engine_halted(const alphaahb_engine_t *engine);
+ALPHAAHB_API int alphaahb_engine_core_state(const alphaahb_engine_t *engine, int core);
+
+// Instructions retired by core since the last reset; all cores when core
+// is -1
+ALPHAAHB_API uint64_t alphaahb_engine_retired(const alphaahb_engine_t *engine, int core);
+
+// In-place views, valid until the engine is destroyed; NULL for a bad core
+ALPHAAHB_API uint64_t *alphaahb_engine_registers(alphaahb_engine_t *engine, int core);
+ALPHAAHB_API float *alphaahb_engine_fp_registers(alphaahb_engine_t *engine, int core);
+ALPHAAHB_API uint8_t *alphaahb_engine_memory(alphaahb_engine_t *engine, uint64_t *size);
+
+// The host wrote bytes at address through the memory view
+ALPHAAHB_API void alphaahb_engine_memory_written(alphaahb_engine_t *engine, uint64_t address,
+                                                 uint64_t bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ALPHAAHB_ENGINE_H
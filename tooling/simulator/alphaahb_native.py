@@ -0,0 +1,188 @@
+#!/usr/bin/env python3
+"""
+AlphaAHB V5 Native Simulation Engine
+Developed and Maintained by GLCTC Corp.
+
+ctypes binding of libalphaahb.so (alphaahb_engine.h), the C simulator built
+by `make tools`. Registers and memory are NumPy views of the engine's own
+storage: reading them after a run, or writing them before one, copies
+nothing. Views stay valid until the engine is closed.
+
+The library is looked up in $ALPHAAHB_ENGINE_LIB, then in the repository's
+build directory, then on the system library path.
+"""
+
+import ctypes
+import ctypes.util
+import os
+from pathlib import Path
+from typing import Optional, Union
+
+import numpy as np
+
+ABI_VERSION = 1
+
+MODES = {"switch": 0, "threaded": 1, "block": 2, "jit": 3}
+CORE_STATES = ["running", "waiting", "barrier", "halted", "faulted"]
+
+GPR_COUNT = 64
+REG_PC = 64
+REG_SP = 65
+REG_FP = 66
+REG_LR = 67
+REG_FLAGS = 68
+REG_COUNT = 69
+FPR_COUNT = 64
+
+class NativeEngineError(RuntimeError):
+    """The native engine is missing or rejected an operation"""
+
+def _find_library() -> str:
+    """Path of libalphaahb.so"""
+    override = os.environ.get("ALPHAAHB_ENGINE_LIB")
+    if override:
+        return override
+    built = Path(__file__).resolve().parents[2] / "build" / "libalphaahb.so"
+    if built.exists():
+        return str(built)
+    found = ctypes.util.find_library("alphaahb")
+    if found:
+        return found
+    raise NativeEngineError("libalphaahb.so not found; run `make tools` or set ALPHAAHB_ENGINE_LIB")
+
+_library = None
+
+def load_library(path: Optional[str] = None) -> ctypes.CDLL:
+    """Load the engine library once and declare its functions"""
+    global _library
+    if _library is not None and path is None:
+        return _library
+
+    lib = ctypes.CDLL(path or _find_library())
+    engine = ctypes.c_void_p
+    signatures = {
+        "alphaahb_engine_abi_version": (ctypes.c_uint, []),
+        "alphaahb_engine_max_cores": (ctypes.c_int, []),
+        "alphaahb_engine_create": (engine, [ctypes.c_int, ctypes.c_uint64]),
+        "alphaahb_engine_destroy": (None, [engine]),
+        "alphaahb_engine_load": (ctypes.c_int, [engine, ctypes.c_uint64, ctypes.c_void_p,
+                                                ctypes.c_size_t]),
+        "alphaahb_engine_load_image": (ctypes.c_int, [engine, ctypes.c_char_p, ctypes.c_size_t]),
+        "alphaahb_engine_reset": (None, [engine, ctypes.c_uint64]),
+        "alphaahb_engine_run": (ctypes.c_int, [engine, ctypes.c_int, ctypes.c_uint64]),
+        "alphaahb_engine_num_cores": (ctypes.c_int, [engine]),
+        "alphaahb_engine_halted": (ctypes.c_int, [engine]),
+        "alphaahb_engine_core_state": (ctypes.c_int, [engine, ctypes.c_int]),
+        "alphaahb_engine_retired": (ctypes.c_uint64, [engine, ctypes.c_int]),
+        "alphaahb_engine_registers": (ctypes.POINTER(ctypes.c_uint64), [engine, ctypes.c_int]),
+        "alphaahb_engine_fp_registers": (ctypes.POINTER(ctypes.c_float), [engine, ctypes.c_int]),
+        "alphaahb_engine_memory": (ctypes.POINTER(ctypes.c_uint8),
+                                   [engine, ctypes.POINTER(ctypes.c_uint64)]),
+        "alphaahb_engine_memory_written": (None, [engine, ctypes.c_uint64, ctypes.c_uint64]),
+    }
+    for name, (restype, argtypes) in signatures.items():
+        function = getattr(lib, name)
+        function.restype = restype
+        function.argtypes = argtypes
+
+    version = lib.alphaahb_engine_abi_version()
+    if version != ABI_VERSION:
+        raise NativeEngineError(f"libalphaahb.so has ABI version {version}, expected {ABI_VERSION}")
+    if path is None:
+        _library = lib
+    return lib
+
+def _per_core_view(first: ctypes.POINTER, second: Optional[ctypes.POINTER], num_cores: int,
+                   count: int, dtype: np.dtype) -> np.ndarray:
+    """(num_cores, count) view of per-core arrays spaced evenly in memory"""
+    itemsize = np.dtype(dtype).itemsize
+    start = ctypes.cast(first, ctypes.c_void_p).value
+    stride = ctypes.cast(second, ctypes.c_void_p).value - start if second else count * itemsize
+    span = (num_cores - 1) * stride + count * itemsize
+    buffer = (ctypes.c_uint8 * span).from_address(start)
+    return np.ndarray(shape=(num_cores, count), dtype=dtype, buffer=buffer,
+                      strides=(stride, itemsize))
+
+class NativeEngine:
+    """Cores, memory and execution engines of the C simulator"""
+
+    def __init__(self, num_cores: int = 1, memory_size: int = 16 * 1024 * 1024,
+                 library: Optional[str] = None):
+        self._handle = None
+        self._lib = load_library(library)
+        max_cores = self._lib.alphaahb_engine_max_cores()
+        if not 1 <= num_cores <= max_cores:
+            raise NativeEngineError(f"native engine models 1 to {max_cores} cores, not {num_cores}")
+        self._handle = self._lib.alphaahb_engine_create(num_cores, memory_size)
+        if not self._handle:
+            raise NativeEngineError(f"cannot create {num_cores} cores with {memory_size} bytes")
+        self.num_cores = num_cores
+
+        size = ctypes.c_uint64()
+        base = self._lib.alphaahb_engine_memory(self._handle, ctypes.byref(size))
+        self.memory = np.ctypeslib.as_array(base, shape=(size.value,))
+
+        def core_arrays(function, count, dtype):
+            second = function(self._handle, 1) if num_cores > 1 else None
+            return _per_core_view(function(self._handle, 0), second, num_cores, count, dtype)
+
+        # registers[core, ALPHAAHB register index]: R0-R63, PC, SP, FP, LR, FLAGS
+        self.registers = core_arrays(self._lib.alphaahb_engine_registers, REG_COUNT, np.uint64)
+        self.fp_registers = core_arrays(self._lib.alphaahb_engine_fp_registers, FPR_COUNT,
+                                        np.float32)
+
+    def close(self):
+        """Destroy the engine; its views must not be used afterwards"""
+        if self._handle:
+            self.memory = self.registers = self.fp_registers = None
+            self._lib.alphaahb_engine_destroy(self._handle)
+            self._handle = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def __del__(self):
+        self.close()
+
+    def load(self, words: Union[np.ndarray, bytes], address: int = 0x1000):
+        """Load instruction words at address and reset every core there"""
+        words = np.ascontiguousarray(np.frombuffer(words, dtype=np.uint64)
+                                     if isinstance(words, (bytes, bytearray)) else words,
+                                     dtype=np.uint64)
+        if self._lib.alphaahb_engine_load(self._handle, address, words.ctypes.data,
+                                          words.size) != 0:
+            raise NativeEngineError(f"cannot load {words.size} words at {address:#x}")
+
+    def load_image(self, data: bytes):
+        """Load an ELF executable, or raw instruction words at the reset PC"""
+        if self._lib.alphaahb_engine_load_image(self._handle, bytes(data), len(data)) != 0:
+            raise NativeEngineError("not an AlphaAHB executable or instruction image")
+
+    def reset(self, entry: int = 0x1000):
+        self._lib.alphaahb_engine_reset(self._handle, entry)
+
+    def run(self, max_instructions: int, mode: str = "jit") -> bool:
+        """Run until every core halts or max_instructions retire; True if all halted"""
+        if mode not in MODES:
+            raise ValueError(f"unknown engine mode {mode!r}")
+        if self._lib.alphaahb_engine_run(self._handle, MODES[mode], max_instructions) != 0:
+            raise NativeEngineError("a core faulted or the cores deadlocked")
+        return self.halted
+
+    def memory_written(self, address: int, nbytes: int):
+        """Report host writes to memory, required where they touch the program"""
+        self._lib.alphaahb_engine_memory_written(self._handle, address, nbytes)
+
+    @property
+    def halted(self) -> bool:
+        return bool(self._lib.alphaahb_engine_halted(self._handle))
+
+    def retired(self, core: int = -1) -> int:
+        """Instructions retired by core, or by every core"""
+        return self._lib.alphaahb_engine_retired(self._handle, core)
+
+    def core_state(self, core: int) -> str:
+        return CORE_STATES[self._lib.alphaahb_engine_core_state(self._handle, core)]
@@ -5,6 +5,12 @@ Developed and Maintained by GLCTC Corp.
 
 A comprehensive cycle-accurate simulator for the AlphaAHB V5 ISA and AlphaM MIMD SoC.
 Supports full pipeline simulation, multi-core MIMD execution, and performance analysis.
+
+With backend="native" (--backend native), simulate() runs the program on the
+C simulator through libalphaahb.so (alphaahb_native.py) instead: binaries are
+ELF executables or raw 64-bit instruction words in the encoding of
+examples/cpu-simulator.h, and the engine's registers and memory stay
+available as NumPy views in simulator.native.
 """
 
 import sys
@@ -77,9 +83,14 @@ class SimulationResult:
 class AlphaAHBSimulator:
     """Main simulator class"""
     
-    def __init__(self, target: str = "alpham", num_cores: int = 64):
+    def __init__(self, target: str = "alpham", num_cores: int = 64, backend: str = "python",
+                 engine_mode: str = "jit"):
         self.target = target
         self.num_cores = num_cores
+        self.backend = backend
+        self.engine_mode = engine_mode
+        self.native = None
+        self.pipeline_stages = len(PipelineStage)
         self.cores = self._init_cores()
         self.memory = MemoryHierarchy(
             l1i_cache={},
@@ -91,7 +102,6 @@ class AlphaAHBSimulator:
         )
         self.current_cycle = 0
         self.instruction_set = self._init_instruction_set()
-        self.pipeline_stages = len(PipelineStage)
         
     def _init_cores(self) -> List[Core]:
         """Initialize cores based on target"""
@@ -279,6 +289,9 @@ class AlphaAHBSimulator:
 
     def simulate(self, binary_data: bytes, max_cycles: int = 1000000) -> SimulationResult:
         """Run simulation"""
+        if self.backend == "native":
+            return self._simulate_native(binary_data, max_cycles)
+
         print(f"Starting simulation with {len(self.cores)} cores")
         print(f"Target: {self.target}")
         print(f"Binary size: {len(binary_data)} bytes")
@@ -310,6 +323,56 @@ class AlphaAHBSimulator:
         
         return result
 
+    def _simulate_native(self, binary_data: bytes, max_cycles: int) -> SimulationResult:
+        """Run simulation on the C engine, one instruction per core per cycle"""
+        from alphaahb_native import NativeEngine, load_library
+
+        if self.native is None:
+            max_cores = load_library().alphaahb_engine_max_cores()
+            num_cores = min(self.num_cores, max_cores) if self.target == "alpham" else 1
+            self.native = NativeEngine(num_cores=num_cores)
+        engine = self.native
+        print(f"Starting native simulation with {engine.num_cores} cores ({self.engine_mode} engine)")
+        print(f"Target: {self.target}")
+        print(f"Binary size: {len(binary_data)} bytes")
+
+        engine.load_image(binary_data)
+        start_time = time.time()
+        engine.run(max_cycles * engine.num_cores, mode=self.engine_mode)
+        simulation_time = time.time() - start_time
+
+        retired = [engine.retired(core) for core in range(engine.num_cores)]
+        total_instructions = sum(retired)
+        total_cycles = max(retired)
+        self.current_cycle = total_cycles
+        result = SimulationResult(
+            total_cycles=total_cycles,
+            total_instructions=total_instructions,
+            ipc=total_instructions / total_cycles if total_cycles > 0 else 0.0,
+            power_consumption=0.0,
+            memory_bandwidth=0.0,
+            cache_hit_rates={},
+            core_utilization={core: count / total_instructions if total_instructions > 0 else 0.0
+                              for core, count in enumerate(retired)},
+            performance_metrics={
+                "simulation_time": simulation_time,
+                "target": self.target,
+                "num_cores": engine.num_cores,
+                "backend": "native",
+                "engine_mode": self.engine_mode,
+                "halted": engine.halted,
+                "instructions_per_second": (total_instructions / simulation_time
+                                            if simulation_time > 0 else 0.0)
+            }
+        )
+
+        print(f"Simulation completed in {simulation_time:.2f} seconds")
+        print(f"Total cycles: {result.total_cycles}")
+        print(f"Total instructions: {result.total_instructions}")
+        print(f"IPC: {result.ipc:.2f}")
+
+        return result
+
     def _simulate_cycle(self):
         """Simulate one cycle"""
         for core in self.cores:
@@ -710,6 +773,10 @@ def main():
     parser.add_argument('--cycles', type=int, default=1000000,
                        help='Maximum simulation cycles')
     parser.add_argument('--output', help='Output file for results')
+    parser.add_argument('--backend', choices=['python', 'native'], default='python',
+                       help='Simulate in Python or on the C engine (libalphaahb.so, `make tools`)')
+    parser.add_argument('--engine-mode', choices=['switch', 'threaded', 'block', 'jit'],
+                       default='jit', help='Execution engine of the native backend')
     
     args = parser.parse_args()
     
@@ -718,7 +785,8 @@ def main():
         binary_data = f.read()
     
     # Create simulator
-    simulator = AlphaAHBSimulator(target=args.target, num_cores=args.cores)
+    simulator = AlphaAHBSimulator(target=args.target, num_cores=args.cores,
+                                  backend=args.backend, engine_mode=args.engine_mode)
     
     # Run simulation
     result = simulator.simulate(binary_data, max_cycles=args.cycles)
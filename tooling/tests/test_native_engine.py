@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+"""
+AlphaAHB V5 Native Engine Binding Tests
+Developed and Maintained by GLCTC Corp.
+
+Tests of alphaahb_native.py against build/libalphaahb.so (`make tools`):
+the register and memory views, re-predecoding after the host patches the
+program, raw and ELF images, and AlphaAHBSimulator's native backend.
+Skipped when NumPy or the library is missing.
+
+Run with `make tools-check`.
+"""
+
+import json
+import struct
+import sys
+import unittest
+from pathlib import Path
+
+ROOT = Path(__file__).resolve().parents[2]
+sys.path.insert(0, str(ROOT / "tooling" / "simulator"))
+
+try:
+    import numpy as np
+    import alphaahb_native
+    from alphaahb_native import NativeEngine, NativeEngineError
+    alphaahb_native.load_library()
+    SKIP_REASON = None
+except (ImportError, OSError, NativeEngineError) as error:
+    SKIP_REASON = f"native engine unavailable: {error}"
+
+RESET_PC = 0x1000
+RESET_SP = 0x8000
+INST_BYTES = 8
+ELF_MACHINE = 0x4148
+
+def _load_spec():
+    with open(ROOT / "specs" / "instruction-set.json") as f:
+        return json.load(f)
+
+SPEC = _load_spec()
+INSTRUCTIONS = {inst["name"]: inst for inst in SPEC["instructions"]}
+
+def encode(name: str, rd: int = 0, rs1: int = 0, rs2: int = 0, imm: int = 0) -> int:
+    """Instruction word in the encoding of examples/cpu-simulator.h"""
+    inst = INSTRUCTIONS[name]
+    fmt = SPEC["formats"][inst["format"]]
+    extended = 0
+    if fmt["rd"] == "rs1":
+        rs1 = rd
+    else:
+        extended = rd & 0xF
+    if fmt["imm"] == "extended":
+        extended = imm & 0xFFFFFFFF
+        imm = 0
+    return ((fmt["opcode"] & 0xF) << 60 | (inst["funct"] & 0xF) << 56 | (rs2 & 0xF) << 52 |
+            (rs1 & 0xF) << 48 | (imm & 0xFFFF) << 32 | extended)
+
+def words(*program: int) -> "np.ndarray":
+    return np.array(program, dtype=np.uint64)
+
+def elf_image(program: "np.ndarray", base: int) -> bytes:
+    """Minimal executable accepted by cpu_elf_parse: one text segment, no sections"""
+    order = 1 if sys.byteorder == "little" else 2
+    ident = b"\x7fELF" + bytes([2, order, 1]) + bytes(9)
+    header_size, segment_size, section_size = 64, 56, 64
+    header = struct.pack("=16sHHIQQQIHHHHHH", ident, 2, ELF_MACHINE, 1, base, header_size, 0, 0,
+                         header_size, segment_size, 1, section_size, 0, 0)
+    text = program.tobytes()
+    segment = struct.pack("=IIQQQQQQ", 1, 5, header_size + segment_size, base, base, len(text),
+                          len(text), INST_BYTES)
+    return header + segment + text
+
+@unittest.skipIf(SKIP_REASON is not None, SKIP_REASON)
+class NativeEngineTest(unittest.TestCase):
+    """NativeEngine over libalphaahb.so"""
+
+    def setUp(self):
+        self.engine = NativeEngine(num_cores=2, memory_size=1 << 20)
+
+    def tearDown(self):
+        self.engine.close()
+
+    def test_register_views(self):
+        engine = self.engine
+        engine.load(words(encode("ADDI", 4, 4, imm=1),
+                          encode("ADD", 3, 1, 2),
+                          encode("HALT")))
+        self.assertEqual(engine.registers.shape, (2, alphaahb_native.REG_COUNT))
+        self.assertEqual(engine.fp_registers.shape, (2, alphaahb_native.FPR_COUNT))
+        np.testing.assert_array_equal(engine.registers[:, alphaahb_native.REG_PC], RESET_PC)
+        np.testing.assert_array_equal(engine.registers[:, alphaahb_native.REG_SP], RESET_SP)
+
+        # Inputs and the entry point go in through the views, without a copy
+        engine.registers[:, 1] = [40, 41]
+        engine.registers[:, 2] = 2
+        engine.registers[:, alphaahb_native.REG_PC] = RESET_PC + INST_BYTES
+        self.assertTrue(engine.run(1000))
+        np.testing.assert_array_equal(engine.registers[:, 3], [42, 43])
+        np.testing.assert_array_equal(engine.registers[:, 4], 0)
+        self.assertEqual([engine.retired(core) for core in range(2)], [2, 2])
+        self.assertEqual(engine.retired(), 4)
+        self.assertEqual(engine.core_state(1), "halted")
+
+    def test_memory_written(self):
+        engine = self.engine
+        program = words(encode("ADDI", 2, 2, imm=1), encode("HALT"))
+        patched = words(encode("ADDI", 2, 2, imm=5))
+        engine.load(program)
+        for mode in alphaahb_native.MODES:
+            with self.subTest(mode=mode):
+                engine.memory[RESET_PC:RESET_PC + INST_BYTES] = program[:1].view(np.uint8)
+                engine.memory_written(RESET_PC, INST_BYTES)
+                engine.reset(RESET_PC)
+                engine.run(1000, mode=mode)
+                self.assertEqual(engine.registers[0, 2], 1)
+
+                # The patched word runs only because the write was reported
+                engine.memory[RESET_PC:RESET_PC + INST_BYTES] = patched.view(np.uint8)
+                engine.memory_written(RESET_PC, INST_BYTES)
+                engine.reset(RESET_PC)
+                engine.run(1000, mode=mode)
+                self.assertEqual(engine.registers[0, 2], 5)
+
+    def test_load_image(self):
+        engine = self.engine
+        program = words(encode("ADDI", 1, 0, imm=6),
+                        encode("ADDI", 2, 0, imm=7),
+                        encode("MUL", 3, 1, 2),
+                        encode("HALT"))
+
+        engine.load_image(program.tobytes())
+        self.assertEqual(engine.registers[0, alphaahb_native.REG_PC], RESET_PC)
+        engine.run(1000)
+        self.assertEqual(engine.registers[0, 3], 42)
+
+        base = 0x4000
+        engine.load_image(elf_image(program, base))
+        self.assertEqual(engine.registers[0, alphaahb_native.REG_PC], base)
+        self.assertEqual(engine.registers[0, 3], 0)
+        self.assertEqual(bytes(engine.memory[base:base + program.nbytes]), program.tobytes())
+        engine.run(1000)
+        self.assertEqual(engine.registers[0, 3], 42)
+
+        with self.assertRaises(NativeEngineError):
+            engine.load_image(program.tobytes()[:-1])
+        damaged = bytearray(elf_image(program, base))
+        damaged[18] ^= 0xFF
+        with self.assertRaises(NativeEngineError):
+            engine.load_image(bytes(damaged))
+
+@unittest.skipIf(SKIP_REASON is not None, SKIP_REASON)
+class NativeBackendTest(unittest.TestCase):
+    """AlphaAHBSimulator.simulate with backend="native" """
+
+    def test_simulate(self):
+        from alphaahb_sim import AlphaAHBSimulator
+
+        simulator = AlphaAHBSimulator(target="alpham", num_cores=2, backend="native",
+                                      engine_mode="threaded")
+        program = words(encode("ADDI", 1, 0, imm=6),
+                        encode("MUL", 3, 1, 1),
+                        encode("HALT"))
+        try:
+            result = simulator.simulate(program.tobytes(), max_cycles=1000)
+            self.assertEqual(result.total_instructions, 6)
+            self.assertEqual(result.total_cycles, 3)
+            self.assertEqual(result.performance_metrics["backend"], "native")
+            self.assertTrue(result.performance_metrics["halted"])
+            np.testing.assert_array_equal(simulator.native.registers[:, 3], 36)
+        finally:
+            if simulator.native is not None:
+                simulator.native.close()
+
+if __name__ == "__main__":
+    unittest.main()